@@ -3,6 +3,7 @@
 import logging
 import asyncio
 import ipaddress
+from typing import List
 
 import aiocoap
 import aiocoap.error as error
@@ -26,13 +27,25 @@ class UnknownAddressRequest(error.BadRequest):
 
 ipv6_byte_len = 16
 
+def cbor_array(items: List[bytes]) -> bytes:
+    """Places already encoded CBOR items in an array, so certificates are sent exactly as they were loaded"""
+    length = len(items)
+    if length < 24:
+        header = bytes([0x80 | length])
+    elif length < 256:
+        header = bytes([0x98, length])
+    else:
+        header = bytes([0x99]) + length.to_bytes(2, "big")
+
+    return header + b"".join(items)
+
 class COAPKeyServer(resource.Resource):
     def __init__(self, keystore: Keystore):
         super().__init__()
         self.keystore = keystore
 
     async def render_get(self, request):
-        """An MQTT Subscribe request"""
+        """Return the certificate for the requested address, or the certificates for a CBOR list of addresses"""
 
         try:
             if request.opt.content_format == media_types_rev['text/plain;charset=utf-8']:
@@ -42,7 +55,12 @@ class COAPKeyServer(resource.Resource):
                 request_address = ipaddress.IPv6Address(request.payload[0:ipv6_byte_len])
 
             elif request.opt.content_format == media_types_rev['application/cbor']:
-                request_address = ipaddress.IPv6Address(cbor2.loads(request.payload))
+                request_address = cbor2.loads(request.payload)
+
+                if isinstance(request_address, list):
+                    request_address = [ipaddress.IPv6Address(address) for address in request_address]
+                else:
+                    request_address = ipaddress.IPv6Address(request_address)
 
             else:
                 raise error.UnsupportedContentFormat()
@@ -52,6 +70,22 @@ class COAPKeyServer(resource.Resource):
 
         logger.info(f"Received request for {request_address} from {request.remote}")
 
+        if isinstance(request_address, list):
+            # Respond with the certificates that can be provided, the node will ask again for those missing
+            certs = []
+            for address in request_address:
+                try:
+                    certs.append(self._get_cert(address))
+                except UnknownAddressRequest:
+                    logger.warning(f"Unable to provide certificate for {address}")
+
+            payload = cbor_array(certs)
+        else:
+            payload = self._get_cert(request_address)
+
+        return aiocoap.Message(payload=payload, content_format=media_types_rev['application/cbor'])
+
+    def _get_cert(self, request_address: ipaddress.IPv6Address) -> bytes:
         # Convert to global address, if request is for link-local
         if str(request_address).startswith("fe80"):
             global_request_address = ipaddress.IPv6Address("fd00" + str(request_address)[4:])
@@ -61,12 +95,10 @@ class COAPKeyServer(resource.Resource):
             request_address = global_request_address
 
         try:
-            cert = self.keystore.get_cert(request_address)
+            return self.keystore.get_cert(request_address)
         except FileNotFoundError:
             raise UnknownAddressRequest()
 
-        return aiocoap.Message(payload=cert, content_format=media_types_rev['application/cbor'])
-
 
 def main(key_dir, coap_target_port):
     logger.info("Starting coap key server")
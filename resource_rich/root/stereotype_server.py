@@ -5,6 +5,7 @@ import asyncio
 import os
 from enum import IntEnum
 from dataclasses import dataclass
+from typing import List, Union
 
 import aiocoap
 import aiocoap.error as error
@@ -38,14 +39,27 @@ class StereotypeRequest:
     tags: StereotypeTags
 
     @staticmethod
-    def decode(payload: bytes) -> StereotypeRequest:
-        model, tags = cbor2.loads(payload)
+    def decode(data) -> StereotypeRequest:
+        model, tags = data
 
         model = TrustModel(model)
         tags = StereotypeTags(*tags)
 
         return StereotypeRequest(model, tags)
 
+    @staticmethod
+    def decode_payload(payload: bytes) -> Union[StereotypeRequest, List[StereotypeRequest]]:
+        """A payload is either a single [model, tags] request or a list of them"""
+        data = cbor2.loads(payload)
+
+        if not isinstance(data, list):
+            raise error.BadRequest("Stereotype request is not an array")
+
+        if len(data) == 0 or isinstance(data[0], list):
+            return [StereotypeRequest.decode(item) for item in data]
+        else:
+            return StereotypeRequest.decode(data)
+
 @dataclass(frozen=True)
 class StereotypeResponse:
     model: TrustModel
@@ -61,12 +75,28 @@ class StereotypeResponse:
 
 class StereotypeServer(resource.Resource):
     async def render_get(self, request):
-        """Return stereotype information for the requested Edge server"""
+        """Return stereotype information for the requested Edge server(s)"""
         if request.opt.content_format != media_types_rev['application/cbor']:
             raise error.UnsupportedContentFormat()
 
-        payload = StereotypeRequest.decode(request.payload)
+        payload = StereotypeRequest.decode_payload(request.payload)
+
+        if isinstance(payload, list):
+            # Respond with the stereotypes that can be provided, those missing will be requested again
+            result = []
+            for item in payload:
+                try:
+                    result.append(self._stereotype(item).encode())
+                except error.ConstructionRenderableError as ex:
+                    logger.warning(f"Unable to provide stereotype for {item}: {ex!r}")
+        else:
+            result = self._stereotype(payload).encode()
+
+        result_payload = cbor2.dumps(result)
+
+        return aiocoap.Message(payload=result_payload, code=codes.CONTENT, content_format=media_types_rev['application/cbor'])
 
+    def _stereotype(self, payload: StereotypeRequest) -> StereotypeResponse:
         if payload.model == TrustModel.No:
             result = self._no_trust_model(payload)
 
@@ -85,10 +115,7 @@ class StereotypeServer(resource.Resource):
         else:
             raise error.BadRequest(f"Unknown trust model {payload.model}")
 
-        result = StereotypeResponse(payload.model, payload.tags, result)
-        result_payload = cbor2.dumps(result.encode())
-
-        return aiocoap.Message(payload=result_payload, code=codes.CONTENT, content_format=media_types_rev['application/cbor'])
+        return StereotypeResponse(payload.model, payload.tags, result)
 
     def _no_trust_model(self, payload: StereotypeRequest):
         # No trust information
@@ -253,9 +253,10 @@ config = [
     ('Stereotypes', 'MAX_NUM_STEREOTYPES', 5, 'stereotypes_memb'),
     ('Edges', 'NUM_EDGE_RESOURCES', 4, 'edge_resources_memb'),
     ('Edge Capabilities', 'NUM_EDGE_CAPABILITIES', 3 * 4, 'edge_capabilities_memb'),
-    ('Peers', 'NUM_PEERS', 8, 'peers_memb'),
-    ('Peer Edges', 'NUM_PEERS', 8 * 4, 'peer_edges_memb'),
-    ('Peer Edge Capabilities', 'NUM_PEERS', 8 * 4 * 3, 'peer_capabilities_memb'),
+    # Peer info built with PEER_INFO_COMPACT uses plain arrays instead of MEMBs
+    ('Peers', 'NUM_PEERS', 8, 'peers_memb', 'peers'),
+    ('Peer Edges', 'NUM_PEERS', 8 * 4, 'peer_edges_memb', 'peer_edges'),
+    ('Peer Edge Capabilities', 'NUM_PEERS', 8 * 4 * 3, 'peer_capabilities_memb', 'peer_capabilities'),
     None,
     ('Reputation Tx Buffer', 'TRUST_TX_SIZE', 2, 'trust_tx_memb'),
     ('Reputation Rx Buffer', 'TRUST_RX_SIZE', 2, 'trust_rx_memb'),
@@ -269,9 +270,10 @@ for conf in config:
         print("\\midrule")
         continue
 
-    (nice_name, cname, num, vname) = conf
+    (nice_name, cname, num, vname, *alt_names) = conf
+    names = [vname + "_memb_mem", *alt_names]
     try:
-        [symb] = [x for x in ram_symb if x.name == vname + "_memb_mem"]
+        [symb] = [x for x in ram_symb if x.name in names]
         size = symb.size
         print(f"{nice_name} & {num} & {int(size/num)} & {size} \\\\ % {vname}")
     except ValueError:
@@ -0,0 +1,56 @@
+#!/usr/bin/env python3
+
+"""
+Generates the lookup table used by gaussian_dist_cdf in wsn/common/trust/distributions.c.
+
+The table holds the upper tail of the standard normal distribution, Q(z) = 1 - Phi(z) = erfc(z / sqrt(2)) / 2,
+for z from 0 to NORMAL_CDF_TABLE_MAX_Z in steps of 1 / NORMAL_CDF_TABLE_STEPS. Values are in [0, 0.5] so they are
+stored as Q0.16 in a uint16_t, which is also directly a Q16.16 fraction.
+"""
+
+import math
+
+def generate(steps_log2: int, max_z: int) -> str:
+    steps = 1 << steps_log2
+    count = max_z * steps + 1
+
+    values = [round(math.erfc((i / steps) / math.sqrt(2)) / 2 * 65536) for i in range(count)]
+
+    # Check the Q0.16 values fit
+    assert all(0 <= v <= 0xffff for v in values)
+
+    lines = [
+        "// Generated by tools/gen_normal_cdf_table.py, do not edit",
+        "#pragma once",
+        "/*-------------------------------------------------------------------------------------------------------------------*/",
+        "#include <stdint.h>",
+        "/*-------------------------------------------------------------------------------------------------------------------*/",
+        f"#define NORMAL_CDF_TABLE_STEPS_LOG2 {steps_log2}",
+        "#define NORMAL_CDF_TABLE_STEPS (1 << NORMAL_CDF_TABLE_STEPS_LOG2)",
+        f"#define NORMAL_CDF_TABLE_MAX_Z {max_z}",
+        "#define NORMAL_CDF_TABLE_LEN (NORMAL_CDF_TABLE_MAX_Z * NORMAL_CDF_TABLE_STEPS + 1)",
+        "/*-------------------------------------------------------------------------------------------------------------------*/",
+        "// Q(z) = 1 - Phi(z) in Q0.16 for z = i / NORMAL_CDF_TABLE_STEPS",
+        "static const uint16_t normal_cdf_table[NORMAL_CDF_TABLE_LEN] = {",
+    ]
+
+    for i in range(0, count, 8):
+        lines.append("    " + " ".join(f"{v:5d}," for v in values[i:i+8]))
+
+    lines.append("};")
+    lines.append("/*-------------------------------------------------------------------------------------------------------------------*/")
+
+    return "\n".join(lines) + "\n"
+
+if __name__ == "__main__":
+    import argparse
+
+    parser = argparse.ArgumentParser(description='Generate the normal CDF lookup table')
+    parser.add_argument('-s', '--steps-log2', type=int, default=6, help='The table has 2^steps_log2 entries per unit of z.')
+    parser.add_argument('-z', '--max-z', type=int, default=6, help='The largest z in the table, Q(z) is 0 beyond it.')
+    parser.add_argument('-o', '--output', type=str, default="wsn/common/trust/normal-cdf-table.h", help='The header to write.')
+
+    args = parser.parse_args()
+
+    with open(args.output, "w") as f:
+        f.write(generate(args.steps_log2, args.max_z))
@@ -26,6 +26,10 @@ class Setup(BaseSetup):
             build_args["PROFILE_AES"] = 1
         elif self.mode == "ECC":
             build_args["PROFILE_ECC"] = 1
+        elif self.mode == "TRUST":
+            build_args["PROFILE_TRUST"] = 1
+        elif self.mode == "CRYPTO_QUEUE":
+            build_args["PROFILE_CRYPTO_QUEUE"] = 1
         else:
             raise RuntimeError(f"Unknown profile mode {self.mode}")
 
@@ -39,7 +43,7 @@ if __name__ == "__main__":
     import argparse
 
     parser = argparse.ArgumentParser(description='Setup')
-    parser.add_argument('mode', choices=['ECC', 'AES'], help='What to profile')
+    parser.add_argument('mode', choices=['ECC', 'AES', 'TRUST', 'CRYPTO_QUEUE'], help='What to profile')
     parser.add_argument('--target', choices=available_targets, default=available_targets[0], help="Which target to compile for")
     parser.add_argument('--verbose-make', action='store_true', help='Outputs greater detail while compiling')
     parser.add_argument('--deploy', choices=['none', 'ansible', 'fabric'], default='none', help='Choose how deployment is performed to observers')
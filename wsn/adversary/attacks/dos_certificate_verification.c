@@ -59,7 +59,8 @@ static bool build_message(void)
         return false;
     }
 
-    if (!queue_message_to_sign(&dos_certificate_verification, payload_buf, payload_buf, sizeof(payload_buf), payload_len))
+    if (!queue_message_to_sign(&dos_certificate_verification, payload_buf, payload_buf, sizeof(payload_buf), payload_len,
+                               CRYPTO_PRIORITY_BULK, CRYPTO_NO_DEADLINE))
     {
         LOG_ERR("trust periodic_action: Unable to sign message\n");
         return false;
@@ -89,7 +90,7 @@ static bool build_message_continue(void* data)
     }
     else
     {
-        LOG_ERR("Sign of trust information failed %d\n", entry->result);
+        LOG_ERR("Sign of trust information failed %" CRYPTO_RESULT_SPEC "\n", entry->result);
         return false;
     }
 
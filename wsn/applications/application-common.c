@@ -12,10 +12,11 @@
 #define LOG_LEVEL LOG_LEVEL_NONE
 #endif
 /*-------------------------------------------------------------------------------------------------------------------*/
-void app_state_init(app_state_t* state, const char* name, const char* uri)
+void app_state_init(app_state_t* state, capability_id_t id, const char* uri)
 {
     state->running = false;
-    state->name = name;
+    state->id = id;
+    state->name = capability_id_name(id);
     state->uri = uri;
 }
 /*-------------------------------------------------------------------------------------------------------------------*/
@@ -27,7 +28,7 @@ bool app_state_edge_capability_add(app_state_t* state, edge_resource_t* edge)
 
     const bool prev_running = state->running;
 
-    state->running = edge_info_has_active_capability(state->name);
+    state->running = edge_info_has_active_capability(state->id);
 
     edge_capability_add_common(edge);
 
@@ -43,7 +44,7 @@ bool app_state_edge_capability_remove(app_state_t* state, edge_resource_t* edge)
 
     const bool prev_running = state->running;
 
-    state->running = edge_info_has_active_capability(state->name);
+    state->running = edge_info_has_active_capability(state->id);
 
     edge_capability_remove_common(edge);
 
@@ -5,6 +5,7 @@
 #include "edge-info.h"
 /*-------------------------------------------------------------------------------------------------------------------*/
 typedef struct {
+    capability_id_t id;
     const char* name;
     const char* uri;
 
@@ -20,7 +21,7 @@ typedef struct {
 
 } app_state_t;
 /*-------------------------------------------------------------------------------------------------------------------*/
-void app_state_init(app_state_t* state, const char* name, const char* uri);
+void app_state_init(app_state_t* state, capability_id_t id, const char* uri);
 /*-------------------------------------------------------------------------------------------------------------------*/
 bool app_state_edge_capability_add(app_state_t* state, edge_resource_t* edge);
 bool app_state_edge_capability_remove(app_state_t* state, edge_resource_t* edge);
@@ -17,6 +17,13 @@
 #define LOG_LEVEL LOG_LEVEL_NONE
 #endif
 /*-------------------------------------------------------------------------------------------------------------------*/
+#ifdef APPLICATION_PROCESSES
+APPLICATION_PROCESSES_DECL;
+/*-------------------------------------------------------------------------------------------------------------------*/
+// Indexed by capability ID, as APPLICATION_PROCESSES is in the same order as APPLICATION_NAMES
+static struct process* const application_processes[CAPABILITY_ID_NUM] = { APPLICATION_PROCESSES };
+#endif
+/*-------------------------------------------------------------------------------------------------------------------*/
 struct process* find_process_with_name(const char* name)
 {
 	for (struct process* iter = PROCESS_LIST(); iter != NULL; iter = iter->next)
@@ -32,7 +39,19 @@ struct process* find_process_with_name(const char* name)
 /*-------------------------------------------------------------------------------------------------------------------*/
 struct process* find_process_for_capability(const edge_capability_t* cap)
 {
-    return find_process_with_name(cap->name);
+    if (!capability_id_is_valid(cap->id))
+    {
+        return NULL;
+    }
+
+#ifdef APPLICATION_PROCESSES
+    struct process* proc = application_processes[cap->id];
+
+    return process_is_running(proc) ? proc : NULL;
+#else
+    // Builds without the applications' processes (e.g., the adversary) can only find them by name
+    return find_process_with_name(capability_id_name(cap->id));
+#endif
 }
 /*-------------------------------------------------------------------------------------------------------------------*/
 void post_to_capability_process(const edge_capability_t* cap, process_event_t pe, void* data)
@@ -46,7 +65,7 @@ void post_to_capability_process(const edge_capability_t* cap, process_event_t pe
     }
     else
     {
-        LOG_INFO("Failed to find a process running the application (%s)\n", cap->name);
+        LOG_INFO("Failed to find a process running the application (%s)\n", capability_id_name(cap->id));
     }
 }
 /*-------------------------------------------------------------------------------------------------------------------*/
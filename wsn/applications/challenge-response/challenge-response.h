@@ -4,6 +4,9 @@
 /*-------------------------------------------------------------------------------------------------------------------*/
 #define CHALLENGE_RESPONSE_APPLICATION_NAME "cr"
 #define CHALLENGE_RESPONSE_APPLICATION_URI "cr"
+
+// No trust weights, as the result quality of this application contributes to other applications instead
+#define CHALLENGE_RESPONSE_TRUST_WEIGHTS(X)
 /*-------------------------------------------------------------------------------------------------------------------*/
 typedef struct {
     uint8_t data[32];
@@ -557,7 +557,7 @@ init(void)
     oscore_protect_resource(&res_coap);
 #endif
 
-    app_state_init(&app_state, CHALLENGE_RESPONSE_APPLICATION_NAME, CHALLENGE_RESPONSE_APPLICATION_URI);
+    app_state_init(&app_state, CHALLENGE_RESPONSE_APPLICATION_ID, CHALLENGE_RESPONSE_APPLICATION_URI);
 
     timed_unlock_init(&coap_callback_in_use, "challenge-response", (1 * 60 * CLOCK_SECOND));
 
@@ -3,4 +3,20 @@
 #define MONITORING_APPLICATION_NAME "envmon"
 #define MONITORING_APPLICATION_URI "envmon"
 
+// Trust weights, see trust-models.h
+#ifdef APPLICATIONS_MONITOR_THROUGHPUT
+#define MONITORING_TRUST_WEIGHTS_METRICS(X) \
+    X(TRUST_METRIC_TASK_SUBMISSION, 2.0f/3.0f) \
+    X(TRUST_METRIC_THROUGHPUT,      1.0f/3.0f)
+#else
+#define MONITORING_TRUST_WEIGHTS_METRICS(X) \
+    X(TRUST_METRIC_TASK_SUBMISSION, 1.0f)
+#endif
+
+// If the trust model uses reputation, only assign up to
+// this much of the total trust value from reputation
+#define MONITORING_TRUST_WEIGHTS(X) \
+    MONITORING_TRUST_WEIGHTS_METRICS(X) \
+    X(TRUST_CONF_REPUTATION_WEIGHT, 0.25f)
+
 void init_trust_weights_monitoring(void);
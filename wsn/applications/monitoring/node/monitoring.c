@@ -131,7 +131,7 @@ send_callback(coap_callback_request_state_t* callback_state)
     // Find the information on the capability for this edge
     // If this capability no longer exists, then the Edge has informed us that it no longer
     // offers that capability
-    edge_capability_t* cap = edge_info_capability_find(edge, MONITORING_APPLICATION_NAME);
+    edge_capability_t* cap = edge_info_capability_find(edge, MONITORING_APPLICATION_ID);
     if (cap == NULL)
     {
         LOG_WARN("Edge ");
@@ -180,7 +180,7 @@ periodic_action(void)
     LOG_DBG("Generated message (len=%d)\n", len);
 
     // Choose an Edge node to send information to
-    edge_resource_t* edge = choose_edge(MONITORING_APPLICATION_NAME);
+    edge_resource_t* edge = choose_edge(MONITORING_APPLICATION_ID);
     if (edge == NULL)
     {
         LOG_ERR("Failed to find an edge resource to send task to\n");
@@ -269,7 +269,7 @@ init(void)
     SENSORS_ACTIVATE(temperature_sensor);
 #endif
 
-    app_state_init(&app_state, MONITORING_APPLICATION_NAME, MONITORING_APPLICATION_URI);
+    app_state_init(&app_state, MONITORING_APPLICATION_ID, MONITORING_APPLICATION_URI);
 
     timed_unlock_init(&coap_callback_in_use, "monitoring", (1 * 60 * CLOCK_SECOND));
 }
@@ -188,7 +188,7 @@ send_callback(coap_callback_request_state_t* callback_state)
     // Find the information on the capability for this edge
     // If this capability no longer exists, then the Edge has informed us that it no longer
     // offers that capability
-    edge_capability_t* cap = edge_info_capability_find(edge, ROUTING_APPLICATION_NAME);
+    edge_capability_t* cap = edge_info_capability_find(edge, ROUTING_APPLICATION_ID);
     if (cap == NULL)
     {
         LOG_WARN("Edge ");
@@ -325,7 +325,7 @@ event_triggered_action(const char* data)
         task_dest.latitude, task_dest.longitude);
 
     // Choose an Edge node to send information to
-    edge_resource_t* edge = choose_edge(ROUTING_APPLICATION_NAME);
+    edge_resource_t* edge = choose_edge(ROUTING_APPLICATION_ID);
     if (edge == NULL)
     {
         LOG_ERR("Failed to find an edge resource to send task to\n");
@@ -416,7 +416,7 @@ routing_response_process_status(coap_message_t *request)
         return;
     }
 
-    edge_capability_t* cap = edge_info_capability_find(edge, ROUTING_APPLICATION_NAME);
+    edge_capability_t* cap = edge_info_capability_find(edge, ROUTING_APPLICATION_ID);
     if (cap == NULL)
     {
         LOG_ERR("Failed to find edge (");
@@ -450,7 +450,7 @@ routing_process_task_timeout(void)
         return;
     }
 
-    edge_capability_t* cap = edge_info_capability_find(edge, ROUTING_APPLICATION_NAME);
+    edge_capability_t* cap = edge_info_capability_find(edge, ROUTING_APPLICATION_ID);
     if (!cap)
     {
         LOG_ERR("Failed to find capability " ROUTING_APPLICATION_NAME " for edge ");
@@ -478,7 +478,7 @@ routing_process_task_result(coap_message_t *request, const tm_result_quality_inf
         return;
     }
 
-    edge_capability_t* cap = edge_info_capability_find(edge, ROUTING_APPLICATION_NAME);
+    edge_capability_t* cap = edge_info_capability_find(edge, ROUTING_APPLICATION_ID);
     if (!cap)
     {
         LOG_ERR("Failed to find capability " ROUTING_APPLICATION_NAME " for edge ");
@@ -666,7 +666,7 @@ init(void)
 
     init_trust_weights_routing();
 
-    app_state_init(&app_state, ROUTING_APPLICATION_NAME, ROUTING_APPLICATION_URI);
+    app_state_init(&app_state, ROUTING_APPLICATION_ID, ROUTING_APPLICATION_URI);
 
     timed_unlock_init(&coap_callback_in_use, "routing-coap", (1 * 60 * CLOCK_SECOND));
     timed_unlock_init(&task_in_use, "routing-task", (2 * 60 * CLOCK_SECOND));
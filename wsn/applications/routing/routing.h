@@ -5,6 +5,26 @@
 
 #define ROUTING_SUBMIT_TASK "submit-task:route-req:"
 
+// Trust weights, see trust-models.h
+#ifdef APPLICATIONS_MONITOR_THROUGHPUT
+#define ROUTING_TRUST_WEIGHTS_METRICS(X) \
+    X(TRUST_METRIC_TASK_SUBMISSION, 1.0f/4.0f) \
+    X(TRUST_METRIC_TASK_RESULT,     1.0f/4.0f) \
+    X(TRUST_METRIC_RESULT_QUALITY,  1.0f/4.0f) \
+    X(TRUST_METRIC_THROUGHPUT,      1.0f/4.0f)
+#else
+#define ROUTING_TRUST_WEIGHTS_METRICS(X) \
+    X(TRUST_METRIC_TASK_SUBMISSION, 1.0f/3.0f) \
+    X(TRUST_METRIC_TASK_RESULT,     1.0f/3.0f) \
+    X(TRUST_METRIC_RESULT_QUALITY,  1.0f/3.0f)
+#endif
+
+// If the trust model uses reputation, only assign up to
+// this much of the total trust value from reputation
+#define ROUTING_TRUST_WEIGHTS(X) \
+    ROUTING_TRUST_WEIGHTS_METRICS(X) \
+    X(TRUST_CONF_REPUTATION_WEIGHT, 0.25f)
+
 void init_trust_weights_routing(void);
 
 typedef struct {
@@ -2,17 +2,33 @@
 
 #include "pt.h"
 #include "os/sys/log.h"
+#include "os/sys/rtimer.h"
 #include "os/lib/assert.h"
-#include "os/lib/queue.h"
+#include "os/lib/list.h"
 #include "os/lib/memb.h"
+
+#include <inttypes.h>
+#include <string.h>
 /*-------------------------------------------------------------------------------------------------------------------*/
 #ifndef MESSAGES_TO_SIGN_SIZE
 #define MESSAGES_TO_SIGN_SIZE 3
 #endif
+
+// Entries only CRYPTO_PRIORITY_CRITICAL messages may use, so a backlog of other work cannot lock them out
+#ifndef MESSAGES_TO_SIGN_RESERVED
+#define MESSAGES_TO_SIGN_RESERVED 1
+#endif
 /*-------------------------------------------------------------------------------------------------------------------*/
 #ifndef MESSAGES_TO_VERIFY_SIZE
 #define MESSAGES_TO_VERIFY_SIZE 3
 #endif
+
+#ifndef MESSAGES_TO_VERIFY_RESERVED
+#define MESSAGES_TO_VERIFY_RESERVED 1
+#endif
+/*-------------------------------------------------------------------------------------------------------------------*/
+_Static_assert(MESSAGES_TO_SIGN_RESERVED < MESSAGES_TO_SIGN_SIZE, "Must leave some messages to sign unreserved");
+_Static_assert(MESSAGES_TO_VERIFY_RESERVED < MESSAGES_TO_VERIFY_SIZE, "Must leave some messages to verify unreserved");
 /*-------------------------------------------------------------------------------------------------------------------*/
 #define LOG_MODULE "crypto-sup"
 #ifdef CRYPTO_SUPPORT_LOG_LEVEL
@@ -27,6 +43,9 @@ process_event_t pe_message_verified;
 PROCESS(signer, "signer");
 PROCESS(verifier, "verifier");
 /*-------------------------------------------------------------------------------------------------------------------*/
+static crypto_queue_stats_t sign_stats[CRYPTO_PRIORITY_NUM];
+static crypto_queue_stats_t verify_stats[CRYPTO_PRIORITY_NUM];
+/*-------------------------------------------------------------------------------------------------------------------*/
 void
 crypto_support_init(void)
 {
@@ -42,19 +61,109 @@ crypto_support_init(void)
     process_start(&verifier, NULL);
 }
 /*-------------------------------------------------------------------------------------------------------------------*/
-QUEUE(messages_to_sign);
+static void
+crypto_schedule_init(crypto_schedule_t* sched, crypto_priority_t priority, clock_time_t max_wait)
+{
+    sched->priority = priority;
+    sched->queued_clock = clock_time();
+    sched->max_wait = max_wait;
+    sched->queued_at = RTIMER_NOW();
+}
+/*-------------------------------------------------------------------------------------------------------------------*/
+static bool
+crypto_schedule_expired(const crypto_schedule_t* sched, clock_time_t now)
+{
+    return sched->max_wait != CRYPTO_NO_DEADLINE && (clock_time_t)(now - sched->queued_clock) > sched->max_wait;
+}
+/*-------------------------------------------------------------------------------------------------------------------*/
+static clock_time_t
+crypto_schedule_remaining(const crypto_schedule_t* sched, clock_time_t now)
+{
+    const clock_time_t waited = now - sched->queued_clock;
+
+    return waited >= sched->max_wait ? 0 : sched->max_wait - waited;
+}
+/*-------------------------------------------------------------------------------------------------------------------*/
+// Returns true if a should be started before b
+static bool
+crypto_schedule_before(const crypto_schedule_t* a, const crypto_schedule_t* b, clock_time_t now)
+{
+    if (a->priority != b->priority)
+    {
+        return a->priority < b->priority;
+    }
+
+    // Earliest deadline first, b was queued first so wins ties
+    if (a->max_wait != CRYPTO_NO_DEADLINE)
+    {
+        return b->max_wait == CRYPTO_NO_DEADLINE ||
+               crypto_schedule_remaining(a, now) < crypto_schedule_remaining(b, now);
+    }
+
+    return false;
+}
+/*-------------------------------------------------------------------------------------------------------------------*/
+static bool
+crypto_schedule_can_allocate(crypto_priority_t priority, struct memb* m, int reserved)
+{
+    return priority == CRYPTO_PRIORITY_CRITICAL || memb_numfree(m) > reserved;
+}
+/*-------------------------------------------------------------------------------------------------------------------*/
+static uint32_t
+crypto_stats_elapsed_us(rtimer_clock_t since)
+{
+    const uint64_t us = RTIMERTICKS_TO_US_64((rtimer_clock_t)(RTIMER_NOW() - since));
+
+    return us > UINT32_MAX ? UINT32_MAX : (uint32_t)us;
+}
+/*-------------------------------------------------------------------------------------------------------------------*/
+static void
+crypto_stats_started(crypto_queue_stats_t* stats, const crypto_schedule_t* sched)
+{
+    const uint32_t wait = crypto_stats_elapsed_us(sched->queued_at);
+
+    stats->started += 1;
+    stats->wait_total += wait;
+    if (wait > stats->wait_max)
+    {
+        stats->wait_max = wait;
+    }
+}
+/*-------------------------------------------------------------------------------------------------------------------*/
+static void
+crypto_stats_completed(crypto_queue_stats_t* stats, rtimer_clock_t started_at)
+{
+    const uint32_t service = crypto_stats_elapsed_us(started_at);
+
+    stats->completed += 1;
+    stats->service_total += service;
+    if (service > stats->service_max)
+    {
+        stats->service_max = service;
+    }
+}
+/*-------------------------------------------------------------------------------------------------------------------*/
+LIST(messages_to_sign);
 MEMB(messages_to_sign_memb, messages_to_sign_entry_t, MESSAGES_TO_SIGN_SIZE);
 /*-------------------------------------------------------------------------------------------------------------------*/
-QUEUE(messages_to_verify);
+LIST(messages_to_verify);
 MEMB(messages_to_verify_memb, messages_to_verify_entry_t, MESSAGES_TO_VERIFY_SIZE);
 /*-------------------------------------------------------------------------------------------------------------------*/
 bool queue_message_to_sign(struct process* process, void* data,
-                           uint8_t* message, uint16_t message_buffer_len, uint16_t message_len)
+                           uint8_t* message, uint16_t message_buffer_len, uint16_t message_len,
+                           crypto_priority_t priority, clock_time_t max_wait)
 {
-    messages_to_sign_entry_t* item = memb_alloc(&messages_to_sign_memb);
+    assert(priority < CRYPTO_PRIORITY_NUM);
+
+    messages_to_sign_entry_t* item = NULL;
+    if (crypto_schedule_can_allocate(priority, &messages_to_sign_memb, MESSAGES_TO_SIGN_RESERVED))
+    {
+        item = memb_alloc(&messages_to_sign_memb);
+    }
     if (!item)
     {
-        LOG_WARN("queue_message_to_sign: out of memory\n");
+        LOG_WARN("queue_message_to_sign: out of memory (priority=%u)\n", priority);
+        sign_stats[priority].rejected += 1;
         return false;
     }
 
@@ -63,8 +172,22 @@ bool queue_message_to_sign(struct process* process, void* data,
     item->message = message;
     item->message_buffer_len = message_buffer_len;
     item->message_len = message_len;
+    crypto_schedule_init(&item->sched, priority, max_wait);
 
-    queue_enqueue(messages_to_sign, item);
+    // Keep the list in the order messages are to be signed
+    const clock_time_t now = item->sched.queued_clock;
+    messages_to_sign_entry_t* prev = NULL;
+    for (messages_to_sign_entry_t* iter = list_head(messages_to_sign); iter != NULL; iter = list_item_next(iter))
+    {
+        if (crypto_schedule_before(&item->sched, &iter->sched, now))
+        {
+            break;
+        }
+        prev = iter;
+    }
+    list_insert(messages_to_sign, prev, item);
+
+    sign_stats[priority].queued += 1;
 
     process_poll(&signer);
 
@@ -80,21 +203,38 @@ PROCESS_THREAD(signer, ev, data)
 {
     PROCESS_BEGIN();
 
-    queue_init(messages_to_sign);
+    list_init(messages_to_sign);
     memb_init(&messages_to_sign_memb);
 
     while (1)
     {
-        PROCESS_YIELD_UNTIL(!queue_is_empty(messages_to_sign));
+        PROCESS_WAIT_UNTIL(list_head(messages_to_sign) != NULL);
 
         static messages_to_sign_entry_t* sitem;
-        sitem = (messages_to_sign_entry_t*)queue_dequeue(messages_to_sign);
+        sitem = (messages_to_sign_entry_t*)list_pop(messages_to_sign);
 
-        static sign_state_t sign_state;
-        ECC_SIGN_GET_PROCESS(sign_state) = &signer;
-        PROCESS_PT_SPAWN(&sign_state.pt, ecc_sign(&sign_state, sitem->message, sitem->message_buffer_len, sitem->message_len));
+        if (crypto_schedule_expired(&sitem->sched, clock_time()))
+        {
+            LOG_WARN("Dropping message to sign for %s as it waited too long\n", sitem->process->name);
+            sign_stats[sitem->sched.priority].expired += 1;
+
+            sitem->result = PLATFORM_CRYPTO_EXPIRED;
+        }
+        else
+        {
+            crypto_stats_started(&sign_stats[sitem->sched.priority], &sitem->sched);
 
-        sitem->result = ECC_SIGN_GET_RESULT(sign_state);
+            static rtimer_clock_t sign_started;
+            sign_started = RTIMER_NOW();
+
+            static sign_state_t sign_state;
+            ECC_SIGN_GET_PROCESS(sign_state) = &signer;
+            PROCESS_PT_SPAWN(&sign_state.pt, ecc_sign(&sign_state, sitem->message, sitem->message_buffer_len, sitem->message_len));
+
+            sitem->result = ECC_SIGN_GET_RESULT(sign_state);
+
+            crypto_stats_completed(&sign_stats[sitem->sched.priority], sign_started);
+        }
 
         if (process_post(sitem->process, pe_message_signed, sitem) != PROCESS_ERR_OK)
         {
@@ -110,12 +250,20 @@ PROCESS_THREAD(signer, ev, data)
 /*-------------------------------------------------------------------------------------------------------------------*/
 bool queue_message_to_verify(struct process* process, void* data,
                              const uint8_t* message, uint16_t message_len,
-                             const ecdsa_secp256r1_pubkey_t* pubkey)
+                             const ecdsa_secp256r1_pubkey_t* pubkey,
+                             crypto_priority_t priority, clock_time_t max_wait)
 {
-    messages_to_verify_entry_t* item = memb_alloc(&messages_to_verify_memb);
+    assert(priority < CRYPTO_PRIORITY_NUM);
+
+    messages_to_verify_entry_t* item = NULL;
+    if (crypto_schedule_can_allocate(priority, &messages_to_verify_memb, MESSAGES_TO_VERIFY_RESERVED))
+    {
+        item = memb_alloc(&messages_to_verify_memb);
+    }
     if (!item)
     {
-        LOG_WARN("queue_message_to_verify: out of memory\n");
+        LOG_WARN("queue_message_to_verify: out of memory (priority=%u)\n", priority);
+        verify_stats[priority].rejected += 1;
         return false;
     }
 
@@ -124,8 +272,22 @@ bool queue_message_to_verify(struct process* process, void* data,
     item->message = message;
     item->message_len = message_len;
     item->pubkey = pubkey;
+    crypto_schedule_init(&item->sched, priority, max_wait);
+
+    // Keep the list in the order messages are to be verified
+    const clock_time_t now = item->sched.queued_clock;
+    messages_to_verify_entry_t* prev = NULL;
+    for (messages_to_verify_entry_t* iter = list_head(messages_to_verify); iter != NULL; iter = list_item_next(iter))
+    {
+        if (crypto_schedule_before(&item->sched, &iter->sched, now))
+        {
+            break;
+        }
+        prev = iter;
+    }
+    list_insert(messages_to_verify, prev, item);
 
-    queue_enqueue(messages_to_verify, item);
+    verify_stats[priority].queued += 1;
 
     process_poll(&verifier);
 
@@ -141,21 +303,38 @@ PROCESS_THREAD(verifier, ev, data)
 {
     PROCESS_BEGIN();
 
-    queue_init(messages_to_verify);
+    list_init(messages_to_verify);
     memb_init(&messages_to_verify_memb);
 
     while (1)
     {
-        PROCESS_YIELD_UNTIL(!queue_is_empty(messages_to_verify));
+        PROCESS_WAIT_UNTIL(list_head(messages_to_verify) != NULL);
 
         static messages_to_verify_entry_t* vitem;
-        vitem = (messages_to_verify_entry_t*)queue_dequeue(messages_to_verify);
+        vitem = (messages_to_verify_entry_t*)list_pop(messages_to_verify);
+
+        if (crypto_schedule_expired(&vitem->sched, clock_time()))
+        {
+            LOG_WARN("Dropping message to verify for %s as it waited too long\n", vitem->process->name);
+            verify_stats[vitem->sched.priority].expired += 1;
+
+            vitem->result = PLATFORM_CRYPTO_EXPIRED;
+        }
+        else
+        {
+            crypto_stats_started(&verify_stats[vitem->sched.priority], &vitem->sched);
+
+            static rtimer_clock_t verify_started;
+            verify_started = RTIMER_NOW();
 
-        static verify_state_t verify_state;
-        ECC_VERIFY_GET_PROCESS(verify_state) = &verifier;
-        PROCESS_PT_SPAWN(&verify_state.pt, ecc_verify(&verify_state, vitem->pubkey, vitem->message, vitem->message_len));
+            static verify_state_t verify_state;
+            ECC_VERIFY_GET_PROCESS(verify_state) = &verifier;
+            PROCESS_PT_SPAWN(&verify_state.pt, ecc_verify(&verify_state, vitem->pubkey, vitem->message, vitem->message_len));
 
-        vitem->result = ECC_VERIFY_GET_RESULT(verify_state);
+            vitem->result = ECC_VERIFY_GET_RESULT(verify_state);
+
+            crypto_stats_completed(&verify_stats[vitem->sched.priority], verify_started);
+        }
 
         if (process_post(vitem->process, pe_message_verified, vitem) != PROCESS_ERR_OK)
         {
@@ -169,3 +348,49 @@ PROCESS_THREAD(verifier, ev, data)
     PROCESS_END();
 }
 /*-------------------------------------------------------------------------------------------------------------------*/
+const crypto_queue_stats_t* crypto_sign_stats(crypto_priority_t priority)
+{
+    assert(priority < CRYPTO_PRIORITY_NUM);
+    return &sign_stats[priority];
+}
+/*-------------------------------------------------------------------------------------------------------------------*/
+const crypto_queue_stats_t* crypto_verify_stats(crypto_priority_t priority)
+{
+    assert(priority < CRYPTO_PRIORITY_NUM);
+    return &verify_stats[priority];
+}
+/*-------------------------------------------------------------------------------------------------------------------*/
+void crypto_support_stats_reset(void)
+{
+    memset(sign_stats, 0, sizeof(sign_stats));
+    memset(verify_stats, 0, sizeof(verify_stats));
+}
+/*-------------------------------------------------------------------------------------------------------------------*/
+static void
+crypto_stats_print(const char* name, const crypto_queue_stats_t* stats)
+{
+    static const char* const priority_names[CRYPTO_PRIORITY_NUM] = { "critical", "normal", "bulk" };
+
+    for (uint8_t priority = 0; priority != CRYPTO_PRIORITY_NUM; ++priority)
+    {
+        const crypto_queue_stats_t* s = &stats[priority];
+
+        if (s->queued == 0 && s->rejected == 0)
+        {
+            continue;
+        }
+
+        LOG_INFO("%s %s: queued=%" PRIu32 " rejected=%" PRIu32 " expired=%" PRIu32 " started=%" PRIu32 " completed=%" PRIu32
+                 " wait(avg=%" PRIu32 " max=%" PRIu32 ")us service(avg=%" PRIu32 " max=%" PRIu32 ")us\n",
+            name, priority_names[priority], s->queued, s->rejected, s->expired, s->started, s->completed,
+            s->started == 0 ? 0 : (uint32_t)(s->wait_total / s->started), s->wait_max,
+            s->completed == 0 ? 0 : (uint32_t)(s->service_total / s->completed), s->service_max);
+    }
+}
+/*-------------------------------------------------------------------------------------------------------------------*/
+void crypto_support_stats_print(void)
+{
+    crypto_stats_print("Sign", sign_stats);
+    crypto_stats_print("Verify", verify_stats);
+}
+/*-------------------------------------------------------------------------------------------------------------------*/
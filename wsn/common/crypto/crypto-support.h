@@ -15,6 +15,33 @@
 /*-------------------------------------------------------------------------------------------------------------------*/
 void crypto_support_init(void);
 /*-------------------------------------------------------------------------------------------------------------------*/
+// Classes of messages to sign or verify, a queued message of a lower class is started before any of a higher class.
+// Within a class, messages with the earliest deadline are started first, then those without in the order queued.
+typedef enum {
+    // Work that other work is waiting on, e.g., verifying a certificate needed to offload a task
+    CRYPTO_PRIORITY_CRITICAL = 0,
+    CRYPTO_PRIORITY_NORMAL = 1,
+    // Work that can wait, e.g., signing and verifying periodic trust broadcasts
+    CRYPTO_PRIORITY_BULK = 2,
+
+    CRYPTO_PRIORITY_NUM
+} crypto_priority_t;
+
+// The message waits for as long as needed to be started
+#define CRYPTO_NO_DEADLINE 0
+/*-------------------------------------------------------------------------------------------------------------------*/
+typedef struct
+{
+    uint8_t priority;
+
+    // Messages not started within max_wait of being queued are dropped with result PLATFORM_CRYPTO_EXPIRED
+    clock_time_t queued_clock;
+    clock_time_t max_wait;
+
+    rtimer_clock_t queued_at;
+
+} crypto_schedule_t;
+/*-------------------------------------------------------------------------------------------------------------------*/
 typedef struct messages_to_sign_entry
 {
     struct messages_to_sign_entry* next;
@@ -30,12 +57,16 @@ typedef struct messages_to_sign_entry
     void* data;
 
     // The result of signing
-    uint8_t result;
+    platform_crypto_result_t result;
+
+    crypto_schedule_t sched;
 
 } messages_to_sign_entry_t;
 /*-------------------------------------------------------------------------------------------------------------------*/
+// max_wait is how long the message may wait to be started, or CRYPTO_NO_DEADLINE
 bool queue_message_to_sign(struct process* process, void* data,
-                           uint8_t* message, uint16_t message_buffer_len, uint16_t message_len);
+                           uint8_t* message, uint16_t message_buffer_len, uint16_t message_len,
+                           crypto_priority_t priority, clock_time_t max_wait);
 void queue_message_to_sign_done(messages_to_sign_entry_t* item);
 /*-------------------------------------------------------------------------------------------------------------------*/
 typedef struct messages_to_verify_entry
@@ -49,20 +80,43 @@ typedef struct messages_to_verify_entry
     uint16_t message_len;
 
     // The result of signing
-    uint8_t result;
+    platform_crypto_result_t result;
 
     const ecdsa_secp256r1_pubkey_t* pubkey;
 
     // User supplied data
     void* data;
 
+    crypto_schedule_t sched;
+
 } messages_to_verify_entry_t;
 /*-------------------------------------------------------------------------------------------------------------------*/
 bool queue_message_to_verify(struct process* process, void* data,
                              const uint8_t* message, uint16_t message_len,
-                             const ecdsa_secp256r1_pubkey_t* pubkey);
+                             const ecdsa_secp256r1_pubkey_t* pubkey,
+                             crypto_priority_t priority, clock_time_t max_wait);
 void queue_message_to_verify_done(messages_to_verify_entry_t* item);
 /*-------------------------------------------------------------------------------------------------------------------*/
 extern process_event_t pe_message_signed;
 extern process_event_t pe_message_verified;
 /*-------------------------------------------------------------------------------------------------------------------*/
+// Per class counters, times are in microseconds. The wait is from being queued to being started.
+typedef struct {
+    uint32_t queued;
+    uint32_t rejected;
+    uint32_t expired;
+    uint32_t started;
+    uint32_t completed;
+
+    uint64_t wait_total;
+    uint32_t wait_max;
+
+    uint64_t service_total;
+    uint32_t service_max;
+} crypto_queue_stats_t;
+/*-------------------------------------------------------------------------------------------------------------------*/
+const crypto_queue_stats_t* crypto_sign_stats(crypto_priority_t priority);
+const crypto_queue_stats_t* crypto_verify_stats(crypto_priority_t priority);
+void crypto_support_stats_reset(void);
+void crypto_support_stats_print(void);
+/*-------------------------------------------------------------------------------------------------------------------*/
@@ -6,6 +6,8 @@
 #include "os/sys/log.h"
 #include "os/net/ipv6/uiplib.h"
 
+#include <inttypes.h>
+
 #include "coap.h"
 #include "coap-callback-api.h"
 
@@ -13,6 +15,7 @@
 #include "keystore-oscore.h"
 #include "timed-unlock.h"
 #include "root-endpoint.h"
+#include "trust-models.h"
 /*-------------------------------------------------------------------------------------------------------------------*/
 #define LOG_MODULE "keystore"
 #ifdef KEYSTORE_LOG_LEVEL
@@ -27,6 +30,28 @@ MEMB(public_keys_memb, public_key_item_t, PUBLIC_KEYSTORE_SIZE);
 LIST(public_keys);
 LIST(public_keys_to_verify);
 /*-------------------------------------------------------------------------------------------------------------------*/
+_Static_assert(PUBLIC_KEYSTORE_INDEX_SIZE > PUBLIC_KEYSTORE_SIZE, "Keystore index must have more slots than certificates");
+_Static_assert(PUBLIC_KEYSTORE_INDEX_SIZE <= UINT16_MAX, "Keystore index too large");
+_Static_assert(PUBLIC_KEYSTORE_EVICTION_HISTORY > 0 && PUBLIC_KEYSTORE_EVICTION_HISTORY <= UINT8_MAX, "Invalid eviction history size");
+_Static_assert(PUBLIC_KEYSTORE_VERIFIED_DIGESTS > 0 && PUBLIC_KEYSTORE_VERIFIED_DIGESTS <= UINT8_MAX, "Invalid verified digests size");
+_Static_assert(PUBLIC_KEYSTORE_FAILED_DIGESTS > 0 && PUBLIC_KEYSTORE_FAILED_DIGESTS <= UINT8_MAX, "Invalid failed digests size");
+/*-------------------------------------------------------------------------------------------------------------------*/
+static void
+keystore_index_key(const void* item, uint8_t* eui64)
+{
+    memcpy(eui64, ((const public_key_item_t*)item)->cert.subject, EUI64_LENGTH);
+}
+
+// Index of public_keys keyed by subject
+static void* public_keys_index_slots[PUBLIC_KEYSTORE_INDEX_SIZE];
+static eui64_index_t public_keys_index = { public_keys_index_slots, PUBLIC_KEYSTORE_INDEX_SIZE, keystore_index_key };
+
+static keystore_stats_t stats;
+
+// Keys of recently evicted certificates, oldest first
+static uint16_t evicted_keys[PUBLIC_KEYSTORE_EVICTION_HISTORY];
+static uint8_t evicted_keys_count;
+/*-------------------------------------------------------------------------------------------------------------------*/
 static void
 uip_ip6addr_normalise(const uip_ip6addr_t* in, uip_ip6addr_t* out)
 {
@@ -41,10 +66,66 @@ uip_ip6addr_normalise(const uip_ip6addr_t* in, uip_ip6addr_t* out)
     }
 }
 /*-------------------------------------------------------------------------------------------------------------------*/
+static bool
+keystore_index_match(const void* item, const void* eui64)
+{
+    return memcmp(((const public_key_item_t*)item)->cert.subject, eui64, EUI64_LENGTH) == 0;
+}
+/*-------------------------------------------------------------------------------------------------------------------*/
+static public_key_item_t*
+keystore_index_find(const uint8_t* eui64)
+{
+    return (public_key_item_t*)eui64_index_find(&public_keys_index, eui64, keystore_index_match, eui64);
+}
+/*-------------------------------------------------------------------------------------------------------------------*/
+// Keys identifying a certificate in the eviction history
+static uint16_t
+eviction_key(const uint8_t* eui64)
+{
+    const uint32_t hash = eui64_hash(eui64);
+
+    return (uint16_t)(hash ^ (hash >> 16));
+}
+/*-------------------------------------------------------------------------------------------------------------------*/
+static void
+eviction_history_remove(uint8_t i)
+{
+    memmove(&evicted_keys[i], &evicted_keys[i + 1], (evicted_keys_count - i - 1) * sizeof(*evicted_keys));
+    evicted_keys_count -= 1;
+}
+/*-------------------------------------------------------------------------------------------------------------------*/
+static void
+eviction_history_push(uint16_t key)
+{
+    // Forget the oldest key when full
+    if (evicted_keys_count == PUBLIC_KEYSTORE_EVICTION_HISTORY)
+    {
+        eviction_history_remove(0);
+    }
+
+    evicted_keys[evicted_keys_count++] = key;
+}
+/*-------------------------------------------------------------------------------------------------------------------*/
+// Returns true and forgets the key if it was recently evicted
+static bool
+eviction_history_take(uint16_t key)
+{
+    for (uint8_t i = 0; i != evicted_keys_count; ++i)
+    {
+        if (evicted_keys[i] == key)
+        {
+            eviction_history_remove(i);
+            return true;
+        }
+    }
+
+    return false;
+}
+/*-------------------------------------------------------------------------------------------------------------------*/
 static public_key_item_t*
 keystore_find_in_list(const uint8_t* eui64, list_t l)
 {
-    for (public_key_item_t* iter = list_head(public_keys); iter != NULL; iter = list_item_next(iter))
+    for (public_key_item_t* iter = list_head(l); iter != NULL; iter = list_item_next(iter))
     {
         if (memcmp(&iter->cert.subject, eui64, EUI64_LENGTH) == 0)
         {
@@ -58,7 +139,17 @@ keystore_find_in_list(const uint8_t* eui64, list_t l)
 public_key_item_t*
 keystore_find(const uint8_t* eui64)
 {
-    return keystore_find_in_list(eui64, public_keys);
+    public_key_item_t* item = keystore_index_find(eui64);
+    if (item == NULL)
+    {
+        stats.misses += 1;
+        return NULL;
+    }
+
+    stats.hits += 1;
+    item->last_used = clock_time();
+
+    return item;
 }
 /*-------------------------------------------------------------------------------------------------------------------*/
 public_key_item_t*
@@ -84,6 +175,16 @@ const ecdsa_secp256r1_pubkey_t* keystore_find_pubkey(const uip_ip6addr_t* addr)
     return &item->cert.public_key;
 }
 /*-------------------------------------------------------------------------------------------------------------------*/
+public_key_item_t* keystore_iter(void)
+{
+    return list_head(public_keys);
+}
+/*-------------------------------------------------------------------------------------------------------------------*/
+public_key_item_t* keystore_next(public_key_item_t* iter)
+{
+    return list_item_next(iter);
+}
+/*-------------------------------------------------------------------------------------------------------------------*/
 bool keystore_certificate_contains_tags(const stereotype_tags_t* tags)
 {
     // Check the certificates that have been verified and are waiting to be verified
@@ -135,7 +236,12 @@ bool keystore_is_pinned(const public_key_item_t* item)
 static bool
 keystore_free_up_space(void)
 {
-    // We need to try to free up space for a new certificate.
+    // We need to try to free up space for a new certificate,
+    // by evicting the verified certificate that was least recently used.
+    const clock_time_t now = clock_time();
+
+    public_key_item_t* victim = NULL;
+    clock_time_t victim_age = 0;
 
     for (public_key_item_t* iter = list_head(public_keys); iter != NULL; iter = list_item_next(iter))
     {
@@ -151,25 +257,55 @@ keystore_free_up_space(void)
             continue;
         }
 
-        // TODO: Consider removing specific certificates (e.g., LRU)
-        // (see: https://en.wikipedia.org/wiki/Cache_replacement_policies)
-        if (keystore_remove(iter))
+        const clock_time_t age = now - iter->last_used;
+
+        if (victim == NULL || age > victim_age)
         {
-            return true;
+            victim = iter;
+            victim_age = age;
         }
     }
 
-    return false;
+    if (victim == NULL)
+    {
+        return false;
+    }
+
+    const uint16_t key = eviction_key(victim->cert.subject);
+
+    if (!keystore_remove(victim))
+    {
+        return false;
+    }
+
+    eviction_history_push(key);
+    stats.evictions += 1;
+
+    return true;
 }
 /*-------------------------------------------------------------------------------------------------------------------*/
-bool
-keystore_add(const certificate_t* cert)
+// Moves a certificate from being verified to the verified certificates
+static void
+keystore_verified(public_key_item_t* item)
+{
+    list_remove(public_keys_to_verify, item);
+    list_push(public_keys, item);
+    eui64_index_insert(&public_keys_index, item);
+
+    item->last_used = clock_time();
+
+    // Stereotypes are found via the certificate tags
+    trust_cache_invalidate_all();
+}
+/*-------------------------------------------------------------------------------------------------------------------*/
+static public_key_item_t*
+keystore_add_item(const certificate_t* cert)
 {
     // Check if this certificate is already present
-    public_key_item_t* item = keystore_find(cert->subject);
+    public_key_item_t* item = keystore_index_find(cert->subject);
     if (item)
     {
-        return true;
+        return item;
     }
 
     // Check if this certificate is queued to be verified
@@ -178,7 +314,7 @@ keystore_add(const certificate_t* cert)
     {
         // Poll to ensure that the process is making progress with the certificates to verify
         process_poll(&keystore_add_verifier);
-        return true;
+        return item;
     }
 
     // No item has this certificate so allocate memory for it
@@ -194,7 +330,7 @@ keystore_add(const certificate_t* cert)
             LOG_ERR("Failed to free space for the certificate ");
             LOG_ERR_BYTES(cert->subject, EUI64_LENGTH);
             LOG_ERR_("\n");
-            return false;
+            return NULL;
         }
         else
         {
@@ -204,7 +340,7 @@ keystore_add(const certificate_t* cert)
                 LOG_WARN("keystore_add: out of memory (2nd) for ");
                 LOG_WARN_BYTES(cert->subject, EUI64_LENGTH);
                 LOG_WARN_("\n");
-                return false;
+                return NULL;
             }
             else
             {
@@ -221,15 +357,52 @@ keystore_add(const certificate_t* cert)
 
     item->cert = *cert;
 
-    //item->age = clock_time();
+    item->last_used = clock_time();
     item->pin_count = 0;
+#ifdef TRUST_SNAPSHOT
+    item->restored = false;
+#endif
 
     list_add(public_keys_to_verify, item);
 
     process_poll(&keystore_add_verifier);
 
+    return item;
+}
+/*-------------------------------------------------------------------------------------------------------------------*/
+bool
+keystore_add(const certificate_t* cert)
+{
+    return keystore_add_item(cert) != NULL;
+}
+/*-------------------------------------------------------------------------------------------------------------------*/
+#ifdef TRUST_SNAPSHOT
+bool
+keystore_restore(const certificate_t* cert)
+{
+    // Only the built in root certificate is trusted for the root
+    if (memcmp(cert->subject, root_cert.subject, EUI64_LENGTH) == 0)
+    {
+        cert = &root_cert;
+    }
+
+    public_key_item_t* item = keystore_add_item(cert);
+    if (item == NULL)
+    {
+        return false;
+    }
+
+    // Queued certificates skip verification, unless a different one was queued for the subject.
+    // The shared secret still needs to be generated.
+    if (keystore_index_find(cert->subject) == NULL &&
+        memcmp(&item->cert.public_key, &cert->public_key, sizeof(cert->public_key)) == 0)
+    {
+        item->restored = true;
+    }
+
     return true;
 }
+#endif
 /*-------------------------------------------------------------------------------------------------------------------*/
 bool keystore_remove(public_key_item_t* item)
 {
@@ -257,8 +430,18 @@ bool keystore_remove(public_key_item_t* item)
         return false;
     }
 
+    if (!eui64_index_remove(&public_keys_index, item))
+    {
+        LOG_ERR("Certificate for ");
+        LOG_ERR_BYTES(item->cert.subject, EUI64_LENGTH);
+        LOG_ERR_(" missing from index\n");
+    }
+
     const bool freed = memb_free(&public_keys_memb, item);
 
+    // Stereotypes are found via the certificate tags
+    trust_cache_invalidate_all();
+
     LOG_INFO("keystore_remove: Removed certificate for ");
     LOG_INFO_BYTES(item->cert.subject, EUI64_LENGTH);
     LOG_INFO_(" (freed=%d)\n", freed);
@@ -266,13 +449,90 @@ bool keystore_remove(public_key_item_t* item)
     return freed;
 }
 /*-------------------------------------------------------------------------------------------------------------------*/
-static coap_message_t msg;
-static coap_callback_request_state_t coap_callback;
-static uint8_t key_req_payload[sizeof(uip_ip6addr_t)];
-static timed_unlock_t in_use;
+const keystore_stats_t* keystore_stats(void)
+{
+    return &stats;
+}
+/*-------------------------------------------------------------------------------------------------------------------*/
+void keystore_stats_print(void)
+{
+    LOG_INFO("Keystore: hits=%" PRIu32 " misses=%" PRIu32 " evictions=%" PRIu32 " re-fetches=%" PRIu32
+             " (%u of %u certificates verified)\n",
+        stats.hits, stats.misses, stats.evictions, stats.refetches,
+        (unsigned int)list_length(public_keys), (unsigned int)PUBLIC_KEYSTORE_SIZE);
+    LOG_INFO("Keystore: verified digest hits=%" PRIu32 " failed digest hits=%" PRIu32 "\n",
+        stats.verified_digest_hits, stats.failed_digest_hits);
+}
+/*-------------------------------------------------------------------------------------------------------------------*/
+typedef struct key_request {
+    coap_message_t msg;
+    coap_callback_request_state_t coap_callback;
+    timed_unlock_t in_use;
+
+    // The addresses that this request asked for
+    uip_ip6addr_t addrs[PUBLIC_KEY_REQUEST_BATCH_SIZE];
+    uint8_t num_addrs;
+
+    // Set if a block of the response could not be used
+    bool failed;
+
+    uint8_t payload[(1) + PUBLIC_KEY_REQUEST_BATCH_SIZE * ((1) + sizeof(uip_ip6addr_t))];
+
+    // The response is sent in blocks when it holds more than one certificate. Certificates are decoded
+    // as each block arrives, so only the array header or a certificate that crosses into the next block is kept.
+    uint8_t partial[CERTIFICATE_CBOR_LENGTH];
+    uint16_t partial_len;
+    uint32_t response_len;
+
+    // Certificates in the response that have not been decoded yet, or -1 before the array header
+    int16_t certs_remaining;
+    uint8_t num_certs;
+} key_request_t;
+
+static key_request_t key_requests[PUBLIC_KEY_REQUESTS_MAX_IN_FLIGHT];
+
+// Addresses of public keys waiting to be asked for, oldest first
+static uip_ip6addr_t key_requests_queued[PUBLIC_KEY_REQUEST_QUEUE_SIZE];
+static uint8_t key_requests_queued_count;
+
+_Static_assert(PUBLIC_KEY_REQUEST_BATCH_SIZE >= 1 && PUBLIC_KEY_REQUEST_BATCH_SIZE <= NANOCBOR_MAX_TINY_INTEGER, "Invalid PUBLIC_KEY_REQUEST_BATCH_SIZE");
+_Static_assert(PUBLIC_KEY_REQUESTS_MAX_IN_FLIGHT >= 1, "Invalid PUBLIC_KEY_REQUESTS_MAX_IN_FLIGHT");
+_Static_assert(PUBLIC_KEY_REQUEST_QUEUE_SIZE >= PUBLIC_KEY_REQUEST_BATCH_SIZE && PUBLIC_KEY_REQUEST_QUEUE_SIZE <= UINT8_MAX, "Invalid PUBLIC_KEY_REQUEST_QUEUE_SIZE");
 /*-------------------------------------------------------------------------------------------------------------------*/
 static void request_public_key_callback(coap_callback_request_state_t* callback_state);
 /*-------------------------------------------------------------------------------------------------------------------*/
+static bool
+key_request_is_pending(const uip_ip6addr_t* addr)
+{
+    for (uint8_t i = 0; i != key_requests_queued_count; ++i)
+    {
+        if (uip_ip6addr_cmp(&key_requests_queued[i], addr))
+        {
+            return true;
+        }
+    }
+
+    for (uint8_t i = 0; i != PUBLIC_KEY_REQUESTS_MAX_IN_FLIGHT; ++i)
+    {
+        const key_request_t* request = &key_requests[i];
+
+        if (!timed_unlock_is_locked(&request->in_use))
+        {
+            continue;
+        }
+
+        for (uint8_t j = 0; j != request->num_addrs; ++j)
+        {
+            if (uip_ip6addr_cmp(&request->addrs[j], addr))
+            {
+                return true;
+            }
+        }
+    }
+
+    return false;
+}
+/*-------------------------------------------------------------------------------------------------------------------*/
 bool request_public_key(const uip_ip6addr_t* addr)
 {
     uip_ip6addr_t norm_addr;
@@ -282,7 +542,7 @@ bool request_public_key(const uip_ip6addr_t* addr)
     eui64_from_ipaddr(&norm_addr, eui64);
 
     // Check if we have the key and have verified it
-    if (keystore_find(eui64) != NULL)
+    if (keystore_index_find(eui64) != NULL)
     {
         LOG_DBG("Already have the public key for ");
         LOG_DBG_6ADDR(addr);
@@ -303,50 +563,294 @@ bool request_public_key(const uip_ip6addr_t* addr)
         return false;
     }
 
-    // Check if we are already requesting a key
-    if (timed_unlock_is_locked(&in_use))
+    // Check if we are already requesting this key
+    if (key_request_is_pending(&norm_addr))
+    {
+        LOG_DBG("Already requesting the public key for ");
+        LOG_DBG_6ADDR(addr);
+        LOG_DBG_(", do not need to request it again.\n");
+        return false;
+    }
+
+    if (key_requests_queued_count == PUBLIC_KEY_REQUEST_QUEUE_SIZE)
     {
-        LOG_WARN("Already requesting a public key for ");
-        LOG_WARN_6ADDR((const uip_ip6addr_t*)key_req_payload);
-        LOG_WARN_(" cannot request another for ");
+        LOG_WARN("Too many public keys waiting to be requested, cannot request another for ");
         LOG_WARN_6ADDR(addr);
         LOG_WARN_("\n");
         return false;
     }
 
-    LOG_DBG("Generating public key request for ");
+    LOG_DBG("Queuing public key request for ");
     LOG_DBG_6ADDR(addr);
     LOG_DBG_("\n");
 
-    memcpy(key_req_payload, addr, sizeof(*addr));
+    uip_ipaddr_copy(&key_requests_queued[key_requests_queued_count++], &norm_addr);
+
+    if (eviction_history_take(eviction_key(eui64)))
+    {
+        stats.refetches += 1;
+    }
+
+    // Requests are sent from the keystore process, so that addresses queued together are asked for together
+    process_poll(&keystore_add_verifier);
+
+    return true;
+}
+/*-------------------------------------------------------------------------------------------------------------------*/
+static bool
+key_request_send(key_request_t* request)
+{
+    const uint8_t num_addrs = MIN(key_requests_queued_count, PUBLIC_KEY_REQUEST_BATCH_SIZE);
+
+    nanocbor_encoder_t enc;
+    nanocbor_encoder_init(&enc, request->payload, sizeof(request->payload));
+    nanocbor_fmt_array(&enc, num_addrs);
+
+    for (uint8_t i = 0; i != num_addrs; ++i)
+    {
+        nanocbor_put_bstr(&enc, key_requests_queued[i].u8, sizeof(uip_ip6addr_t));
+        uip_ipaddr_copy(&request->addrs[i], &key_requests_queued[i]);
+    }
+
+    assert(nanocbor_encoded_len(&enc) <= sizeof(request->payload));
 
-    coap_init_message(&msg, COAP_TYPE_CON, COAP_GET, 0);
-    coap_set_header_uri_path(&msg, "key");
-    coap_set_header_content_format(&msg, APPLICATION_OCTET_STREAM);
-    coap_set_payload(&msg, key_req_payload, sizeof(*addr));
+    coap_init_message(&request->msg, COAP_TYPE_CON, COAP_GET, 0);
+    coap_set_header_uri_path(&request->msg, "key");
+    coap_set_header_content_format(&request->msg, APPLICATION_CBOR);
+    // Ask for the certificates in blocks that fit in our messages
+    coap_set_header_block2(&request->msg, 0, 0, COAP_MAX_CHUNK_SIZE);
+    coap_set_payload(&request->msg, request->payload, nanocbor_encoded_len(&enc));
 
 #if defined(WITH_OSCORE) && defined(AIOCOAP_SUPPORTS_OSCORE)
-    coap_set_random_token(&msg);
-    keystore_protect_coap_with_oscore(&msg, &root_ep);
+    coap_set_random_token(&request->msg);
+    keystore_protect_coap_with_oscore(&request->msg, &root_ep);
 #endif
 
-    int ret = coap_send_request(&coap_callback, &root_ep, &msg, &request_public_key_callback);
-    if (ret)
+    int ret = coap_send_request(&request->coap_callback, &root_ep, &request->msg, &request_public_key_callback);
+    if (!ret)
+    {
+        LOG_ERR("coap_send_request req pk failed %d\n", ret);
+        return false;
+    }
+
+    timed_unlock_lock(&request->in_use);
+
+    request->num_addrs = num_addrs;
+    request->failed = false;
+    request->partial_len = 0;
+    request->response_len = 0;
+    request->certs_remaining = -1;
+    request->num_certs = 0;
+
+    LOG_DBG("Requested public keys for");
+    for (uint8_t i = 0; i != num_addrs; ++i)
+    {
+        LOG_DBG_(" ");
+        LOG_DBG_6ADDR(&request->addrs[i]);
+    }
+    LOG_DBG_("\n");
+
+    // Only remove the addresses once sent, so they are asked for again if sending failed
+    key_requests_queued_count -= num_addrs;
+    memmove(&key_requests_queued[0], &key_requests_queued[num_addrs], key_requests_queued_count * sizeof(*key_requests_queued));
+
+    return true;
+}
+/*-------------------------------------------------------------------------------------------------------------------*/
+static void
+key_requests_send(void)
+{
+    for (uint8_t i = 0; i != PUBLIC_KEY_REQUESTS_MAX_IN_FLIGHT && key_requests_queued_count > 0; ++i)
+    {
+        if (!timed_unlock_is_locked(&key_requests[i].in_use))
+        {
+            if (!key_request_send(&key_requests[i]))
+            {
+                break;
+            }
+        }
+    }
+}
+/*-------------------------------------------------------------------------------------------------------------------*/
+static key_request_t*
+find_key_request(coap_callback_request_state_t* callback_state)
+{
+    for (uint8_t i = 0; i != PUBLIC_KEY_REQUESTS_MAX_IN_FLIGHT; ++i)
+    {
+        if (&key_requests[i].coap_callback == callback_state)
+        {
+            return &key_requests[i];
+        }
+    }
+
+    return NULL;
+}
+/*-------------------------------------------------------------------------------------------------------------------*/
+static void
+key_request_add_certificate(key_request_t* request, const uint8_t* encoded, size_t encoded_len)
+{
+    nanocbor_value_t dec;
+    nanocbor_decoder_init(&dec, encoded, encoded_len);
+
+    certificate_t cert;
+    if (certificate_decode(&dec, &cert) != NANOCBOR_OK)
     {
-        LOG_DBG("coap_send_request req pk done\n");
-        timed_unlock_lock(&in_use);
+        LOG_ERR("Failed to decode certificate\n");
+        request->failed = true;
+        return;
+    }
+
+    request->num_certs += 1;
+
+    if (keystore_add(&cert))
+    {
+        LOG_INFO("Successfully added public key for ");
+        LOG_INFO_BYTES(cert.subject, EUI64_LENGTH);
+        LOG_INFO_("\n");
     }
     else
     {
-        LOG_ERR("coap_send_request req pk failed %d\n", ret);
+        LOG_ERR("Failed to add public key for ");
+        LOG_ERR_BYTES(cert.subject, EUI64_LENGTH);
+        LOG_ERR_(" (out of memory)\n");
     }
-    
-    return ret != 0;
+}
+/*-------------------------------------------------------------------------------------------------------------------*/
+// Decodes the array header and every certificate that is complete in the partial buffer,
+// then moves what is left to the start of it
+static void
+key_request_decode_partial(key_request_t* request)
+{
+    uint16_t used = 0;
+
+    if (request->certs_remaining < 0)
+    {
+        nanocbor_value_t dec, arr;
+        nanocbor_decoder_init(&dec, request->partial, request->partial_len);
+        if (nanocbor_enter_array(&dec, &arr) < 0)
+        {
+            // Wait for the rest of the header
+            return;
+        }
+
+        const uint32_t num_certs = nanocbor_array_items_remaining(&arr);
+        if (num_certs > request->num_addrs)
+        {
+            LOG_ERR("Public key response has %" PRIu32 " certificates for %u addresses\n", num_certs, request->num_addrs);
+            request->failed = true;
+            return;
+        }
+
+        // The root encodes the header in as few bytes as possible
+        uint8_t header[1 + sizeof(uint32_t)];
+        nanocbor_encoder_t enc;
+        nanocbor_encoder_init(&enc, header, sizeof(header));
+        nanocbor_fmt_array(&enc, num_certs);
+
+        used = nanocbor_encoded_len(&enc);
+        request->certs_remaining = (int16_t)num_certs;
+    }
+
+    while (request->certs_remaining > 0 && !request->failed)
+    {
+        nanocbor_value_t dec;
+        nanocbor_decoder_init(&dec, &request->partial[used], request->partial_len - used);
+
+        const uint8_t* encoded;
+        size_t encoded_len;
+        if (nanocbor_get_subcbor(&dec, &encoded, &encoded_len) < 0)
+        {
+            // The rest of this certificate is in the next block
+            break;
+        }
+
+        key_request_add_certificate(request, encoded, encoded_len);
+
+        request->certs_remaining -= 1;
+        used = (uint16_t)(encoded + encoded_len - request->partial);
+    }
+
+    request->partial_len -= used;
+    memmove(request->partial, &request->partial[used], request->partial_len);
+}
+/*-------------------------------------------------------------------------------------------------------------------*/
+static void
+key_request_add_block(key_request_t* request, coap_message_t* response)
+{
+    const uint8_t* payload = NULL;
+    int payload_len = coap_get_payload(response, &payload);
+
+    uint32_t block_num;
+    uint8_t block_more;
+    uint16_t block_size;
+    uint32_t block_offset = 0;
+    coap_get_header_block2(response, &block_num, &block_more, &block_size, &block_offset);
+
+    if (block_offset != request->response_len)
+    {
+        LOG_ERR("Public key response block at %" PRIu32 " was expected at %" PRIu32 "\n", block_offset, request->response_len);
+        request->failed = true;
+        return;
+    }
+
+    request->response_len += payload_len;
+
+    while (payload_len > 0 && !request->failed)
+    {
+        const uint16_t len = MIN((uint16_t)payload_len, sizeof(request->partial) - request->partial_len);
+        if (len == 0)
+        {
+            // Even a whole certificate could not be decoded
+            LOG_ERR("Failed to decode public key response\n");
+            request->failed = true;
+            return;
+        }
+
+        memcpy(&request->partial[request->partial_len], payload, len);
+        request->partial_len += len;
+        payload += len;
+        payload_len -= len;
+
+        key_request_decode_partial(request);
+    }
+}
+/*-------------------------------------------------------------------------------------------------------------------*/
+static void
+key_request_process_response(key_request_t* request)
+{
+    // The response contains a certificate for each address that the root could provide
+    if (request->certs_remaining != 0 || request->partial_len != 0)
+    {
+        LOG_ERR("Failed to decode public key response\n");
+    }
+
+    if (request->num_certs != request->num_addrs)
+    {
+        LOG_WARN("Root provided %u of the %u public keys requested\n", request->num_certs, request->num_addrs);
+    }
+}
+/*-------------------------------------------------------------------------------------------------------------------*/
+static void
+key_request_finished(key_request_t* request)
+{
+    request->num_addrs = 0;
+
+    timed_unlock_unlock(&request->in_use);
+
+    // Poll to send any requests that were waiting for this one to finish
+    process_poll(&keystore_add_verifier);
 }
 /*-------------------------------------------------------------------------------------------------------------------*/
 static void
 request_public_key_callback(coap_callback_request_state_t* callback_state)
 {
+    key_request_t* request = find_key_request(callback_state);
+    if (request == NULL)
+    {
+        LOG_ERR("Received a callback for an unknown public key request\n");
+        return;
+    }
+
     switch (callback_state->state.status)
     {
     case COAP_REQUEST_STATUS_RESPONSE:
@@ -356,40 +860,15 @@ request_public_key_callback(coap_callback_request_state_t* callback_state)
         LOG_INFO("Message req pk complete with code (%d) (len=%d)\n",
             response->code, response->payload_len);
 
-        const uint8_t* payload = NULL;
-        const int req_resp_len = coap_get_payload(response, &payload);
-
         if (response->code != CONTENT_2_05)
         {
             LOG_ERR("Failed to request public key from key server '%.*s' (%d)\n",
-                req_resp_len, (const char*)payload, response->code);
+                response->payload_len, (const char*)response->payload, response->code);
+            request->failed = true;
         }
-        else
+        else if (!request->failed)
         {
-            nanocbor_value_t dec;
-            nanocbor_decoder_init(&dec, payload, req_resp_len);
-
-            certificate_t cert;
-            int ret = certificate_decode(&dec, &cert);
-            if (ret == NANOCBOR_OK)
-            {
-                if (keystore_add(&cert))
-                {
-                    LOG_INFO("Successfully added public key for ");
-                    LOG_DBG_BYTES(cert.subject, EUI64_LENGTH);
-                    LOG_INFO_("\n");
-                }
-                else
-                {
-                    LOG_ERR("Failed to add public key for ");
-                    LOG_ERR_BYTES(cert.subject, EUI64_LENGTH);
-                    LOG_ERR_(" (out of memory)\n");
-                }
-            }
-            else
-            {
-                LOG_ERR("Failed to decode certificate\n");
-            }
+            key_request_add_block(request, response);
         }
     } break;
 
@@ -397,37 +876,106 @@ request_public_key_callback(coap_callback_request_state_t* callback_state)
     {
         // Not truly finished yet here, need to wait for signature verification
         // But we are finished with sending and receiving a message
-        timed_unlock_unlock(&in_use);
+        if (!request->failed)
+        {
+            key_request_process_response(request);
+        }
+
+        key_request_finished(request);
     } break;
 
     default:
     {
         LOG_ERR("Failed to send message due to %s(%d)\n",
             coap_request_status_to_string(callback_state->state.status), callback_state->state.status);
-        timed_unlock_unlock(&in_use);
+        key_request_finished(request);
     } break;
     }
 }
 /*-------------------------------------------------------------------------------------------------------------------*/
 static uint8_t add_buffer[TBS_CERTIFICATE_CBOR_LENGTH + DTLS_EC_SIG_SIZE];
 static bool add_buffer_in_use;
+
+// SHA-256 of the encoded certificate and signature being verified
+static uint8_t add_digest[SHA256_DIGEST_LEN_BYTES];
+static bool add_digest_valid;
+/*-------------------------------------------------------------------------------------------------------------------*/
+// Ring of digests, once full the oldest digest is overwritten.
+// Passes and failures are kept in separate rings, so a flood of bad certificates cannot push out good ones.
+typedef struct {
+    uint8_t (*digests)[SHA256_DIGEST_LEN_BYTES];
+    uint8_t capacity;
+    uint8_t count;
+    uint8_t next;
+} digest_cache_t;
+
+static uint8_t verified_digests_storage[PUBLIC_KEYSTORE_VERIFIED_DIGESTS][SHA256_DIGEST_LEN_BYTES];
+static uint8_t failed_digests_storage[PUBLIC_KEYSTORE_FAILED_DIGESTS][SHA256_DIGEST_LEN_BYTES];
+
+static digest_cache_t verified_digests = { verified_digests_storage, PUBLIC_KEYSTORE_VERIFIED_DIGESTS, 0, 0 };
+static digest_cache_t failed_digests = { failed_digests_storage, PUBLIC_KEYSTORE_FAILED_DIGESTS, 0, 0 };
+/*-------------------------------------------------------------------------------------------------------------------*/
+static bool
+digest_cache_contains(const digest_cache_t* cache, const uint8_t* digest)
+{
+    for (uint8_t i = 0; i != cache->count; ++i)
+    {
+        if (memcmp(cache->digests[i], digest, SHA256_DIGEST_LEN_BYTES) == 0)
+        {
+            return true;
+        }
+    }
+
+    return false;
+}
 /*-------------------------------------------------------------------------------------------------------------------*/
 static void
+digest_cache_add(digest_cache_t* cache, const uint8_t* digest)
+{
+    if (digest_cache_contains(cache, digest))
+    {
+        return;
+    }
+
+    memcpy(cache->digests[cache->next], digest, SHA256_DIGEST_LEN_BYTES);
+
+    cache->next = (cache->next + 1) % cache->capacity;
+    if (cache->count < cache->capacity)
+    {
+        cache->count += 1;
+    }
+}
+/*-------------------------------------------------------------------------------------------------------------------*/
+// Returns the certificate if it was accepted without needing to be verified
+static public_key_item_t*
 keystore_add_start(void)
 {
     // Don't start adding a queued certificate to verify if we are already doing work
     if (add_buffer_in_use)
     {
-        return;
+        return NULL;
     }
 
     public_key_item_t* item = list_head(public_keys_to_verify);
     if (!item)
     {
         // Nothing to do, if there are no certificates queued to be verified
-        return;
+        return NULL;
     }
 
+#ifdef TRUST_SNAPSHOT
+    if (item->restored)
+    {
+        LOG_INFO("Restored public key for ");
+        LOG_INFO_BYTES(item->cert.subject, EUI64_LENGTH);
+        LOG_INFO_(" that was verified before rebooting\n");
+
+        keystore_verified(item);
+
+        return item;
+    }
+#endif
+
     const size_t available_space = sizeof(add_buffer) - DTLS_EC_SIG_SIZE;
 
     nanocbor_encoder_t enc;
@@ -444,15 +992,50 @@ keystore_add_start(void)
 
         list_remove(public_keys_to_verify, item);
         memb_free(&public_keys_memb, item);
-        return;
+        return NULL;
     }
 
     // Put the signature at the end
     memcpy(&add_buffer[encoded_length], &item->cert.signature, DTLS_EC_SIG_SIZE);
 
+    // The digest covers the signature too, so a certificate only matches if it is byte-for-byte the same
+    add_digest_valid = platform_crypto_success(
+        sha256_hash(add_buffer, encoded_length + DTLS_EC_SIG_SIZE, add_digest));
+
+    if (add_digest_valid && digest_cache_contains(&failed_digests, add_digest))
+    {
+        LOG_ERR("keystore_add: certificate previously failed verification for ");
+        LOG_ERR_BYTES(item->cert.subject, EUI64_LENGTH);
+        LOG_ERR_("\n");
+
+        stats.failed_digest_hits += 1;
+
+        list_remove(public_keys_to_verify, item);
+        memb_free(&public_keys_memb, item);
+
+        // Move on to the next queued certificate
+        process_poll(&keystore_add_verifier);
+        return NULL;
+    }
+
+    if (add_digest_valid && digest_cache_contains(&verified_digests, add_digest))
+    {
+        LOG_INFO("Public key for ");
+        LOG_INFO_BYTES(item->cert.subject, EUI64_LENGTH);
+        LOG_INFO_(" was verified before\n");
+
+        stats.verified_digest_hits += 1;
+
+        keystore_verified(item);
+
+        return item;
+    }
+
+    // Offloading to an edge waits on its certificate being verified
     if (!queue_message_to_verify(&keystore_add_verifier, item,
                                  add_buffer, encoded_length + DTLS_EC_SIG_SIZE,
-                                 &root_cert.public_key))
+                                 &root_cert.public_key,
+                                 CRYPTO_PRIORITY_CRITICAL, CRYPTO_NO_DEADLINE))
     {
         LOG_ERR("keystore_add: enqueue failed for ");
         LOG_ERR_BYTES(item->cert.subject, EUI64_LENGTH);
@@ -460,10 +1043,12 @@ keystore_add_start(void)
 
         list_remove(public_keys_to_verify, item);
         memb_free(&public_keys_memb, item);
-        return;
+        return NULL;
     }
 
     add_buffer_in_use = true;
+
+    return NULL;
 }
 /*-------------------------------------------------------------------------------------------------------------------*/
 static public_key_item_t*
@@ -471,18 +1056,29 @@ keystore_add_continued(messages_to_verify_entry_t* entry)
 {
     public_key_item_t* item = (public_key_item_t*)entry->data;
 
-    list_remove(public_keys_to_verify, item);
-
     if (platform_crypto_success(entry->result))
     {
         LOG_INFO("Successfully verified public key for ");
         LOG_INFO_BYTES(item->cert.subject, EUI64_LENGTH);
         LOG_INFO_("\n");
 
-        list_push(public_keys, item);
+        keystore_verified(item);
+
+        if (add_digest_valid)
+        {
+            digest_cache_add(&verified_digests, add_digest);
+        }
     }
     else
     {
+        // Only remember certificates with a bad signature, other failures may not happen next time
+        if (add_digest_valid && platform_crypto_signature_invalid(entry->result))
+        {
+            digest_cache_add(&failed_digests, add_digest);
+        }
+
+        list_remove(public_keys_to_verify, item);
+
         LOG_ERR("Failed to verify public key for ");
         LOG_INFO_BYTES(item->cert.subject, EUI64_LENGTH);
         LOG_ERR_(" (sig verification failed)\n");
@@ -610,11 +1206,14 @@ keystore_init(void)
 {
     crypto_support_init();
 
-    memb_init(&public_keys_memb);
-    list_init(public_keys);
-    list_init(public_keys_to_verify);
+    // The pool and lists are not initialised here, as they are statically initialised and
+    // may already hold certificates restored by trust_common_init (see trust-snapshot.h)
+
+    for (uint8_t i = 0; i != PUBLIC_KEY_REQUESTS_MAX_IN_FLIGHT; ++i)
+    {
+        timed_unlock_init(&key_requests[i].in_use, "keystore", (1 * 60 * CLOCK_SECOND));
+    }
 
-    timed_unlock_init(&in_use, "keystore", (1 * 60 * CLOCK_SECOND));
     add_buffer_in_use = false;
 
     // Need to add the root certificate to the keystore in order to
@@ -642,46 +1241,62 @@ PROCESS_THREAD(keystore_add_verifier, ev, data)
     {
         PROCESS_WAIT_EVENT();
 
-        // Need to consider verifying certificate
+        static public_key_item_t* pkitem;
+        pkitem = NULL;
+
+        // Need to consider requesting public keys and verifying certificate
         if (ev == PROCESS_EVENT_POLL)
         {
-            keystore_add_start();
+            key_requests_send();
+
+            pkitem = keystore_add_start();
+        }
+
+        // A public key request timed out, so another can be sent
+        if (ev == pe_timed_unlock_unlocked)
+        {
+            key_requests_send();
         }
 
         // Verify key response
         if (ev == pe_message_verified)
         {
-            static public_key_item_t* pkitem;
             messages_to_verify_entry_t* entry = (messages_to_verify_entry_t*)data;
             assert(entry != NULL);
             assert(entry->data != NULL);
             //LOG_INFO("Processing pe_message_verified for keystore_add_continued\n");
             pkitem = keystore_add_continued(entry);
 
-            // Generated a shared secret if this step succeeded
-            if (pkitem)
+            // Poll ourselves to potentially verify another message,
+            // after the shared secret has been generated if it was verified
+            if (!pkitem)
             {
-                keystore_pin(pkitem);
-
-                static ecdh2_state_t ecdh2_unver_state;
-                ECDH_GET_PROCESS(ecdh2_unver_state) = &keystore_add_verifier;
-                PROCESS_PT_SPAWN(&ecdh2_unver_state.pt, ecdh2(&ecdh2_unver_state, &pkitem->cert.public_key));
-
-                if (platform_crypto_success(ECDH_GET_RESULT(ecdh2_unver_state)))
-                {
-                    generate_shared_secret(pkitem,
-                        ecdh2_unver_state.shared_secret, sizeof(ecdh2_unver_state.shared_secret));
-                }
-                else
-                {
-                    LOG_ERR("Failed to generate shared secret with error %" CRYPTO_RESULT_SPEC "\n",
-                        ECDH_GET_RESULT(ecdh2_unver_state));
-                }
-
-                keystore_unpin(pkitem);
+                process_poll(&keystore_add_verifier);
             }
+        }
+
+        // Generated a shared secret if the certificate was verified (or restored)
+        if (pkitem)
+        {
+            keystore_pin(pkitem);
+
+            static ecdh2_state_t ecdh2_unver_state;
+            ECDH_GET_PROCESS(ecdh2_unver_state) = &keystore_add_verifier;
+            PROCESS_PT_SPAWN(&ecdh2_unver_state.pt, ecdh2(&ecdh2_unver_state, &pkitem->cert.public_key));
+
+            if (platform_crypto_success(ECDH_GET_RESULT(ecdh2_unver_state)))
+            {
+                generate_shared_secret(pkitem,
+                    ecdh2_unver_state.shared_secret, sizeof(ecdh2_unver_state.shared_secret));
+            }
+            else
+            {
+                LOG_ERR("Failed to generate shared secret with error %" CRYPTO_RESULT_SPEC "\n",
+                    ECDH_GET_RESULT(ecdh2_unver_state));
+            }
+
+            keystore_unpin(pkitem);
 
-            // Poll ourselves to potentially verify another message
             process_poll(&keystore_add_verifier);
         }
     }
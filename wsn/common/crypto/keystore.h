@@ -1,6 +1,6 @@
 #pragma once
 /*-------------------------------------------------------------------------------------------------------------------*/
-//#include "clock.h"
+#include "sys/clock.h"
 #include "net/ipv6/uip.h"
 
 #ifdef WITH_OSCORE
@@ -12,6 +12,42 @@
 #ifndef PUBLIC_KEYSTORE_SIZE
 #define PUBLIC_KEYSTORE_SIZE 12
 #endif
+
+// Number of slots in the EUI-64 keyed open-addressing index of verified certificates.
+// Keep this at least twice PUBLIC_KEYSTORE_SIZE so probe sequences stay short.
+#ifndef PUBLIC_KEYSTORE_INDEX_SIZE
+#define PUBLIC_KEYSTORE_INDEX_SIZE (PUBLIC_KEYSTORE_SIZE * 2)
+#endif
+
+// Number of recently evicted certificates remembered, so that re-fetches can be counted
+#ifndef PUBLIC_KEYSTORE_EVICTION_HISTORY
+#define PUBLIC_KEYSTORE_EVICTION_HISTORY 8
+#endif
+
+// Number of digests of certificates that passed and failed signature verification that are remembered,
+// so that a certificate received again (e.g., after being evicted) is not verified again
+#ifndef PUBLIC_KEYSTORE_VERIFIED_DIGESTS
+#define PUBLIC_KEYSTORE_VERIFIED_DIGESTS 8
+#endif
+
+#ifndef PUBLIC_KEYSTORE_FAILED_DIGESTS
+#define PUBLIC_KEYSTORE_FAILED_DIGESTS 4
+#endif
+
+// Up to this many public keys are asked for in one request to the root
+#ifndef PUBLIC_KEY_REQUEST_BATCH_SIZE
+#define PUBLIC_KEY_REQUEST_BATCH_SIZE 4
+#endif
+
+// Number of public key requests that may be awaiting a response at once
+#ifndef PUBLIC_KEY_REQUESTS_MAX_IN_FLIGHT
+#define PUBLIC_KEY_REQUESTS_MAX_IN_FLIGHT 2
+#endif
+
+// Number of addresses that may be waiting for a request to be sent
+#ifndef PUBLIC_KEY_REQUEST_QUEUE_SIZE
+#define PUBLIC_KEY_REQUEST_QUEUE_SIZE 8
+#endif
 /*-------------------------------------------------------------------------------------------------------------------*/
 typedef struct public_key_item {
     struct public_key_item *next;
@@ -22,23 +58,52 @@ typedef struct public_key_item {
     oscore_ctx_t context;
 #endif
 
-    //clock_time_t age;
+    // Last time the certificate was found, the least recently used is evicted first
+    clock_time_t last_used;
 
     uint16_t pin_count;
+
+#ifdef TRUST_SNAPSHOT
+    // Verified before a reboot, so does not need to be verified again
+    bool restored;
+#endif
 } public_key_item_t;
 /*-------------------------------------------------------------------------------------------------------------------*/
 bool keystore_add(const certificate_t* cert);
 bool keystore_remove(public_key_item_t* item);
 /*-------------------------------------------------------------------------------------------------------------------*/
+#ifdef TRUST_SNAPSHOT
+// Adds a certificate that was verified before a reboot (see trust-snapshot.h)
+bool keystore_restore(const certificate_t* cert);
+#endif
+/*-------------------------------------------------------------------------------------------------------------------*/
 public_key_item_t* keystore_find(const uint8_t* eui64);
 public_key_item_t* keystore_find_addr(const uip_ip6addr_t* addr);
 const ecdsa_secp256r1_pubkey_t* keystore_find_pubkey(const uip_ip6addr_t* addr);
 /*-------------------------------------------------------------------------------------------------------------------*/
+// Iterates the certificates that have been verified
+public_key_item_t* keystore_iter(void);
+public_key_item_t* keystore_next(public_key_item_t* iter);
+/*-------------------------------------------------------------------------------------------------------------------*/
 bool keystore_certificate_contains_tags(const stereotype_tags_t* tags);
 /*-------------------------------------------------------------------------------------------------------------------*/
 void keystore_pin(public_key_item_t* item);
 void keystore_unpin(public_key_item_t* item);
 bool keystore_is_pinned(const public_key_item_t* item);
 /*-------------------------------------------------------------------------------------------------------------------*/
+// Returns true if the address was queued to be asked for, addresses queued together are asked for in one request
 bool request_public_key(const uip_ip6addr_t* addr);
 /*-------------------------------------------------------------------------------------------------------------------*/
+// Counters to size PUBLIC_KEYSTORE_SIZE from, a re-fetch is a request for a recently evicted certificate
+typedef struct {
+    uint32_t hits;
+    uint32_t misses;
+    uint32_t evictions;
+    uint32_t refetches;
+    uint32_t verified_digest_hits;
+    uint32_t failed_digest_hits;
+} keystore_stats_t;
+/*-------------------------------------------------------------------------------------------------------------------*/
+const keystore_stats_t* keystore_stats(void);
+void keystore_stats_print(void);
+/*-------------------------------------------------------------------------------------------------------------------*/
@@ -31,6 +31,11 @@ bool platform_crypto_success(platform_crypto_result_t ret)
     return ret == NRF_SUCCESS;
 }
 /*-------------------------------------------------------------------------------------------------------------------*/
+bool platform_crypto_signature_invalid(platform_crypto_result_t ret)
+{
+    return ret == NRF_ERROR_CRYPTO_ECDSA_INVALID_SIGNATURE;
+}
+/*-------------------------------------------------------------------------------------------------------------------*/
 void platform_crypto_support_init(void)
 {
     // Make sure that nrf_crypto has been started
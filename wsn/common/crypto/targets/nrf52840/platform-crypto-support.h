@@ -15,7 +15,12 @@ typedef ret_code_t platform_crypto_result_t;
 /*-------------------------------------------------------------------------------------------------------------------*/
 void platform_crypto_support_init(void);
 /*-------------------------------------------------------------------------------------------------------------------*/
+// The result of a sign or verify dropped as it was not started before its deadline
+#define PLATFORM_CRYPTO_EXPIRED NRF_ERROR_TIMEOUT
+/*-------------------------------------------------------------------------------------------------------------------*/
 bool platform_crypto_success(platform_crypto_result_t ret);
+// True if a verification failed because the signature does not match, rather than the crypto processor failing
+bool platform_crypto_signature_invalid(platform_crypto_result_t ret);
 /*-------------------------------------------------------------------------------------------------------------------*/
 bool crypto_fill_random(uint8_t* buffer, size_t size_in_bytes);
 /*-------------------------------------------------------------------------------------------------------------------*/
@@ -25,6 +25,11 @@ bool platform_crypto_success(platform_crypto_result_t ret)
     return ret == CRYPTO_SUCCESS || ret == PKA_STATUS_SUCCESS;
 }
 /*-------------------------------------------------------------------------------------------------------------------*/
+bool platform_crypto_signature_invalid(platform_crypto_result_t ret)
+{
+    return ret == PKA_STATUS_SIGNATURE_INVALID;
+}
+/*-------------------------------------------------------------------------------------------------------------------*/
 void platform_crypto_support_init(void)
 {
     crypto_init();
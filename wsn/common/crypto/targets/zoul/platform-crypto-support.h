@@ -14,7 +14,13 @@ typedef uint8_t platform_crypto_result_t;
 /*-------------------------------------------------------------------------------------------------------------------*/
 void platform_crypto_support_init(void);
 /*-------------------------------------------------------------------------------------------------------------------*/
+// The result of a sign or verify dropped as it was not started before its deadline,
+// outside the range of the CRYPTO_ and PKA_STATUS_ codes
+#define PLATFORM_CRYPTO_EXPIRED ((platform_crypto_result_t)0xff)
+/*-------------------------------------------------------------------------------------------------------------------*/
 bool platform_crypto_success(platform_crypto_result_t ret);
+// True if a verification failed because the signature does not match, rather than the crypto processor failing
+bool platform_crypto_signature_invalid(platform_crypto_result_t ret);
 /*-------------------------------------------------------------------------------------------------------------------*/
 bool crypto_fill_random(uint8_t* buffer, size_t size_in_bytes);
 /*-------------------------------------------------------------------------------------------------------------------*/
@@ -4,6 +4,7 @@
 #include "uip-ds6.h"
 #include "root-endpoint.h"
 #include <stdio.h>
+#include <string.h>
 /*-------------------------------------------------------------------------------------------------------------------*/
 const uint8_t* current_eui64(void)
 {
@@ -43,6 +44,103 @@ void eui64_to_ipaddr(const uint8_t* eui64, uip_ip6addr_t* ipaddr)
     uip_ds6_set_addr_iid(ipaddr, &lladdr);
 }
 /*-------------------------------------------------------------------------------------------------------------------*/
+uint32_t eui64_hash(const uint8_t* eui64)
+{
+    uint32_t hash = 2166136261u;
+    for (uint8_t i = 0; i != EUI64_LENGTH; ++i)
+    {
+        hash ^= eui64[i];
+        hash *= 16777619u;
+    }
+
+    return hash;
+}
+/*-------------------------------------------------------------------------------------------------------------------*/
+static uint16_t eui64_index_hash(const eui64_index_t* index, const uint8_t* eui64)
+{
+    return (uint16_t)(eui64_hash(eui64) % index->size);
+}
+/*-------------------------------------------------------------------------------------------------------------------*/
+static uint16_t eui64_index_home(const eui64_index_t* index, const void* item)
+{
+    uint8_t eui64[EUI64_LENGTH];
+    index->key(item, eui64);
+
+    return eui64_index_hash(index, eui64);
+}
+/*-------------------------------------------------------------------------------------------------------------------*/
+static inline uint16_t eui64_index_next(const eui64_index_t* index, uint16_t slot)
+{
+    return (slot + 1 == index->size) ? 0 : slot + 1;
+}
+/*-------------------------------------------------------------------------------------------------------------------*/
+void eui64_index_clear(eui64_index_t* index)
+{
+    memset(index->slots, 0, index->size * sizeof(*index->slots));
+}
+/*-------------------------------------------------------------------------------------------------------------------*/
+void* eui64_index_find(const eui64_index_t* index, const uint8_t* eui64,
+                       bool (*match)(const void* item, const void* arg), const void* arg)
+{
+    for (uint16_t slot = eui64_index_hash(index, eui64); index->slots[slot] != NULL; slot = eui64_index_next(index, slot))
+    {
+        if (match(index->slots[slot], arg))
+        {
+            return index->slots[slot];
+        }
+    }
+
+    return NULL;
+}
+/*-------------------------------------------------------------------------------------------------------------------*/
+void eui64_index_insert(eui64_index_t* index, void* item)
+{
+    uint16_t slot = eui64_index_home(index, item);
+
+    while (index->slots[slot] != NULL)
+    {
+        slot = eui64_index_next(index, slot);
+    }
+
+    index->slots[slot] = item;
+}
+/*-------------------------------------------------------------------------------------------------------------------*/
+bool eui64_index_remove(eui64_index_t* index, const void* item)
+{
+    uint16_t slot = eui64_index_home(index, item);
+
+    while (index->slots[slot] != item)
+    {
+        if (index->slots[slot] == NULL)
+        {
+            return false;
+        }
+
+        slot = eui64_index_next(index, slot);
+    }
+
+    index->slots[slot] = NULL;
+
+    // Shift back later entries in this cluster that can no longer be reached from their home slot
+    for (uint16_t next = eui64_index_next(index, slot); index->slots[next] != NULL; next = eui64_index_next(index, next))
+    {
+        const uint16_t home = eui64_index_home(index, index->slots[next]);
+
+        const bool reachable = (slot <= next)
+            ? (slot < home && home <= next)
+            : (slot < home || home <= next);
+
+        if (!reachable)
+        {
+            index->slots[slot] = index->slots[next];
+            index->slots[next] = NULL;
+            slot = next;
+        }
+    }
+
+    return true;
+}
+/*-------------------------------------------------------------------------------------------------------------------*/
 bool eui64_from_str(const char* eui64_str, uint8_t* eui64)
 {
     int len = strlen(eui64_str);
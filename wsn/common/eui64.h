@@ -10,6 +10,27 @@ const uint8_t* current_eui64(void);
 void eui64_from_ipaddr(const uip_ip6addr_t* ipaddr, uint8_t* eui64);
 void eui64_to_ipaddr(const uint8_t* eui64, uip_ip6addr_t* ipaddr);
 /*-------------------------------------------------------------------------------------------------------------------*/
+// FNV-1a hash, used to index tables keyed by EUI-64
+uint32_t eui64_hash(const uint8_t* eui64);
+/*-------------------------------------------------------------------------------------------------------------------*/
+// Open-addressing (linear probing) index of items keyed by EUI-64. It must have more slots than items,
+// so every probe ends at an empty slot. Removal uses backward shift deletion, so no tombstones are needed.
+typedef struct {
+    void** slots;
+    uint16_t size;
+
+    // Gets the EUI-64 an item is indexed by
+    void (*key)(const void* item, uint8_t* eui64);
+} eui64_index_t;
+/*-------------------------------------------------------------------------------------------------------------------*/
+void eui64_index_clear(eui64_index_t* index);
+// Returns the first item indexed by eui64 that match accepts, or NULL
+void* eui64_index_find(const eui64_index_t* index, const uint8_t* eui64,
+                       bool (*match)(const void* item, const void* arg), const void* arg);
+void eui64_index_insert(eui64_index_t* index, void* item);
+// Returns false if the item was not in the index
+bool eui64_index_remove(eui64_index_t* index, const void* item);
+/*-------------------------------------------------------------------------------------------------------------------*/
 bool eui64_from_str(const char* eui64_str, uint8_t* eui64);
 bool eui64_from_strn(const char* eui64_str, size_t length, uint8_t* eui64);
 int eui64_to_str(const uint8_t* eui64, char* eui64_str, size_t eui64_str_size);
@@ -0,0 +1,301 @@
+#include "fixed-point.h"
+/*-------------------------------------------------------------------------------------------------------------------*/
+// Polynomials are evaluated with more fractional bits than the result, then rounded
+#define Q30_CONST(x) ((int32_t)((x) * 1073741824.0 + ((x) >= 0 ? 0.5 : -0.5)))
+#define Q28_CONST(x) ((int32_t)((x) * 268435456.0 + ((x) >= 0 ? 0.5 : -0.5)))
+/*-------------------------------------------------------------------------------------------------------------------*/
+static q16_16_t saturate(int64_t x)
+{
+    if (x > Q16_16_MAX)
+    {
+        return Q16_16_MAX;
+    }
+    else if (x < -Q16_16_MAX)
+    {
+        return -Q16_16_MAX;
+    }
+    else
+    {
+        return (q16_16_t)x;
+    }
+}
+/*-------------------------------------------------------------------------------------------------------------------*/
+q16_16_t q16_16_div(q16_16_t a, q16_16_t b)
+{
+    if (b == 0)
+    {
+        return a >= 0 ? Q16_16_MAX : -Q16_16_MAX;
+    }
+
+    return saturate(((int64_t)a * Q16_16_ONE) / b);
+}
+/*-------------------------------------------------------------------------------------------------------------------*/
+q16_16_t q16_16_ratio(uint32_t n, uint32_t d)
+{
+    if (d == 0)
+    {
+        return Q16_16_MAX;
+    }
+
+    // Counts are usually small, which allows a single 32-bit division
+    if (n <= UINT16_MAX)
+    {
+        return saturate((n << Q16_16_FRAC_BITS) / d);
+    }
+
+    return saturate(((uint64_t)n << Q16_16_FRAC_BITS) / d);
+}
+/*-------------------------------------------------------------------------------------------------------------------*/
+q16_16_t q16_16_ratio64(uint64_t n, uint64_t d)
+{
+    // Drop precision from both until the numerator can be shifted
+    while (n >= ((uint64_t)1 << 47))
+    {
+        n >>= 1;
+        d >>= 1;
+    }
+
+    if (d == 0)
+    {
+        return Q16_16_MAX;
+    }
+
+    const uint64_t result = (n << Q16_16_FRAC_BITS) / d;
+
+    return result > Q16_16_MAX ? Q16_16_MAX : (q16_16_t)result;
+}
+/*-------------------------------------------------------------------------------------------------------------------*/
+bool q16_16_isclose(q16_16_t a, q16_16_t b)
+{
+    // Same relative tolerance as isclose in float-helpers.c
+    const int64_t rel_tol = Q16_16_CONST(2.5e-4);
+
+    const int64_t abs_a = a < 0 ? -(int64_t)a : a;
+    const int64_t abs_b = b < 0 ? -(int64_t)b : b;
+    const int64_t comp = abs_a < abs_b ? abs_b : abs_a;
+
+    const int64_t diff = (int64_t)a - b;
+
+    return (diff < 0 ? -diff : diff) <= ((rel_tol * comp) >> Q16_16_FRAC_BITS);
+}
+/*-------------------------------------------------------------------------------------------------------------------*/
+q16_16_t q16_16_exp_neg(q16_16_t x)
+{
+    if (x <= 0)
+    {
+        return Q16_16_ONE;
+    }
+
+    // exp(-12) is below the smallest representable value
+    if (x >= Q16_16_CONST(12.0))
+    {
+        return 0;
+    }
+
+    // exp(-x) = 2^-(k + f) where k is an integer and 0 <= f < 1
+    const q16_16_t y = q16_16_mul(x, Q16_16_CONST(1.4426950408889634)); // log2(e)
+    const int k = y >> Q16_16_FRAC_BITS;
+    const int32_t f = (y & (Q16_16_ONE - 1)) << (30 - Q16_16_FRAC_BITS);
+
+    // Taylor series of 2^-f = exp(-f ln 2), the first omitted term is below 2e-5
+    static const int32_t coeffs[] = {
+        Q30_CONST(0.000154035),
+        Q30_CONST(-0.001333356),
+        Q30_CONST(0.009618129),
+        Q30_CONST(-0.055504109),
+        Q30_CONST(0.240226507),
+        Q30_CONST(-0.693147181),
+        Q30_CONST(1.0),
+    };
+
+    int32_t acc = coeffs[0];
+    for (unsigned i = 1; i != sizeof(coeffs)/sizeof(*coeffs); ++i)
+    {
+        acc = coeffs[i] + (int32_t)(((int64_t)acc * f) >> 30);
+    }
+
+    const int shift = (30 - Q16_16_FRAC_BITS) + k;
+    if (shift >= 31)
+    {
+        return 0;
+    }
+
+    return (acc + (1 << (shift - 1))) >> shift;
+}
+/*-------------------------------------------------------------------------------------------------------------------*/
+q16_16_t q16_16_erfc(q16_16_t x)
+{
+    // erfc(-x) = 2 - erfc(x)
+    if (x < 0)
+    {
+        return 2 * Q16_16_ONE - q16_16_erfc(-x);
+    }
+
+    // erfc(6) is below the smallest representable value
+    if (x >= Q16_16_CONST(6.0))
+    {
+        return 0;
+    }
+
+    // Abramowitz and Stegun 7.1.26, which has an absolute error below 1.5e-7
+    // erfc(x) = t * (a1 + t * (a2 + t * (a3 + t * (a4 + t * a5)))) * exp(-x^2) where t = 1 / (1 + p*x)
+    const int32_t t = (int32_t)(((int64_t)1 << (28 + Q16_16_FRAC_BITS)) /
+                                (Q16_16_ONE + q16_16_mul(Q16_16_CONST(0.3275911), x)));
+
+    static const int32_t coeffs[] = {
+        Q28_CONST(1.061405429),
+        Q28_CONST(-1.453152027),
+        Q28_CONST(1.421413741),
+        Q28_CONST(-0.284496736),
+        Q28_CONST(0.254829592),
+    };
+
+    int32_t acc = coeffs[0];
+    for (unsigned i = 1; i != sizeof(coeffs)/sizeof(*coeffs); ++i)
+    {
+        acc = coeffs[i] + (int32_t)(((int64_t)acc * t) >> 28);
+    }
+    acc = (int32_t)(((int64_t)acc * t) >> 28);
+
+    const q16_16_t e = q16_16_exp_neg(q16_16_mul(x, x));
+
+    return (q16_16_t)(((int64_t)acc * e + (1 << 27)) >> 28);
+}
+/*-------------------------------------------------------------------------------------------------------------------*/
+float q16_16_to_float(q16_16_t x)
+{
+    return x / 65536.0f;
+}
+/*-------------------------------------------------------------------------------------------------------------------*/
+q16_16_t q16_16_from_float(float x)
+{
+    return saturate((int64_t)(x * 65536.0f + (x >= 0 ? 0.5f : -0.5f)));
+}
+/*-------------------------------------------------------------------------------------------------------------------*/
+q48_16_t q48_16_mul(q48_16_t a, q48_16_t b)
+{
+    // a = hi * 2^16 + lo, where lo is never negative
+    const int64_t hi = a >> Q16_16_FRAC_BITS;
+    const int64_t lo = a & (Q16_16_ONE - 1);
+
+    return hi * b + ((lo * b + Q16_16_HALF) >> Q16_16_FRAC_BITS);
+}
+/*-------------------------------------------------------------------------------------------------------------------*/
+q16_16_t q48_16_div(q48_16_t a, q48_16_t b)
+{
+    if (b == 0)
+    {
+        return a >= 0 ? Q16_16_MAX : -Q16_16_MAX;
+    }
+
+    // Drop precision from both until the numerator can be shifted
+    while (a >= ((int64_t)1 << 46) || a <= -((int64_t)1 << 46))
+    {
+        a /= 2;
+        b /= 2;
+
+        if (b == 0)
+        {
+            return a >= 0 ? Q16_16_MAX : -Q16_16_MAX;
+        }
+    }
+
+    // Rounded to nearest, division truncates towards zero so the half is added away from zero
+    const int64_t n = a * Q16_16_ONE;
+    const int64_t half = (b < 0 ? -b : b) / 2;
+
+    return saturate((n + (n < 0 ? -half : half)) / b);
+}
+/*-------------------------------------------------------------------------------------------------------------------*/
+static uint32_t isqrt32(uint32_t x)
+{
+    if (x == 0)
+    {
+        return 0;
+    }
+
+    // sqrt((i + 16.5) * 2^26), for the top 6 bits of a value normalised to [2^30, 2^32)
+    static const uint16_t seeds[48] = {
+        33276, 34270, 35235, 36175, 37091, 37985, 38858, 39712,
+        40548, 41368, 42171, 42959, 43733, 44494, 45242, 45977,
+        46702, 47415, 48117, 48809, 49492, 50166, 50830, 51486,
+        52134, 52773, 53405, 54030, 54647, 55258, 55862, 56459,
+        57051, 57636, 58215, 58789, 59357, 59919, 60477, 61029,
+        61576, 62119, 62657, 63190, 63719, 64243, 64763, 65279,
+    };
+
+    const unsigned shift = __builtin_clz(x) & ~1u;
+    const uint32_t y = x << shift;
+
+    // The seed is within 1.5%, so two Newton steps are accurate to within one
+    uint32_t result = seeds[(y >> 26) - 16];
+    result = (result + y / result) / 2;
+    result = (result + y / result) / 2;
+
+    result >>= shift / 2;
+
+    while ((uint64_t)result * result > x)
+    {
+        result -= 1;
+    }
+    while ((uint64_t)(result + 1) * (result + 1) <= x)
+    {
+        result += 1;
+    }
+
+    return result;
+}
+/*-------------------------------------------------------------------------------------------------------------------*/
+static uint64_t isqrt64(uint64_t x)
+{
+    if (x <= UINT32_MAX)
+    {
+        return isqrt32((uint32_t)x);
+    }
+
+    // Estimate from the square root of the top 32 bits, which is rounded up so that it is never too small
+    const unsigned top_bits = 64 - __builtin_clzll(x);
+    const unsigned shift = (top_bits - 32 + 1) & ~1u;
+
+    uint64_t result = ((uint64_t)isqrt32((uint32_t)(x >> shift)) + 1) << (shift / 2);
+
+    // A single Newton step doubles the 16 correct bits of the estimate,
+    // the step cannot undershoot so at most a couple of corrections are needed
+    result = (result + x / result) / 2;
+
+    while (result * result > x)
+    {
+        result -= 1;
+    }
+
+    return result;
+}
+/*-------------------------------------------------------------------------------------------------------------------*/
+q48_16_t q48_16_sqrt(q48_16_t x)
+{
+    if (x <= 0)
+    {
+        return 0;
+    }
+
+    // sqrt(x / 2^16) * 2^16 = sqrt(x * 2^16)
+    if (x < ((int64_t)1 << 47))
+    {
+        return (q48_16_t)isqrt64((uint64_t)x << Q16_16_FRAC_BITS);
+    }
+    else
+    {
+        return (q48_16_t)isqrt64((uint64_t)x) << (Q16_16_FRAC_BITS / 2);
+    }
+}
+/*-------------------------------------------------------------------------------------------------------------------*/
+float q48_16_to_float(q48_16_t x)
+{
+    return x / 65536.0f;
+}
+/*-------------------------------------------------------------------------------------------------------------------*/
+q48_16_t q48_16_from_float(float x)
+{
+    return (q48_16_t)(x * 65536.0f + (x >= 0 ? 0.5f : -0.5f));
+}
+/*-------------------------------------------------------------------------------------------------------------------*/
@@ -0,0 +1,72 @@
+#pragma once
+/*-------------------------------------------------------------------------------------------------------------------*/
+#include <stdint.h>
+#include <stdbool.h>
+/*-------------------------------------------------------------------------------------------------------------------*/
+// Signed fixed-point numbers with 16 fractional bits, for MCUs without an FPU.
+// q16_16_t covers [-32768, 32768) which is enough for probabilities, weights and trust values.
+// q48_16_t has the same resolution but a much larger range, for sample values such as throughput
+// (and their squares) that do not fit in a q16_16_t. Converting between the two is just a cast.
+typedef int32_t q16_16_t;
+typedef int64_t q48_16_t;
+/*-------------------------------------------------------------------------------------------------------------------*/
+#define Q16_16_FRAC_BITS 16
+#define Q16_16_ONE ((q16_16_t)1 << Q16_16_FRAC_BITS)
+#define Q16_16_HALF ((q16_16_t)1 << (Q16_16_FRAC_BITS - 1))
+// Saturating operations are symmetric, so the result can always be negated
+#define Q16_16_MAX INT32_MAX
+
+// For constants only, so the conversion is done by the compiler
+#define Q16_16_CONST(x) ((q16_16_t)((x) * 65536.0 + ((x) >= 0 ? 0.5 : -0.5)))
+/*-------------------------------------------------------------------------------------------------------------------*/
+static inline q16_16_t q16_16_from_uint(uint32_t x)
+{
+    return (q16_16_t)(x << Q16_16_FRAC_BITS);
+}
+/*-------------------------------------------------------------------------------------------------------------------*/
+static inline q16_16_t q16_16_mul(q16_16_t a, q16_16_t b)
+{
+    return (q16_16_t)(((int64_t)a * b + Q16_16_HALF) >> Q16_16_FRAC_BITS);
+}
+/*-------------------------------------------------------------------------------------------------------------------*/
+// Saturates to +/-Q16_16_MAX, including when dividing by zero
+q16_16_t q16_16_div(q16_16_t a, q16_16_t b);
+/*-------------------------------------------------------------------------------------------------------------------*/
+// n / d, saturating at Q16_16_MAX
+q16_16_t q16_16_ratio(uint32_t n, uint32_t d);
+q16_16_t q16_16_ratio64(uint64_t n, uint64_t d);
+/*-------------------------------------------------------------------------------------------------------------------*/
+// Multiplies by an integer and truncates, such as to scale a probability to a random number range
+static inline uint32_t q16_16_scale_to_uint(q16_16_t x, uint32_t n)
+{
+    return x <= 0 ? 0 : (uint32_t)(((uint64_t)x * n) >> Q16_16_FRAC_BITS);
+}
+/*-------------------------------------------------------------------------------------------------------------------*/
+bool q16_16_isclose(q16_16_t a, q16_16_t b);
+/*-------------------------------------------------------------------------------------------------------------------*/
+// exp(-x) for x >= 0
+q16_16_t q16_16_exp_neg(q16_16_t x);
+
+// erfc(x), accurate to within a few LSB
+q16_16_t q16_16_erfc(q16_16_t x);
+/*-------------------------------------------------------------------------------------------------------------------*/
+// Conversions involving floats are only intended for serialisation and logging
+float q16_16_to_float(q16_16_t x);
+q16_16_t q16_16_from_float(float x);
+/*-------------------------------------------------------------------------------------------------------------------*/
+static inline q48_16_t q48_16_from_uint(uint32_t x)
+{
+    return (q48_16_t)x << Q16_16_FRAC_BITS;
+}
+/*-------------------------------------------------------------------------------------------------------------------*/
+// Splits a so that the intermediate product does not overflow for values up to about 2^23
+q48_16_t q48_16_mul(q48_16_t a, q48_16_t b);
+
+// Saturates to +/-Q16_16_MAX, as it is used to find a ratio between two samples
+q16_16_t q48_16_div(q48_16_t a, q48_16_t b);
+
+q48_16_t q48_16_sqrt(q48_16_t x);
+/*-------------------------------------------------------------------------------------------------------------------*/
+float q48_16_to_float(q48_16_t x);
+q48_16_t q48_16_from_float(float x);
+/*-------------------------------------------------------------------------------------------------------------------*/
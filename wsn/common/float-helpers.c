@@ -1,6 +1,7 @@
 #include "float-helpers.h"
 
 #include <math.h>
+#include <string.h>
 
 bool isclose(float a, float b)
 {
@@ -10,3 +11,86 @@ bool isclose(float a, float b)
 
     return fabs(a - b) <= (rel_tol * comp);
 }
+
+uint16_t float_to_half(float f)
+{
+    uint32_t x;
+    memcpy(&x, &f, sizeof(x));
+
+    const uint16_t sign = (x >> 16) & 0x8000;
+    const int32_t exp = (int32_t)((x >> 23) & 0xff) - 127 + 15;
+    uint32_t mant = x & 0x7fffff;
+
+    if (((x >> 23) & 0xff) == 0xff)
+    {
+        // Infinity or NaN
+        return sign | 0x7c00 | (mant ? 0x200 : 0);
+    }
+
+    if (exp >= 0x1f)
+    {
+        return sign | 0x7bff;
+    }
+
+    if (exp <= 0)
+    {
+        // Subnormal or zero
+        if (exp < -10)
+        {
+            return sign;
+        }
+
+        mant |= 0x800000;
+        const uint32_t shift = 14 - exp;
+        uint32_t half = mant >> shift;
+        const uint32_t rem = mant & ((1u << shift) - 1);
+        const uint32_t halfway = 1u << (shift - 1);
+        if (rem > halfway || (rem == halfway && (half & 1)))
+        {
+            half += 1;
+        }
+        return sign | half;
+    }
+
+    uint32_t half = ((uint32_t)exp << 10) | (mant >> 13);
+    const uint32_t rem = mant & 0x1fff;
+    if (rem > 0x1000 || (rem == 0x1000 && (half & 1)))
+    {
+        // May carry into the exponent, which is still correct
+        half += 1;
+    }
+
+    return half >= 0x7c00 ? (sign | 0x7bff) : (sign | half);
+}
+
+float half_to_float(uint16_t h)
+{
+    const uint32_t sign = (uint32_t)(h & 0x8000) << 16;
+    const uint32_t exp = (h >> 10) & 0x1f;
+    const uint32_t mant = h & 0x3ff;
+
+    uint32_t x;
+    if (exp == 0x1f)
+    {
+        x = sign | 0x7f800000 | (mant << 13);
+    }
+    else if (exp == 0)
+    {
+        // Subnormal or zero, mant * 2^-24
+        const float f = ldexpf((float)mant, -24);
+        return sign ? -f : f;
+    }
+    else
+    {
+        x = sign | ((exp - 15 + 127) << 23) | (mant << 13);
+    }
+
+    float f;
+    memcpy(&f, &x, sizeof(f));
+    return f;
+}
+
+float float_round_half(float f)
+{
+    return half_to_float(float_to_half(f));
+}
@@ -1,5 +1,16 @@
 #pragma once
 
 #include <stdbool.h>
+#include <stdint.h>
 
 bool isclose(float a, float b);
+
+#define HALF_FLOAT_MAX 65504.0f
+#define HALF_FLOAT_MIN_NORMAL 6.103515625e-05f
+
+// IEEE 754 binary16, rounded to nearest even. Values too large for it saturate to the largest finite half (65504).
+uint16_t float_to_half(float f);
+float half_to_float(uint16_t h);
+
+// Rounds f to the nearest value representable as a half
+float float_round_half(float f);
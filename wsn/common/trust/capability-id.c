@@ -0,0 +1,68 @@
+#include "capability-id.h"
+#include "applications.h"
+
+#include <string.h>
+/*-------------------------------------------------------------------------------------------------------------------*/
+_Static_assert(CAPABILITY_ID_NUM == APPLICATION_NUM, "Capability IDs must match the applications");
+_Static_assert(CAPABILITY_ID_NUM < CAPABILITY_ID_INVALID, "Too many applications for capability_id_t");
+/*-------------------------------------------------------------------------------------------------------------------*/
+static const char* const capability_names[CAPABILITY_ID_NUM] = APPLICATION_NAMES;
+
+// Position of each capability when sorted by name, so the canonical order can be compared without strcmp
+static uint8_t capability_ranks[CAPABILITY_ID_NUM];
+/*-------------------------------------------------------------------------------------------------------------------*/
+void capability_id_init(void)
+{
+    for (capability_id_t id = 0; id != CAPABILITY_ID_NUM; ++id)
+    {
+        uint8_t rank = 0;
+
+        for (capability_id_t other = 0; other != CAPABILITY_ID_NUM; ++other)
+        {
+            if (strcmp(capability_names[other], capability_names[id]) < 0)
+            {
+                rank++;
+            }
+        }
+
+        capability_ranks[id] = rank;
+    }
+}
+/*-------------------------------------------------------------------------------------------------------------------*/
+capability_id_t capability_id_find(const char* name)
+{
+    return capability_id_findn(name, strlen(name));
+}
+/*-------------------------------------------------------------------------------------------------------------------*/
+capability_id_t capability_id_findn(const char* name, size_t name_len)
+{
+    for (capability_id_t id = 0; id != CAPABILITY_ID_NUM; ++id)
+    {
+        if (strncmp(capability_names[id], name, name_len) == 0 && capability_names[id][name_len] == '\0')
+        {
+            return id;
+        }
+    }
+
+    return CAPABILITY_ID_INVALID;
+}
+/*-------------------------------------------------------------------------------------------------------------------*/
+const char* capability_id_name(capability_id_t id)
+{
+    if (!capability_id_is_valid(id))
+    {
+        return "?";
+    }
+
+    return capability_names[id];
+}
+/*-------------------------------------------------------------------------------------------------------------------*/
+int capability_id_compare(capability_id_t a, capability_id_t b)
+{
+    // Invalid IDs are ordered after every valid one
+    const int rank_a = capability_id_is_valid(a) ? capability_ranks[a] : CAPABILITY_ID_NUM;
+    const int rank_b = capability_id_is_valid(b) ? capability_ranks[b] : CAPABILITY_ID_NUM;
+
+    return rank_a - rank_b;
+}
+/*-------------------------------------------------------------------------------------------------------------------*/
@@ -0,0 +1,35 @@
+#pragma once
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdbool.h>
+/*-------------------------------------------------------------------------------------------------------------------*/
+// Capability names are interned into a small integer ID when they are first received
+// (MQTT topics or CBOR trust payloads). The IDs are generated by applications/Makefile.include
+// in the same order as APPLICATION_NAMES, e.g., MONITORING_APPLICATION_ID.
+typedef enum {
+    APPLICATION_IDS,
+
+    CAPABILITY_ID_NUM
+} capability_ids_t;
+/*-------------------------------------------------------------------------------------------------------------------*/
+typedef uint8_t capability_id_t;
+/*-------------------------------------------------------------------------------------------------------------------*/
+#define CAPABILITY_ID_INVALID UINT8_MAX
+/*-------------------------------------------------------------------------------------------------------------------*/
+void capability_id_init(void);
+/*-------------------------------------------------------------------------------------------------------------------*/
+capability_id_t capability_id_find(const char* name);
+capability_id_t capability_id_findn(const char* name, size_t name_len);
+/*-------------------------------------------------------------------------------------------------------------------*/
+const char* capability_id_name(capability_id_t id);
+/*-------------------------------------------------------------------------------------------------------------------*/
+// Canonical order of capabilities (by name), as IDs are not guaranteed to match between builds.
+// The order of the names is found once by capability_id_init, so this only compares integers.
+int capability_id_compare(capability_id_t a, capability_id_t b);
+/*-------------------------------------------------------------------------------------------------------------------*/
+static inline bool capability_id_is_valid(capability_id_t id)
+{
+    return id < CAPABILITY_ID_NUM;
+}
+/*-------------------------------------------------------------------------------------------------------------------*/
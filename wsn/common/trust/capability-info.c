@@ -34,7 +34,7 @@ free_up_capabilities(void)
     for (capability_t* eiter = list_head(capabilities); eiter != NULL; eiter = list_item_next(eiter))
     {
         // Remove information on capabilities for which there are no active capabilities
-        if (!edge_info_has_active_capability(eiter->name))
+        if (!edge_info_has_active_capability(eiter->id))
         {
             return capability_info_remove(eiter);
         }
@@ -79,12 +79,12 @@ capability_info_init(void)
 }
 /*-------------------------------------------------------------------------------------------------------------------*/
 capability_t*
-capability_info_add(const char* name)
+capability_info_add(capability_id_t id)
 {
     capability_t* cap;
 
     // First lets check if we already have a record of this capability
-    cap = capability_info_find(name);
+    cap = capability_info_find(id);
     if (cap != NULL)
     {
         return cap;
@@ -96,7 +96,7 @@ capability_info_add(const char* name)
         return NULL;
     }
 
-    strcpy(cap->name, name);
+    cap->id = id;
 
     list_push(capabilities, cap);
 
@@ -129,11 +129,11 @@ capability_info_next(capability_t* iter)
 }
 /*-------------------------------------------------------------------------------------------------------------------*/
 capability_t*
-capability_info_find(const char* name)
+capability_info_find(capability_id_t id)
 {
     for (capability_t* iter = list_head(capabilities); iter != NULL; iter = list_item_next(iter))
     {
-        if (strcmp(iter->name, name) == 0)
+        if (iter->id == id)
         {
             return iter;
         }
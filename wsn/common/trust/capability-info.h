@@ -27,7 +27,7 @@ typedef struct capability
 {
     struct capability *next;
 
-    char name[EDGE_CAPABILITY_NAME_LEN + 1];
+    capability_id_t id;
 
     capability_tm_t tm;
 
@@ -35,10 +35,10 @@ typedef struct capability
 /*-------------------------------------------------------------------------------------------------------------------*/
 void capability_info_init(void);
 /*-------------------------------------------------------------------------------------------------------------------*/
-capability_t* capability_info_add(const char* name);
+capability_t* capability_info_add(capability_id_t id);
 bool capability_info_remove(capability_t* edge);
 /*-------------------------------------------------------------------------------------------------------------------*/
-capability_t* capability_info_find(const char* name);
+capability_t* capability_info_find(capability_id_t id);
 /*-------------------------------------------------------------------------------------------------------------------*/
 capability_t* capability_info_iter(void);
 capability_t* capability_info_next(capability_t* iter);
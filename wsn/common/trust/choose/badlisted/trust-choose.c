@@ -12,12 +12,12 @@
 #endif
 /*-------------------------------------------------------------------------------------------------------------------*/
 // Only support choosing nodes that are good
-edge_resource_t* choose_edge(const char* capability_name)
+edge_resource_t* choose_edge(capability_id_t capability_id)
 {
     edge_resource_t* candidates[NUM_EDGE_RESOURCES];
     uint8_t candidates_len = 0;
 
-    //LOG_DBG("Choosing an edge to submit task for %s\n", capability_name);
+    //LOG_DBG("Choosing an edge to submit task for %s\n", capability_id_name(capability_id));
 
     for (edge_resource_t* iter = edge_info_iter(); iter != NULL; iter = edge_info_next(iter))
     {
@@ -32,7 +32,7 @@ edge_resource_t* choose_edge(const char* capability_name)
         }
 
         // Make sure the edge has the desired capability
-        edge_capability_t* capability = edge_info_capability_find(iter, capability_name);
+        edge_capability_t* capability = edge_info_capability_find(iter, capability_id);
         if (capability == NULL)
         {
             //LOG_DBG("Excluding edge %s because it lacks the capability\n", edge_info_name(iter));
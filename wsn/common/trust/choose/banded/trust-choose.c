@@ -1,5 +1,6 @@
 #include "trust-choose.h"
 #include "trust-model.h"
+#include "trust-models.h"
 #include "edge-info.h"
 #include "random-helpers.h"
 #include "os/sys/log.h"
@@ -19,16 +20,16 @@
 /*-------------------------------------------------------------------------------------------------------------------*/
 // Pick randomly from the set of nodes within the highest
 // populated band.
-edge_resource_t* choose_edge(const char* capability_name)
+edge_resource_t* choose_edge(capability_id_t capability_id)
 {
     edge_resource_t* candidates[NUM_EDGE_RESOURCES];
-    float trust_values[NUM_EDGE_RESOURCES];
+    trust_real_t trust_values[NUM_EDGE_RESOURCES];
 
-    float highest_trust = 0;
+    trust_real_t highest_trust = TRUST_REAL(0);
 
     uint8_t candidates_len = 0;
 
-    //LOG_DBG("Choosing an edge to submit task for %s\n", capability_name);
+    //LOG_DBG("Choosing an edge to submit task for %s\n", capability_id_name(capability_id));
 
     for (edge_resource_t* iter = edge_info_iter(); iter != NULL; iter = edge_info_next(iter))
     {
@@ -43,7 +44,7 @@ edge_resource_t* choose_edge(const char* capability_name)
         }
 
         // Make sure the edge has the desired capability
-        edge_capability_t* capability = edge_info_capability_find(iter, capability_name);
+        edge_capability_t* capability = edge_info_capability_find(iter, capability_id);
         if (capability == NULL)
         {
             //LOG_DBG("Excluding edge %s because it lacks the capability\n", edge_info_name(iter));
@@ -62,14 +63,14 @@ edge_resource_t* choose_edge(const char* capability_name)
             continue;
         }
 
-        const float trust_value = calculate_trust_value(iter, capability);
+        const trust_real_t trust_value = trust_value_cached(iter, capability);
 
         // Record this as a potential candidate
         candidates[candidates_len] = iter;
         trust_values[candidates_len] = trust_value;
 
         LOG_INFO("Trust value for edge %s and capability %s=%f at %u/%u\n",
-            edge_info_name(iter), capability_name, trust_value, candidates_len, NUM_EDGE_RESOURCES);
+            edge_info_name(iter), capability_id_name(capability_id), trust_real_to_float(trust_value), candidates_len, NUM_EDGE_RESOURCES);
 
         // Record the highest trust seen
         if (trust_value > highest_trust)
@@ -81,7 +82,7 @@ edge_resource_t* choose_edge(const char* capability_name)
     }
 
     LOG_DBG("Filtering candidates, looking for those in the range [%f, %f]\n",
-        highest_trust - BAND_SIZE, highest_trust);
+        trust_real_to_float(highest_trust - TRUST_REAL(BAND_SIZE)), trust_real_to_float(highest_trust));
 
     uint8_t new_idx = 0;
 
@@ -89,7 +90,7 @@ edge_resource_t* choose_edge(const char* capability_name)
     // So lets remove any edges we are not considering
     for (uint8_t i = 0; i < candidates_len; ++i)
     {
-        if (trust_values[i] >= highest_trust - BAND_SIZE /*&& trust_values[i] <= highest_trust*/)
+        if (trust_values[i] >= highest_trust - TRUST_REAL(BAND_SIZE) /*&& trust_values[i] <= highest_trust*/)
         {
             candidates[new_idx] = candidates[i];
             trust_values[new_idx] = trust_values[i];
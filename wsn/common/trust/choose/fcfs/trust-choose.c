@@ -12,7 +12,7 @@
 /*-------------------------------------------------------------------------------------------------------------------*/
 // Use the first edge node we are aware of that supports
 // the provided capability
-edge_resource_t* choose_edge(const char* capability_name)
+edge_resource_t* choose_edge(capability_id_t capability_id)
 {
     for (edge_resource_t* iter = edge_info_iter(); iter != NULL; iter = edge_info_next(iter))
     {
@@ -22,7 +22,7 @@ edge_resource_t* choose_edge(const char* capability_name)
             continue;
         }
 
-        edge_capability_t* capability = edge_info_capability_find(iter, capability_name);
+        edge_capability_t* capability = edge_info_capability_find(iter, capability_id);
         if (capability == NULL)
         {
             continue;
@@ -1,5 +1,6 @@
 #include "trust-choose.h"
 #include "trust-model.h"
+#include "trust-models.h"
 #include "edge-info.h"
 #include "os/sys/log.h"
 /*-------------------------------------------------------------------------------------------------------------------*/
@@ -12,12 +13,12 @@
 /*-------------------------------------------------------------------------------------------------------------------*/
 // Pick the edge node with the highest trust level that supports
 // the provided capability.
-edge_resource_t* choose_edge(const char* capability_name)
+edge_resource_t* choose_edge(capability_id_t capability_id)
 {
     edge_resource_t* best_edge = NULL;
 
     // Start trust at -1, so even edges with 0 trust will be considered
-    float best_trust = -1.0f;
+    trust_real_t best_trust = TRUST_REAL(-1);
 
     for (edge_resource_t* iter = edge_info_iter(); iter != NULL; iter = edge_info_next(iter))
     {
@@ -27,10 +28,10 @@ edge_resource_t* choose_edge(const char* capability_name)
             continue;
         }
 
-        edge_capability_t* capability = edge_info_capability_find(iter, capability_name);
+        edge_capability_t* capability = edge_info_capability_find(iter, capability_id);
         if (capability == NULL)
         {
-            LOG_WARN("Cannot find capability %s for edge %s\n", capability_name, edge_info_name(iter));
+            LOG_WARN("Cannot find capability %s for edge %s\n", capability_id_name(capability_id), edge_info_name(iter));
             continue;
         }
 
@@ -40,10 +41,10 @@ edge_resource_t* choose_edge(const char* capability_name)
             continue;
         }
 
-        float trust_value = calculate_trust_value(iter, capability);
+        trust_real_t trust_value = trust_value_cached(iter, capability);
 
         LOG_INFO("Trust value for edge %s and capability %s=%f\n",
-            edge_info_name(iter), capability_name, trust_value);
+            edge_info_name(iter), capability_id_name(capability_id), trust_real_to_float(trust_value));
 
         if (trust_value > best_trust)
         {
@@ -1,5 +1,6 @@
 #include "trust-choose.h"
 #include "trust-model.h"
+#include "trust-models.h"
 #include "edge-info.h"
 #include "os/sys/log.h"
 #include "os/lib/random.h"
@@ -13,17 +14,17 @@
 /*-------------------------------------------------------------------------------------------------------------------*/
 // Divide up RANDOM_RAND_MAX proportionally based on the trust values of the edge capability
 // Pick the edge that a random number fall into the range of
-edge_resource_t* choose_edge(const char* capability_name)
+edge_resource_t* choose_edge(capability_id_t capability_id)
 {
     edge_resource_t* candidates[NUM_EDGE_RESOURCES];
-    float trust_values[NUM_EDGE_RESOURCES];
+    trust_real_t trust_values[NUM_EDGE_RESOURCES];
     uint16_t trust_values_boundaries[NUM_EDGE_RESOURCES];
 
-    float trust_values_sum = 0.0f;
+    trust_real_t trust_values_sum = TRUST_REAL(0);
 
     uint8_t candidates_len = 0;
 
-    //LOG_DBG("Choosing an edge to submit task for %s\n", capability_name);
+    //LOG_DBG("Choosing an edge to submit task for %s\n", capability_id_name(capability_id));
 
     for (edge_resource_t* iter = edge_info_iter(); iter != NULL; iter = edge_info_next(iter))
     {
@@ -38,7 +39,7 @@ edge_resource_t* choose_edge(const char* capability_name)
         }
 
         // Make sure the edge has the desired capability
-        edge_capability_t* capability = edge_info_capability_find(iter, capability_name);
+        edge_capability_t* capability = edge_info_capability_find(iter, capability_id);
         if (capability == NULL)
         {
             //LOG_DBG("Excluding edge %s because it lacks the capability\n", edge_info_name(iter));
@@ -57,14 +58,14 @@ edge_resource_t* choose_edge(const char* capability_name)
             continue;
         }
 
-        const float trust_value = calculate_trust_value(iter, capability);
+        const trust_real_t trust_value = trust_value_cached(iter, capability);
 
         // Record this as a potential candidate
         candidates[candidates_len] = iter;
         trust_values[candidates_len] = trust_value;
 
         LOG_INFO("Trust value for edge %s and capability %s=%f at %u/%u\n",
-            edge_info_name(iter), capability_name, trust_value, candidates_len, NUM_EDGE_RESOURCES);
+            edge_info_name(iter), capability_id_name(capability_id), trust_real_to_float(trust_value), candidates_len, NUM_EDGE_RESOURCES);
 
         candidates_len++;
 
@@ -74,10 +75,10 @@ edge_resource_t* choose_edge(const char* capability_name)
     for (uint8_t i = 0; i != candidates_len; ++i)
     {
         // Normalise the trust values so they sum to 1
-        trust_values[i] /= trust_values_sum;
+        trust_values[i] = trust_real_div(trust_values[i], trust_values_sum);
 
         // What proportion of RANDOM_RAND_MAX is this normalised trust value
-        trust_values_boundaries[i] = (uint16_t)(trust_values[i] * RANDOM_RAND_MAX);
+        trust_values_boundaries[i] = (uint16_t)trust_real_scale_to_uint(trust_values[i], RANDOM_RAND_MAX);
     }
 
     LOG_DBG("There are %u candidates \n", candidates_len);
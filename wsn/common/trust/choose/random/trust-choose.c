@@ -13,7 +13,7 @@
 /*-------------------------------------------------------------------------------------------------------------------*/
 // Use a random edge node we are aware of that supports
 // the requested capability
-edge_resource_t* choose_edge(const char* capability_name)
+edge_resource_t* choose_edge(capability_id_t capability_id)
 {
     edge_resource_t* candidates[NUM_EDGE_RESOURCES];
     uint16_t candidates_len = 0;
@@ -26,7 +26,7 @@ edge_resource_t* choose_edge(const char* capability_name)
             continue;
         }
 
-        edge_capability_t* capability = edge_info_capability_find(iter, capability_name);
+        edge_capability_t* capability = edge_info_capability_find(iter, capability_id);
         if (capability == NULL)
         {
             continue;
@@ -1,5 +1,7 @@
 #pragma once
 
+#include "capability-id.h"
+
 struct edge_resource;
 
-struct edge_resource* choose_edge(const char* capability_name);
+struct edge_resource* choose_edge(capability_id_t capability_id);
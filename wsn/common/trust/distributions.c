@@ -3,6 +3,9 @@
 #include <stdio.h>
 #include <math.h>
 #include "os/sys/log.h"
+#include "os/sys/clock.h"
+#include "normal-cdf-table.h"
+#include "float-helpers.h"
 /*-------------------------------------------------------------------------------------------------------------------*/
 #define LOG_MODULE "trust-dist"
 #ifdef TRUST_MODEL_LOG_LEVEL
@@ -20,20 +23,24 @@ void beta_dist_init(beta_dist_t* dist, uint32_t alpha, uint32_t beta)
     dist->beta = beta;
 }
 /*-------------------------------------------------------------------------------------------------------------------*/
-float beta_dist_expected(const beta_dist_t* dist)
+trust_real_t beta_dist_expected(const beta_dist_t* dist)
 {
-    const float a = dist->alpha;
-    const float b = dist->beta;
-
-    return a / (a + b);
+    return trust_real_ratio(dist->alpha, dist->alpha + dist->beta);
 }
 /*-------------------------------------------------------------------------------------------------------------------*/
-float beta_dist_variance(const beta_dist_t* dist)
+trust_real_t beta_dist_variance(const beta_dist_t* dist)
 {
+#ifdef TRUST_FIXED_POINT
+    const uint64_t a = dist->alpha;
+    const uint64_t b = dist->beta;
+
+    return q16_16_ratio64(a * b, ((a + b) * (a + b)) + (a + b + 1));
+#else
     const float a = dist->alpha;
     const float b = dist->beta;
 
     return (a * b) / (((a + b) * (a + b)) + (a + b + 1.0f));
+#endif
 }
 /*-------------------------------------------------------------------------------------------------------------------*/
 void beta_dist_add_good(beta_dist_t* dist)
@@ -67,6 +74,21 @@ void beta_dist_print(const beta_dist_t* dist)
 /*-------------------------------------------------------------------------------------------------------------------*/
 int beta_dist_serialise(nanocbor_encoder_t* enc, const beta_dist_t* dist)
 {
+#ifdef TRUST_DIST_COMPACT
+    beta_dist_compact_t compact;
+    beta_dist_compact(dist, &compact);
+
+    if (compact.scale != 0)
+    {
+        NANOCBOR_CHECK(nanocbor_fmt_array(enc, 3));
+        NANOCBOR_CHECK(nanocbor_fmt_uint(enc, compact.alpha));
+        NANOCBOR_CHECK(nanocbor_fmt_uint(enc, compact.beta));
+        NANOCBOR_CHECK(nanocbor_fmt_uint(enc, compact.scale));
+
+        return NANOCBOR_OK;
+    }
+#endif
+
     NANOCBOR_CHECK(nanocbor_fmt_array(enc, 2));
     NANOCBOR_CHECK(nanocbor_fmt_uint(enc, dist->alpha));
     NANOCBOR_CHECK(nanocbor_fmt_uint(enc, dist->beta));
@@ -74,6 +96,11 @@ int beta_dist_serialise(nanocbor_encoder_t* enc, const beta_dist_t* dist)
     return NANOCBOR_OK;
 }
 /*-------------------------------------------------------------------------------------------------------------------*/
+static uint32_t beta_dist_unscale(uint32_t count, uint32_t scale)
+{
+    return count > (UINT32_MAX >> scale) ? UINT32_MAX : (count << scale);
+}
+/*-------------------------------------------------------------------------------------------------------------------*/
 int beta_dist_deserialise(nanocbor_value_t* dec, beta_dist_t* dist)
 {
     nanocbor_value_t arr;
@@ -81,6 +108,22 @@ int beta_dist_deserialise(nanocbor_value_t* dec, beta_dist_t* dist)
     NANOCBOR_CHECK(nanocbor_get_uint32(&arr, &dist->alpha));
     NANOCBOR_CHECK(nanocbor_get_uint32(&arr, &dist->beta));
 
+    // A scale is only present for counts that were quantised, which is always accepted so that
+    // nodes built with and without TRUST_DIST_COMPACT can exchange trust
+    if (!nanocbor_at_end(&arr))
+    {
+        uint32_t scale;
+        NANOCBOR_CHECK(nanocbor_get_uint32(&arr, &scale));
+
+        if (scale >= 32)
+        {
+            return NANOCBOR_ERR_OVERFLOW;
+        }
+
+        dist->alpha = beta_dist_unscale(dist->alpha, scale);
+        dist->beta = beta_dist_unscale(dist->beta, scale);
+    }
+
     if (!nanocbor_at_end(&arr))
     {
         return NANOCBOR_ERR_END;
@@ -91,7 +134,219 @@ int beta_dist_deserialise(nanocbor_value_t* dec, beta_dist_t* dist)
     return NANOCBOR_OK;
 }
 /*-------------------------------------------------------------------------------------------------------------------*/
-void gaussian_dist_init(gaussian_dist_t* dist, float mean, float variance)
+static uint32_t beta_dist_scale(uint32_t count, uint8_t scale)
+{
+    // Round to nearest, in 64 bits as count may be close to UINT32_MAX
+    return scale == 0 ? count : (uint32_t)(((uint64_t)count + (UINT64_C(1) << (scale - 1))) >> scale);
+}
+/*-------------------------------------------------------------------------------------------------------------------*/
+void beta_dist_compact(const beta_dist_t* dist, beta_dist_compact_t* compact)
+{
+    const uint32_t max = dist->alpha > dist->beta ? dist->alpha : dist->beta;
+
+    uint8_t scale = 0;
+    while (beta_dist_scale(max, scale) > UINT16_MAX)
+    {
+        scale += 1;
+    }
+
+    compact->alpha = (uint16_t)beta_dist_scale(dist->alpha, scale);
+    compact->beta = (uint16_t)beta_dist_scale(dist->beta, scale);
+    compact->scale = scale;
+}
+/*-------------------------------------------------------------------------------------------------------------------*/
+trust_real_t beta_dist_compact_expected(const beta_dist_compact_t* compact)
+{
+    // The shared scale cancels out
+    return trust_real_ratio(compact->alpha, (uint32_t)compact->alpha + compact->beta);
+}
+/*-------------------------------------------------------------------------------------------------------------------*/
+void beta_dist_compact_print(const beta_dist_compact_t* compact)
+{
+    printf("Beta(alpha=%"PRIu16",beta=%"PRIu16",scale=%"PRIu8")", compact->alpha, compact->beta, compact->scale);
+}
+/*-------------------------------------------------------------------------------------------------------------------*/
+static uint32_t decayed_beta_dist_now(void)
+{
+    return (uint32_t)clock_seconds();
+}
+/*-------------------------------------------------------------------------------------------------------------------*/
+// 2^-(elapsed / BETA_DIST_DECAY_HALF_LIFE)
+static trust_real_t decayed_beta_dist_factor(uint32_t elapsed)
+{
+    if (elapsed == 0)
+    {
+        return TRUST_REAL(1);
+    }
+
+    // Below the resolution of Q16.16, and small enough to ignore for floats
+    if (elapsed >= 18u * BETA_DIST_DECAY_HALF_LIFE)
+    {
+        return TRUST_REAL(0);
+    }
+
+#ifdef TRUST_FIXED_POINT
+    const q16_16_t x = (q16_16_t)(((uint64_t)elapsed * Q16_16_CONST(0.6931471805599453)) / BETA_DIST_DECAY_HALF_LIFE);
+
+    return q16_16_exp_neg(x);
+#else
+    return exp2f(-(float)elapsed / BETA_DIST_DECAY_HALF_LIFE);
+#endif
+}
+/*-------------------------------------------------------------------------------------------------------------------*/
+// Evidence updated after now (e.g., restored from a snapshot taken at a later uptime) has not decayed
+static uint32_t decayed_beta_dist_elapsed(const decayed_beta_dist_t* dist, uint32_t now)
+{
+    return (int32_t)(now - dist->updated) > 0 ? now - dist->updated : 0;
+}
+/*-------------------------------------------------------------------------------------------------------------------*/
+static void decayed_beta_dist_decay(decayed_beta_dist_t* dist, uint32_t now)
+{
+    const trust_real_t factor = decayed_beta_dist_factor(decayed_beta_dist_elapsed(dist, now));
+
+    dist->good = trust_real_mul(dist->good, factor);
+    dist->bad = trust_real_mul(dist->bad, factor);
+    dist->updated = now;
+}
+/*-------------------------------------------------------------------------------------------------------------------*/
+static void decayed_beta_dist_add(decayed_beta_dist_t* dist, trust_real_t good, trust_real_t bad)
+{
+    decayed_beta_dist_decay(dist, decayed_beta_dist_now());
+
+    if (dist->good + dist->bad >= TRUST_REAL(BETA_DIST_DECAY_MAX_EVIDENCE - 1))
+    {
+        dist->good /= 2;
+        dist->bad /= 2;
+    }
+
+    dist->good += good;
+    dist->bad += bad;
+}
+/*-------------------------------------------------------------------------------------------------------------------*/
+void decayed_beta_dist_init(decayed_beta_dist_t* dist, uint32_t alpha, uint32_t beta)
+{
+    assert(alpha > 0);
+    assert(beta > 0);
+
+    dist->good = trust_real_from_uint(alpha - 1);
+    dist->bad = trust_real_from_uint(beta - 1);
+    dist->updated = decayed_beta_dist_now();
+}
+/*-------------------------------------------------------------------------------------------------------------------*/
+trust_real_t decayed_beta_dist_expected(const decayed_beta_dist_t* dist)
+{
+    // Decayed without modifying dist, the factor cancels out apart from in the prior
+    const trust_real_t factor = decayed_beta_dist_factor(decayed_beta_dist_elapsed(dist, decayed_beta_dist_now()));
+
+    const trust_real_t alpha = TRUST_REAL(1) + trust_real_mul(dist->good, factor);
+    const trust_real_t beta = TRUST_REAL(1) + trust_real_mul(dist->bad, factor);
+
+    return trust_real_div(alpha, alpha + beta);
+}
+/*-------------------------------------------------------------------------------------------------------------------*/
+void decayed_beta_dist_add_good(decayed_beta_dist_t* dist)
+{
+    decayed_beta_dist_add(dist, TRUST_REAL(1), TRUST_REAL(0));
+}
+/*-------------------------------------------------------------------------------------------------------------------*/
+void decayed_beta_dist_add_bad(decayed_beta_dist_t* dist)
+{
+    decayed_beta_dist_add(dist, TRUST_REAL(0), TRUST_REAL(1));
+}
+/*-------------------------------------------------------------------------------------------------------------------*/
+void decayed_beta_dist_combine(const decayed_beta_dist_t* a, const decayed_beta_dist_t* b, decayed_beta_dist_t* out)
+{
+    *out = *a;
+    decayed_beta_dist_decay(out, decayed_beta_dist_now());
+
+    if (b != NULL)
+    {
+        out->good += b->good;
+        out->bad += b->bad;
+    }
+}
+/*-------------------------------------------------------------------------------------------------------------------*/
+void decayed_beta_dist_rebase(decayed_beta_dist_t* dist, int32_t seconds_shift)
+{
+    // Wraps around in the same way as the clock
+    dist->updated += (uint32_t)seconds_shift;
+}
+/*-------------------------------------------------------------------------------------------------------------------*/
+void decayed_beta_dist_print(const decayed_beta_dist_t* dist)
+{
+    printf("DecayedBeta(alpha=%f,beta=%f,t=%"PRIu32")",
+        1.0f + trust_real_to_float(dist->good), 1.0f + trust_real_to_float(dist->bad), dist->updated);
+}
+/*-------------------------------------------------------------------------------------------------------------------*/
+static bool decayed_beta_dist_serialise_pinned;
+static uint32_t decayed_beta_dist_serialise_time;
+/*-------------------------------------------------------------------------------------------------------------------*/
+void decayed_beta_dist_serialise_as_of(uint32_t seconds)
+{
+    decayed_beta_dist_serialise_pinned = true;
+    decayed_beta_dist_serialise_time = seconds;
+}
+/*-------------------------------------------------------------------------------------------------------------------*/
+void decayed_beta_dist_serialise_now(void)
+{
+    decayed_beta_dist_serialise_pinned = false;
+}
+/*-------------------------------------------------------------------------------------------------------------------*/
+int decayed_beta_dist_serialise(nanocbor_encoder_t* enc, const decayed_beta_dist_t* dist)
+{
+    const uint32_t as_of = decayed_beta_dist_serialise_pinned ? decayed_beta_dist_serialise_time : decayed_beta_dist_now();
+
+    // Evidence added after the pinned time is included undecayed
+    decayed_beta_dist_t now = *dist;
+    if ((int32_t)(as_of - now.updated) > 0)
+    {
+        decayed_beta_dist_decay(&now, as_of);
+    }
+
+    NANOCBOR_CHECK(nanocbor_fmt_array(enc, 2));
+    NANOCBOR_CHECK(nanocbor_fmt_uint(enc, 1 + trust_real_scale_to_uint(now.good + TRUST_REAL(0.5), 1)));
+    NANOCBOR_CHECK(nanocbor_fmt_uint(enc, 1 + trust_real_scale_to_uint(now.bad + TRUST_REAL(0.5), 1)));
+
+    return NANOCBOR_OK;
+}
+/*-------------------------------------------------------------------------------------------------------------------*/
+int decayed_beta_dist_deserialise(nanocbor_value_t* dec, decayed_beta_dist_t* dist)
+{
+    uint32_t alpha, beta;
+
+    nanocbor_value_t arr;
+    NANOCBOR_CHECK(nanocbor_enter_array(dec, &arr));
+    NANOCBOR_CHECK(nanocbor_get_uint32(&arr, &alpha));
+    NANOCBOR_CHECK(nanocbor_get_uint32(&arr, &beta));
+
+    if (!nanocbor_at_end(&arr))
+    {
+        return NANOCBOR_ERR_END;
+    }
+
+    nanocbor_leave_container(dec, &arr);
+
+    if (alpha == 0 || beta == 0)
+    {
+        return NANOCBOR_ERR_INVALID_TYPE;
+    }
+
+    // A beta_dist_t may have accumulated more evidence than can be held
+    uint32_t good = alpha - 1, bad = beta - 1;
+    while ((uint64_t)good + bad >= BETA_DIST_DECAY_MAX_EVIDENCE)
+    {
+        good /= 2;
+        bad /= 2;
+    }
+
+    dist->good = trust_real_from_uint(good);
+    dist->bad = trust_real_from_uint(bad);
+    dist->updated = decayed_beta_dist_now();
+
+    return NANOCBOR_OK;
+}
+/*-------------------------------------------------------------------------------------------------------------------*/
+void gaussian_dist_init(gaussian_dist_t* dist, trust_wide_t mean, trust_wide_t variance)
 {
     dist->mean = mean;
     dist->variance = variance;
@@ -107,15 +362,57 @@ void gaussian_dist_init_empty(gaussian_dist_t* dist)
     dist->count = 0;
 }
 /*-------------------------------------------------------------------------------------------------------------------*/
-float gaussian_dist_cdf(const gaussian_dist_t* dist, float value)
+trust_real_t gaussian_dist_cdf(const gaussian_dist_t* dist, trust_wide_t value)
+{
+    // Phi(z) = 1 - Q(z) and Phi(-z) = Q(z), where Q(|z|) is interpolated from normal_cdf_table
+#ifdef TRUST_FIXED_POINT
+    const q16_16_t z = q48_16_div(value - dist->mean, q48_16_sqrt(dist->variance));
+    const uint32_t abs_z = z < 0 ? -(uint32_t)z : (uint32_t)z;
+
+    const unsigned frac_bits = Q16_16_FRAC_BITS - NORMAL_CDF_TABLE_STEPS_LOG2;
+    const uint32_t i = abs_z >> frac_bits;
+
+    q16_16_t tail = 0;
+    if (i < NORMAL_CDF_TABLE_LEN - 1)
+    {
+        // The table is decreasing, so the difference is never negative
+        const uint32_t frac = abs_z & ((1u << frac_bits) - 1);
+        const uint32_t diff = normal_cdf_table[i] - normal_cdf_table[i + 1];
+        tail = normal_cdf_table[i] - (q16_16_t)((diff * frac + (1u << (frac_bits - 1))) >> frac_bits);
+    }
+
+    return z < 0 ? tail : Q16_16_ONE - tail;
+#else
+    const float z = (value - dist->mean) / sqrtf(dist->variance);
+    const float pos = fabsf(z) * NORMAL_CDF_TABLE_STEPS;
+
+    // Also handles a NaN z (a zero variance and value at the mean) which gives 1
+    float tail = 0;
+    if (pos < NORMAL_CDF_TABLE_LEN - 1)
+    {
+        const uint32_t i = (uint32_t)pos;
+        const float frac = pos - i;
+        tail = (normal_cdf_table[i] + (normal_cdf_table[i + 1] - (float)normal_cdf_table[i]) * frac) / 65536.0f;
+    }
+
+    return z < 0 ? tail : 1.0f - tail;
+#endif
+}
+/*-------------------------------------------------------------------------------------------------------------------*/
+trust_real_t gaussian_dist_cdf_exact(const gaussian_dist_t* dist, trust_wide_t value)
 {
     // See: https://github.com/boostorg/math/blob/2b9927871fd86312f753e4bcbdb82236022c5856/include/boost/math/distributions/normal.hpp#L203
+#ifdef TRUST_FIXED_POINT
+    const q16_16_t diff = q48_16_div(value - dist->mean, q48_16_sqrt(dist->variance * 2));
+    return q16_16_erfc(-diff) / 2;
+#else
     const double diff = (value - dist->mean) / sqrt(dist->variance * 2.0);
     const double result = erfc(-diff) / 2.0;
     return (float)result;
+#endif
 }
 /*-------------------------------------------------------------------------------------------------------------------*/
-void gaussian_dist_update(gaussian_dist_t* dist, float value)
+void gaussian_dist_update(gaussian_dist_t* dist, trust_wide_t value)
 {
     // First item
     if (dist->count == 0)
@@ -128,11 +425,14 @@ void gaussian_dist_update(gaussian_dist_t* dist, float value)
     {
         const uint32_t new_count = dist->count + 1;
 
-        const float new_mean = dist->mean + (value - dist->mean) / new_count;
+        const trust_wide_t diff = value - dist->mean;
+
+        const trust_wide_t new_mean = dist->mean + diff / new_count;
 
         // https://math.stackexchange.com/questions/102978/incremental-computation-of-standard-deviation
-        const float new_variance = (dist->variance * ((new_count - 2.0f) / (new_count - 1.0f))) +
-                                   ((value - dist->mean) * (value - dist->mean)) / new_count;
+        // variance * ((new_count - 2) / (new_count - 1)) is rearranged so it cannot overflow in fixed-point
+        const trust_wide_t new_variance = (dist->variance - dist->variance / dist->count) +
+                                          trust_wide_mul(diff, diff) / new_count;
 
         dist->mean = new_mean;
         dist->variance = new_variance;
@@ -141,7 +441,7 @@ void gaussian_dist_update(gaussian_dist_t* dist, float value)
     }
 }
 /*-------------------------------------------------------------------------------------------------------------------*/
-void gaussian_dist_update_ewma(gaussian_dist_t* dist, float value, float alpha)
+void gaussian_dist_update_ewma(gaussian_dist_t* dist, trust_wide_t value, trust_real_t alpha)
 {
     // First item
     if (dist->count == 0)
@@ -154,10 +454,11 @@ void gaussian_dist_update_ewma(gaussian_dist_t* dist, float value, float alpha)
     {
         // https://fanf2.user.srcf.net/hermes/doc/antiforgery/stats.pdf
         // https://en.wikipedia.org/wiki/Moving_average#Exponentially_weighted_moving_variance_and_standard_deviation
-        const float diff = value - dist->mean;
-        const float incr = alpha * diff;
-        const float new_mean = dist->mean + incr;
-        const float new_variance = (1.0f - alpha) * (dist->variance + diff * incr);
+        const trust_wide_t diff = value - dist->mean;
+        const trust_wide_t incr = trust_wide_mul(trust_wide_from_real(alpha), diff);
+        const trust_wide_t new_mean = dist->mean + incr;
+        const trust_wide_t new_variance = trust_wide_mul(trust_wide_from_real(TRUST_REAL(1) - alpha),
+                                                         dist->variance + trust_wide_mul(diff, incr));
 
         dist->mean = new_mean;
         dist->variance = new_variance;
@@ -165,7 +466,7 @@ void gaussian_dist_update_ewma(gaussian_dist_t* dist, float value, float alpha)
     }
 }
 /*-------------------------------------------------------------------------------------------------------------------*/
-void throughput_dist_update(throughput_dist_t* dist, float value)
+void throughput_dist_update(throughput_dist_t* dist, trust_wide_t value)
 {
     // First item
     if (dist->count == 0)
@@ -184,25 +485,43 @@ void throughput_dist_update(throughput_dist_t* dist, float value)
 /*-------------------------------------------------------------------------------------------------------------------*/
 void gaussian_dist_print(const gaussian_dist_t* dist)
 {
-    printf("N(mean=%f,var=%f,n=%"PRIu32")", dist->mean, dist->variance, dist->count);
+    printf("N(mean=%f,var=%f,n=%"PRIu32")",
+        trust_wide_to_float(dist->mean), trust_wide_to_float(dist->variance), dist->count);
+}
+/*-------------------------------------------------------------------------------------------------------------------*/
+#ifdef TRUST_DIST_COMPACT
+static float gaussian_dist_compact_float(float f)
+{
+    // Values outside the normal range of a half would lose too much precision
+    return (fabsf(f) <= HALF_FLOAT_MAX && fabsf(f) >= HALF_FLOAT_MIN_NORMAL) ? float_round_half(f) : f;
 }
 /*-------------------------------------------------------------------------------------------------------------------*/
+#endif
 int gaussian_dist_serialise(nanocbor_encoder_t* enc, const gaussian_dist_t* dist)
 {
     NANOCBOR_CHECK(nanocbor_fmt_array(enc, 3));
-    NANOCBOR_CHECK(nanocbor_fmt_float(enc, dist->mean));
-    NANOCBOR_CHECK(nanocbor_fmt_float(enc, dist->variance));
+#ifdef TRUST_DIST_COMPACT
+    // NanoCBOR encodes a float as a half when that is lossless
+    NANOCBOR_CHECK(nanocbor_fmt_float(enc, gaussian_dist_compact_float(trust_wide_to_float(dist->mean))));
+    NANOCBOR_CHECK(nanocbor_fmt_float(enc, gaussian_dist_compact_float(trust_wide_to_float(dist->variance))));
+    NANOCBOR_CHECK(nanocbor_fmt_uint(enc, dist->count > UINT16_MAX ? UINT16_MAX : dist->count));
+#else
+    NANOCBOR_CHECK(nanocbor_fmt_float(enc, trust_wide_to_float(dist->mean)));
+    NANOCBOR_CHECK(nanocbor_fmt_float(enc, trust_wide_to_float(dist->variance)));
     NANOCBOR_CHECK(nanocbor_fmt_uint(enc, dist->count));
+#endif
 
     return NANOCBOR_OK;
 }
 /*-------------------------------------------------------------------------------------------------------------------*/
 int gaussian_dist_deserialise(nanocbor_value_t* dec, gaussian_dist_t* dist)
 {
+    float mean, variance;
+
     nanocbor_value_t arr;
     NANOCBOR_CHECK(nanocbor_enter_array(dec, &arr));
-    NANOCBOR_CHECK(nanocbor_get_float(&arr, &dist->mean));
-    NANOCBOR_CHECK(nanocbor_get_float(&arr, &dist->variance));
+    NANOCBOR_CHECK(nanocbor_get_float(&arr, &mean));
+    NANOCBOR_CHECK(nanocbor_get_float(&arr, &variance));
     NANOCBOR_CHECK(nanocbor_get_uint32(&arr, &dist->count));
 
     if (!nanocbor_at_end(&arr))
@@ -212,6 +531,9 @@ int gaussian_dist_deserialise(nanocbor_value_t* dec, gaussian_dist_t* dist)
 
     nanocbor_leave_container(dec, &arr);
 
+    dist->mean = trust_wide_from_float(mean);
+    dist->variance = trust_wide_from_float(variance);
+
     return NANOCBOR_OK;
 }
 /*-------------------------------------------------------------------------------------------------------------------*/
@@ -303,31 +625,32 @@ int poisson_observation_deserialise(nanocbor_value_t* dec, poisson_observation_t
     return NANOCBOR_OK;
 }
 /*-------------------------------------------------------------------------------------------------------------------*/
-void exponential_dist_init(exponential_dist_t* dist, float lambda)
+void exponential_dist_init(exponential_dist_t* dist, trust_wide_t mean)
 {
-    dist->lambda = lambda;
+    dist->mean = mean;
     dist->n = 1;
 }
 /*-------------------------------------------------------------------------------------------------------------------*/
-float exponential_dist_expected(const exponential_dist_t* dist)
+trust_wide_t exponential_dist_expected(const exponential_dist_t* dist)
 {
-    return 1.0f / dist->lambda;
+    return dist->mean;
 }
 /*-------------------------------------------------------------------------------------------------------------------*/
-float exponential_dist_variance(const exponential_dist_t* dist)
+trust_wide_t exponential_dist_variance(const exponential_dist_t* dist)
 {
-    return 1.0f / (dist->lambda * (float)dist->lambda);
+    return trust_wide_mul(dist->mean, dist->mean);
 }
 /*-------------------------------------------------------------------------------------------------------------------*/
 void exponential_dist_print(const exponential_dist_t* dist)
 {
-    printf("Exp(lambda=%f,n=%"PRIu32")", dist->lambda, dist->n);
+    printf("Exp(mean=%f,n=%"PRIu32")", trust_wide_to_float(dist->mean), dist->n);
 }
 /*-------------------------------------------------------------------------------------------------------------------*/
 int exponential_dist_serialise(nanocbor_encoder_t* enc, const exponential_dist_t* dist)
 {
     NANOCBOR_CHECK(nanocbor_fmt_array(enc, 2));
-    NANOCBOR_CHECK(nanocbor_fmt_float(enc, dist->lambda));
+    // The rate is sent for compatibility
+    NANOCBOR_CHECK(nanocbor_fmt_float(enc, 1.0f / trust_wide_to_float(dist->mean)));
     NANOCBOR_CHECK(nanocbor_fmt_uint(enc, dist->n));
 
     return NANOCBOR_OK;
@@ -335,9 +658,11 @@ int exponential_dist_serialise(nanocbor_encoder_t* enc, const exponential_dist_t
 /*-------------------------------------------------------------------------------------------------------------------*/
 int exponential_dist_deserialise(nanocbor_value_t* dec, exponential_dist_t* dist)
 {
+    float lambda;
+
     nanocbor_value_t arr;
     NANOCBOR_CHECK(nanocbor_enter_array(dec, &arr));
-    NANOCBOR_CHECK(nanocbor_get_float(&arr, &dist->lambda));
+    NANOCBOR_CHECK(nanocbor_get_float(&arr, &lambda));
     NANOCBOR_CHECK(nanocbor_get_uint32(&arr, &dist->n));
 
     if (!nanocbor_at_end(&arr))
@@ -347,23 +672,26 @@ int exponential_dist_deserialise(nanocbor_value_t* dec, exponential_dist_t* dist
 
     nanocbor_leave_container(dec, &arr);
 
+    dist->mean = trust_wide_from_float(1.0f / lambda);
+
     return NANOCBOR_OK;
 }
 /*-------------------------------------------------------------------------------------------------------------------*/
-float exponential_dist_cdf(const exponential_dist_t* dist, float value)
+trust_real_t exponential_dist_cdf(const exponential_dist_t* dist, trust_wide_t value)
 {
-    return 1.0f - exp(-dist->lambda * value);
+#ifdef TRUST_FIXED_POINT
+    return Q16_16_ONE - q16_16_exp_neg(q48_16_div(value, dist->mean));
+#else
+    return 1.0f - exp(-value / dist->mean);
+#endif
 }
 /*-------------------------------------------------------------------------------------------------------------------*/
-void exponential_dist_mle_update(exponential_dist_t* dist, float value)
+void exponential_dist_mle_update(exponential_dist_t* dist, trust_wide_t value)
 {
     // See: https://en.wikipedia.org/wiki/Exponential_distribution#Parameter_estimation
     // See: https://math.stackexchange.com/questions/106700/incremental-averaging
-    const float xbar = 1.0f / dist->lambda;
-
-    const float new_xbar = xbar + (value - xbar) / (dist->n + 1);
-
-    dist->lambda = 1.0f / new_xbar;
+    // The MLE of the mean is the sample mean, so it can be updated incrementally
+    dist->mean += (value - dist->mean) / (dist->n + 1);
     dist->n += 1;
 }
 /*-------------------------------------------------------------------------------------------------------------------*/
@@ -1,6 +1,7 @@
 #pragma once
 
 #include "nanocbor-helper.h"
+#include "trust-real.h"
 
 #include <stdint.h>
 
@@ -13,8 +14,8 @@ typedef struct beta_dist {
 void beta_dist_init(beta_dist_t* dist, uint32_t alpha, uint32_t beta);
 void beta_dist_print(const beta_dist_t* dist);
 /*-------------------------------------------------------------------------------------------------------------------*/
-float beta_dist_expected(const beta_dist_t* dist);
-float beta_dist_variance(const beta_dist_t* dist);
+trust_real_t beta_dist_expected(const beta_dist_t* dist);
+trust_real_t beta_dist_variance(const beta_dist_t* dist);
 /*-------------------------------------------------------------------------------------------------------------------*/
 void beta_dist_add_good(beta_dist_t* dist);
 void beta_dist_add_bad(beta_dist_t* dist);
@@ -24,12 +25,68 @@ void beta_dist_combine(const beta_dist_t* a, const beta_dist_t* b, beta_dist_t*
 int beta_dist_serialise(nanocbor_encoder_t* enc, const beta_dist_t* dist);
 int beta_dist_deserialise(nanocbor_value_t* dec, beta_dist_t* dist);
 /*-------------------------------------------------------------------------------------------------------------------*/
+// A beta_dist_t with 16-bit counts that share a scale exponent, the counts are alpha << scale and beta << scale.
+// Counts that need more than 16 bits are rounded, which changes the expected value by less than 2^-15.
+// With TRUST_DIST_COMPACT a beta_dist_t is serialised as [alpha, beta, scale] in this form when scale is not 0.
+typedef struct beta_dist_compact {
+    uint16_t alpha;
+    uint16_t beta;
+    uint8_t scale;
+} beta_dist_compact_t;
+/*-------------------------------------------------------------------------------------------------------------------*/
+void beta_dist_compact(const beta_dist_t* dist, beta_dist_compact_t* compact);
+void beta_dist_compact_print(const beta_dist_compact_t* compact);
+trust_real_t beta_dist_compact_expected(const beta_dist_compact_t* compact);
+/*-------------------------------------------------------------------------------------------------------------------*/
+
+/*-------------------------------------------------------------------------------------------------------------------*/
+// A beta distribution that forgets old evidence, which halves every BETA_DIST_DECAY_HALF_LIFE seconds.
+// Instead of a periodic sweep of every record, the decay is applied lazily when the distribution is read or
+// updated, from the time (clock_seconds) it was last updated. As with a beta_dist_t initialised to (1, 1),
+// the evidence is on top of a Beta(1, 1) prior, so with no recent evidence the expected value tends to 0.5.
+#ifndef BETA_DIST_DECAY_HALF_LIFE
+#define BETA_DIST_DECAY_HALF_LIFE (30 * 60)
+#endif
+
+// Keeps alpha + beta representable in fixed-point, the evidence is halved if it is reached
+#ifndef BETA_DIST_DECAY_MAX_EVIDENCE
+#define BETA_DIST_DECAY_MAX_EVIDENCE 16384
+#endif
+
+typedef struct decayed_beta_dist {
+    trust_real_t good;  // Decayed number of 'good' events
+    trust_real_t bad;   // Decayed number of 'bad' events
+    uint32_t updated;   // When good and bad were last decayed
+} decayed_beta_dist_t;
+/*-------------------------------------------------------------------------------------------------------------------*/
+void decayed_beta_dist_init(decayed_beta_dist_t* dist, uint32_t alpha, uint32_t beta);
+void decayed_beta_dist_print(const decayed_beta_dist_t* dist);
+/*-------------------------------------------------------------------------------------------------------------------*/
+trust_real_t decayed_beta_dist_expected(const decayed_beta_dist_t* dist);
+/*-------------------------------------------------------------------------------------------------------------------*/
+void decayed_beta_dist_add_good(decayed_beta_dist_t* dist);
+void decayed_beta_dist_add_bad(decayed_beta_dist_t* dist);
+/*-------------------------------------------------------------------------------------------------------------------*/
+// b is a prior (such as a stereotype) so is not decayed
+void decayed_beta_dist_combine(const decayed_beta_dist_t* a, const decayed_beta_dist_t* b, decayed_beta_dist_t* out);
+/*-------------------------------------------------------------------------------------------------------------------*/
+// Moves the time the distribution was last decayed by seconds_shift, for when it was restored after a reboot
+void decayed_beta_dist_rebase(decayed_beta_dist_t* dist, int32_t seconds_shift);
+/*-------------------------------------------------------------------------------------------------------------------*/
+// Serialised as the decayed alpha and beta rounded to integers, the same as a beta_dist_t
+int decayed_beta_dist_serialise(nanocbor_encoder_t* enc, const decayed_beta_dist_t* dist);
+int decayed_beta_dist_deserialise(nanocbor_value_t* dec, decayed_beta_dist_t* dist);
+// Serialisation decays to this time (in clock_seconds) instead of the current time until
+// decayed_beta_dist_serialise_now is called, so every block of a transfer is as of its manifest
+void decayed_beta_dist_serialise_as_of(uint32_t seconds);
+void decayed_beta_dist_serialise_now(void);
+/*-------------------------------------------------------------------------------------------------------------------*/
 
 /*-------------------------------------------------------------------------------------------------------------------*/
 // Used to record information about continuous events
 typedef struct gaussian_dist {
-    float mean;
-    float variance;
+    trust_wide_t mean;
+    trust_wide_t variance;
 
     // Need to keep a count of the number of values used to calculate the mean and variance.
     // This facilitates performing incremental updates without needing to store all previous values.
@@ -38,19 +95,24 @@ typedef struct gaussian_dist {
 
 // Used to record information about continuous events
 typedef struct throughput_dist {
-    float current;
+    trust_wide_t current;
     uint32_t count;
 } throughput_dist_t;
-void throughput_dist_update(throughput_dist_t* dist, float value);
+void throughput_dist_update(throughput_dist_t* dist, trust_wide_t value);
 /*-------------------------------------------------------------------------------------------------------------------*/
-void gaussian_dist_init(gaussian_dist_t* dist, float mean, float variance);
+void gaussian_dist_init(gaussian_dist_t* dist, trust_wide_t mean, trust_wide_t variance);
 void gaussian_dist_init_empty(gaussian_dist_t* dist);
 void gaussian_dist_print(const gaussian_dist_t* dist);
-float gaussian_dist_cdf(const gaussian_dist_t* dist, float value);
+// Interpolated from a lookup table (see tools/gen_normal_cdf_table.py) with an absolute error below 3e-5,
+// which is checked by `make cdf-bench` in wsn/host. The exact version evaluates erfc, which is slow without an FPU.
+trust_real_t gaussian_dist_cdf(const gaussian_dist_t* dist, trust_wide_t value);
+trust_real_t gaussian_dist_cdf_exact(const gaussian_dist_t* dist, trust_wide_t value);
 /*-------------------------------------------------------------------------------------------------------------------*/
-void gaussian_dist_update(gaussian_dist_t* dist, float value);
-void gaussian_dist_update_ewma(gaussian_dist_t* dist, float value, float weight);
+void gaussian_dist_update(gaussian_dist_t* dist, trust_wide_t value);
+void gaussian_dist_update_ewma(gaussian_dist_t* dist, trust_wide_t value, trust_real_t weight);
 /*-------------------------------------------------------------------------------------------------------------------*/
+// With TRUST_DIST_COMPACT the mean and variance are rounded to half-precision when they are in its range,
+// which has a relative error below 2^-11, and the count saturates at UINT16_MAX.
 int gaussian_dist_serialise(nanocbor_encoder_t* enc, const gaussian_dist_t* dist);
 int gaussian_dist_deserialise(nanocbor_value_t* dec, gaussian_dist_t* dist);
 /*-------------------------------------------------------------------------------------------------------------------*/
@@ -84,34 +146,69 @@ int poisson_observation_deserialise(nanocbor_value_t* dec, poisson_observation_t
 /*-------------------------------------------------------------------------------------------------------------------*/
 
 /*-------------------------------------------------------------------------------------------------------------------*/
+// Parameterised by the mean time between events (1/lambda), as the rate
+// is often too small to be represented in fixed-point
 typedef struct exponential_dist {
-    float lambda; // The time between events
+    trust_wide_t mean;
     uint32_t n;
 } exponential_dist_t;
 /*-------------------------------------------------------------------------------------------------------------------*/
-void exponential_dist_init(exponential_dist_t* dist, float lambda);
+void exponential_dist_init(exponential_dist_t* dist, trust_wide_t mean);
 void exponential_dist_init_empty(exponential_dist_t* dist);
 void exponential_dist_print(const exponential_dist_t* dist);
 /*-------------------------------------------------------------------------------------------------------------------*/
-float exponential_dist_expected(const exponential_dist_t* dist);
-float exponential_dist_variance(const exponential_dist_t* dist);
+trust_wide_t exponential_dist_expected(const exponential_dist_t* dist);
+trust_wide_t exponential_dist_variance(const exponential_dist_t* dist);
 /*-------------------------------------------------------------------------------------------------------------------*/
 int exponential_dist_serialise(nanocbor_encoder_t* enc, const exponential_dist_t* dist);
 int exponential_dist_deserialise(nanocbor_value_t* dec, exponential_dist_t* dist);
 /*-------------------------------------------------------------------------------------------------------------------*/
-float exponential_dist_cdf(const exponential_dist_t* dist, float value);
-void exponential_dist_mle_update(exponential_dist_t* dist, float value);
+trust_real_t exponential_dist_cdf(const exponential_dist_t* dist, trust_wide_t value);
+void exponential_dist_mle_update(exponential_dist_t* dist, trust_wide_t value);
 /*-------------------------------------------------------------------------------------------------------------------*/
 
+#define dist_init(x, ...) _Generic((x), \
+    beta_dist_t*:             beta_dist_init, \
+    decayed_beta_dist_t*:     decayed_beta_dist_init, \
+    gaussian_dist_t*:         gaussian_dist_init, \
+    poisson_dist_t*:          poisson_dist_init, \
+    exponential_dist_t*:      exponential_dist_init)(x, __VA_ARGS__)
+
 #define dist_print(x) _Generic((x), \
+    beta_dist_t*:                   beta_dist_print, \
     const beta_dist_t*:             beta_dist_print, \
+    decayed_beta_dist_t*:           decayed_beta_dist_print, \
+    const decayed_beta_dist_t*:     decayed_beta_dist_print, \
+    beta_dist_compact_t*:           beta_dist_compact_print, \
+    const beta_dist_compact_t*:     beta_dist_compact_print, \
     const gaussian_dist_t*:         gaussian_dist_print, \
     const poisson_dist_t*:          poisson_dist_print, \
     const poisson_observation_t*:   poisson_observation_print, \
     const exponential_dist_t*:      exponential_dist_print)(x)
 
+#define dist_expected(x) _Generic((x), \
+    beta_dist_t*:                   beta_dist_expected, \
+    const beta_dist_t*:             beta_dist_expected, \
+    decayed_beta_dist_t*:           decayed_beta_dist_expected, \
+    const decayed_beta_dist_t*:     decayed_beta_dist_expected, \
+    beta_dist_compact_t*:           beta_dist_compact_expected, \
+    const beta_dist_compact_t*:     beta_dist_compact_expected)(x)
+
+#define dist_add_good(x) _Generic((x), \
+    beta_dist_t*:             beta_dist_add_good, \
+    decayed_beta_dist_t*:     decayed_beta_dist_add_good)(x)
+
+#define dist_add_bad(x) _Generic((x), \
+    beta_dist_t*:             beta_dist_add_bad, \
+    decayed_beta_dist_t*:     decayed_beta_dist_add_bad)(x)
+
+#define dist_combine(a, b, out) _Generic((out), \
+    beta_dist_t*:             beta_dist_combine, \
+    decayed_beta_dist_t*:     decayed_beta_dist_combine)(a, b, out)
+
 #define dist_serialise(enc, x) _Generic((x), \
     const beta_dist_t*:             beta_dist_serialise, \
+    const decayed_beta_dist_t*:     decayed_beta_dist_serialise, \
     const gaussian_dist_t*:         gaussian_dist_serialise, \
     const poisson_dist_t*:          poisson_dist_serialise, \
     const poisson_observation_t*:   poisson_observation_serialise, \
@@ -119,6 +216,7 @@ void exponential_dist_mle_update(exponential_dist_t* dist, float value);
 
 #define dist_deserialise(dec, x) _Generic((x), \
     beta_dist_t*:             beta_dist_deserialise, \
+    decayed_beta_dist_t*:     decayed_beta_dist_deserialise, \
     gaussian_dist_t*:         gaussian_dist_deserialise, \
     poisson_dist_t*:          poisson_dist_deserialise, \
     poisson_observation_t*:   poisson_observation_deserialise, \
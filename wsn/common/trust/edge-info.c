@@ -1,11 +1,15 @@
 #include "edge-info.h"
 #include "capability-info.h"
+#include "peer-info.h"
+#include "trust-models.h"
 #include "eui64.h"
 
 #include "lib/memb.h"
 #include "os/sys/log.h"
 
 #include "coap-constants.h"
+
+#include <inttypes.h>
 /*-------------------------------------------------------------------------------------------------------------------*/
 #define LOG_MODULE "trust-edge"
 #ifdef TRUST_MODEL_LOG_LEVEL
@@ -19,23 +23,178 @@ MEMB(edge_capabilities_memb, edge_capability_t, NUM_EDGE_RESOURCES * NUM_EDGE_CA
 /*-------------------------------------------------------------------------------------------------------------------*/
 LIST(edge_resources);
 /*-------------------------------------------------------------------------------------------------------------------*/
+static uint16_t generation;
+/*-------------------------------------------------------------------------------------------------------------------*/
+#if EDGE_INFO_EVICTION == EDGE_INFO_EVICTION_LOWEST_TRUST && defined(TRUST_MODEL_NO_TRUST_VALUE)
+#error "EDGE_INFO_EVICTION_LOWEST_TRUST requires a trust model that provides trust values"
+#endif
+
+_Static_assert(EDGE_INFO_EVICTION_HISTORY > 0 && EDGE_INFO_EVICTION_HISTORY <= UINT8_MAX, "Invalid eviction history size");
+/*-------------------------------------------------------------------------------------------------------------------*/
+static edge_info_eviction_stats_t eviction_stats;
+
+// Keys of recently evicted records, oldest first
+static uint16_t evicted_keys[EDGE_INFO_EVICTION_HISTORY];
+static uint8_t evicted_keys_count;
+/*-------------------------------------------------------------------------------------------------------------------*/
+_Static_assert(EDGE_INFO_INDEX_SIZE > NUM_EDGE_RESOURCES, "Edge index must have more slots than edge resources");
+_Static_assert(EDGE_INFO_INDEX_SIZE <= UINT16_MAX, "Edge index too large");
+/*-------------------------------------------------------------------------------------------------------------------*/
+// Index of edge_resources keyed by the EUI-64 of their address
+static void
+edge_index_key(const void* item, uint8_t* eui64)
+{
+    eui64_from_ipaddr(&((const edge_resource_t*)item)->ep.ipaddr, eui64);
+}
+
+static bool
+edge_index_match(const void* item, const void* addr)
+{
+    return uip_ip6addr_cmp(&((const edge_resource_t*)item)->ep.ipaddr, (const uip_ipaddr_t*)addr);
+}
+
+static void* edge_index_slots[EDGE_INFO_INDEX_SIZE];
+static eui64_index_t edge_index = { edge_index_slots, EDGE_INFO_INDEX_SIZE, edge_index_key };
+/*-------------------------------------------------------------------------------------------------------------------*/
+// Keys identifying an edge or capability record in the eviction history
+static uint16_t
+eviction_key(const edge_resource_t* edge, const edge_capability_t* capability)
+{
+    uint8_t eui64[EUI64_LENGTH];
+    eui64_from_ipaddr(&edge->ep.ipaddr, eui64);
+
+    uint32_t hash = eui64_hash(eui64);
+    if (capability != NULL)
+    {
+        hash = (hash ^ (capability->id + 1u)) * 16777619u;
+    }
+
+    return (uint16_t)(hash ^ (hash >> 16));
+}
+/*-------------------------------------------------------------------------------------------------------------------*/
+static void
+eviction_history_remove(uint8_t i)
+{
+    memmove(&evicted_keys[i], &evicted_keys[i + 1], (evicted_keys_count - i - 1) * sizeof(*evicted_keys));
+    evicted_keys_count -= 1;
+}
+/*-------------------------------------------------------------------------------------------------------------------*/
+static void
+eviction_history_push(uint16_t key)
+{
+    // Forget the oldest key when full
+    if (evicted_keys_count == EDGE_INFO_EVICTION_HISTORY)
+    {
+        eviction_history_remove(0);
+    }
+
+    evicted_keys[evicted_keys_count++] = key;
+}
+/*-------------------------------------------------------------------------------------------------------------------*/
+// Returns true and forgets the key if it was recently evicted
+static bool
+eviction_history_take(uint16_t key)
+{
+    for (uint8_t i = 0; i != evicted_keys_count; ++i)
+    {
+        if (evicted_keys[i] == key)
+        {
+            eviction_history_remove(i);
+            return true;
+        }
+    }
+
+    return false;
+}
+/*-------------------------------------------------------------------------------------------------------------------*/
+#if EDGE_INFO_EVICTION == EDGE_INFO_EVICTION_LOWEST_TRUST
+static trust_real_t
+edge_eviction_trust(edge_resource_t* edge)
+{
+    // An edge is only as valuable as its most trusted capability
+    trust_real_t trust = TRUST_REAL(0);
+
+    for (edge_capability_t* cap = list_head(edge->capabilities); cap != NULL; cap = list_item_next(cap))
+    {
+        trust = MAX(trust, trust_value_cached(edge, cap));
+    }
+
+    return trust;
+}
+#endif
+/*-------------------------------------------------------------------------------------------------------------------*/
+// Candidates with the highest priority are evicted first, ties go to the earliest candidate
+static uint32_t
+eviction_priority(edge_resource_t* edge, edge_capability_t* capability)
+{
+#if EDGE_INFO_EVICTION == EDGE_INFO_EVICTION_FIRST
+    return 0;
+
+#elif EDGE_INFO_EVICTION == EDGE_INFO_EVICTION_LRU
+    const clock_time_t last_used = capability != NULL ? capability->last_used : edge->last_used;
+
+    return (uint32_t)(clock_time() - last_used);
+
+#elif EDGE_INFO_EVICTION == EDGE_INFO_EVICTION_LEAST_INFORMATION
+    const uint16_t information = capability != NULL ? capability->information : edge->information;
+
+    return UINT16_MAX - information;
+
+#elif EDGE_INFO_EVICTION == EDGE_INFO_EVICTION_LOWEST_TRUST
+    const trust_real_t trust = capability != NULL ? trust_value_cached(edge, capability) : edge_eviction_trust(edge);
+
+    return trust_real_scale_to_uint(TRUST_REAL(1) - trust, UINT16_MAX);
+
+#else
+#   error "Unknown EDGE_INFO_EVICTION"
+#endif
+}
+/*-------------------------------------------------------------------------------------------------------------------*/
 static bool
 free_up_edge_capabilities(void)
 {
-    // TODO: might need to address bias in which inactive edge capability is selected for removal
+    edge_resource_t* victim_edge = NULL;
+    edge_capability_t* victim = NULL;
+    uint32_t victim_priority = 0;
 
     for (edge_resource_t* eiter = list_head(edge_resources); eiter != NULL; eiter = list_item_next(eiter))
     {
         for (edge_capability_t* citer = list_head(eiter->capabilities); citer != NULL; citer = list_item_next(citer))
         {
-            if (!edge_capability_is_active(citer))
+            if (edge_capability_is_active(citer))
             {
-                return edge_info_capability_remove(eiter, citer);
+                continue;
+            }
+
+            const uint32_t priority = eviction_priority(eiter, citer);
+
+            if (victim == NULL || priority > victim_priority)
+            {
+                victim_edge = eiter;
+                victim = citer;
+                victim_priority = priority;
             }
         }
     }
 
-    return false;
+    if (victim == NULL)
+    {
+        return false;
+    }
+
+    LOG_DBG("Evicting capability %s from edge %s\n", capability_id_name(victim->id), edge_info_name(victim_edge));
+
+    const uint16_t key = eviction_key(victim_edge, victim);
+
+    if (!edge_info_capability_remove(victim_edge, victim))
+    {
+        return false;
+    }
+
+    eviction_history_push(key);
+    eviction_stats.capability_evictions += 1;
+
+    return true;
 }
 /*-------------------------------------------------------------------------------------------------------------------*/
 static edge_capability_t*
@@ -75,17 +234,43 @@ edge_capability_free(edge_capability_t* capability)
 static bool
 free_up_edge_resource(void)
 {
-    // TODO: might need to address bias in which inactive edge is selected for removal
+    edge_resource_t* victim = NULL;
+    uint32_t victim_priority = 0;
 
     for (edge_resource_t* eiter = list_head(edge_resources); eiter != NULL; eiter = list_item_next(eiter))
     {
-        if (!edge_info_is_active(eiter))
+        if (edge_info_is_active(eiter))
         {
-            return edge_info_remove(eiter);
+            continue;
+        }
+
+        const uint32_t priority = eviction_priority(eiter, NULL);
+
+        if (victim == NULL || priority > victim_priority)
+        {
+            victim = eiter;
+            victim_priority = priority;
         }
     }
 
-    return false;
+    if (victim == NULL)
+    {
+        return false;
+    }
+
+    LOG_DBG("Evicting edge %s\n", edge_info_name(victim));
+
+    const uint16_t key = eviction_key(victim, NULL);
+
+    if (!edge_info_remove(victim))
+    {
+        return false;
+    }
+
+    eviction_history_push(key);
+    eviction_stats.edge_evictions += 1;
+
+    return true;
 }
 /*-------------------------------------------------------------------------------------------------------------------*/
 static edge_resource_t*
@@ -128,9 +313,15 @@ edge_info_init(void)
 {
     LOG_DBG("Initialising edge info\n");
 
+    capability_id_init();
+
     memb_init(&edge_resources_memb);
     memb_init(&edge_capabilities_memb);
     list_init(edge_resources);
+    eui64_index_clear(&edge_index);
+
+    memset(&eviction_stats, 0, sizeof(eviction_stats));
+    evicted_keys_count = 0;
 }
 /*-------------------------------------------------------------------------------------------------------------------*/
 edge_resource_t*
@@ -155,9 +346,32 @@ edge_info_add(const uip_ipaddr_t* addr)
     edge->ep.secure = 0;
     edge->ep.port = UIP_HTONS(COAP_DEFAULT_PORT);
 
-    list_push(edge_resources, edge);
+    // Keep in canonical order
+    edge_resource_t* prev = NULL;
+    for (edge_resource_t* iter = list_head(edge_resources); iter != NULL && edge_info_compare(iter, edge) < 0; iter = list_item_next(iter))
+    {
+        prev = iter;
+    }
 
-    edge->flags = EDGE_RESOURCE_NO_FLAGS;
+    list_insert(edge_resources, prev, edge);
+    eui64_index_insert(&edge_index, edge);
+
+    // New records need to be disseminated
+    edge->flags = EDGE_RESOURCE_TRUST_CHANGED;
+    edge->tm_version = 0;
+
+#if EDGE_INFO_EVICTION == EDGE_INFO_EVICTION_LRU
+    edge->last_used = clock_time();
+#elif EDGE_INFO_EVICTION == EDGE_INFO_EVICTION_LEAST_INFORMATION
+    edge->information = 0;
+#endif
+
+    if (eviction_history_take(eviction_key(edge, NULL)))
+    {
+        eviction_stats.edge_readds += 1;
+    }
+
+    generation += 1;
 
     return edge;
 }
@@ -169,7 +383,17 @@ edge_info_remove(edge_resource_t* edge)
 
     if (removed)
     {
+        if (!eui64_index_remove(&edge_index, edge))
+        {
+            LOG_ERR("Edge %s missing from index\n", edge_info_name(edge));
+        }
+
+        // Peers' records point at this edge and its capabilities, whose slots may be reused
+        peer_info_remove_edges(edge);
+
         edge_resource_free(edge);
+
+        generation += 1;
     }
 
     return removed;
@@ -190,15 +414,10 @@ edge_info_next(edge_resource_t* iter)
 edge_resource_t*
 edge_info_find_addr(const uip_ipaddr_t* addr)
 {
-    for (edge_resource_t* iter = list_head(edge_resources); iter != NULL; iter = list_item_next(iter))
-    {
-        if (uip_ip6addr_cmp(&iter->ep.ipaddr, addr))
-        {
-            return iter;
-        }
-    }
+    uint8_t eui64[EUI64_LENGTH];
+    eui64_from_ipaddr(addr, eui64);
 
-    return NULL;
+    return eui64_index_find(&edge_index, eui64, edge_index_match, addr);
 }
 /*-------------------------------------------------------------------------------------------------------------------*/
 edge_resource_t*
@@ -215,17 +434,115 @@ size_t edge_info_count(void)
     return list_length(edge_resources);
 }
 /*-------------------------------------------------------------------------------------------------------------------*/
+int edge_info_compare(const edge_resource_t* a, const edge_resource_t* b)
+{
+    return memcmp(&a->ep.ipaddr, &b->ep.ipaddr, sizeof(a->ep.ipaddr));
+}
+/*-------------------------------------------------------------------------------------------------------------------*/
 bool edge_info_is_active(const edge_resource_t* edge)
 {
     return (edge->flags & EDGE_RESOURCE_ACTIVE) != 0;
 }
 /*-------------------------------------------------------------------------------------------------------------------*/
+void edge_info_tm_changed(edge_resource_t* edge)
+{
+    edge->tm_version += 1;
+    edge->flags |= EDGE_RESOURCE_TRUST_CHANGED;
+
+#if EDGE_INFO_EVICTION == EDGE_INFO_EVICTION_LEAST_INFORMATION
+    if (edge->information != UINT16_MAX)
+    {
+        edge->information += 1;
+    }
+#endif
+
+    generation += 1;
+}
+/*-------------------------------------------------------------------------------------------------------------------*/
+void edge_info_capability_tm_changed(edge_capability_t* capability)
+{
+    capability->tm_version += 1;
+    capability->flags |= EDGE_CAPABILITY_TRUST_CHANGED;
+
+#if EDGE_INFO_EVICTION == EDGE_INFO_EVICTION_LEAST_INFORMATION
+    if (capability->information != UINT16_MAX)
+    {
+        capability->information += 1;
+    }
+#endif
+
+    generation += 1;
+}
+/*-------------------------------------------------------------------------------------------------------------------*/
+bool edge_info_tm_has_changes(const edge_resource_t* edge)
+{
+    if (edge->flags & EDGE_RESOURCE_TRUST_CHANGED)
+    {
+        return true;
+    }
+
+    for (const edge_capability_t* cap = list_head(edge->capabilities); cap != NULL; cap = list_item_next(cap))
+    {
+        if (cap->flags & EDGE_CAPABILITY_TRUST_CHANGED)
+        {
+            return true;
+        }
+    }
+
+    return false;
+}
+/*-------------------------------------------------------------------------------------------------------------------*/
+uint16_t edge_info_generation(void)
+{
+    return generation;
+}
+/*-------------------------------------------------------------------------------------------------------------------*/
+void edge_info_used(edge_resource_t* edge, edge_capability_t* capability)
+{
+#if EDGE_INFO_EVICTION == EDGE_INFO_EVICTION_LRU
+    const clock_time_t now = clock_time();
+
+    edge->last_used = now;
+
+    if (capability != NULL)
+    {
+        capability->last_used = now;
+    }
+#endif
+}
+/*-------------------------------------------------------------------------------------------------------------------*/
+const edge_info_eviction_stats_t* edge_info_eviction_stats(void)
+{
+    return &eviction_stats;
+}
+/*-------------------------------------------------------------------------------------------------------------------*/
+void edge_info_eviction_stats_print(void)
+{
+    LOG_INFO("Eviction: edges evicted=%" PRIu32 " re-added=%" PRIu32 ", "
+             "capabilities evicted=%" PRIu32 " re-added=%" PRIu32 "\n",
+        eviction_stats.edge_evictions, eviction_stats.edge_readds,
+        eviction_stats.capability_evictions, eviction_stats.capability_readds);
+}
+/*-------------------------------------------------------------------------------------------------------------------*/
+void edge_info_tm_clear_changes(void)
+{
+    for (edge_resource_t* edge = list_head(edge_resources); edge != NULL; edge = list_item_next(edge))
+    {
+        edge->flags &= ~EDGE_RESOURCE_TRUST_CHANGED;
+
+        for (edge_capability_t* cap = list_head(edge->capabilities); cap != NULL; cap = list_item_next(cap))
+        {
+            cap->flags &= ~EDGE_CAPABILITY_TRUST_CHANGED;
+        }
+    }
+}
+/*-------------------------------------------------------------------------------------------------------------------*/
 edge_capability_t*
-edge_info_capability_add(edge_resource_t* edge, const char* name)
+edge_info_capability_add(edge_resource_t* edge, capability_id_t id)
 {
     edge_capability_t* capability;
 
-    capability = edge_info_capability_find(edge, name);
+    capability = edge_info_capability_find(edge, id);
     if (capability != NULL)
     {
         return capability;
@@ -238,17 +555,42 @@ edge_info_capability_add(edge_resource_t* edge, const char* name)
     }
 
     // Also need to create independent capability info
-    capability_t* cap = capability_info_add(name);
+    capability_t* cap = capability_info_add(id);
     if (cap == NULL)
     {
-        LOG_ERR("Failed to allocate memory for capability info %s\n", name);
+        LOG_ERR("Failed to allocate memory for capability info %s\n", capability_id_name(id));
     }
 
-    strncpy(capability->name, name, EDGE_CAPABILITY_NAME_LEN);
+    capability->id = id;
 
-    capability->flags = EDGE_CAPABILITY_NO_FLAGS;
+    // New records need to be disseminated
+    capability->flags = EDGE_CAPABILITY_TRUST_CHANGED;
+    capability->tm_version = 0;
+
+#if EDGE_INFO_EVICTION == EDGE_INFO_EVICTION_LRU
+    capability->last_used = clock_time();
+#elif EDGE_INFO_EVICTION == EDGE_INFO_EVICTION_LEAST_INFORMATION
+    capability->information = 0;
+#endif
+
+    if (eviction_history_take(eviction_key(edge, capability)))
+    {
+        eviction_stats.capability_readds += 1;
+    }
 
-    list_push(edge->capabilities, capability);
+    generation += 1;
+
+    // Keep in canonical order
+    edge_capability_t* prev = NULL;
+    for (edge_capability_t* iter = list_head(edge->capabilities); iter != NULL && capability_id_compare(iter->id, id) < 0; iter = list_item_next(iter))
+    {
+        prev = iter;
+    }
+
+    list_insert(edge->capabilities, prev, capability);
+
+    // Trust in other capabilities can depend on this one (e.g., challenge-response)
+    trust_cache_invalidate_edge(edge);
 
     return capability;
 }
@@ -260,26 +602,34 @@ bool edge_info_capability_remove(edge_resource_t* edge, edge_capability_t* capab
     if (removed)
     {
         // Remove capability info, if none left
-        if (!edge_info_has_active_capability(capability->name))
+        if (!edge_info_has_active_capability(capability->id))
         {
-            capability_t* cap = capability_info_find(capability->name);
+            capability_t* cap = capability_info_find(capability->id);
             if (cap != NULL)
             {
                 capability_info_remove(cap);
             }
         }
 
+        // Peers' records point at this capability, whose slot may be reused
+        peer_info_remove_capabilities(capability);
+
         edge_capability_free(capability);
+
+        generation += 1;
+
+        // Trust in other capabilities can depend on this one (e.g., challenge-response)
+        trust_cache_invalidate_edge(edge);
     }
 
     return removed;
 }
 /*-------------------------------------------------------------------------------------------------------------------*/
-bool edge_info_capability_remove_by_name(edge_resource_t* edge, const char* name)
+bool edge_info_capability_remove_by_id(edge_resource_t* edge, capability_id_t id)
 {
     edge_capability_t* capability;
 
-    capability = edge_info_capability_find(edge, name);
+    capability = edge_info_capability_find(edge, id);
     if (capability == NULL)
     {
         return false;
@@ -303,7 +653,7 @@ void edge_info_capability_clear(edge_resource_t* edge)
 }
 /*-------------------------------------------------------------------------------------------------------------------*/
 edge_capability_t*
-edge_info_capability_find(edge_resource_t* edge, const char* name)
+edge_info_capability_find(edge_resource_t* edge, capability_id_t id)
 {
     if (edge == NULL)
     {
@@ -312,7 +662,7 @@ edge_info_capability_find(edge_resource_t* edge, const char* name)
 
     for (edge_capability_t* iter = list_head(edge->capabilities); iter != NULL; iter = list_item_next(iter))
     {
-        if (strcmp(iter->name, name) == 0)
+        if (iter->id == id)
         {
             return iter;
         }
@@ -321,6 +671,26 @@ edge_info_capability_find(edge_resource_t* edge, const char* name)
     return NULL;
 }
 /*-------------------------------------------------------------------------------------------------------------------*/
+edge_capability_t*
+edge_info_capability_find_next(edge_resource_t* edge, edge_capability_t** iter, capability_id_t id)
+{
+    edge_capability_t* cap = *iter;
+
+    while (cap != NULL && capability_id_compare(cap->id, id) < 0)
+    {
+        cap = list_item_next(cap);
+    }
+
+    if (cap != NULL && cap->id == id)
+    {
+        *iter = list_item_next(cap);
+        return cap;
+    }
+
+    // Not ahead of the cursor, so either absent or looked up out of order
+    return edge_info_capability_find(edge, id);
+}
+/*-------------------------------------------------------------------------------------------------------------------*/
 static char edge_info_name_buffer[EUI64_LENGTH*2 + 1];
 /*-------------------------------------------------------------------------------------------------------------------*/
 const char* edge_info_name(const edge_resource_t* edge)
@@ -338,7 +708,7 @@ bool edge_capability_is_active(const edge_capability_t* capability)
     return (capability->flags & EDGE_CAPABILITY_ACTIVE) != 0;
 }
 /*-------------------------------------------------------------------------------------------------------------------*/
-bool edge_info_has_active_capability(const char* name)
+bool edge_info_has_active_capability(capability_id_t id)
 {
     for (edge_resource_t* iter = list_head(edge_resources); iter != NULL; iter = list_item_next(iter))
     {
@@ -348,7 +718,7 @@ bool edge_info_has_active_capability(const char* name)
             continue;
         }
 
-        edge_capability_t* capability = edge_info_capability_find(iter, name);
+        edge_capability_t* capability = edge_info_capability_find(iter, id);
         if (capability != NULL && edge_capability_is_active(capability))
         {
             return true;
@@ -8,6 +8,7 @@
 
 #include "trust-common.h"
 #include "trust-model.h"
+#include "capability-id.h"
 #include "stereotype-tags.h"
 
 #include "coap-endpoint.h"
@@ -21,23 +22,65 @@
 #define NUM_EDGE_CAPABILITIES 3
 #endif
 /*-------------------------------------------------------------------------------------------------------------------*/
+// Number of slots in the EUI-64 keyed open-addressing index used by edge_info_find_*.
+// Keep this at least twice NUM_EDGE_RESOURCES so probe sequences stay short.
+#ifndef EDGE_INFO_INDEX_SIZE
+#define EDGE_INFO_INDEX_SIZE (NUM_EDGE_RESOURCES * 2)
+#endif
+/*-------------------------------------------------------------------------------------------------------------------*/
+// Policy used to pick which inactive edge or capability record is evicted when the pools are full
+#define EDGE_INFO_EVICTION_FIRST 0
+#define EDGE_INFO_EVICTION_LRU 1
+#define EDGE_INFO_EVICTION_LEAST_INFORMATION 2
+#define EDGE_INFO_EVICTION_LOWEST_TRUST 3
+
+#ifndef EDGE_INFO_EVICTION
+#define EDGE_INFO_EVICTION EDGE_INFO_EVICTION_FIRST
+#endif
+/*-------------------------------------------------------------------------------------------------------------------*/
+// Number of recently evicted records remembered, so that re-adds can be counted
+#ifndef EDGE_INFO_EVICTION_HISTORY
+#define EDGE_INFO_EVICTION_HISTORY 8
+#endif
+/*-------------------------------------------------------------------------------------------------------------------*/
 #define EDGE_CAPABILITY_NO_FLAGS 0
 #define EDGE_CAPABILITY_ACTIVE (1 << 0)
+#define EDGE_CAPABILITY_TRUST_CACHED (1 << 1)
+#define EDGE_CAPABILITY_TRUST_CHANGED (1 << 2)
 /*-------------------------------------------------------------------------------------------------------------------*/
 typedef struct edge_capability
 {
     struct edge_capability *next;
 
-    char name[EDGE_CAPABILITY_NAME_LEN + 1];
+    capability_id_t id;
 
     uint32_t flags;
 
+    // Incremented each time tm changes, EDGE_CAPABILITY_TRUST_CHANGED is set
+    // until the change has been included in a trust broadcast
+    uint8_t tm_version;
+
+    // Time of the last interaction or number of times tm has changed, kept for the eviction policy that uses it
+#if EDGE_INFO_EVICTION == EDGE_INFO_EVICTION_LRU
+    clock_time_t last_used;
+#elif EDGE_INFO_EVICTION == EDGE_INFO_EVICTION_LEAST_INFORMATION
+    uint16_t information;
+#endif
+
+#ifndef TRUST_MODEL_NO_TRUST_VALUE
+    // Last result of calculate_trust_value, valid when EDGE_CAPABILITY_TRUST_CACHED
+    // is set and trust_epoch matches the current trust cache epoch
+    uint16_t trust_epoch;
+    trust_real_t trust;
+#endif
+
     edge_capability_tm_t tm;
 
 } edge_capability_t;
 /*-------------------------------------------------------------------------------------------------------------------*/
 #define EDGE_RESOURCE_NO_FLAGS 0
 #define EDGE_RESOURCE_ACTIVE (1 << 0)
+#define EDGE_RESOURCE_TRUST_CHANGED (1 << 1)
 /*-------------------------------------------------------------------------------------------------------------------*/
 typedef struct edge_resource
 {
@@ -47,6 +90,17 @@ typedef struct edge_resource
 
     uint32_t flags;
 
+    // Incremented each time tm changes, EDGE_RESOURCE_TRUST_CHANGED is set
+    // until the change has been included in a trust broadcast
+    uint8_t tm_version;
+
+    // Time of the last interaction or number of times tm has changed, kept for the eviction policy that uses it
+#if EDGE_INFO_EVICTION == EDGE_INFO_EVICTION_LRU
+    clock_time_t last_used;
+#elif EDGE_INFO_EVICTION == EDGE_INFO_EVICTION_LEAST_INFORMATION
+    uint16_t information;
+#endif
+
     edge_resource_tm_t tm;
 
     LIST_STRUCT(capabilities);
@@ -66,15 +120,41 @@ edge_resource_t* edge_info_next(edge_resource_t* iter);
 /*-------------------------------------------------------------------------------------------------------------------*/
 size_t edge_info_count(void);
 /*-------------------------------------------------------------------------------------------------------------------*/
+// Canonical order of edges (by address). Edges are iterated, and an edge's capabilities
+// are listed (by capability_id_compare), in canonical order.
+int edge_info_compare(const edge_resource_t* a, const edge_resource_t* b);
+/*-------------------------------------------------------------------------------------------------------------------*/
 bool edge_info_is_active(const edge_resource_t* edge);
 /*-------------------------------------------------------------------------------------------------------------------*/
+void edge_info_tm_changed(edge_resource_t* edge);
+void edge_info_capability_tm_changed(edge_capability_t* capability);
+bool edge_info_tm_has_changes(const edge_resource_t* edge);
+void edge_info_tm_clear_changes(void);
+// Changes whenever any edge or capability record is added, removed or has its tm changed
+uint16_t edge_info_generation(void);
+/*-------------------------------------------------------------------------------------------------------------------*/
+// Records an interaction with the edge (and capability, if not NULL) for LRU eviction
+void edge_info_used(edge_resource_t* edge, edge_capability_t* capability);
+/*-------------------------------------------------------------------------------------------------------------------*/
+typedef struct {
+    uint32_t edge_evictions;
+    uint32_t edge_readds;
+    uint32_t capability_evictions;
+    uint32_t capability_readds;
+} edge_info_eviction_stats_t;
+/*-------------------------------------------------------------------------------------------------------------------*/
+const edge_info_eviction_stats_t* edge_info_eviction_stats(void);
+void edge_info_eviction_stats_print(void);
 /*-------------------------------------------------------------------------------------------------------------------*/
-edge_capability_t* edge_info_capability_add(edge_resource_t* edge, const char* name);
-bool edge_info_capability_remove_by_name(edge_resource_t* edge, const char* name);
+edge_capability_t* edge_info_capability_add(edge_resource_t* edge, capability_id_t id);
+bool edge_info_capability_remove_by_id(edge_resource_t* edge, capability_id_t id);
 bool edge_info_capability_remove(edge_resource_t* edge, edge_capability_t* capability);
 void edge_info_capability_clear(edge_resource_t* edge);
 /*-------------------------------------------------------------------------------------------------------------------*/
-edge_capability_t* edge_info_capability_find(edge_resource_t* edge, const char* name);
+edge_capability_t* edge_info_capability_find(edge_resource_t* edge, capability_id_t id);
+// Continues the search from *iter, which is advanced past the capability found.
+// Only ever moves forward when ids are looked up in canonical order.
+edge_capability_t* edge_info_capability_find_next(edge_resource_t* edge, edge_capability_t** iter, capability_id_t id);
 /*-------------------------------------------------------------------------------------------------------------------*/
 bool edge_capability_is_active(const edge_capability_t* capability);
 /*-------------------------------------------------------------------------------------------------------------------*/
@@ -83,5 +163,5 @@ extern process_event_t pe_edge_capability_remove;
 /*-------------------------------------------------------------------------------------------------------------------*/
 const char* edge_info_name(const edge_resource_t* edge); // TODO: Remove this function
 /*-------------------------------------------------------------------------------------------------------------------*/
-bool edge_info_has_active_capability(const char* name);
+bool edge_info_has_active_capability(capability_id_t id);
 /*-------------------------------------------------------------------------------------------------------------------*/
@@ -1,5 +1,6 @@
 #include "hmm.h"
 #include <math.h>
+#include <string.h>
 #include "assert.h"
 #include "os/sys/log.h"
 /*-------------------------------------------------------------------------------------------------------------------*/
@@ -18,46 +19,58 @@
 /*-------------------------------------------------------------------------------------------------------------------*/
 #define PR_GOOD_GIVEN_TRUSTWORTHY 0.9f
 #define PR_BAD_GIVEN_UNTRUSTWORTHY 0.9f
+#define PR_GOOD_GIVEN_DEGRADED 0.5f
 #define NUM_BAD_OBSERVATIONS (HMM_NUM_OBSERVATIONS - 1)
+
+_Static_assert(HMM_NUM_OBSERVATIONS <= (1 << INTERACTION_HISTORY_BITS), "Observations do not fit in the interaction history");
+/*-------------------------------------------------------------------------------------------------------------------*/
+// The kernels below are written once using HMM_FOR_EACH_STATE, which is either a loop or is fully
+// unrolled so that every index into the HMM is a constant and there is no loop overhead
+#if HMM_KERNEL == HMM_KERNEL_GENERIC
+#   define HMM_FOR_EACH_STATE(s, ...) for (uint8_t s = 0; s != HMM_NUM_STATES; ++s) { __VA_ARGS__ }
+
+#elif HMM_KERNEL == HMM_KERNEL_UNROLLED
+#   define HMM_STATE(s, n, ...) { const uint8_t s = n; __VA_ARGS__ }
+#   if HMM_NUM_STATES == 2
+#       define HMM_FOR_EACH_STATE(s, ...) HMM_STATE(s, 0, __VA_ARGS__) HMM_STATE(s, 1, __VA_ARGS__)
+#   elif HMM_NUM_STATES == 3
+#       define HMM_FOR_EACH_STATE(s, ...) HMM_STATE(s, 0, __VA_ARGS__) HMM_STATE(s, 1, __VA_ARGS__) HMM_STATE(s, 2, __VA_ARGS__)
+#   else
+#       error "HMM_KERNEL_UNROLLED does not support this number of states"
+#   endif
+
+#else
+#   error "Unknown HMM_KERNEL"
+#endif
 /*-------------------------------------------------------------------------------------------------------------------*/
 void hmm_init_default(hmm_t* hmm)
 {
-    hmm->initial[HMM_STATE_EDGE_TRUSTWORTHY] = 0.8f;
-    hmm->initial[HMM_STATE_EDGE_UNTRUSTWORTHY] = 0.2f;
+    // Edge nodes are expected to be trustworthy, and to return to being trustworthy
+#if HMM_NUM_STATES == 2
+    static const float initial[HMM_NUM_STATES] = { 0.8f, 0.2f };
+    static const float pr_good[HMM_NUM_STATES] = { PR_GOOD_GIVEN_TRUSTWORTHY, 1.0f - PR_BAD_GIVEN_UNTRUSTWORTHY };
+#elif HMM_NUM_STATES == 3
+    static const float initial[HMM_NUM_STATES] = { 0.8f, 0.1f, 0.1f };
+    static const float pr_good[HMM_NUM_STATES] = { PR_GOOD_GIVEN_TRUSTWORTHY, 1.0f - PR_BAD_GIVEN_UNTRUSTWORTHY, PR_GOOD_GIVEN_DEGRADED };
+#endif
 
-    hmm->trans[HMM_STATE_EDGE_TRUSTWORTHY][HMM_STATE_EDGE_TRUSTWORTHY] = 0.8f;
-    hmm->trans[HMM_STATE_EDGE_TRUSTWORTHY][HMM_STATE_EDGE_UNTRUSTWORTHY] = 0.2f;
-    hmm->trans[HMM_STATE_EDGE_UNTRUSTWORTHY][HMM_STATE_EDGE_TRUSTWORTHY] = 0.8f;
-    hmm->trans[HMM_STATE_EDGE_UNTRUSTWORTHY][HMM_STATE_EDGE_UNTRUSTWORTHY] = 0.2f;
+    memcpy(hmm->initial, initial, sizeof(hmm->initial));
 
     for (uint8_t i = 0; i != HMM_NUM_STATES; ++i)
     {
+        memcpy(hmm->trans[i], initial, sizeof(hmm->trans[i]));
+
         for (uint8_t j = 0; j != HMM_NUM_OBSERVATIONS; ++j)
         {
-            const bool good_state = i == HMM_STATE_EDGE_TRUSTWORTHY;
             const bool good_obs = j == HMM_OBS_TASK_RESULT_QUALITY_CORRECT;
 
-            if (good_state)
+            if (good_obs)
             {
-                if (good_obs)
-                {
-                    hmm->emission[i][j] = PR_GOOD_GIVEN_TRUSTWORTHY;
-                }
-                else
-                {
-                    hmm->emission[i][j] = (1.0f - PR_GOOD_GIVEN_TRUSTWORTHY) / NUM_BAD_OBSERVATIONS;
-                }
+                hmm->emission[i][j] = pr_good[i];
             }
             else
             {
-                if (good_obs)
-                {
-                    hmm->emission[i][j] = (1.0f - PR_BAD_GIVEN_UNTRUSTWORTHY);
-                }
-                else
-                {
-                    hmm->emission[i][j] = PR_BAD_GIVEN_UNTRUSTWORTHY / NUM_BAD_OBSERVATIONS;
-                }
+                hmm->emission[i][j] = (1.0f - pr_good[i]) / NUM_BAD_OBSERVATIONS;
             }
         }
     }
@@ -65,106 +78,129 @@ void hmm_init_default(hmm_t* hmm)
 /*-------------------------------------------------------------------------------------------------------------------*/
 float hmm_one_observation_probability(const hmm_t* hmm, hmm_observations_t ob)
 {
-    double c = 0.0;
+    float c = 0.0f;
 
-    for (uint8_t i = 0; i != HMM_NUM_STATES; ++i)
-    {
-        c += hmm->initial[i] * hmm->emission[i][ob];
-    }
+    HMM_FOR_EACH_STATE(s,
+        c += hmm->initial[s] * hmm->emission[s][ob];
+    )
 
     return c;
 }
 /*-------------------------------------------------------------------------------------------------------------------*/
-float hmm_observation_probability(const hmm_t* hmm, hmm_observations_t ob, const interaction_history_t* prev_obs)
+float hmm_observation_probability(const hmm_t* hmm, hmm_observations_t ob, const hmm_forward_t* fwd)
 {
-    // Use the forward algorithm to solve
-    // Based on pseudocode from: https://web.stanford.edu/~jurafsky/slp3/A.pdf
-
-    // Also see: https://github.com/sukhoy/nanohmm/blob/master/nanohmm.c#L25
+    // Termination of the forward algorithm with the additional observation treated as a member of the history.
+    // The probability of the history is the product of the scaling factors, which was found as it was pushed.
+    float c = 0.0f;
 
-    float alpha[HMM_NUM_STATES][INTERACTION_HISTORY_SIZE+1];
-    float c[INTERACTION_HISTORY_SIZE+1];
+    HMM_FOR_EACH_STATE(s,
+        c += fwd->predicted[s] * hmm->emission[s][ob];
+    )
 
-    const uint8_t* obs = NULL;
+    return fwd->likelihood * c;
+}
+/*-------------------------------------------------------------------------------------------------------------------*/
+void hmm_forward_init(const hmm_t* hmm, hmm_forward_t* fwd)
+{
+    memcpy(fwd->predicted, hmm->initial, sizeof(fwd->predicted));
 
-    // Initialisation and Recursion
-    uint8_t t;
-    for (t = 0; t < prev_obs->count; ++t)
-    {
-        obs = (t == 0)
-            ? interaction_history_iter(prev_obs)
-            : interaction_history_next(prev_obs, obs);
-        assert(obs != NULL);
+    memset(fwd->neg_log_c, 0, sizeof(fwd->neg_log_c));
+    fwd->neg_log_likelihood = 0;
+    fwd->likelihood = 1.0f;
+}
+/*-------------------------------------------------------------------------------------------------------------------*/
+static uint8_t hmm_neg_log_scale(float c)
+{
+    // A scaling factor of 0 (or one small enough to underflow) saturates rather than becoming infinite
+    const float neg_log_c = -logf(c) * HMM_LOG_SCALE_STEPS;
 
-        c[t] = 0.0f;
+    return neg_log_c < UINT8_MAX ? (uint8_t)lroundf(neg_log_c) : UINT8_MAX;
+}
+/*-------------------------------------------------------------------------------------------------------------------*/
+// One step of the forward algorithm, for the observation at position pos in the history's ring buffer
+static void hmm_forward_step(const hmm_t* hmm, hmm_forward_t* fwd, uint8_t pos, hmm_observations_t ob)
+{
+    // Based on pseudocode from: https://web.stanford.edu/~jurafsky/slp3/A.pdf
+    // Also see: https://github.com/sukhoy/nanohmm/blob/master/nanohmm.c#L25
+    float alpha[HMM_NUM_STATES];
+    float c = 0.0f;
 
-        for (uint8_t s1 = 0; s1 != HMM_NUM_STATES; ++s1)
-        {
-            if (t == 0)
-            {
-                alpha[s1][t] = hmm->initial[s1];
-            }
-            else
-            {
-                alpha[s1][t] = 0.0f;
+    HMM_FOR_EACH_STATE(s,
+        alpha[s] = fwd->predicted[s] * hmm->emission[s][ob];
 
-                for (uint8_t s2 = 0; s2 != HMM_NUM_STATES; ++s2)
-                {
-                    alpha[s1][t] += alpha[s2][t-1] * hmm->trans[s2][s1];
-                }
-            }
+        c += alpha[s];
+    )
 
-            alpha[s1][t] *= hmm->emission[s1][*obs];
+    // Accumulate in the log domain, as the product of the scaling factors underflows
+    fwd->neg_log_c[pos] = hmm_neg_log_scale(c);
+    fwd->neg_log_likelihood += fwd->neg_log_c[pos];
 
-            c[t] += alpha[s1][t];
-        }
+    if (c != 0) // Scaling, by multiplying as division is slower
+    {
+        const float inv_c = 1.0f / c;
 
-        if (c[t] != 0) // Scaling
-        {
-            for (uint8_t i = 0; i != HMM_NUM_STATES; ++i)
-            {
-                alpha[i][t] /= c[t];
-            }
-        }
+        HMM_FOR_EACH_STATE(s,
+            alpha[s] *= inv_c;
+        )
     }
 
-    // Treat the additional observation as a member of the history list
-    t = prev_obs->count;
+    HMM_FOR_EACH_STATE(s1,
+        fwd->predicted[s1] = 0.0f;
 
-    // TODO: should probably be using the backward algorithm here
-    c[t] = 0.0f;
-    for (uint8_t s1 = 0; s1 != HMM_NUM_STATES; ++s1)
-    {
-        alpha[s1][t] = 0.0f;
+        HMM_FOR_EACH_STATE(s2,
+            fwd->predicted[s1] += alpha[s2] * hmm->trans[s2][s1];
+        )
+    )
+}
+/*-------------------------------------------------------------------------------------------------------------------*/
+static void hmm_forward_update_likelihood(hmm_forward_t* fwd)
+{
+    // Found once per push rather than on each evaluation
+    fwd->likelihood = expf(-(float)fwd->neg_log_likelihood * (1.0f / HMM_LOG_SCALE_STEPS));
+}
+/*-------------------------------------------------------------------------------------------------------------------*/
+void hmm_forward_push(const hmm_t* hmm, hmm_forward_t* fwd, interaction_history_t* hist, hmm_observations_t ob)
+{
+    // The position the observation is written to, which holds the oldest observation when the history is full
+    const uint8_t pos = (hist->head + hist->count) % INTERACTION_HISTORY_SIZE;
 
-        for (uint8_t s2 = 0; s2 != HMM_NUM_STATES; ++s2)
-        {
-            alpha[s1][t] += alpha[s2][t-1] * hmm->trans[s2][s1];
-        }
+    if (hist->count == INTERACTION_HISTORY_SIZE)
+    {
+        fwd->neg_log_likelihood -= fwd->neg_log_c[pos];
+    }
 
-        alpha[s1][t] *= hmm->emission[s1][ob];
+    interaction_history_push(hist, ob);
 
-        c[t] += alpha[s1][t];
+    // Once per trip around the ring buffer, so the cost is amortised to one step per push
+    if (pos == INTERACTION_HISTORY_SIZE - 1)
+    {
+        hmm_forward_recompute(hmm, fwd, hist);
     }
-
-    if (c[t] != 0) // Scaling
+    else
     {
-        for (uint8_t i = 0; i != HMM_NUM_STATES; ++i)
-        {
-            alpha[i][t] /= c[t];
-        }
+        hmm_forward_step(hmm, fwd, pos, ob);
+        hmm_forward_update_likelihood(fwd);
     }
+}
+/*-------------------------------------------------------------------------------------------------------------------*/
+void hmm_forward_recompute(const hmm_t* hmm, hmm_forward_t* fwd, const interaction_history_t* hist)
+{
+    hmm_forward_init(hmm, fwd);
 
-    // Termination
-    // Instead of the product, do exp of the sum of the logs for numerical stability
-    double result = 0.0;
-
-    for (uint8_t t = 0; t != INTERACTION_HISTORY_SIZE+1; ++t)
+    // Consume the packed history a word at a time
+    uint32_t word;
+    uint8_t n;
+    for (uint8_t t = 0; (n = interaction_history_word(hist, t, &word)) != 0; t += n)
     {
-        result += log(c[t]);
+        for (uint8_t i = 0; i != n; ++i, word >>= INTERACTION_HISTORY_BITS)
+        {
+            const uint8_t pos = (hist->head + t + i) % INTERACTION_HISTORY_SIZE;
+
+            hmm_forward_step(hmm, fwd, pos, word & INTERACTION_HISTORY_MASK);
+        }
     }
 
-    return exp(result);
+    hmm_forward_update_likelihood(fwd);
 }
 /*-------------------------------------------------------------------------------------------------------------------*/
 void hmm_update(hmm_t* hmm, hmm_observations_t ob, bool first)
@@ -177,35 +213,33 @@ void hmm_update(hmm_t* hmm, hmm_observations_t ob, bool first)
 
     if (first)
     {
-        for (uint8_t s1 = 0; s1 != HMM_NUM_STATES; ++s1)
-        {
+        HMM_FOR_EACH_STATE(s1,
             alpha[s1] = hmm->initial[s1] * hmm->emission[s1][ob];
 
             c += alpha[s1];
-        }
+        )
     }
     else
     {
-        for (uint8_t s1 = 0; s1 != HMM_NUM_STATES; ++s1)
-        {
+        HMM_FOR_EACH_STATE(s1,
             alpha[s1] = 0.0f;
 
-            for (uint8_t s2 = 0; s2 != HMM_NUM_STATES; ++s2)
-            {
+            HMM_FOR_EACH_STATE(s2,
                 alpha[s1] += hmm->initial[s2] * hmm->trans[s2][s1];
-            }
+            )
 
             alpha[s1] *= hmm->emission[s1][ob];
 
             c += alpha[s1];
-        }
+        )
     }
 
     // Normalise alphas
-    for (uint8_t s1 = 0; s1 != HMM_NUM_STATES; ++s1)
-    {
-        alpha[s1] /= c;
-    }
+    const float inv_c = 1.0f / c;
+
+    HMM_FOR_EACH_STATE(s1,
+        alpha[s1] *= inv_c;
+    )
 
     // Update initial
     memcpy(hmm->initial, alpha, sizeof(hmm->initial));
@@ -267,7 +301,7 @@ int hmm_deserialise(nanocbor_value_t* dec, hmm_t* hmm)
     NANOCBOR_CHECK(nanocbor_enter_array(&arr, &sub_arr));
     for (int i = 0; i != HMM_NUM_STATES; ++i)
     {
-        NANOCBOR_CHECK(nanocbor_get_float(&arr, &hmm->initial[i]));
+        NANOCBOR_CHECK(nanocbor_get_float(&sub_arr, &hmm->initial[i]));
     }
 
     if (!nanocbor_at_end(&sub_arr))
@@ -287,7 +321,7 @@ int hmm_deserialise(nanocbor_value_t* dec, hmm_t* hmm)
 
         for (int j = 0; j != HMM_NUM_STATES; ++j)
         {
-            NANOCBOR_CHECK(nanocbor_get_float(&arr, &hmm->trans[i][j]));
+            NANOCBOR_CHECK(nanocbor_get_float(&sub_arr2, &hmm->trans[i][j]));
         }
 
         if (!nanocbor_at_end(&sub_arr2))
@@ -316,7 +350,7 @@ int hmm_deserialise(nanocbor_value_t* dec, hmm_t* hmm)
 
         for (int j = 0; j != HMM_NUM_OBSERVATIONS; ++j)
         {
-            NANOCBOR_CHECK(nanocbor_get_float(&arr, &hmm->emission[i][j]));
+            NANOCBOR_CHECK(nanocbor_get_float(&sub_arr2, &hmm->emission[i][j]));
         }
 
         if (!nanocbor_at_end(&sub_arr2))
@@ -4,15 +4,42 @@
 
 #include "nanocbor-helper.h"
 /*-------------------------------------------------------------------------------------------------------------------*/
+#ifndef HMM_NUM_STATES
 #define HMM_NUM_STATES 2
+#endif
+
+#ifndef HMM_NUM_OBSERVATIONS
 #define HMM_NUM_OBSERVATIONS 4
+#endif
+/*-------------------------------------------------------------------------------------------------------------------*/
+// How the forward and update kernels in hmm.c are compiled
+#define HMM_KERNEL_GENERIC 0
+#define HMM_KERNEL_UNROLLED 1
+
+#ifndef HMM_KERNEL
+#define HMM_KERNEL HMM_KERNEL_UNROLLED
+#endif
 /*-------------------------------------------------------------------------------------------------------------------*/
+#if HMM_NUM_STATES == 2
 // Hidden states: Is the edge node trustworthy (behaving well) or untrustworthy (behaving badly)
 typedef enum {
     HMM_STATE_EDGE_TRUSTWORTHY = 0,
     HMM_STATE_EDGE_UNTRUSTWORTHY = 1
 } hmm_states_t;
 
+#elif HMM_NUM_STATES == 3
+// Hidden states: As above, but the edge node may also be degraded (behaving well, but unreliably)
+typedef enum {
+    HMM_STATE_EDGE_TRUSTWORTHY = 0,
+    HMM_STATE_EDGE_UNTRUSTWORTHY = 1,
+    HMM_STATE_EDGE_DEGRADED = 2
+} hmm_states_t;
+
+#else
+#error "Bad number of states"
+
+#endif
+
 // Observations: What interactions have been observed
 #if HMM_NUM_OBSERVATIONS == 4
 typedef enum {
@@ -62,11 +89,45 @@ typedef struct {
     (1) + HMM_NUM_STATES * ((1) + HMM_NUM_OBSERVATIONS * sizeof(float)) \
 )
 /*-------------------------------------------------------------------------------------------------------------------*/
+// Scaling factors are kept as -ln(c) in steps of 1/HMM_LOG_SCALE_STEPS nats, saturating at UINT8_MAX
+#ifndef HMM_LOG_SCALE_STEPS
+#define HMM_LOG_SCALE_STEPS 32
+#endif
+
+_Static_assert(INTERACTION_HISTORY_SIZE * UINT8_MAX <= UINT16_MAX, "Log likelihood may overflow");
+
+// Cached results of the scaled forward algorithm over an interaction history, so the probability of the history
+// followed by another observation is found in O(states) rather than O(history * states^2).
+//
+// Each push extends the forward algorithm by one step. Once the history is full the dropped observation's
+// scaling factor is subtracted from the log likelihood (a fixed-lag approximation, as the predicted states
+// still reflect it), and the forward algorithm is run again over the packed history once every
+// INTERACTION_HISTORY_SIZE pushes to reset the approximation. hmm_forward_recompute must also be called
+// when the HMM changes.
+typedef struct {
+    // Probability of each state at the next observation, given the observations so far
+    float predicted[HMM_NUM_STATES];
+
+    // Probability of the observations so far, exp(-neg_log_likelihood)
+    float likelihood;
+
+    // -ln of each observation's scaling factor, indexed by its position in the history's ring buffer
+    uint8_t neg_log_c[INTERACTION_HISTORY_SIZE];
+
+    // -ln of the probability of the observations so far, the sum of neg_log_c
+    uint16_t neg_log_likelihood;
+
+} hmm_forward_t;
+/*-------------------------------------------------------------------------------------------------------------------*/
 void hmm_init_default(hmm_t* hmm);
 /*-------------------------------------------------------------------------------------------------------------------*/
 void hmm_update(hmm_t* hmm, hmm_observations_t ob, bool first);
 float hmm_one_observation_probability(const hmm_t* hmm, hmm_observations_t ob);
-float hmm_observation_probability(const hmm_t* hmm, hmm_observations_t ob, const interaction_history_t* prev_obs);
+float hmm_observation_probability(const hmm_t* hmm, hmm_observations_t ob, const hmm_forward_t* fwd);
+/*-------------------------------------------------------------------------------------------------------------------*/
+void hmm_forward_init(const hmm_t* hmm, hmm_forward_t* fwd);
+void hmm_forward_push(const hmm_t* hmm, hmm_forward_t* fwd, interaction_history_t* hist, hmm_observations_t ob);
+void hmm_forward_recompute(const hmm_t* hmm, hmm_forward_t* fwd, const interaction_history_t* hist);
 /*-------------------------------------------------------------------------------------------------------------------*/
 int hmm_serialise(nanocbor_encoder_t* enc, const hmm_t* hmm);
 int hmm_deserialise(nanocbor_value_t* dec, hmm_t* hmm);
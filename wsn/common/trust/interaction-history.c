@@ -1,66 +1,78 @@
 #include "interaction-history.h"
 #include <stddef.h>
 #include <stdio.h>
+#include <string.h>
 #include <inttypes.h>
 /*-------------------------------------------------------------------------------------------------------------------*/
 void interaction_history_init(interaction_history_t* hist)
 {
-    hist->head = hist->tail = 0;
+    memset(hist->interactions, 0, sizeof(hist->interactions));
+    hist->head = 0;
     hist->count = 0;
 }
 /*-------------------------------------------------------------------------------------------------------------------*/
 void interaction_history_push(interaction_history_t* hist, uint8_t interaction)
 {
-    // If reachex maximum, then remove first element
+    const uint8_t tail = (hist->head + hist->count) % INTERACTION_HISTORY_SIZE;
+
+    // If reached maximum, then remove first element
     if (hist->count == INTERACTION_HISTORY_SIZE)
     {
         hist->head = (hist->head + 1) % INTERACTION_HISTORY_SIZE;
-        hist->count -= 1;
+    }
+    else
+    {
+        hist->count += 1;
     }
 
-    hist->interactions[hist->tail] = interaction;
-
-    hist->tail = (hist->tail + 1) % INTERACTION_HISTORY_SIZE;
+    const uint8_t shift = (tail % INTERACTION_HISTORY_PER_WORD) * INTERACTION_HISTORY_BITS;
+    uint32_t* word = &hist->interactions[tail / INTERACTION_HISTORY_PER_WORD];
 
-    hist->count += 1;
+    *word = (*word & ~(INTERACTION_HISTORY_MASK << shift)) | ((interaction & INTERACTION_HISTORY_MASK) << shift);
 }
 /*-------------------------------------------------------------------------------------------------------------------*/
-const uint8_t* interaction_history_iter(const interaction_history_t* hist)
+uint8_t interaction_history_get(const interaction_history_t* hist, uint8_t index)
 {
-    if (hist->count == 0)
-    {
-        return NULL;
-    }
+    uint32_t word;
+    interaction_history_word(hist, index, &word);
 
-    return &hist->interactions[hist->head];
+    return word & INTERACTION_HISTORY_MASK;
 }
 /*-------------------------------------------------------------------------------------------------------------------*/
-const uint8_t* interaction_history_next(const interaction_history_t* hist, const uint8_t* iter)
+uint8_t interaction_history_word(const interaction_history_t* hist, uint8_t index, uint32_t* word)
 {
-    ++iter;
-
-    // Wrap around
-    if (iter == hist->interactions + INTERACTION_HISTORY_SIZE)
+    if (index >= hist->count)
     {
-        iter = hist->interactions;
+        *word = 0;
+        return 0;
     }
 
-    if (iter == hist->interactions + hist->tail)
+    const uint8_t pos = (hist->head + index) % INTERACTION_HISTORY_SIZE;
+    const uint8_t offset = pos % INTERACTION_HISTORY_PER_WORD;
+
+    *word = hist->interactions[pos / INTERACTION_HISTORY_PER_WORD] >> (offset * INTERACTION_HISTORY_BITS);
+
+    // Stop at the end of the word, the end of the ring buffer or the end of the history
+    uint8_t n = INTERACTION_HISTORY_PER_WORD - offset;
+
+    if (n > INTERACTION_HISTORY_SIZE - pos)
     {
-        return NULL;
+        n = INTERACTION_HISTORY_SIZE - pos;
     }
-    else
+    if (n > hist->count - index)
     {
-        return iter;
+        n = hist->count - index;
     }
+
+    return n;
 }
 /*-------------------------------------------------------------------------------------------------------------------*/
 void interaction_history_print(const interaction_history_t* hist)
 {
     printf("[");
-    for (const uint8_t* iter = interaction_history_iter(hist); iter != NULL; iter = interaction_history_next(hist, iter))
+    for (uint8_t i = 0; i != hist->count; ++i)
     {
-        printf("%" PRIu8 ", ", *iter);
+        printf("%" PRIu8 ", ", interaction_history_get(hist, i));
     }
     printf("]");
 }
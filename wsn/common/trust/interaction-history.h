@@ -4,13 +4,25 @@
 #ifndef INTERACTION_HISTORY_SIZE
 #define INTERACTION_HISTORY_SIZE 8
 #endif
+
+// Bits used to store each interaction, must divide 32
+#ifndef INTERACTION_HISTORY_BITS
+#define INTERACTION_HISTORY_BITS 2
+#endif
+
+_Static_assert(INTERACTION_HISTORY_SIZE > 0 && INTERACTION_HISTORY_SIZE <= UINT8_MAX, "Invalid interaction history size");
+_Static_assert(32 % INTERACTION_HISTORY_BITS == 0, "Interactions cannot be packed into words");
+
+#define INTERACTION_HISTORY_PER_WORD (32 / INTERACTION_HISTORY_BITS)
+#define INTERACTION_HISTORY_WORDS ((INTERACTION_HISTORY_SIZE + INTERACTION_HISTORY_PER_WORD - 1) / INTERACTION_HISTORY_PER_WORD)
+#define INTERACTION_HISTORY_MASK ((uint32_t)((1ull << INTERACTION_HISTORY_BITS) - 1))
 /*-------------------------------------------------------------------------------------------------------------------*/
+// A ring buffer of interactions packed into words, with interaction i at bits [i*BITS, (i+1)*BITS)
 typedef struct interaction_history
 {
-    // TODO: could consider better packing interactions (4 interactions per byte - 2 bits per interaction)
-    uint8_t interactions[INTERACTION_HISTORY_SIZE];
+    uint32_t interactions[INTERACTION_HISTORY_WORDS];
 
-    uint8_t head, tail;
+    uint8_t head;
     uint8_t count;
 
 } interaction_history_t;
@@ -19,8 +31,12 @@ void interaction_history_init(interaction_history_t* hist);
 /*-------------------------------------------------------------------------------------------------------------------*/
 void interaction_history_push(interaction_history_t* hist, uint8_t interaction);
 /*-------------------------------------------------------------------------------------------------------------------*/
-const uint8_t* interaction_history_iter(const interaction_history_t* hist);
-const uint8_t* interaction_history_next(const interaction_history_t* hist, const uint8_t* iter);
+// The index-th oldest interaction
+uint8_t interaction_history_get(const interaction_history_t* hist, uint8_t index);
+
+// Provides the index-th oldest interaction and those after it in the same word, with the oldest in the lowest bits.
+// Returns how many interactions are in the word, which is 0 when index is past the end of the history.
+uint8_t interaction_history_word(const interaction_history_t* hist, uint8_t index, uint32_t* word);
 /*-------------------------------------------------------------------------------------------------------------------*/
 void interaction_history_print(const interaction_history_t* hist);
 /*-------------------------------------------------------------------------------------------------------------------*/
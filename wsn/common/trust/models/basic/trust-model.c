@@ -16,8 +16,8 @@
 /*-------------------------------------------------------------------------------------------------------------------*/
 void edge_resource_tm_init(edge_resource_tm_t* tm)
 {
-    beta_dist_init(&tm->task_submission, 1, 1);
-    beta_dist_init(&tm->task_result, 1, 1);
+    dist_init(&tm->task_submission, 1, 1);
+    dist_init(&tm->task_result, 1, 1);
 }
 /*-------------------------------------------------------------------------------------------------------------------*/
 void edge_resource_tm_print(const edge_resource_tm_t* tm)
@@ -32,7 +32,7 @@ void edge_resource_tm_print(const edge_resource_tm_t* tm)
 /*-------------------------------------------------------------------------------------------------------------------*/
 void edge_capability_tm_init(edge_capability_tm_t* tm)
 {
-    beta_dist_init(&tm->result_quality, 1, 1);
+    dist_init(&tm->result_quality, 1, 1);
 }
 /*-------------------------------------------------------------------------------------------------------------------*/
 void edge_capability_tm_print(const edge_capability_tm_t* tm)
@@ -43,6 +43,19 @@ void edge_capability_tm_print(const edge_capability_tm_t* tm)
     printf(")");
 }
 /*-------------------------------------------------------------------------------------------------------------------*/
+#ifdef TRUST_MODEL_HAS_TM_REBASE
+void edge_resource_tm_rebase(edge_resource_tm_t* tm, int32_t time_shift, int32_t seconds_shift)
+{
+    decayed_beta_dist_rebase(&tm->task_submission, seconds_shift);
+    decayed_beta_dist_rebase(&tm->task_result, seconds_shift);
+}
+/*-------------------------------------------------------------------------------------------------------------------*/
+void edge_capability_tm_rebase(edge_capability_tm_t* tm, int32_t time_shift, int32_t seconds_shift)
+{
+    decayed_beta_dist_rebase(&tm->result_quality, seconds_shift);
+}
+/*-------------------------------------------------------------------------------------------------------------------*/
+#endif
 void peer_tm_init(peer_tm_t* tm)
 {
 }
@@ -53,7 +66,7 @@ void peer_tm_print(const peer_tm_t* tm)
     printf(")");
 }
 /*-------------------------------------------------------------------------------------------------------------------*/
-float calculate_trust_value(edge_resource_t* edge, edge_capability_t* capability)
+trust_real_t calculate_trust_value(edge_resource_t* edge, edge_capability_t* capability)
 {
     // Get the stereotype that may inform the trust value
     edge_stereotype_t* s = NULL;
@@ -63,52 +76,41 @@ float calculate_trust_value(edge_resource_t* edge, edge_capability_t* capability
         s = edge_stereotype_find(&item->cert.tags);
     }
 
-    float trust = 0;
-    float w_total = 0;
-    float w, e;
+    trust_real_t trust = TRUST_REAL(0);
+    trust_real_t w, e;
 
-    beta_dist_t temp;
+    tm_beta_dist_t temp;
 
-    w = find_trust_weight(capability->name, TRUST_METRIC_TASK_SUBMISSION);
-    beta_dist_combine(&edge->tm.task_submission, s ? &s->edge_tm.task_submission : NULL, &temp);
-    e = beta_dist_expected(&temp);
-    trust += w * e;
-    w_total += w;
+    w = find_trust_weight(capability->id, TRUST_METRIC_TASK_SUBMISSION);
+    dist_combine(&edge->tm.task_submission, s ? &s->edge_tm.task_submission : NULL, &temp);
+    e = dist_expected(&temp);
+    trust += trust_real_mul(w, e);
 
-    w = find_trust_weight(capability->name, TRUST_METRIC_TASK_RESULT);
-    beta_dist_combine(&edge->tm.task_result, s ? &s->edge_tm.task_result : NULL, &temp);
-    e = beta_dist_expected(&temp);
-    trust += w * e;
-    w_total += w;
+    w = find_trust_weight(capability->id, TRUST_METRIC_TASK_RESULT);
+    dist_combine(&edge->tm.task_result, s ? &s->edge_tm.task_result : NULL, &temp);
+    e = dist_expected(&temp);
+    trust += trust_real_mul(w, e);
 
-    w = find_trust_weight(capability->name, TRUST_METRIC_RESULT_QUALITY);
-    e = beta_dist_expected(&capability->tm.result_quality);
-    trust += w * e;
-    w_total += w;
+    w = find_trust_weight(capability->id, TRUST_METRIC_RESULT_QUALITY);
+    e = dist_expected(&capability->tm.result_quality);
+    trust += trust_real_mul(w, e);
 
 #if defined(APPLICATION_CHALLENGE_RESPONSE) && defined(TRUST_MODEL_USE_CHALLENGE_RESPONSE)
     // This application is special, as its result quality applies to
     // other applications too (as long as they specify a weight for it).
-    edge_capability_t* cr = edge_info_capability_find(edge, CHALLENGE_RESPONSE_APPLICATION_NAME);
+    edge_capability_t* cr = edge_info_capability_find(edge, CHALLENGE_RESPONSE_APPLICATION_ID);
     if (cr != NULL)
     {
-        w = find_trust_weight(capability->name, TRUST_METRIC_CHALLENGE_RESP);
-        e = beta_dist_expected(&cr->tm.result_quality);
-        trust += w * e;
-        w_total += w;
+        w = find_trust_weight(capability->id, TRUST_METRIC_CHALLENGE_RESP);
+        e = dist_expected(&cr->tm.result_quality);
+        trust += trust_real_mul(w, e);
     }
 #endif
 
-    // The weights should add up to be 1, check this
-    if (!isclose(w_total, 1.0f))
-    {
-        LOG_ERR("The trust weights should total up to be close to 1, they are %f\n", w_total);
-    }
-
     return trust;
 }
 /*-------------------------------------------------------------------------------------------------------------------*/
-void tm_update_task_submission(edge_resource_t* edge, edge_capability_t* cap, const tm_task_submission_info_t* info)
+void tm_model_update_task_submission(edge_resource_t* edge, edge_capability_t* cap, const tm_task_submission_info_t* info)
 {
     bool should_update;
     const bool good = tm_task_submission_good(info, &should_update);
@@ -119,63 +121,69 @@ void tm_update_task_submission(edge_resource_t* edge, edge_capability_t* cap, co
     }
 
     LOG_INFO("Updating Edge %s capability %s TM task_submission (req=%d, coap=%d): ",
-        edge_info_name(edge), cap->name, info->coap_request_status, info->coap_status);
-    beta_dist_print(&edge->tm.task_submission);
+        edge_info_name(edge), capability_id_name(cap->id), info->coap_request_status, info->coap_status);
+    dist_print(&edge->tm.task_submission);
     LOG_INFO_(" -> ");
 
     if (good)
     {
-        beta_dist_add_good(&edge->tm.task_submission);
+        dist_add_good(&edge->tm.task_submission);
     }
     else
     {
-        beta_dist_add_bad(&edge->tm.task_submission);
+        dist_add_bad(&edge->tm.task_submission);
     }
 
-    beta_dist_print(&edge->tm.task_submission);
+    edge_info_tm_changed(edge);
+
+    dist_print(&edge->tm.task_submission);
     LOG_INFO_("\n");
 }
 /*-------------------------------------------------------------------------------------------------------------------*/
-void tm_update_task_result(edge_resource_t* edge, edge_capability_t* cap, const tm_task_result_info_t* info)
+void tm_model_update_task_result(edge_resource_t* edge, edge_capability_t* cap, const tm_task_result_info_t* info)
 {
-    LOG_INFO("Updating Edge %s capability %s TM task_result (result=%d): ", edge_info_name(edge), cap->name, info->result);
-    beta_dist_print(&edge->tm.task_result);
+    LOG_INFO("Updating Edge %s capability %s TM task_result (result=%d): ", edge_info_name(edge), capability_id_name(cap->id), info->result);
+    dist_print(&edge->tm.task_result);
     LOG_INFO_(" -> ");
 
     if (info->result == TM_TASK_RESULT_INFO_SUCCESS)
     {
-        beta_dist_add_good(&edge->tm.task_result);
+        dist_add_good(&edge->tm.task_result);
     }
     else
     {
-        beta_dist_add_bad(&edge->tm.task_result);
+        dist_add_bad(&edge->tm.task_result);
     }
 
-    beta_dist_print(&edge->tm.task_result);
+    edge_info_tm_changed(edge);
+
+    dist_print(&edge->tm.task_result);
     LOG_INFO_("\n");
 }
 /*-------------------------------------------------------------------------------------------------------------------*/
-void tm_update_result_quality(edge_resource_t* edge, edge_capability_t* cap, const tm_result_quality_info_t* info)
+void tm_model_update_result_quality(edge_resource_t* edge, edge_capability_t* cap, const tm_result_quality_info_t* info)
 {
-    LOG_INFO("Updating Edge %s capability %s TM result_quality (good=%d): ", edge_info_name(edge), cap->name, info->good);
-    beta_dist_print(&cap->tm.result_quality);
+    LOG_INFO("Updating Edge %s capability %s TM result_quality (good=%d): ", edge_info_name(edge), capability_id_name(cap->id), info->good);
+    dist_print(&cap->tm.result_quality);
     LOG_INFO_(" -> ");
 
     if (info->good)
     {
-        beta_dist_add_good(&cap->tm.result_quality);
+        dist_add_good(&cap->tm.result_quality);
     }
     else
     {
-        beta_dist_add_bad(&cap->tm.result_quality);
+        dist_add_bad(&cap->tm.result_quality);
     }
 
-    beta_dist_print(&cap->tm.result_quality);
+    edge_info_capability_tm_changed(cap);
+
+    dist_print(&cap->tm.result_quality);
     LOG_INFO_("\n");
 }
 /*-------------------------------------------------------------------------------------------------------------------*/
 #ifdef APPLICATION_CHALLENGE_RESPONSE
-void tm_update_challenge_response(edge_resource_t* edge, const tm_challenge_response_info_t* info)
+void tm_model_update_challenge_response(edge_resource_t* edge, const tm_challenge_response_info_t* info)
 {
     bool should_update;
     const bool good = tm_challenge_response_good(info, &should_update);
@@ -185,7 +193,7 @@ void tm_update_challenge_response(edge_resource_t* edge, const tm_challenge_resp
         return;
     }
 
-    edge_capability_t* cap = edge_info_capability_find(edge, CHALLENGE_RESPONSE_APPLICATION_NAME);
+    edge_capability_t* cap = edge_info_capability_find(edge, CHALLENGE_RESPONSE_APPLICATION_ID);
     if (cap == NULL)
     {
         LOG_ERR("Failed to find cr application\n");
@@ -193,7 +201,7 @@ void tm_update_challenge_response(edge_resource_t* edge, const tm_challenge_resp
     }
 
     const tm_result_quality_info_t info2 = { .good = good };
-    tm_update_result_quality(edge, cap, &info2);
+    tm_model_update_result_quality(edge, cap, &info2);
 }
 #endif
 /*-------------------------------------------------------------------------------------------------------------------*/
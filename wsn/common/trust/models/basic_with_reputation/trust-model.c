@@ -45,6 +45,19 @@ void edge_capability_tm_print(const edge_capability_tm_t* tm)
     printf(")");
 }
 /*-------------------------------------------------------------------------------------------------------------------*/
+#ifdef TRUST_DIST_COMPACT
+void peer_edge_resource_tm_from(peer_edge_resource_tm_t* out, const edge_resource_tm_t* tm)
+{
+    beta_dist_compact(&tm->task_submission, &out->task_submission);
+    beta_dist_compact(&tm->task_result, &out->task_result);
+}
+/*-------------------------------------------------------------------------------------------------------------------*/
+void peer_edge_capability_tm_from(peer_edge_capability_tm_t* out, const edge_capability_tm_t* tm)
+{
+    beta_dist_compact(&tm->result_quality, &out->result_quality);
+}
+/*-------------------------------------------------------------------------------------------------------------------*/
+#endif
 void peer_tm_init(peer_tm_t* tm)
 {
 }
@@ -55,7 +68,7 @@ void peer_tm_print(const peer_tm_t* tm)
     printf(")");
 }
 /*-------------------------------------------------------------------------------------------------------------------*/
-float calculate_trust_value(edge_resource_t* edge, edge_capability_t* capability)
+trust_real_t calculate_trust_value(edge_resource_t* edge, edge_capability_t* capability)
 {
     // Get the stereotype that may inform the trust value
     edge_stereotype_t* s = NULL;
@@ -65,49 +78,38 @@ float calculate_trust_value(edge_resource_t* edge, edge_capability_t* capability
         s = edge_stereotype_find(&item->cert.tags);
     }
 
-    float trust = 0;
-    float w_total = 0;
-    float e = 0;
+    trust_real_t trust = TRUST_REAL(0);
+    trust_real_t e = TRUST_REAL(0);
 
     beta_dist_t temp;
 
-    const float w_task_sub = find_trust_weight(capability->name, TRUST_METRIC_TASK_SUBMISSION);
+    const trust_real_t w_task_sub = find_trust_weight(capability->id, TRUST_METRIC_TASK_SUBMISSION);
     beta_dist_combine(&edge->tm.task_submission, s ? &s->edge_tm.task_submission : NULL, &temp);
     e = beta_dist_expected(&temp);
-    trust += w_task_sub * e;
-    w_total += w_task_sub;
+    trust += trust_real_mul(w_task_sub, e);
 
-    const float w_task_res = find_trust_weight(capability->name, TRUST_METRIC_TASK_RESULT);
+    const trust_real_t w_task_res = find_trust_weight(capability->id, TRUST_METRIC_TASK_RESULT);
     beta_dist_combine(&edge->tm.task_result, s ? &s->edge_tm.task_result : NULL, &temp);
     e = beta_dist_expected(&temp);
-    trust += w_task_res * e;
-    w_total += w_task_res;
+    trust += trust_real_mul(w_task_res, e);
 
-    const float w_task_qual = find_trust_weight(capability->name, TRUST_METRIC_RESULT_QUALITY);
+    const trust_real_t w_task_qual = find_trust_weight(capability->id, TRUST_METRIC_RESULT_QUALITY);
     e = beta_dist_expected(&capability->tm.result_quality);
-    trust += w_task_qual * e;
-    w_total += w_task_qual;
+    trust += trust_real_mul(w_task_qual, e);
 
 #if defined(APPLICATION_CHALLENGE_RESPONSE) && defined(TRUST_MODEL_USE_CHALLENGE_RESPONSE)
     // This application is special, as its result quality applies to
     // other applications too (as long as they specify a weight for it).
-    edge_capability_t* cr = edge_info_capability_find(edge, CHALLENGE_RESPONSE_APPLICATION_NAME);
+    edge_capability_t* cr = edge_info_capability_find(edge, CHALLENGE_RESPONSE_APPLICATION_ID);
     if (cr != NULL)
     {
-        const float w_cr = find_trust_weight(capability->name, TRUST_METRIC_CHALLENGE_RESP);
+        const trust_real_t w_cr = find_trust_weight(capability->id, TRUST_METRIC_CHALLENGE_RESP);
         e = beta_dist_expected(&cr->tm.result_quality);
-        trust += w_cr * e;
-        w_total += w_cr;
+        trust += trust_real_mul(w_cr, e);
     }
 #endif
 
-    // The weights should add up to be 1, check this
-    if (!isclose(w_total, 1.0f))
-    {
-        LOG_ERR("The trust weights should total up to be close to 1, they are %f\n", w_total);
-    }
-
-    float rep = 0;
+    trust_real_t rep = TRUST_REAL(0);
     uint32_t rep_count = 0;
 
     // Note that this does not attempt to weight trustworthiness of information
@@ -127,53 +129,53 @@ float calculate_trust_value(edge_resource_t* edge, edge_capability_t* capability
             continue;
         }
 
-        float rep_edge = 0;
-        w_total = 0;
+        trust_real_t rep_edge = TRUST_REAL(0);
+        trust_real_t w_total = TRUST_REAL(0);
 
         // Combine peer-provided Edge information
-        e = beta_dist_expected(&edge_iter->tm.task_submission);
-        rep_edge += w_task_sub * e;
+        e = dist_expected(&edge_iter->tm.task_submission);
+        rep_edge += trust_real_mul(w_task_sub, e);
         w_total += w_task_sub;
 
-        e = beta_dist_expected(&edge_iter->tm.task_result);
-        rep_edge += w_task_res * e;
+        e = dist_expected(&edge_iter->tm.task_result);
+        rep_edge += trust_real_mul(w_task_res, e);
         w_total += w_task_res;
 
         peer_edge_capability_t* cap_iter = peer_info_find_capability(edge_iter, capability);
         if (cap_iter)
         {
             // Combine peer-provided Capability information
-            e = beta_dist_expected(&cap_iter->tm.result_quality);
-            rep_edge += w_task_qual * e;
+            e = dist_expected(&cap_iter->tm.result_quality);
+            rep_edge += trust_real_mul(w_task_qual, e);
             w_total += w_task_qual;
         }
 
         // We do not expect w_total to equal 1 here as information may be missing
-        assert(w_total >= 0.0f);
-        assert(w_total <= 1.0f);
+        assert(w_total >= TRUST_REAL(0));
+        assert(w_total <= TRUST_REAL(1));
 
         // Now aggregate these values together with other reputation values
         // Normalise the reputation, we may be missing some information, such as the capability.
-        rep += (rep_edge / w_total);
+        rep += trust_real_div(rep_edge, w_total);
         rep_count += 1;
     }
 
     if (rep_count > 0)
     {
         // Find the average reputation among peers
-        rep = rep / rep_count;
+        rep = rep / (int32_t)rep_count;
 
         // If there is no reputation weight defined, then this result will be 0
-        const float w_rep = find_trust_weight(capability->name, TRUST_CONF_REPUTATION_WEIGHT);
+        const trust_real_t w_rep = find_trust_weight(capability->id, TRUST_CONF_REPUTATION_WEIGHT);
 
         // Include reputation in the final trust value
-        trust = (trust * (1.0-w_rep)) + (rep * w_rep);
+        trust = trust_real_mul(trust, TRUST_REAL(1) - w_rep) + trust_real_mul(rep, w_rep);
     }
 
     return trust;
 }
 /*-------------------------------------------------------------------------------------------------------------------*/
-void tm_update_task_submission(edge_resource_t* edge, edge_capability_t* cap, const tm_task_submission_info_t* info)
+void tm_model_update_task_submission(edge_resource_t* edge, edge_capability_t* cap, const tm_task_submission_info_t* info)
 {
     bool should_update;
     const bool good = tm_task_submission_good(info, &should_update);
@@ -184,7 +186,7 @@ void tm_update_task_submission(edge_resource_t* edge, edge_capability_t* cap, co
     }
 
     LOG_INFO("Updating Edge %s capability %s TM task_submission (req=%d, coap=%d): ",
-        edge_info_name(edge), cap->name, info->coap_request_status, info->coap_status);
+        edge_info_name(edge), capability_id_name(cap->id), info->coap_request_status, info->coap_status);
     beta_dist_print(&edge->tm.task_submission);
     LOG_INFO_(" -> ");
 
@@ -197,13 +199,15 @@ void tm_update_task_submission(edge_resource_t* edge, edge_capability_t* cap, co
         beta_dist_add_bad(&edge->tm.task_submission);
     }
 
+    edge_info_tm_changed(edge);
+
     beta_dist_print(&edge->tm.task_submission);
     LOG_INFO_("\n");
 }
 /*-------------------------------------------------------------------------------------------------------------------*/
-void tm_update_task_result(edge_resource_t* edge, edge_capability_t* cap, const tm_task_result_info_t* info)
+void tm_model_update_task_result(edge_resource_t* edge, edge_capability_t* cap, const tm_task_result_info_t* info)
 {
-    LOG_INFO("Updating Edge %s capability %s TM task_result (result=%d): ", edge_info_name(edge), cap->name, info->result);
+    LOG_INFO("Updating Edge %s capability %s TM task_result (result=%d): ", edge_info_name(edge), capability_id_name(cap->id), info->result);
     beta_dist_print(&edge->tm.task_result);
     LOG_INFO_(" -> ");
 
@@ -216,13 +220,15 @@ void tm_update_task_result(edge_resource_t* edge, edge_capability_t* cap, const
         beta_dist_add_bad(&edge->tm.task_result);
     }
 
+    edge_info_tm_changed(edge);
+
     beta_dist_print(&edge->tm.task_result);
     LOG_INFO_("\n");
 }
 /*-------------------------------------------------------------------------------------------------------------------*/
-void tm_update_result_quality(edge_resource_t* edge, edge_capability_t* cap, const tm_result_quality_info_t* info)
+void tm_model_update_result_quality(edge_resource_t* edge, edge_capability_t* cap, const tm_result_quality_info_t* info)
 {
-    LOG_INFO("Updating Edge %s capability %s TM result_quality (good=%d): ", edge_info_name(edge), cap->name, info->good);
+    LOG_INFO("Updating Edge %s capability %s TM result_quality (good=%d): ", edge_info_name(edge), capability_id_name(cap->id), info->good);
     beta_dist_print(&cap->tm.result_quality);
     LOG_INFO_(" -> ");
 
@@ -235,12 +241,14 @@ void tm_update_result_quality(edge_resource_t* edge, edge_capability_t* cap, con
         beta_dist_add_bad(&cap->tm.result_quality);
     }
 
+    edge_info_capability_tm_changed(cap);
+
     beta_dist_print(&cap->tm.result_quality);
     LOG_INFO_("\n");
 }
 /*-------------------------------------------------------------------------------------------------------------------*/
 #ifdef APPLICATION_CHALLENGE_RESPONSE
-void tm_update_challenge_response(edge_resource_t* edge, const tm_challenge_response_info_t* info)
+void tm_model_update_challenge_response(edge_resource_t* edge, const tm_challenge_response_info_t* info)
 {
     bool should_update;
     const bool good = tm_challenge_response_good(info, &should_update);
@@ -250,7 +258,7 @@ void tm_update_challenge_response(edge_resource_t* edge, const tm_challenge_resp
         return;
     }
 
-    edge_capability_t* cap = edge_info_capability_find(edge, CHALLENGE_RESPONSE_APPLICATION_NAME);
+    edge_capability_t* cap = edge_info_capability_find(edge, CHALLENGE_RESPONSE_APPLICATION_ID);
     if (cap == NULL)
     {
         LOG_ERR("Failed to find cr application\n");
@@ -258,7 +266,7 @@ void tm_update_challenge_response(edge_resource_t* edge, const tm_challenge_resp
     }
 
     const tm_result_quality_info_t info2 = { .good = good };
-    tm_update_result_quality(edge, cap, &info2);
+    tm_model_update_result_quality(edge, cap, &info2);
 }
 #endif
 /*-------------------------------------------------------------------------------------------------------------------*/
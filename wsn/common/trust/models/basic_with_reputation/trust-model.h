@@ -38,6 +38,27 @@ void edge_capability_tm_init(edge_capability_tm_t* tm);
 void edge_capability_tm_print(const edge_capability_tm_t* tm);
 /*-------------------------------------------------------------------------------------------------------------------*/
 
+/*-------------------------------------------------------------------------------------------------------------------*/
+#ifdef TRUST_DIST_COMPACT
+// Copies of peer-provided trust only need the expected values, so are held with quantised counts
+#define TRUST_MODEL_HAS_PEER_TM
+
+typedef struct peer_edge_resource_tm {
+    beta_dist_compact_t task_submission;
+    beta_dist_compact_t task_result;
+
+} peer_edge_resource_tm_t;
+
+typedef struct peer_edge_capability_tm {
+    beta_dist_compact_t result_quality;
+
+} peer_edge_capability_tm_t;
+/*-------------------------------------------------------------------------------------------------------------------*/
+void peer_edge_resource_tm_from(peer_edge_resource_tm_t* out, const edge_resource_tm_t* tm);
+void peer_edge_capability_tm_from(peer_edge_capability_tm_t* out, const edge_capability_tm_t* tm);
+#endif
+/*-------------------------------------------------------------------------------------------------------------------*/
+
 /*-------------------------------------------------------------------------------------------------------------------*/
 typedef struct peer_tm {
 
@@ -48,7 +69,7 @@ void peer_tm_print(const peer_tm_t* tm);
 /*-------------------------------------------------------------------------------------------------------------------*/
 
 /*-------------------------------------------------------------------------------------------------------------------*/
-float calculate_trust_value(struct edge_resource* edge, struct edge_capability* capability);
+trust_real_t calculate_trust_value(struct edge_resource* edge, struct edge_capability* capability);
 /*-------------------------------------------------------------------------------------------------------------------*/
 
 /*-------------------------------------------------------------------------------------------------------------------*/
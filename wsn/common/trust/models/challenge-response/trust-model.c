@@ -49,7 +49,7 @@ bool edge_is_good(edge_resource_t* edge)
     return !edge->tm.bad;
 }
 /*-------------------------------------------------------------------------------------------------------------------*/
-void tm_update_challenge_response(edge_resource_t* edge, const tm_challenge_response_info_t* info)
+void tm_model_update_challenge_response(edge_resource_t* edge, const tm_challenge_response_info_t* info)
 {
     bool should_update;
     const bool good = tm_challenge_response_good(info, &should_update);
@@ -67,6 +67,7 @@ void tm_update_challenge_response(edge_resource_t* edge, const tm_challenge_resp
             {
                 edge->tm.epoch_number += 1;
                 edge->tm.bad = false;
+                edge_info_tm_changed(edge);
             }
         }
         else
@@ -75,6 +76,7 @@ void tm_update_challenge_response(edge_resource_t* edge, const tm_challenge_resp
             {
                 edge->tm.epoch_number += 1;
                 edge->tm.bad = true;
+                edge_info_tm_changed(edge);
             }
         }
 
@@ -7,6 +7,7 @@
 #define TRUST_MODEL_TAG 3
 #define TRUST_MODEL_NO_PEER_PROVIDED
 #define TRUST_MODEL_NO_PERIODIC_BROADCAST
+#define TRUST_MODEL_NO_TRUST_VALUE
 
 struct edge_resource;
 
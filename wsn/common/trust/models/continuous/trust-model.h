@@ -11,14 +11,22 @@
 struct edge_resource;
 struct edge_capability;
 
+// Defining TRUST_MODEL_BETA_DECAY forgets old interactions, see decayed_beta_dist_t
+#ifdef TRUST_MODEL_BETA_DECAY
+#define TRUST_MODEL_HAS_TM_REBASE
+typedef decayed_beta_dist_t tm_beta_dist_t;
+#else
+typedef beta_dist_t tm_beta_dist_t;
+#endif
+
 /*-------------------------------------------------------------------------------------------------------------------*/
 // Per-Edge interactions
 typedef struct edge_resource_tm {
     // When submitting a task, did the Edge accept it correctly?
-    beta_dist_t task_submission;
+    tm_beta_dist_t task_submission;
 
     // Was a task result received when it was expected
-    beta_dist_t task_result;
+    tm_beta_dist_t task_result;
 
     // Are periodic announces being sent as often as expected
     poisson_observation_t announce;
@@ -33,7 +41,7 @@ void edge_resource_tm_print(const edge_resource_tm_t* tm);
 // Per-Application of Edge interactions
 typedef struct edge_capability_tm {
     // Was the result correct or not (nodes do not have the capability to evaluate response 'goodness')
-    beta_dist_t result_quality;
+    tm_beta_dist_t result_quality;
 
     // How long did it take to receive a response?
     gaussian_dist_t latency;
@@ -43,11 +51,17 @@ typedef struct edge_capability_tm {
 void edge_capability_tm_init(edge_capability_tm_t* tm);
 void edge_capability_tm_print(const edge_capability_tm_t* tm);
 /*-------------------------------------------------------------------------------------------------------------------*/
+// The clocks restart at boot, so the times held by restored records are moved along by the shift (see trust-snapshot.h)
+#ifdef TRUST_MODEL_HAS_TM_REBASE
+void edge_resource_tm_rebase(edge_resource_tm_t* tm, int32_t time_shift, int32_t seconds_shift);
+void edge_capability_tm_rebase(edge_capability_tm_t* tm, int32_t time_shift, int32_t seconds_shift);
+#endif
+/*-------------------------------------------------------------------------------------------------------------------*/
 
 /*-------------------------------------------------------------------------------------------------------------------*/
 typedef struct peer_tm {
     // Did the peer deliver a task observation when it was expected?
-    beta_dist_t task_observation;
+    tm_beta_dist_t task_observation;
 
 } peer_tm_t;
 /*-------------------------------------------------------------------------------------------------------------------*/
@@ -56,7 +70,7 @@ void peer_tm_print(const peer_tm_t* tm);
 /*-------------------------------------------------------------------------------------------------------------------*/
 
 /*-------------------------------------------------------------------------------------------------------------------*/
-float calculate_trust_value(struct edge_resource* edge, struct edge_capability* capability);
+trust_real_t calculate_trust_value(struct edge_resource* edge, struct edge_capability* capability);
 /*-------------------------------------------------------------------------------------------------------------------*/
 
 /*-------------------------------------------------------------------------------------------------------------------*/
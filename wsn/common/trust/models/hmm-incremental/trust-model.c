@@ -49,13 +49,14 @@ void peer_tm_print(const peer_tm_t* tm)
     printf(")");
 }
 /*-------------------------------------------------------------------------------------------------------------------*/
-float calculate_trust_value(edge_resource_t* edge, edge_capability_t* cap)
+trust_real_t calculate_trust_value(edge_resource_t* edge, edge_capability_t* cap)
 {
     // What is the probability that the next observation will be good
-    return hmm_one_observation_probability(&cap->tm.hmm, HMM_OBS_TASK_RESULT_QUALITY_CORRECT);
+    // The HMM itself is evaluated in floating-point
+    return trust_real_from_float(hmm_one_observation_probability(&cap->tm.hmm, HMM_OBS_TASK_RESULT_QUALITY_CORRECT));
 }
 /*-------------------------------------------------------------------------------------------------------------------*/
-void tm_update_task_submission(edge_resource_t* edge, edge_capability_t* cap, const tm_task_submission_info_t* info)
+void tm_model_update_task_submission(edge_resource_t* edge, edge_capability_t* cap, const tm_task_submission_info_t* info)
 {
     bool should_update;
     const bool good = tm_task_submission_good(info, &should_update);
@@ -66,7 +67,7 @@ void tm_update_task_submission(edge_resource_t* edge, edge_capability_t* cap, co
     }
 
     LOG_INFO("Updating Edge %s capability %s TM task_submission (req=%d, coap=%d): ",
-        edge_info_name(edge), cap->name, info->coap_request_status, info->coap_status);
+        edge_info_name(edge), capability_id_name(cap->id), info->coap_request_status, info->coap_status);
     edge_capability_tm_print(&cap->tm);
     LOG_INFO_(" -> ");
 
@@ -74,15 +75,16 @@ void tm_update_task_submission(edge_resource_t* edge, edge_capability_t* cap, co
     {
         hmm_update(&cap->tm.hmm, HMM_OBS_TASK_SUBMISSION_ACK_TIMEDOUT, cap->tm.first);
         cap->tm.first = false;
+        edge_info_capability_tm_changed(cap);
     }
 
     edge_capability_tm_print(&cap->tm);
     LOG_INFO_("\n");
 }
 /*-------------------------------------------------------------------------------------------------------------------*/
-void tm_update_task_result(edge_resource_t* edge, edge_capability_t* cap, const tm_task_result_info_t* info)
+void tm_model_update_task_result(edge_resource_t* edge, edge_capability_t* cap, const tm_task_result_info_t* info)
 {
-    LOG_INFO("Updating Edge %s capability %s TM task_result (result=%d): ", edge_info_name(edge), cap->name, info->result);
+    LOG_INFO("Updating Edge %s capability %s TM task_result (result=%d): ", edge_info_name(edge), capability_id_name(cap->id), info->result);
     edge_capability_tm_print(&cap->tm);
     LOG_INFO_(" -> ");
 
@@ -90,15 +92,16 @@ void tm_update_task_result(edge_resource_t* edge, edge_capability_t* cap, const
     {
         hmm_update(&cap->tm.hmm, HMM_OBS_TASK_RESPONSE_TIMEDOUT, cap->tm.first);
         cap->tm.first = false;
+        edge_info_capability_tm_changed(cap);
     }
 
     edge_capability_tm_print(&cap->tm);
     LOG_INFO_("\n");
 }
 /*-------------------------------------------------------------------------------------------------------------------*/
-void tm_update_result_quality(edge_resource_t* edge, edge_capability_t* cap, const tm_result_quality_info_t* info)
+void tm_model_update_result_quality(edge_resource_t* edge, edge_capability_t* cap, const tm_result_quality_info_t* info)
 {
-    LOG_INFO("Updating Edge %s capability %s TM result_quality (good=%d): ", edge_info_name(edge), cap->name, info->good);
+    LOG_INFO("Updating Edge %s capability %s TM result_quality (good=%d): ", edge_info_name(edge), capability_id_name(cap->id), info->good);
     edge_capability_tm_print(&cap->tm);
     LOG_INFO_(" -> ");
 
@@ -113,12 +116,14 @@ void tm_update_result_quality(edge_resource_t* edge, edge_capability_t* cap, con
         cap->tm.first = false;
     }
 
+    edge_info_capability_tm_changed(cap);
+
     edge_capability_tm_print(&cap->tm);
     LOG_INFO_("\n");
 }
 /*-------------------------------------------------------------------------------------------------------------------*/
 #ifdef APPLICATION_CHALLENGE_RESPONSE
-void tm_update_challenge_response(edge_resource_t* edge, const tm_challenge_response_info_t* info)
+void tm_model_update_challenge_response(edge_resource_t* edge, const tm_challenge_response_info_t* info)
 {
     bool should_update;
     const bool good = tm_challenge_response_good(info, &should_update);
@@ -128,7 +133,7 @@ void tm_update_challenge_response(edge_resource_t* edge, const tm_challenge_resp
         return;
     }
 
-    edge_capability_t* cap = edge_info_capability_find(edge, CHALLENGE_RESPONSE_APPLICATION_NAME);
+    edge_capability_t* cap = edge_info_capability_find(edge, CHALLENGE_RESPONSE_APPLICATION_ID);
     if (cap == NULL)
     {
         LOG_ERR("Failed to find cr application\n");
@@ -136,7 +141,7 @@ void tm_update_challenge_response(edge_resource_t* edge, const tm_challenge_resp
     }
 
     const tm_result_quality_info_t info2 = { .good = good };
-    tm_update_result_quality(edge, cap, &info2);
+    tm_model_update_result_quality(edge, cap, &info2);
 }
 #endif
 /*-------------------------------------------------------------------------------------------------------------------*/
@@ -166,6 +171,7 @@ int deserialise_trust_edge_resource(nanocbor_value_t* dec, edge_resource_tm_t* e
 int deserialise_trust_edge_capability(nanocbor_value_t* dec, edge_capability_tm_t* cap)
 {
     nanocbor_value_t arr;
+    NANOCBOR_CHECK(nanocbor_enter_array(dec, &arr));
     NANOCBOR_CHECK(hmm_deserialise(&arr, &cap->hmm));
     NANOCBOR_CHECK(nanocbor_get_bool(&arr, &cap->first));
 
@@ -46,7 +46,7 @@ void peer_tm_print(const peer_tm_t* tm);
 /*-------------------------------------------------------------------------------------------------------------------*/
 
 /*-------------------------------------------------------------------------------------------------------------------*/
-float calculate_trust_value(struct edge_resource* edge, struct edge_capability* capability);
+trust_real_t calculate_trust_value(struct edge_resource* edge, struct edge_capability* capability);
 /*-------------------------------------------------------------------------------------------------------------------*/
 
 /*-------------------------------------------------------------------------------------------------------------------*/
@@ -29,6 +29,7 @@ void edge_capability_tm_init(edge_capability_tm_t* tm)
 {
     hmm_init_default(&tm->hmm);
     interaction_history_init(&tm->hist);
+    hmm_forward_init(&tm->hmm, &tm->fwd);
 }
 /*-------------------------------------------------------------------------------------------------------------------*/
 void edge_capability_tm_print(const edge_capability_tm_t* tm)
@@ -49,13 +50,14 @@ void peer_tm_print(const peer_tm_t* tm)
     printf(")");
 }
 /*-------------------------------------------------------------------------------------------------------------------*/
-float calculate_trust_value(edge_resource_t* edge, edge_capability_t* cap)
+trust_real_t calculate_trust_value(edge_resource_t* edge, edge_capability_t* cap)
 {
     // What is the probability that the next observation will be good
-    return hmm_observation_probability(&cap->tm.hmm, HMM_OBS_TASK_RESULT_QUALITY_CORRECT, &cap->tm.hist);
+    // The HMM itself is evaluated in floating-point
+    return trust_real_from_float(hmm_observation_probability(&cap->tm.hmm, HMM_OBS_TASK_RESULT_QUALITY_CORRECT, &cap->tm.fwd));
 }
 /*-------------------------------------------------------------------------------------------------------------------*/
-void tm_update_task_submission(edge_resource_t* edge, edge_capability_t* cap, const tm_task_submission_info_t* info)
+void tm_model_update_task_submission(edge_resource_t* edge, edge_capability_t* cap, const tm_task_submission_info_t* info)
 {
     bool should_update;
     const bool good = tm_task_submission_good(info, &should_update);
@@ -66,55 +68,59 @@ void tm_update_task_submission(edge_resource_t* edge, edge_capability_t* cap, co
     }
 
     LOG_INFO("Updating Edge %s capability %s TM task_submission (req=%d, coap=%d): ",
-        edge_info_name(edge), cap->name, info->coap_request_status, info->coap_status);
+        edge_info_name(edge), capability_id_name(cap->id), info->coap_request_status, info->coap_status);
     edge_capability_tm_print(&cap->tm);
     LOG_INFO_(" -> ");
 
     if (!good)
     {
-        interaction_history_push(&cap->tm.hist, HMM_OBS_TASK_SUBMISSION_ACK_TIMEDOUT);
+        hmm_forward_push(&cap->tm.hmm, &cap->tm.fwd, &cap->tm.hist, HMM_OBS_TASK_SUBMISSION_ACK_TIMEDOUT);
+        edge_info_capability_tm_changed(cap);
     }
 
     edge_capability_tm_print(&cap->tm);
     LOG_INFO_("\n");
 }
 /*-------------------------------------------------------------------------------------------------------------------*/
-void tm_update_task_result(edge_resource_t* edge, edge_capability_t* cap, const tm_task_result_info_t* info)
+void tm_model_update_task_result(edge_resource_t* edge, edge_capability_t* cap, const tm_task_result_info_t* info)
 {
-    LOG_INFO("Updating Edge %s capability %s TM task_result (result=%d): ", edge_info_name(edge), cap->name, info->result);
+    LOG_INFO("Updating Edge %s capability %s TM task_result (result=%d): ", edge_info_name(edge), capability_id_name(cap->id), info->result);
     edge_capability_tm_print(&cap->tm);
     LOG_INFO_(" -> ");
 
     if (info->result != TM_TASK_RESULT_INFO_SUCCESS)
     {
-        interaction_history_push(&cap->tm.hist, HMM_OBS_TASK_RESPONSE_TIMEDOUT);
+        hmm_forward_push(&cap->tm.hmm, &cap->tm.fwd, &cap->tm.hist, HMM_OBS_TASK_RESPONSE_TIMEDOUT);
+        edge_info_capability_tm_changed(cap);
     }
 
     edge_capability_tm_print(&cap->tm);
     LOG_INFO_("\n");
 }
 /*-------------------------------------------------------------------------------------------------------------------*/
-void tm_update_result_quality(edge_resource_t* edge, edge_capability_t* cap, const tm_result_quality_info_t* info)
+void tm_model_update_result_quality(edge_resource_t* edge, edge_capability_t* cap, const tm_result_quality_info_t* info)
 {
-    LOG_INFO("Updating Edge %s capability %s TM result_quality (good=%d): ", edge_info_name(edge), cap->name, info->good);
+    LOG_INFO("Updating Edge %s capability %s TM result_quality (good=%d): ", edge_info_name(edge), capability_id_name(cap->id), info->good);
     edge_capability_tm_print(&cap->tm);
     LOG_INFO_(" -> ");
 
     if (info->good)
     {
-        interaction_history_push(&cap->tm.hist, HMM_OBS_TASK_RESULT_QUALITY_CORRECT);
+        hmm_forward_push(&cap->tm.hmm, &cap->tm.fwd, &cap->tm.hist, HMM_OBS_TASK_RESULT_QUALITY_CORRECT);
     }
     else
     {
-        interaction_history_push(&cap->tm.hist, HMM_OBS_TASK_RESULT_QUALITY_INCORRECT);
+        hmm_forward_push(&cap->tm.hmm, &cap->tm.fwd, &cap->tm.hist, HMM_OBS_TASK_RESULT_QUALITY_INCORRECT);
     }
 
+    edge_info_capability_tm_changed(cap);
+
     edge_capability_tm_print(&cap->tm);
     LOG_INFO_("\n");
 }
 /*-------------------------------------------------------------------------------------------------------------------*/
 #ifdef APPLICATION_CHALLENGE_RESPONSE
-void tm_update_challenge_response(edge_resource_t* edge, const tm_challenge_response_info_t* info)
+void tm_model_update_challenge_response(edge_resource_t* edge, const tm_challenge_response_info_t* info)
 {
     bool should_update;
     const bool good = tm_challenge_response_good(info, &should_update);
@@ -124,7 +130,7 @@ void tm_update_challenge_response(edge_resource_t* edge, const tm_challenge_resp
         return;
     }
 
-    edge_capability_t* cap = edge_info_capability_find(edge, CHALLENGE_RESPONSE_APPLICATION_NAME);
+    edge_capability_t* cap = edge_info_capability_find(edge, CHALLENGE_RESPONSE_APPLICATION_ID);
     if (cap == NULL)
     {
         LOG_ERR("Failed to find cr application\n");
@@ -132,7 +138,7 @@ void tm_update_challenge_response(edge_resource_t* edge, const tm_challenge_resp
     }
 
     const tm_result_quality_info_t info2 = { .good = good };
-    tm_update_result_quality(edge, cap, &info2);
+    tm_model_update_result_quality(edge, cap, &info2);
 }
 #endif
 /*-------------------------------------------------------------------------------------------------------------------*/
@@ -161,6 +167,10 @@ int deserialise_trust_edge_capability(nanocbor_value_t* dec, edge_capability_tm_
 {
     NANOCBOR_CHECK(hmm_deserialise(dec, &cap->hmm));
 
+    // The cached forward variables depend on the HMM, the history is not serialised so is
+    // whatever the caller initialised it to
+    hmm_forward_recompute(&cap->hmm, &cap->fwd, &cap->hist);
+
     return NANOCBOR_OK;
 }
 /*-------------------------------------------------------------------------------------------------------------------*/
@@ -29,6 +29,7 @@ void edge_resource_tm_print(const edge_resource_tm_t* tm);
 typedef struct edge_capability_tm {
     hmm_t hmm;
     interaction_history_t hist;
+    hmm_forward_t fwd;
 
 } edge_capability_tm_t;
 /*-------------------------------------------------------------------------------------------------------------------*/
@@ -46,7 +47,7 @@ void peer_tm_print(const peer_tm_t* tm);
 /*-------------------------------------------------------------------------------------------------------------------*/
 
 /*-------------------------------------------------------------------------------------------------------------------*/
-float calculate_trust_value(struct edge_resource* edge, struct edge_capability* capability);
+trust_real_t calculate_trust_value(struct edge_resource* edge, struct edge_capability* capability);
 /*-------------------------------------------------------------------------------------------------------------------*/
 
 /*-------------------------------------------------------------------------------------------------------------------*/
@@ -85,7 +85,7 @@ void edge_capability_tm_init(edge_capability_tm_t* tm)
 
     exponential_dist_init(
         &tm->throughput_goodness_change,
-        1.0f / (EXPECTED_TIME_THROUGHPUT_BAD * CLOCK_SECOND));
+        trust_wide_from_uint(EXPECTED_TIME_THROUGHPUT_BAD * CLOCK_SECOND));
 
     tm->throughput_last_became_bad = (clock_time_t)-1;
 }
@@ -106,6 +106,18 @@ void edge_capability_tm_print(const edge_capability_tm_t* tm)
     printf(")");
 }
 /*-------------------------------------------------------------------------------------------------------------------*/
+void edge_resource_tm_rebase(edge_resource_tm_t* tm, int32_t time_shift, int32_t seconds_shift)
+{
+}
+/*-------------------------------------------------------------------------------------------------------------------*/
+void edge_capability_tm_rebase(edge_capability_tm_t* tm, int32_t time_shift, int32_t seconds_shift)
+{
+    if (tm->throughput_last_became_bad != (clock_time_t)-1)
+    {
+        tm->throughput_last_became_bad += time_shift;
+    }
+}
+/*-------------------------------------------------------------------------------------------------------------------*/
 void peer_tm_init(peer_tm_t* tm)
 {
 }
@@ -132,26 +144,26 @@ void capability_tm_print(const capability_tm_t* tm)
     printf(")");
 }
 /*-------------------------------------------------------------------------------------------------------------------*/
-static float pr_value_lt_norm(const gaussian_dist_t* norm, const gaussian_dist_t* ewma)
+static trust_real_t pr_value_lt_norm(const gaussian_dist_t* norm, const gaussian_dist_t* ewma)
 {
     // Return middle value when no data in distributions
     if (norm->count == 0 || ewma->count == 0)
     {
-        return 0.5f;
+        return TRUST_REAL(0.5);
     }
 
     // In the EWMA distribution what is the probability of observing a value
     // greater than the mean calculated via an unweighted average
 
-    if (ewma->variance == 0.0f)
+    if (ewma->variance == 0)
     {
         if (norm->mean < ewma->mean)
         {
-            return 1.0f;
+            return TRUST_REAL(1);
         }
         else
         {
-            return 0.0f;
+            return TRUST_REAL(0);
         }
     }
     else
@@ -160,12 +172,12 @@ static float pr_value_lt_norm(const gaussian_dist_t* norm, const gaussian_dist_t
     }
 }
 /*-------------------------------------------------------------------------------------------------------------------*/
-static float pr_value_ge_norm(const gaussian_dist_t* norm, const gaussian_dist_t* ewma)
+static trust_real_t pr_value_ge_norm(const gaussian_dist_t* norm, const gaussian_dist_t* ewma)
 {
-    return 1.0f - pr_value_lt_norm(norm, ewma);
+    return TRUST_REAL(1) - pr_value_lt_norm(norm, ewma);
 }
 /*-------------------------------------------------------------------------------------------------------------------*/
-static float goodness_pge_local(const edge_resource_t* edge, const edge_capability_t* capability)
+static trust_real_t goodness_pge_local(const edge_resource_t* edge, const edge_capability_t* capability)
 {
     const gaussian_dist_t* in = &capability->tm.throughput_in;
     const gaussian_dist_t* out = &capability->tm.throughput_out;
@@ -173,14 +185,14 @@ static float goodness_pge_local(const edge_resource_t* edge, const edge_capabili
     const gaussian_dist_t* in_ewma = &capability->tm.throughput_in_ewma;
     const gaussian_dist_t* out_ewma = &capability->tm.throughput_out_ewma;
 
-    const float in_pr = pr_value_ge_norm(in, in_ewma);
-    const float out_pr = pr_value_ge_norm(out, out_ewma);
+    const trust_real_t in_pr = pr_value_ge_norm(in, in_ewma);
+    const trust_real_t out_pr = pr_value_ge_norm(out, out_ewma);
 
-    const float result = (in_pr + out_pr) / 2.0f;
+    const trust_real_t result = (in_pr + out_pr) / 2;
 
     LOG_INFO("goodness_of_throughput[%s, %s](%f,%f) = %f",
-        edge_info_name(edge), capability->name,
-        in_pr, out_pr, result);
+        edge_info_name(edge), capability_id_name(capability->id),
+        trust_real_to_float(in_pr), trust_real_to_float(out_pr), trust_real_to_float(result));
     LOG_INFO_(" in-norm:");
     gaussian_dist_print(in);
     LOG_INFO_(" out-norm:");
@@ -194,7 +206,7 @@ static float goodness_pge_local(const edge_resource_t* edge, const edge_capabili
     return result;
 }
 /*-------------------------------------------------------------------------------------------------------------------*/
-static float goodness_plt_global(const edge_resource_t* edge, const edge_capability_t* capability, const capability_t* global_cap)
+static trust_real_t goodness_plt_global(const edge_resource_t* edge, const edge_capability_t* capability, const capability_t* global_cap)
 {
     const gaussian_dist_t* in = &capability->tm.throughput_in;
     const gaussian_dist_t* out = &capability->tm.throughput_out;
@@ -202,14 +214,14 @@ static float goodness_plt_global(const edge_resource_t* edge, const edge_capabil
     const gaussian_dist_t* in_global = &global_cap->tm.throughput_in;
     const gaussian_dist_t* out_global = &global_cap->tm.throughput_out;
 
-    const float in_pr = pr_value_lt_norm(in, in_global);
-    const float out_pr = pr_value_lt_norm(out, out_global);
+    const trust_real_t in_pr = pr_value_lt_norm(in, in_global);
+    const trust_real_t out_pr = pr_value_lt_norm(out, out_global);
 
-    const float result = (in_pr + out_pr) / 2.0f;
+    const trust_real_t result = (in_pr + out_pr) / 2;
 
     LOG_INFO("goodness_p2[%s, %s](%f,%f) = %f",
-        edge_info_name(edge), capability->name,
-        in_pr, out_pr, result);
+        edge_info_name(edge), capability_id_name(capability->id),
+        trust_real_to_float(in_pr), trust_real_to_float(out_pr), trust_real_to_float(result));
     LOG_INFO_(" in-norm:");
     gaussian_dist_print(in);
     LOG_INFO_(" out-norm:");
@@ -223,7 +235,7 @@ static float goodness_plt_global(const edge_resource_t* edge, const edge_capabil
     return result;
 }
 /*-------------------------------------------------------------------------------------------------------------------*/
-float calculate_trust_value(edge_resource_t* edge, edge_capability_t* capability)
+trust_real_t calculate_trust_value(edge_resource_t* edge, edge_capability_t* capability)
 {
     // Get the stereotype that may inform the trust value
     edge_stereotype_t* s = NULL;
@@ -233,52 +245,41 @@ float calculate_trust_value(edge_resource_t* edge, edge_capability_t* capability
         s = edge_stereotype_find(&item->cert.tags);
     }
 
-    float trust = 0;
-    float w_total = 0;
-    float w, e;
+    trust_real_t trust = TRUST_REAL(0);
+    trust_real_t w, e;
 
     beta_dist_t temp;
 
-    w = find_trust_weight(capability->name, TRUST_METRIC_TASK_SUBMISSION);
+    w = find_trust_weight(capability->id, TRUST_METRIC_TASK_SUBMISSION);
     beta_dist_combine(&edge->tm.task_submission, s ? &s->edge_tm.task_submission : NULL, &temp);
     e = beta_dist_expected(&temp);
-    trust += w * e;
-    w_total += w;
+    trust += trust_real_mul(w, e);
 
-    w = find_trust_weight(capability->name, TRUST_METRIC_TASK_RESULT);
+    w = find_trust_weight(capability->id, TRUST_METRIC_TASK_RESULT);
     beta_dist_combine(&edge->tm.task_result, s ? &s->edge_tm.task_result : NULL, &temp);
     e = beta_dist_expected(&temp);
-    trust += w * e;
-    w_total += w;
+    trust += trust_real_mul(w, e);
 
-    w = find_trust_weight(capability->name, TRUST_METRIC_RESULT_QUALITY);
+    w = find_trust_weight(capability->id, TRUST_METRIC_RESULT_QUALITY);
     e = beta_dist_expected(&capability->tm.result_quality);
-    trust += w * e;
-    w_total += w;
+    trust += trust_real_mul(w, e);
 
 #if defined(APPLICATION_CHALLENGE_RESPONSE) && defined(TRUST_MODEL_USE_CHALLENGE_RESPONSE)
     // This application is special, as its result quality applies to
     // other applications too (as long as they specify a weight for it).
-    edge_capability_t* cr = edge_info_capability_find(edge, CHALLENGE_RESPONSE_APPLICATION_NAME);
+    edge_capability_t* cr = edge_info_capability_find(edge, CHALLENGE_RESPONSE_APPLICATION_ID);
     if (cr != NULL)
     {
-        w = find_trust_weight(capability->name, TRUST_METRIC_CHALLENGE_RESP);
+        w = find_trust_weight(capability->id, TRUST_METRIC_CHALLENGE_RESP);
         e = beta_dist_expected(&cr->tm.result_quality);
-        trust += w * e;
-        w_total += w;
+        trust += trust_real_mul(w, e);
     }
 #endif
 
-    // The weights should add up to be 1, check this
-    if (!isclose(w_total, 1.0f))
-    {
-        LOG_ERR("The trust weights should total up to be close to 1, they are %f\n", w_total);
-    }
-
     return trust;
 }
 /*-------------------------------------------------------------------------------------------------------------------*/
-void tm_update_task_submission(edge_resource_t* edge, edge_capability_t* cap, const tm_task_submission_info_t* info)
+void tm_model_update_task_submission(edge_resource_t* edge, edge_capability_t* cap, const tm_task_submission_info_t* info)
 {
     bool should_update;
     const bool good = tm_task_submission_good(info, &should_update);
@@ -289,7 +290,7 @@ void tm_update_task_submission(edge_resource_t* edge, edge_capability_t* cap, co
     }
 
     LOG_INFO("Updating Edge %s capability %s TM task_submission (req=%d, coap=%d): ",
-        edge_info_name(edge), cap->name, info->coap_request_status, info->coap_status);
+        edge_info_name(edge), capability_id_name(cap->id), info->coap_request_status, info->coap_status);
     beta_dist_print(&edge->tm.task_submission);
     LOG_INFO_(" -> ");
 
@@ -302,13 +303,15 @@ void tm_update_task_submission(edge_resource_t* edge, edge_capability_t* cap, co
         beta_dist_add_bad(&edge->tm.task_submission);
     }
 
+    edge_info_tm_changed(edge);
+
     beta_dist_print(&edge->tm.task_submission);
     LOG_INFO_("\n");
 }
 /*-------------------------------------------------------------------------------------------------------------------*/
-void tm_update_task_result(edge_resource_t* edge, edge_capability_t* cap, const tm_task_result_info_t* info)
+void tm_model_update_task_result(edge_resource_t* edge, edge_capability_t* cap, const tm_task_result_info_t* info)
 {
-    LOG_INFO("Updating Edge %s capability %s TM task_result (result=%d): ", edge_info_name(edge), cap->name, info->result);
+    LOG_INFO("Updating Edge %s capability %s TM task_result (result=%d): ", edge_info_name(edge), capability_id_name(cap->id), info->result);
     beta_dist_print(&edge->tm.task_result);
     LOG_INFO_(" -> ");
 
@@ -321,13 +324,15 @@ void tm_update_task_result(edge_resource_t* edge, edge_capability_t* cap, const
         beta_dist_add_bad(&edge->tm.task_result);
     }
 
+    edge_info_tm_changed(edge);
+
     beta_dist_print(&edge->tm.task_result);
     LOG_INFO_("\n");
 }
 /*-------------------------------------------------------------------------------------------------------------------*/
-void tm_update_result_quality(edge_resource_t* edge, edge_capability_t* cap, const tm_result_quality_info_t* info)
+void tm_model_update_result_quality(edge_resource_t* edge, edge_capability_t* cap, const tm_result_quality_info_t* info)
 {
-    LOG_INFO("Updating Edge %s capability %s TM result_quality (good=%d): ", edge_info_name(edge), cap->name, info->good);
+    LOG_INFO("Updating Edge %s capability %s TM result_quality (good=%d): ", edge_info_name(edge), capability_id_name(cap->id), info->good);
     beta_dist_print(&cap->tm.result_quality);
     LOG_INFO_(" -> ");
 
@@ -340,43 +345,47 @@ void tm_update_result_quality(edge_resource_t* edge, edge_capability_t* cap, con
         beta_dist_add_bad(&cap->tm.result_quality);
     }
 
+    edge_info_capability_tm_changed(cap);
+
     beta_dist_print(&cap->tm.result_quality);
     LOG_INFO_("\n");
 }
 /*-------------------------------------------------------------------------------------------------------------------*/
-void tm_update_task_throughput(edge_resource_t* edge, edge_capability_t* cap, const tm_throughput_info_t* info)
+void tm_model_update_task_throughput(edge_resource_t* edge, edge_capability_t* cap, const tm_throughput_info_t* info)
 {
     const bool was_bad = !cap->tm.throughput_good;
 
-    capability_t* global_cap = capability_info_find(cap->name);
+    capability_t* global_cap = capability_info_find(cap->id);
     if (global_cap == NULL)
     {
-        LOG_ERR("Failed to find per-capability trust information for %s\n", cap->name);
+        LOG_ERR("Failed to find per-capability trust information for %s\n", capability_id_name(cap->id));
     }
 
-    const float p1 = goodness_pge_local(edge, cap);
-    const float p2 = goodness_plt_global(edge, cap, global_cap);
+    const trust_real_t p1 = goodness_pge_local(edge, cap);
+    const trust_real_t p2 = goodness_plt_global(edge, cap, global_cap);
 
     const uint32_t max_count = MAX(cap->tm.throughput_in.count, cap->tm.throughput_out.count);
 
-    LOG_INFO("tm_update_task_throughput(%s, %s): pge=%f, plt=%f, |in|=%"PRIu32", |out|=%"PRIu32"\n",
-        edge_info_name(edge), cap->name,
-        p1, p2,
+    LOG_INFO("tm_model_update_task_throughput(%s, %s): pge=%f, plt=%f, |in|=%"PRIu32", |out|=%"PRIu32"\n",
+        edge_info_name(edge), capability_id_name(cap->id),
+        trust_real_to_float(p1), trust_real_to_float(p2),
         cap->tm.throughput_in.count, cap->tm.throughput_out.count);
 
     // Don't start excluding edges for the first few tasks
     // It takes time to build up the distributions appropriately
     if (max_count >= THROUGHPUT_EXCLUSION_THRESHOLD)
     {
-        if (p1 <= THROUGHPUT_LOCAL_LOWER && p2 < THROUGHPUT_GLOBAL_ACCEPTABLE)
+        if (p1 <= TRUST_REAL(THROUGHPUT_LOCAL_LOWER) && p2 < TRUST_REAL(THROUGHPUT_GLOBAL_ACCEPTABLE))
         {
-            LOG_INFO("Goodness of throughput = %f, goodness p2 = %f, setting to bad\n", p1, p2);
+            LOG_INFO("Goodness of throughput = %f, goodness p2 = %f, setting to bad\n",
+                trust_real_to_float(p1), trust_real_to_float(p2));
             cap->tm.throughput_good = false;
             cap->tm.throughput_last_became_bad = clock_time();
         }
-        else if (p1 >= THROUGHPUT_LOCAL_HIGHER && p2 >= THROUGHPUT_GLOBAL_ACCEPTABLE)
+        else if (p1 >= TRUST_REAL(THROUGHPUT_LOCAL_HIGHER) && p2 >= TRUST_REAL(THROUGHPUT_GLOBAL_ACCEPTABLE))
         {
-            LOG_INFO("Goodness of throughput = %f, goodness p2 = %f, setting to good\n", p1, p2);
+            LOG_INFO("Goodness of throughput = %f, goodness p2 = %f, setting to good\n",
+                trust_real_to_float(p1), trust_real_to_float(p2));
             cap->tm.throughput_good = true;
 
             if (was_bad)
@@ -389,11 +398,11 @@ void tm_update_task_throughput(edge_resource_t* edge, edge_capability_t* cap, co
                 // Update the time between changes
                 exponential_dist_mle_update(
                     &cap->tm.throughput_goodness_change,
-                    time_between_change);
+                    trust_wide_from_uint(time_between_change));
 
                 LOG_INFO_(" to ");
                 exponential_dist_print(&cap->tm.throughput_goodness_change);
-                LOG_INFO_(" [time_between_change=%"PRIu32"]\n", time_between_change);
+                LOG_INFO_(" [time_between_change=%"PRIu32"]\n", (uint32_t)time_between_change);
             }
         }
         else
@@ -410,7 +419,7 @@ void tm_update_task_throughput(edge_resource_t* edge, edge_capability_t* cap, co
                 exponential_dist_print(&cap->tm.throughput_goodness_change);
 
                 // Update the time between changes
-                cap->tm.throughput_goodness_change.lambda /= 2.0f;
+                cap->tm.throughput_goodness_change.mean *= 2;
 
                 LOG_INFO_(" to ");
                 exponential_dist_print(&cap->tm.throughput_goodness_change);
@@ -423,20 +432,22 @@ void tm_update_task_throughput(edge_resource_t* edge, edge_capability_t* cap, co
     }
     else
     {
-        LOG_INFO("Goodness of throughput = %f, goodness p2 = %f, not changing goodness\n", p1, p2);
+        LOG_INFO("Goodness of throughput = %f, goodness p2 = %f, not changing goodness\n",
+            trust_real_to_float(p1), trust_real_to_float(p2));
     }
 
     if (info->direction == TM_THROUGHPUT_IN)
     {
         LOG_INFO("Updating Edge %s capability %s TM throughput in (%" PRIu32 " bytes/second): ",
-            edge_info_name(edge), cap->name, info->throughput);
+            edge_info_name(edge), capability_id_name(cap->id), info->throughput);
         gaussian_dist_print(&cap->tm.throughput_in);
         LOG_INFO_(" ewma:");
         gaussian_dist_print(&cap->tm.throughput_in_ewma);
         LOG_INFO_(" -> ");
 
-        gaussian_dist_update(&cap->tm.throughput_in, info->throughput);
-        gaussian_dist_update_ewma(&cap->tm.throughput_in_ewma, info->throughput, THROUGHPUT_EWMA_WEIGHT);
+        gaussian_dist_update(&cap->tm.throughput_in, trust_wide_from_uint(info->throughput));
+        gaussian_dist_update_ewma(&cap->tm.throughput_in_ewma, trust_wide_from_uint(info->throughput),
+            TRUST_REAL(THROUGHPUT_EWMA_WEIGHT));
 
         gaussian_dist_print(&cap->tm.throughput_in);
         LOG_INFO_(" ewma:");
@@ -446,10 +457,10 @@ void tm_update_task_throughput(edge_resource_t* edge, edge_capability_t* cap, co
         if (global_cap)
         {
             LOG_INFO("Updating Global capability %s TM throughput in (%" PRIu32 " bytes/second): ",
-            global_cap->name, info->throughput);
+            capability_id_name(global_cap->id), info->throughput);
             gaussian_dist_print(&global_cap->tm.throughput_in);
             LOG_INFO_(" -> ");
-            gaussian_dist_update(&global_cap->tm.throughput_in, info->throughput);
+            gaussian_dist_update(&global_cap->tm.throughput_in, trust_wide_from_uint(info->throughput));
             gaussian_dist_print(&global_cap->tm.throughput_in);
             LOG_INFO_("\n");
         }
@@ -457,14 +468,15 @@ void tm_update_task_throughput(edge_resource_t* edge, edge_capability_t* cap, co
     else if (info->direction == TM_THROUGHPUT_OUT)
     {
         LOG_INFO("Updating Edge %s capability %s TM throughput out (%" PRIu32 " bytes/second): ",
-        edge_info_name(edge), cap->name, info->throughput);
+        edge_info_name(edge), capability_id_name(cap->id), info->throughput);
         gaussian_dist_print(&cap->tm.throughput_out);
         LOG_INFO_(" ewma:");
         gaussian_dist_print(&cap->tm.throughput_out_ewma);
         LOG_INFO_(" -> ");
 
-        gaussian_dist_update(&cap->tm.throughput_out, info->throughput);
-        gaussian_dist_update_ewma(&cap->tm.throughput_out_ewma, info->throughput, THROUGHPUT_EWMA_WEIGHT);
+        gaussian_dist_update(&cap->tm.throughput_out, trust_wide_from_uint(info->throughput));
+        gaussian_dist_update_ewma(&cap->tm.throughput_out_ewma, trust_wide_from_uint(info->throughput),
+            TRUST_REAL(THROUGHPUT_EWMA_WEIGHT));
 
         gaussian_dist_print(&cap->tm.throughput_out);
         LOG_INFO_(" ewma:");
@@ -474,10 +486,10 @@ void tm_update_task_throughput(edge_resource_t* edge, edge_capability_t* cap, co
         if (global_cap)
         {
             LOG_INFO("Updating Global capability %s TM throughput out (%" PRIu32 " bytes/second): ",
-            global_cap->name, info->throughput);
+            capability_id_name(global_cap->id), info->throughput);
             gaussian_dist_print(&global_cap->tm.throughput_out);
             LOG_INFO_(" -> ");
-            gaussian_dist_update(&global_cap->tm.throughput_out, info->throughput);
+            gaussian_dist_update(&global_cap->tm.throughput_out, trust_wide_from_uint(info->throughput));
             gaussian_dist_print(&global_cap->tm.throughput_out);
             LOG_INFO_("\n");
         }
@@ -486,10 +498,13 @@ void tm_update_task_throughput(edge_resource_t* edge, edge_capability_t* cap, co
     {
         LOG_ERR("Unknown throughput direction\n");
     }
+
+    // Every observation is folded into the throughput distributions, and may change the goodness
+    edge_info_capability_tm_changed(cap);
 }
 /*-------------------------------------------------------------------------------------------------------------------*/
 #ifdef APPLICATION_CHALLENGE_RESPONSE
-void tm_update_challenge_response(edge_resource_t* edge, const tm_challenge_response_info_t* info)
+void tm_model_update_challenge_response(edge_resource_t* edge, const tm_challenge_response_info_t* info)
 {
     bool should_update;
     const bool good = tm_challenge_response_good(info, &should_update);
@@ -499,7 +514,7 @@ void tm_update_challenge_response(edge_resource_t* edge, const tm_challenge_resp
         return;
     }
 
-    edge_capability_t* cap = edge_info_capability_find(edge, CHALLENGE_RESPONSE_APPLICATION_NAME);
+    edge_capability_t* cap = edge_info_capability_find(edge, CHALLENGE_RESPONSE_APPLICATION_ID);
     if (cap == NULL)
     {
         LOG_ERR("Failed to find cr application\n");
@@ -507,7 +522,7 @@ void tm_update_challenge_response(edge_resource_t* edge, const tm_challenge_resp
     }
 
     const tm_result_quality_info_t info2 = { .good = good };
-    tm_update_result_quality(edge, cap, &info2);
+    tm_model_update_result_quality(edge, cap, &info2);
 }
 #endif
 /*-------------------------------------------------------------------------------------------------------------------*/
@@ -525,16 +540,16 @@ bool edge_capability_is_good(struct edge_resource* edge, struct edge_capability*
 
     // What is the likelihood we have become good again?
     // May still be bad, but could be worth trying this edge node again
-    const float cdf = exponential_dist_cdf(
+    const trust_real_t cdf = exponential_dist_cdf(
         &capability->tm.throughput_goodness_change,
-        time_between_change);
+        trust_wide_from_uint(time_between_change));
 
     LOG_INFO("Considering if bad Edge %s Capability %s has become good. Time between change = %" PRIu32 "s. Pr(X <= TBC) = %f, X ~ Exp(1/%f)",
-        edge_info_name(edge), capability->name,
-        time_between_change / CLOCK_SECOND,
-        cdf, 1.0f/capability->tm.throughput_goodness_change.lambda);
+        edge_info_name(edge), capability_id_name(capability->id),
+        (uint32_t)(time_between_change / CLOCK_SECOND),
+        trust_real_to_float(cdf), trust_wide_to_float(capability->tm.throughput_goodness_change.mean));
 
-    return cdf >= EXPECTED_TIME_THROUGHPUT_BAD_TO_GOOD_PR;
+    return cdf >= TRUST_REAL(EXPECTED_TIME_THROUGHPUT_BAD_TO_GOOD_PR);
 }
 /*-------------------------------------------------------------------------------------------------------------------*/
 int serialise_trust_edge_resource(nanocbor_encoder_t* enc, const edge_resource_tm_t* edge)
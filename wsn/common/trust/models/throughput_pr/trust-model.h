@@ -10,6 +10,7 @@
 #define TRUST_MODEL_NO_PEER_PROVIDED
 #define TRUST_MODEL_NO_PERIODIC_BROADCAST
 #define TRUST_MODEL_HAS_PER_CAPABILITY_INFO
+#define TRUST_MODEL_HAS_TM_REBASE
 
 #ifndef APPLICATIONS_MONITOR_THROUGHPUT
 #error "Must define APPLICATIONS_MONITOR_THROUGHPUT"
@@ -54,6 +55,12 @@ typedef struct edge_capability_tm {
 void edge_capability_tm_init(edge_capability_tm_t* tm);
 void edge_capability_tm_print(const edge_capability_tm_t* tm);
 /*-------------------------------------------------------------------------------------------------------------------*/
+// The clocks restart at boot, so the times held by restored records are moved along by the shift (see trust-snapshot.h)
+#ifdef TRUST_MODEL_HAS_TM_REBASE
+void edge_resource_tm_rebase(edge_resource_tm_t* tm, int32_t time_shift, int32_t seconds_shift);
+void edge_capability_tm_rebase(edge_capability_tm_t* tm, int32_t time_shift, int32_t seconds_shift);
+#endif
+/*-------------------------------------------------------------------------------------------------------------------*/
 
 /*-------------------------------------------------------------------------------------------------------------------*/
 typedef struct peer_tm {
@@ -81,7 +88,7 @@ bool edge_capability_is_good(struct edge_resource* edge, struct edge_capability*
 /*-------------------------------------------------------------------------------------------------------------------*/
 
 /*-------------------------------------------------------------------------------------------------------------------*/
-float calculate_trust_value(struct edge_resource* edge, struct edge_capability* capability);
+trust_real_t calculate_trust_value(struct edge_resource* edge, struct edge_capability* capability);
 /*-------------------------------------------------------------------------------------------------------------------*/
 
 /*-------------------------------------------------------------------------------------------------------------------*/
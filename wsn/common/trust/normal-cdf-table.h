@@ -0,0 +1,63 @@
+// Generated by tools/gen_normal_cdf_table.py, do not edit
+#pragma once
+/*-------------------------------------------------------------------------------------------------------------------*/
+#include <stdint.h>
+/*-------------------------------------------------------------------------------------------------------------------*/
+#define NORMAL_CDF_TABLE_STEPS_LOG2 6
+#define NORMAL_CDF_TABLE_STEPS (1 << NORMAL_CDF_TABLE_STEPS_LOG2)
+#define NORMAL_CDF_TABLE_MAX_Z 6
+#define NORMAL_CDF_TABLE_LEN (NORMAL_CDF_TABLE_MAX_Z * NORMAL_CDF_TABLE_STEPS + 1)
+/*-------------------------------------------------------------------------------------------------------------------*/
+// Q(z) = 1 - Phi(z) in Q0.16 for z = i / NORMAL_CDF_TABLE_STEPS
+static const uint16_t normal_cdf_table[NORMAL_CDF_TABLE_LEN] = {
+    32768, 32359, 31951, 31543, 31135, 30727, 30320, 29914,
+    29508, 29103, 28699, 28296, 27894, 27494, 27094, 26696,
+    26299, 25904, 25510, 25119, 24729, 24341, 23955, 23570,
+    23189, 22809, 22432, 22057, 21684, 21314, 20947, 20582,
+    20220, 19861, 19505, 19152, 18801, 18454, 18110, 17769,
+    17432, 17097, 16766, 16439, 16114, 15793, 15476, 15162,
+    14852, 14546, 14243, 13944, 13648, 13356, 13068, 12784,
+    12503, 12227, 11954, 11685, 11420, 11158, 10901, 10647,
+    10398, 10152,  9910,  9672,  9437,  9207,  8981,  8758,
+     8539,  8324,  8113,  7905,  7701,  7502,  7305,  7113,
+     6924,  6739,  6557,  6379,  6205,  6034,  5866,  5703,
+     5542,  5385,  5231,  5081,  4934,  4790,  4650,  4512,
+     4378,  4247,  4119,  3994,  3872,  3753,  3637,  3524,
+     3413,  3305,  3200,  3098,  2999,  2901,  2807,  2715,
+     2625,  2538,  2453,  2371,  2291,  2213,  2137,  2064,
+     1992,  1923,  1855,  1790,  1726,  1665,  1605,  1547,
+     1491,  1437,  1384,  1333,  1283,  1235,  1189,  1144,
+     1101,  1059,  1018,   979,   941,   904,   868,   834,
+      801,   769,   738,   709,   680,   652,   626,   600,
+      575,   551,   528,   506,   485,   464,   444,   425,
+      407,   389,   372,   356,   341,   326,   311,   297,
+      284,   271,   259,   247,   236,   225,   215,   205,
+      195,   186,   177,   169,   161,   153,   146,   139,
+      132,   126,   120,   114,   108,   103,    98,    93,
+       88,    84,    80,    76,    72,    68,    65,    61,
+       58,    55,    52,    50,    47,    45,    42,    40,
+       38,    36,    34,    32,    30,    29,    27,    26,
+       24,    23,    22,    20,    19,    18,    17,    16,
+       15,    14,    14,    13,    12,    11,    11,    10,
+        9,     9,     8,     8,     7,     7,     7,     6,
+        6,     5,     5,     5,     5,     4,     4,     4,
+        3,     3,     3,     3,     3,     3,     2,     2,
+        2,     2,     2,     2,     2,     1,     1,     1,
+        1,     1,     1,     1,     1,     1,     1,     1,
+        1,     1,     1,     1,     1,     0,     0,     0,
+        0,     0,     0,     0,     0,     0,     0,     0,
+        0,     0,     0,     0,     0,     0,     0,     0,
+        0,     0,     0,     0,     0,     0,     0,     0,
+        0,     0,     0,     0,     0,     0,     0,     0,
+        0,     0,     0,     0,     0,     0,     0,     0,
+        0,     0,     0,     0,     0,     0,     0,     0,
+        0,     0,     0,     0,     0,     0,     0,     0,
+        0,     0,     0,     0,     0,     0,     0,     0,
+        0,     0,     0,     0,     0,     0,     0,     0,
+        0,     0,     0,     0,     0,     0,     0,     0,
+        0,     0,     0,     0,     0,     0,     0,     0,
+        0,     0,     0,     0,     0,     0,     0,     0,
+        0,     0,     0,     0,     0,     0,     0,     0,
+        0,
+};
+/*-------------------------------------------------------------------------------------------------------------------*/
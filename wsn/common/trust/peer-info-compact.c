@@ -0,0 +1,404 @@
+#include "peer-info.h"
+#include "trust-models.h"
+/*-------------------------------------------------------------------------------------------------------------------*/
+#include <string.h>
+/*-------------------------------------------------------------------------------------------------------------------*/
+#include "os/sys/log.h"
+/*-------------------------------------------------------------------------------------------------------------------*/
+#define LOG_MODULE "trust-peer"
+#ifdef TRUST_MODEL_LOG_LEVEL
+#define LOG_LEVEL TRUST_MODEL_LOG_LEVEL
+#else
+#define LOG_LEVEL LOG_LEVEL_NONE
+#endif
+/*-------------------------------------------------------------------------------------------------------------------*/
+#ifdef PEER_INFO_COMPACT
+/*-------------------------------------------------------------------------------------------------------------------*/
+_Static_assert(NUM_PEERS <= UINT8_MAX, "Number of peers must fit in a uint8_t");
+_Static_assert(PEER_INFO_EDGE_SLOTS < PEER_INFO_INDEX_INVALID, "Edge slots must be addressable by peer_info_index_t");
+_Static_assert(PEER_INFO_CAPABILITY_SLOTS < PEER_INFO_INDEX_INVALID, "Capability slots must be addressable by peer_info_index_t");
+/*-------------------------------------------------------------------------------------------------------------------*/
+// Records stay in the slot they were allocated in, as callers hold pointers to them.
+// Free edge and capability slots are linked through next.
+static peer_t peers[NUM_PEERS];
+static uint8_t peers_used[(NUM_PEERS + 7) / 8];
+
+static peer_edge_t peer_edges[PEER_INFO_EDGE_SLOTS];
+static peer_info_index_t free_peer_edges;
+
+static peer_edge_capability_t peer_capabilities[PEER_INFO_CAPABILITY_SLOTS];
+static peer_info_index_t free_peer_capabilities;
+/*-------------------------------------------------------------------------------------------------------------------*/
+static bool
+peer_is_used(uint8_t idx)
+{
+    return (peers_used[idx / 8] & (1u << (idx % 8))) != 0;
+}
+/*-------------------------------------------------------------------------------------------------------------------*/
+static void
+peer_set_used(uint8_t idx, bool used)
+{
+    if (used)
+    {
+        peers_used[idx / 8] |= (1u << (idx % 8));
+    }
+    else
+    {
+        peers_used[idx / 8] &= ~(1u << (idx % 8));
+    }
+}
+/*-------------------------------------------------------------------------------------------------------------------*/
+// Frees a chain of capabilities, starting at idx
+static void
+peer_capabilities_free(peer_info_index_t idx)
+{
+    while (idx != PEER_INFO_INDEX_INVALID)
+    {
+        peer_edge_capability_t* const peer_cap = &peer_capabilities[idx];
+        const peer_info_index_t next = peer_cap->next;
+
+        peer_cap->cap = NULL;
+        peer_cap->next = free_peer_capabilities;
+        free_peer_capabilities = idx;
+
+        idx = next;
+    }
+}
+/*-------------------------------------------------------------------------------------------------------------------*/
+// Frees a single edge and its capabilities, it must already have been unlinked from its peer
+static void
+peer_edge_free(peer_info_index_t idx)
+{
+    peer_edge_t* const peer_edge = &peer_edges[idx];
+
+    peer_capabilities_free(peer_edge->capabilities);
+    peer_edge->capabilities = PEER_INFO_INDEX_INVALID;
+
+    peer_edge->edge = NULL;
+    peer_edge->next = free_peer_edges;
+    free_peer_edges = idx;
+}
+/*-------------------------------------------------------------------------------------------------------------------*/
+static uint8_t
+peer_edges_length(const peer_t* peer)
+{
+    uint8_t length = 0;
+
+    for (peer_info_index_t idx = peer->edges; idx != PEER_INFO_INDEX_INVALID; idx = peer_edges[idx].next)
+    {
+        length++;
+    }
+
+    return length;
+}
+/*-------------------------------------------------------------------------------------------------------------------*/
+static uint8_t
+peer_capabilities_length(const peer_edge_t* peer_edge)
+{
+    uint8_t length = 0;
+
+    for (peer_info_index_t idx = peer_edge->capabilities; idx != PEER_INFO_INDEX_INVALID; idx = peer_capabilities[idx].next)
+    {
+        length++;
+    }
+
+    return length;
+}
+/*-------------------------------------------------------------------------------------------------------------------*/
+void peer_info_init(void)
+{
+    LOG_DBG("Initialising peer info (compact, %u edge slots, %u capability slots)\n",
+        (unsigned int)PEER_INFO_EDGE_SLOTS, (unsigned int)PEER_INFO_CAPABILITY_SLOTS);
+
+    memset(peers_used, 0, sizeof(peers_used));
+
+    free_peer_edges = PEER_INFO_EDGE_SLOTS == 0 ? PEER_INFO_INDEX_INVALID : 0;
+    for (peer_info_index_t i = 0; i != PEER_INFO_EDGE_SLOTS; ++i)
+    {
+        peer_edges[i].edge = NULL;
+        peer_edges[i].next = (i + 1 == PEER_INFO_EDGE_SLOTS) ? PEER_INFO_INDEX_INVALID : i + 1;
+    }
+
+    free_peer_capabilities = PEER_INFO_CAPABILITY_SLOTS == 0 ? PEER_INFO_INDEX_INVALID : 0;
+    for (peer_info_index_t i = 0; i != PEER_INFO_CAPABILITY_SLOTS; ++i)
+    {
+        peer_capabilities[i].cap = NULL;
+        peer_capabilities[i].next = (i + 1 == PEER_INFO_CAPABILITY_SLOTS) ? PEER_INFO_INDEX_INVALID : i + 1;
+    }
+}
+/*-------------------------------------------------------------------------------------------------------------------*/
+peer_t*
+peer_info_add(const uip_ipaddr_t* addr)
+{
+    peer_t* peer;
+
+#ifdef TRUST_MODEL_NO_PEER_PROVIDED
+    LOG_ERR("Cannot add peer information as we have been built with TRUST_MODEL_NO_PEER_PROVIDED\n");
+    return NULL;
+#endif
+
+    // First lets check if we already have a record of this peer
+    peer = peer_info_find(addr);
+    if (peer != NULL)
+    {
+        return peer;
+    }
+
+    uint8_t idx;
+    for (idx = 0; idx != NUM_PEERS && peer_is_used(idx); ++idx)
+    {
+    }
+
+    if (idx == NUM_PEERS)
+    {
+        LOG_ERR("peer_info_add: out of memory\n");
+        return NULL;
+    }
+
+    peer_set_used(idx, true);
+    peer = &peers[idx];
+
+    peer_tm_init(&peer->tm);
+
+    uip_ipaddr_copy(&peer->addr, addr);
+    peer->last_seen = PEER_LAST_SEEN_INVALID;
+    peer->edges = PEER_INFO_INDEX_INVALID;
+
+    return peer;
+}
+/*-------------------------------------------------------------------------------------------------------------------*/
+void
+peer_info_remove(peer_t* peer)
+{
+    peer_info_index_t idx = peer->edges;
+    while (idx != PEER_INFO_INDEX_INVALID)
+    {
+        const peer_info_index_t next = peer_edges[idx].next;
+        peer_edge_free(idx);
+        idx = next;
+    }
+
+    peer->edges = PEER_INFO_INDEX_INVALID;
+
+    peer_set_used((uint8_t)(peer - peers), false);
+
+    trust_cache_invalidate_all();
+}
+/*-------------------------------------------------------------------------------------------------------------------*/
+void peer_info_remove_edges(edge_resource_t* edge)
+{
+    // Remove information about the provided edge from each peer
+    for (peer_t* peer = peer_info_iter(); peer != NULL; peer = peer_info_next(peer))
+    {
+        peer_info_index_t* link = &peer->edges;
+
+        while (*link != PEER_INFO_INDEX_INVALID)
+        {
+            const peer_info_index_t idx = *link;
+
+            if (peer_edges[idx].edge == edge)
+            {
+                *link = peer_edges[idx].next;
+                peer_edge_free(idx);
+            }
+            else
+            {
+                link = &peer_edges[idx].next;
+            }
+        }
+    }
+}
+/*-------------------------------------------------------------------------------------------------------------------*/
+void peer_info_remove_capabilities(edge_capability_t* cap)
+{
+    // Remove information about the provided capability from each peer
+    for (peer_t* peer = peer_info_iter(); peer != NULL; peer = peer_info_next(peer))
+    {
+        for (peer_info_index_t eidx = peer->edges; eidx != PEER_INFO_INDEX_INVALID; eidx = peer_edges[eidx].next)
+        {
+            peer_info_index_t* link = &peer_edges[eidx].capabilities;
+
+            while (*link != PEER_INFO_INDEX_INVALID)
+            {
+                const peer_info_index_t idx = *link;
+
+                if (peer_capabilities[idx].cap == cap)
+                {
+                    // An edge holds at most one record of a capability
+                    *link = peer_capabilities[idx].next;
+                    peer_capabilities[idx].next = PEER_INFO_INDEX_INVALID;
+                    peer_capabilities_free(idx);
+                    break;
+                }
+
+                link = &peer_capabilities[idx].next;
+            }
+        }
+    }
+}
+/*-------------------------------------------------------------------------------------------------------------------*/
+static peer_t*
+peer_info_used_from(uint8_t idx)
+{
+    for (; idx < NUM_PEERS; ++idx)
+    {
+        if (peer_is_used(idx))
+        {
+            return &peers[idx];
+        }
+    }
+
+    return NULL;
+}
+/*-------------------------------------------------------------------------------------------------------------------*/
+peer_t*
+peer_info_iter(void)
+{
+    return peer_info_used_from(0);
+}
+/*-------------------------------------------------------------------------------------------------------------------*/
+peer_t*
+peer_info_next(peer_t* iter)
+{
+    return peer_info_used_from((uint8_t)(iter - peers) + 1);
+}
+/*-------------------------------------------------------------------------------------------------------------------*/
+peer_t*
+peer_info_find(const uip_ipaddr_t* addr)
+{
+    for (uint8_t i = 0; i != NUM_PEERS; ++i)
+    {
+        if (peer_is_used(i) && uip_ip6addr_cmp(&peers[i].addr, addr))
+        {
+            return &peers[i];
+        }
+    }
+
+    return NULL;
+}
+/*-------------------------------------------------------------------------------------------------------------------*/
+peer_edge_t* peer_info_find_edge(peer_t* peer, edge_resource_t* edge)
+{
+    for (peer_info_index_t idx = peer->edges; idx != PEER_INFO_INDEX_INVALID; idx = peer_edges[idx].next)
+    {
+        if (peer_edges[idx].edge == edge)
+        {
+            return &peer_edges[idx];
+        }
+    }
+
+    return NULL;
+}
+/*-------------------------------------------------------------------------------------------------------------------*/
+peer_edge_t* peer_info_find_edge_or_allocate(peer_t* peer, edge_resource_t* edge)
+{
+    peer_edge_t* peer_edge = peer_info_find_edge(peer, edge);
+
+    if (peer_edge == NULL)
+    {
+        // Check that this node has not allocated more than its fair share of edges
+        if (peer_edges_length(peer) >= NUM_EDGE_RESOURCES)
+        {
+            return NULL;
+        }
+
+        if (free_peer_edges == PEER_INFO_INDEX_INVALID)
+        {
+            return NULL;
+        }
+
+        const peer_info_index_t idx = free_peer_edges;
+        free_peer_edges = peer_edges[idx].next;
+
+        peer_edge = &peer_edges[idx];
+        peer_edge->edge = edge;
+        peer_edge->version = 0;
+        peer_edge->capabilities = PEER_INFO_INDEX_INVALID;
+
+        // Keep in canonical order
+        peer_info_index_t* link = &peer->edges;
+        while (*link != PEER_INFO_INDEX_INVALID && edge_info_compare(peer_edges[*link].edge, edge) < 0)
+        {
+            link = &peer_edges[*link].next;
+        }
+
+        peer_edge->next = *link;
+        *link = idx;
+    }
+
+    return peer_edge;
+}
+/*-------------------------------------------------------------------------------------------------------------------*/
+peer_edge_capability_t* peer_info_find_capability(peer_edge_t* peer_edge, edge_capability_t* cap)
+{
+    for (peer_info_index_t idx = peer_edge->capabilities; idx != PEER_INFO_INDEX_INVALID; idx = peer_capabilities[idx].next)
+    {
+        if (peer_capabilities[idx].cap == cap)
+        {
+            return &peer_capabilities[idx];
+        }
+    }
+
+    return NULL;
+}
+/*-------------------------------------------------------------------------------------------------------------------*/
+peer_edge_capability_t* peer_info_find_capability_or_allocate(peer_edge_t* peer_edge, edge_capability_t* cap)
+{
+    peer_edge_capability_t* peer_cap = peer_info_find_capability(peer_edge, cap);
+
+    if (peer_cap == NULL)
+    {
+        // Check that this node has not allocated more than its fair share of edge capabilities
+        if (peer_capabilities_length(peer_edge) >= NUM_EDGE_CAPABILITIES)
+        {
+            return NULL;
+        }
+
+        if (free_peer_capabilities == PEER_INFO_INDEX_INVALID)
+        {
+            return NULL;
+        }
+
+        const peer_info_index_t idx = free_peer_capabilities;
+        free_peer_capabilities = peer_capabilities[idx].next;
+
+        peer_cap = &peer_capabilities[idx];
+        peer_cap->cap = cap;
+        peer_cap->version = 0;
+
+        // Keep in canonical order
+        peer_info_index_t* link = &peer_edge->capabilities;
+        while (*link != PEER_INFO_INDEX_INVALID && capability_id_compare(peer_capabilities[*link].cap->id, cap->id) < 0)
+        {
+            link = &peer_capabilities[*link].next;
+        }
+
+        peer_cap->next = *link;
+        *link = idx;
+    }
+
+    return peer_cap;
+}
+/*-------------------------------------------------------------------------------------------------------------------*/
+peer_edge_t* peer_info_edges_head(peer_t* peer)
+{
+    return peer->edges == PEER_INFO_INDEX_INVALID ? NULL : &peer_edges[peer->edges];
+}
+/*-------------------------------------------------------------------------------------------------------------------*/
+peer_edge_t* peer_info_edges_next(peer_edge_t* peer_edge)
+{
+    return peer_edge->next == PEER_INFO_INDEX_INVALID ? NULL : &peer_edges[peer_edge->next];
+}
+/*-------------------------------------------------------------------------------------------------------------------*/
+peer_edge_capability_t* peer_info_capabilities_head(peer_edge_t* peer_edge)
+{
+    return peer_edge->capabilities == PEER_INFO_INDEX_INVALID ? NULL : &peer_capabilities[peer_edge->capabilities];
+}
+/*-------------------------------------------------------------------------------------------------------------------*/
+peer_edge_capability_t* peer_info_capabilities_next(peer_edge_capability_t* peer_cap)
+{
+    return peer_cap->next == PEER_INFO_INDEX_INVALID ? NULL : &peer_capabilities[peer_cap->next];
+}
+/*-------------------------------------------------------------------------------------------------------------------*/
+#endif /* PEER_INFO_COMPACT */
+/*-------------------------------------------------------------------------------------------------------------------*/
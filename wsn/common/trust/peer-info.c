@@ -1,8 +1,10 @@
 #include "peer-info.h"
+#include "trust-models.h"
 /*-------------------------------------------------------------------------------------------------------------------*/
 #include "lib/list.h"
 #include "lib/memb.h"
 #include "os/sys/log.h"
+#include "assert.h"
 /*-------------------------------------------------------------------------------------------------------------------*/
 #define LOG_MODULE "trust-peer"
 #ifdef TRUST_MODEL_LOG_LEVEL
@@ -12,14 +14,11 @@
 #endif
 /*-------------------------------------------------------------------------------------------------------------------*/
 #ifdef TRUST_MODEL_NO_PEER_PROVIDED
-#   define NUM_PEERS 0
 #   pragma message "No space for peer-provided information has been allocated"
-#else
-#   ifndef NUM_PEERS
-#       define NUM_PEERS 8
-#   endif
 #endif
 /*-------------------------------------------------------------------------------------------------------------------*/
+#ifndef PEER_INFO_COMPACT
+/*-------------------------------------------------------------------------------------------------------------------*/
 MEMB(peers_memb, peer_t, NUM_PEERS);
 MEMB(peer_edges_memb, peer_edge_t, NUM_PEERS * NUM_EDGE_RESOURCES);
 MEMB(peer_capabilities_memb, peer_edge_capability_t, NUM_PEERS * NUM_EDGE_RESOURCES * NUM_EDGE_CAPABILITIES);
@@ -152,6 +151,8 @@ peer_info_remove(peer_t* peer)
     list_remove(peers, peer);
 
     peer_free(peer);
+
+    trust_cache_invalidate_all();
 }
 /*-------------------------------------------------------------------------------------------------------------------*/
 void peer_info_remove_edges(edge_resource_t* edge)
@@ -165,6 +166,7 @@ void peer_info_remove_edges(edge_resource_t* edge)
 
             if (iter->edge == edge)
             {
+                list_remove(peer->edges, iter);
                 peer_edge_free(iter);
             }
 
@@ -173,6 +175,23 @@ void peer_info_remove_edges(edge_resource_t* edge)
     }
 }
 /*-------------------------------------------------------------------------------------------------------------------*/
+void peer_info_remove_capabilities(edge_capability_t* cap)
+{
+    // Remove information about the provided capability from each peer
+    for (peer_t* peer = list_head(peers); peer != NULL; peer = list_item_next(peer))
+    {
+        for (peer_edge_t* peer_edge = list_head(peer->edges); peer_edge != NULL; peer_edge = list_item_next(peer_edge))
+        {
+            peer_edge_capability_t* const peer_cap = peer_info_find_capability(peer_edge, cap);
+            if (peer_cap != NULL)
+            {
+                list_remove(peer_edge->capabilities, peer_cap);
+                peer_capability_free(peer_cap);
+            }
+        }
+    }
+}
+/*-------------------------------------------------------------------------------------------------------------------*/
 peer_t*
 peer_info_iter(void)
 {
@@ -212,7 +231,7 @@ peer_edge_t* peer_info_find_edge(peer_t* peer, edge_resource_t* edge)
     return NULL;
 }
 /*-------------------------------------------------------------------------------------------------------------------*/
-static peer_edge_t* peer_info_find_edge_or_allocate(peer_t* peer, edge_resource_t* edge)
+peer_edge_t* peer_info_find_edge_or_allocate(peer_t* peer, edge_resource_t* edge)
 {
     peer_edge_t* peer_edge = peer_info_find_edge(peer, edge);
 
@@ -234,7 +253,14 @@ static peer_edge_t* peer_info_find_edge_or_allocate(peer_t* peer, edge_resource_
 
         peer_edge->edge = edge;
 
-        list_push(peer->edges, peer_edge);
+        // Keep in canonical order
+        peer_edge_t* prev = NULL;
+        for (peer_edge_t* iter = list_head(peer->edges); iter != NULL && edge_info_compare(iter->edge, edge) < 0; iter = list_item_next(iter))
+        {
+            prev = iter;
+        }
+
+        list_insert(peer->edges, prev, peer_edge);
     }
 
     return peer_edge;
@@ -253,7 +279,7 @@ peer_edge_capability_t* peer_info_find_capability(peer_edge_t* peer_edge, edge_c
     return NULL;
 }
 /*-------------------------------------------------------------------------------------------------------------------*/
-static peer_edge_capability_t* peer_info_find_capability_or_allocate(peer_edge_t* peer_edge, edge_capability_t* cap)
+peer_edge_capability_t* peer_info_find_capability_or_allocate(peer_edge_t* peer_edge, edge_capability_t* cap)
 {
     peer_edge_capability_t* peer_cap = peer_info_find_capability(peer_edge, cap);
 
@@ -273,53 +299,216 @@ static peer_edge_capability_t* peer_info_find_capability_or_allocate(peer_edge_t
 
         peer_cap->cap = cap;
 
-        list_push(peer_edge->capabilities, peer_cap);
+        // Keep in canonical order
+        peer_edge_capability_t* prev = NULL;
+        for (peer_edge_capability_t* iter = list_head(peer_edge->capabilities); iter != NULL && capability_id_compare(iter->cap->id, cap->id) < 0; iter = list_item_next(iter))
+        {
+            prev = iter;
+        }
+
+        list_insert(peer_edge->capabilities, prev, peer_cap);
     }
 
     return peer_cap;
 }
 /*-------------------------------------------------------------------------------------------------------------------*/
-bool peer_info_update_edge(peer_t* peer, edge_resource_t* edge, const edge_resource_tm_t* tm)
+peer_edge_t* peer_info_edges_head(peer_t* peer)
 {
-    peer_edge_t* peer_edge = peer_info_find_edge_or_allocate(peer, edge);
-    if (peer_edge == NULL)
+    return list_head(peer->edges);
+}
+/*-------------------------------------------------------------------------------------------------------------------*/
+peer_edge_t* peer_info_edges_next(peer_edge_t* peer_edge)
+{
+    return list_item_next(peer_edge);
+}
+/*-------------------------------------------------------------------------------------------------------------------*/
+peer_edge_capability_t* peer_info_capabilities_head(peer_edge_t* peer_edge)
+{
+    return list_head(peer_edge->capabilities);
+}
+/*-------------------------------------------------------------------------------------------------------------------*/
+peer_edge_capability_t* peer_info_capabilities_next(peer_edge_capability_t* peer_cap)
+{
+    return list_item_next(peer_cap);
+}
+/*-------------------------------------------------------------------------------------------------------------------*/
+#endif /* PEER_INFO_COMPACT */
+/*-------------------------------------------------------------------------------------------------------------------*/
+// Versions wrap, so compare them as serial numbers
+static bool version_is_newer(uint8_t version, uint8_t current)
+{
+    return (int8_t)(uint8_t)(version - current) > 0;
+}
+/*-------------------------------------------------------------------------------------------------------------------*/
+bool peer_info_is_ordered(peer_t* peer)
+{
+    peer_edge_t* prev_edge = NULL;
+
+    for (peer_edge_t* peer_edge = peer_info_edges_head(peer); peer_edge != NULL; peer_edge = peer_info_edges_next(peer_edge))
+    {
+        if (prev_edge != NULL && edge_info_compare(prev_edge->edge, peer_edge->edge) >= 0)
+        {
+            return false;
+        }
+
+        peer_edge_capability_t* prev_cap = NULL;
+
+        for (peer_edge_capability_t* peer_cap = peer_info_capabilities_head(peer_edge); peer_cap != NULL; peer_cap = peer_info_capabilities_next(peer_cap))
+        {
+            if (prev_cap != NULL && capability_id_compare(prev_cap->cap->id, peer_cap->cap->id) >= 0)
+            {
+                return false;
+            }
+
+            prev_cap = peer_cap;
+        }
+
+        prev_edge = peer_edge;
+    }
+
+    return true;
+}
+/*-------------------------------------------------------------------------------------------------------------------*/
+void peer_info_merge_begin(peer_info_merge_t* merge, peer_t* peer)
+{
+    // Records of removed edges and capabilities are removed with them (see edge_info_remove),
+    // otherwise a reused record could be out of order and the merge would skip past records
+    assert(peer_info_is_ordered(peer));
+
+    merge->peer = peer;
+    merge->next_edge = peer_info_edges_head(peer);
+    merge->next_cap = NULL;
+
+    merge->edge = NULL;
+    merge->peer_edge = NULL;
+    merge->cap = NULL;
+    merge->peer_cap = NULL;
+}
+/*-------------------------------------------------------------------------------------------------------------------*/
+void peer_info_merge_edge(peer_info_merge_t* merge, edge_resource_t* edge)
+{
+    peer_edge_t* iter = merge->next_edge;
+
+    // Skip the peer's records of edges that are not in the payload
+    while (iter != NULL && edge_info_compare(iter->edge, edge) < 0)
     {
-        LOG_ERR("Out of memory peer_edges_memb\n");
-        return false;
+        iter = peer_info_edges_next(iter);
     }
 
-    peer_edge->tm = *tm;
+    if (iter != NULL && iter->edge == edge)
+    {
+        merge->peer_edge = iter;
+        merge->next_edge = peer_info_edges_next(iter);
+    }
+    else
+    {
+        // Not ahead of the cursor, so either absent or the payload is out of order
+        merge->peer_edge = peer_info_find_edge(merge->peer, edge);
+        merge->next_edge = iter;
+    }
+
+    merge->edge = edge;
+    merge->next_cap = merge->peer_edge != NULL ? peer_info_capabilities_head(merge->peer_edge) : NULL;
+
+    merge->cap = NULL;
+    merge->peer_cap = NULL;
+}
+/*-------------------------------------------------------------------------------------------------------------------*/
+void peer_info_merge_capability(peer_info_merge_t* merge, edge_capability_t* cap)
+{
+    merge->cap = cap;
+
+    if (merge->peer_edge == NULL)
+    {
+        merge->peer_cap = NULL;
+        return;
+    }
+
+    peer_edge_capability_t* iter = merge->next_cap;
+
+    while (iter != NULL && capability_id_compare(iter->cap->id, cap->id) < 0)
+    {
+        iter = peer_info_capabilities_next(iter);
+    }
+
+    if (iter != NULL && iter->cap == cap)
+    {
+        merge->peer_cap = iter;
+        merge->next_cap = peer_info_capabilities_next(iter);
+    }
+    else
+    {
+        merge->peer_cap = peer_info_find_capability(merge->peer_edge, cap);
+        merge->next_cap = iter;
+    }
+}
+/*-------------------------------------------------------------------------------------------------------------------*/
+bool peer_info_merge_edge_is_newer(const peer_info_merge_t* merge, uint8_t version)
+{
+    return merge->peer_edge == NULL || version_is_newer(version, merge->peer_edge->version);
+}
+/*-------------------------------------------------------------------------------------------------------------------*/
+bool peer_info_merge_capability_is_newer(const peer_info_merge_t* merge, uint8_t version)
+{
+    return merge->peer_cap == NULL || version_is_newer(version, merge->peer_cap->version);
+}
+/*-------------------------------------------------------------------------------------------------------------------*/
+bool peer_info_merge_update_edge(peer_info_merge_t* merge, uint8_t version, const edge_resource_tm_t* tm)
+{
+    if (merge->peer_edge == NULL)
+    {
+        merge->peer_edge = peer_info_find_edge_or_allocate(merge->peer, merge->edge);
+        if (merge->peer_edge == NULL)
+        {
+            LOG_ERR("Out of memory peer_edges_memb\n");
+            return false;
+        }
+    }
+
+    peer_edge_resource_tm_from(&merge->peer_edge->tm, tm);
+    merge->peer_edge->version = version;
+
+    trust_cache_invalidate_edge(merge->edge);
 
     LOG_DBG("Updated peer ");
-    LOG_DBG_6ADDR(&peer->addr);
-    LOG_DBG_(" edge '%s' to ", edge_info_name(edge));
+    LOG_DBG_6ADDR(&merge->peer->addr);
+    LOG_DBG_(" edge '%s' (v%" PRIu8 ") to ", edge_info_name(merge->edge), version);
     edge_resource_tm_print(tm);
     LOG_DBG_("\n");
 
     return true;
 }
 /*-------------------------------------------------------------------------------------------------------------------*/
-bool peer_info_update_capability(peer_t* peer, edge_resource_t* edge, edge_capability_t* cap, const edge_capability_tm_t* tm)
+bool peer_info_merge_update_capability(peer_info_merge_t* merge, uint8_t version, const edge_capability_tm_t* tm)
 {
-    peer_edge_t* peer_edge = peer_info_find_edge_or_allocate(peer, edge);
-    if (peer_edge == NULL)
+    if (merge->peer_edge == NULL)
     {
-        LOG_ERR("Out of memory peer_edges_memb\n");
-        return false;
+        merge->peer_edge = peer_info_find_edge_or_allocate(merge->peer, merge->edge);
+        if (merge->peer_edge == NULL)
+        {
+            LOG_ERR("Out of memory peer_edges_memb\n");
+            return false;
+        }
     }
 
-    peer_edge_capability_t* peer_cap = peer_info_find_capability_or_allocate(peer_edge, cap);
-    if (peer_cap == NULL)
+    if (merge->peer_cap == NULL)
     {
-        LOG_ERR("Out of memory peer_capabilities_memb\n");
-        return false;
+        merge->peer_cap = peer_info_find_capability_or_allocate(merge->peer_edge, merge->cap);
+        if (merge->peer_cap == NULL)
+        {
+            LOG_ERR("Out of memory peer_capabilities_memb\n");
+            return false;
+        }
     }
 
-    peer_cap->tm = *tm;
+    peer_edge_capability_tm_from(&merge->peer_cap->tm, tm);
+    merge->peer_cap->version = version;
+
+    trust_cache_invalidate_edge(merge->edge);
 
     LOG_DBG("Updated peer ");
-    LOG_DBG_6ADDR(&peer->addr);
-    LOG_DBG_(" edge '%s' capability '%s' to ", edge_info_name(edge), cap->name);
+    LOG_DBG_6ADDR(&merge->peer->addr);
+    LOG_DBG_(" edge '%s' capability '%s' (v%" PRIu8 ") to ", edge_info_name(merge->edge), capability_id_name(merge->cap->id), version);
     edge_capability_tm_print(tm);
     LOG_DBG_("\n");
 
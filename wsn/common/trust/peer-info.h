@@ -8,11 +8,99 @@
 /*-------------------------------------------------------------------------------------------------------------------*/
 #define PEER_LAST_SEEN_INVALID UINT32_MAX
 /*-------------------------------------------------------------------------------------------------------------------*/
+#ifdef TRUST_MODEL_NO_PEER_PROVIDED
+#   define NUM_PEERS 0
+#else
+#   ifndef NUM_PEERS
+#       define NUM_PEERS 8
+#   endif
+#endif
+/*-------------------------------------------------------------------------------------------------------------------*/
+// Peer-provided trust is only read, so a model may hold it in a smaller form than its own (see TRUST_DIST_COMPACT)
+// by defining TRUST_MODEL_HAS_PEER_TM along with these types and conversions.
+#ifndef TRUST_MODEL_HAS_PEER_TM
+typedef edge_resource_tm_t peer_edge_resource_tm_t;
+typedef edge_capability_tm_t peer_edge_capability_tm_t;
+
+static inline void peer_edge_resource_tm_from(peer_edge_resource_tm_t* out, const edge_resource_tm_t* tm)
+{
+    *out = *tm;
+}
+static inline void peer_edge_capability_tm_from(peer_edge_capability_tm_t* out, const edge_capability_tm_t* tm)
+{
+    *out = *tm;
+}
+#endif
+/*-------------------------------------------------------------------------------------------------------------------*/
+#ifdef PEER_INFO_COMPACT
+/*-------------------------------------------------------------------------------------------------------------------*/
+// Records are held in fixed arrays and linked by indices instead of pointers.
+// Edge and capability slots are shared by all peers. Records never move, so
+// pointers to them remain valid until they are removed.
+/*-------------------------------------------------------------------------------------------------------------------*/
+#ifndef PEER_INFO_EDGE_SLOTS
+#define PEER_INFO_EDGE_SLOTS (NUM_PEERS * NUM_EDGE_RESOURCES)
+#endif
+
+#ifndef PEER_INFO_CAPABILITY_SLOTS
+#define PEER_INFO_CAPABILITY_SLOTS (NUM_PEERS * NUM_EDGE_RESOURCES * NUM_EDGE_CAPABILITIES)
+#endif
+/*-------------------------------------------------------------------------------------------------------------------*/
+// 8-bit links when every slot can be addressed by one, otherwise 16-bit
+#if PEER_INFO_EDGE_SLOTS < UINT8_MAX && PEER_INFO_CAPABILITY_SLOTS < UINT8_MAX
+typedef uint8_t peer_info_index_t;
+#define PEER_INFO_INDEX_INVALID UINT8_MAX
+#else
+typedef uint16_t peer_info_index_t;
+#define PEER_INFO_INDEX_INVALID UINT16_MAX
+#endif
+/*-------------------------------------------------------------------------------------------------------------------*/
+typedef struct peer_edge_capability {
+    edge_capability_t* cap;
+    peer_edge_capability_tm_t tm;
+
+    // Version of tm as last received from the peer
+    uint8_t version;
+
+    peer_info_index_t next;
+
+} peer_edge_capability_t;
+/*-------------------------------------------------------------------------------------------------------------------*/
+typedef struct peer_edge {
+    edge_resource_t* edge;
+    peer_edge_resource_tm_t tm;
+
+    // Version of tm as last received from the peer
+    uint8_t version;
+
+    peer_info_index_t next;
+    peer_info_index_t capabilities;
+
+} peer_edge_t;
+/*-------------------------------------------------------------------------------------------------------------------*/
+typedef struct peer
+{
+    uip_ipaddr_t addr;
+
+    // Time in peer's local clock (non-monotonic)
+    uint32_t last_seen;
+
+    peer_tm_t tm;
+
+    peer_info_index_t edges;
+
+} peer_t;
+/*-------------------------------------------------------------------------------------------------------------------*/
+#else
+/*-------------------------------------------------------------------------------------------------------------------*/
 typedef struct peer_edge_capability {
     struct peer_edge_capability* next;
 
     edge_capability_t* cap;
-    edge_capability_tm_t tm;
+    peer_edge_capability_tm_t tm;
+
+    // Version of tm as last received from the peer
+    uint8_t version;
 
 } peer_edge_capability_t;
 /*-------------------------------------------------------------------------------------------------------------------*/
@@ -20,7 +108,10 @@ typedef struct peer_edge {
     struct peer_edge* next;
 
     edge_resource_t* edge;
-    edge_resource_tm_t tm;
+    peer_edge_resource_tm_t tm;
+
+    // Version of tm as last received from the peer
+    uint8_t version;
 
     LIST_STRUCT(capabilities);
 
@@ -41,11 +132,15 @@ typedef struct peer
 
 } peer_t;
 /*-------------------------------------------------------------------------------------------------------------------*/
+#endif
+/*-------------------------------------------------------------------------------------------------------------------*/
 void peer_info_init(void);
 /*-------------------------------------------------------------------------------------------------------------------*/
 peer_t* peer_info_add(const uip_ipaddr_t* addr);
 void peer_info_remove(peer_t* peer);
+// Remove every peer's records of an edge or capability, before the record is freed and its slot reused
 void peer_info_remove_edges(edge_resource_t* edge);
+void peer_info_remove_capabilities(edge_capability_t* cap);
 /*-------------------------------------------------------------------------------------------------------------------*/
 peer_t* peer_info_find(const uip_ipaddr_t* addr);
 /*-------------------------------------------------------------------------------------------------------------------*/
@@ -55,6 +150,45 @@ peer_edge_capability_t* peer_info_find_capability(peer_edge_t* peer_edge, edge_c
 peer_t* peer_info_iter(void);
 peer_t* peer_info_next(peer_t* iter);
 /*-------------------------------------------------------------------------------------------------------------------*/
-bool peer_info_update_edge(peer_t* peer, edge_resource_t* edge, const edge_resource_tm_t* tm);
-bool peer_info_update_capability(peer_t* peer, edge_resource_t* edge, edge_capability_t* cap, const edge_capability_tm_t* tm);
+// Merge-join of a received trust payload with a peer's records. Records are kept in the
+// canonical order of edge_info_compare and capability_id_compare, so when the payload is
+// in the same order (as serialise_trust produces) both sides are walked once.
+typedef struct {
+    peer_t* peer;
+
+    // First of the peer's records that the merge has not yet passed
+    peer_edge_t* next_edge;
+    peer_edge_capability_t* next_cap;
+
+    // Edge and capability being merged and the peer's records of them (NULL if none held)
+    edge_resource_t* edge;
+    peer_edge_t* peer_edge;
+    edge_capability_t* cap;
+    peer_edge_capability_t* peer_cap;
+
+} peer_info_merge_t;
+/*-------------------------------------------------------------------------------------------------------------------*/
+// Returns true if the peer's records are in canonical order, which the merge relies on
+bool peer_info_is_ordered(peer_t* peer);
+/*-------------------------------------------------------------------------------------------------------------------*/
+void peer_info_merge_begin(peer_info_merge_t* merge, peer_t* peer);
+void peer_info_merge_edge(peer_info_merge_t* merge, edge_resource_t* edge);
+void peer_info_merge_capability(peer_info_merge_t* merge, edge_capability_t* cap);
+/*-------------------------------------------------------------------------------------------------------------------*/
+// Returns true if the version is newer than the one held for the peer's record, or if no record is held
+bool peer_info_merge_edge_is_newer(const peer_info_merge_t* merge, uint8_t version);
+bool peer_info_merge_capability_is_newer(const peer_info_merge_t* merge, uint8_t version);
+/*-------------------------------------------------------------------------------------------------------------------*/
+bool peer_info_merge_update_edge(peer_info_merge_t* merge, uint8_t version, const edge_resource_tm_t* tm);
+bool peer_info_merge_update_capability(peer_info_merge_t* merge, uint8_t version, const edge_capability_tm_t* tm);
+/*-------------------------------------------------------------------------------------------------------------------*/
+// Provided by the storage backend (peer-info.c or peer-info-compact.c)
+peer_edge_t* peer_info_edges_head(peer_t* peer);
+peer_edge_t* peer_info_edges_next(peer_edge_t* peer_edge);
+peer_edge_capability_t* peer_info_capabilities_head(peer_edge_t* peer_edge);
+peer_edge_capability_t* peer_info_capabilities_next(peer_edge_capability_t* peer_cap);
+
+// Allocated records are inserted in canonical order
+peer_edge_t* peer_info_find_edge_or_allocate(peer_t* peer, edge_resource_t* edge);
+peer_edge_capability_t* peer_info_find_capability_or_allocate(peer_edge_t* peer_edge, edge_capability_t* cap);
 /*-------------------------------------------------------------------------------------------------------------------*/
@@ -30,14 +30,26 @@
 MEMB(stereotypes_memb, edge_stereotype_t, MAX_NUM_STEREOTYPES);
 LIST(stereotypes);
 LIST(stereotypes_requesting);
+LIST(stereotypes_in_flight);
 /*-------------------------------------------------------------------------------------------------------------------*/
 PROCESS(stereotype, "stereotype");
 /*-------------------------------------------------------------------------------------------------------------------*/
-static coap_message_t msg;
-static coap_callback_request_state_t coap_callback;
-static timed_unlock_t coap_callback_in_use;
-static uint8_t msg_buf[(1) + (1) + STEREOTYPE_TAGS_CBOR_MAX_LEN];
+typedef struct stereotype_request {
+    coap_message_t msg;
+    coap_callback_request_state_t coap_callback;
+    timed_unlock_t in_use;
 
+    // The stereotypes in stereotypes_in_flight that this request asked for
+    edge_stereotype_t* stereotypes[STEREOTYPES_BATCH_SIZE];
+    uint8_t num_stereotypes;
+
+    uint8_t msg_buf[(1) + STEREOTYPES_BATCH_SIZE * ((1) + (1) + STEREOTYPE_TAGS_CBOR_MAX_LEN)];
+} stereotype_request_t;
+
+static stereotype_request_t requests[STEREOTYPES_MAX_IN_FLIGHT];
+
+_Static_assert(STEREOTYPES_BATCH_SIZE >= 1 && STEREOTYPES_BATCH_SIZE <= NANOCBOR_MAX_TINY_INTEGER, "Invalid STEREOTYPES_BATCH_SIZE");
+_Static_assert(STEREOTYPES_MAX_IN_FLIGHT >= 1, "Invalid STEREOTYPES_MAX_IN_FLIGHT");
 _Static_assert(TRUST_MODEL_TAG >= NANOCBOR_MIN_TINY_INTEGER, "TRUST_MODEL_TAG too small");
 _Static_assert(TRUST_MODEL_TAG <= NANOCBOR_MAX_TINY_INTEGER, "TRUST_MODEL_TAG too large");
 /*-------------------------------------------------------------------------------------------------------------------*/
@@ -81,12 +93,52 @@ static bool edge_stereotype_remove_from_list(edge_stereotype_t* stereotype, list
 /*-------------------------------------------------------------------------------------------------------------------*/
 bool edge_stereotype_remove(edge_stereotype_t* stereotype)
 {
-    return edge_stereotype_remove_from_list(stereotype, stereotypes);
+    const bool removed = edge_stereotype_remove_from_list(stereotype, stereotypes);
+    if (removed)
+    {
+        trust_cache_invalidate_all();
+    }
+
+    return removed;
+}
+/*-------------------------------------------------------------------------------------------------------------------*/
+edge_stereotype_t* edge_stereotype_iter(void)
+{
+    return list_head(stereotypes);
+}
+/*-------------------------------------------------------------------------------------------------------------------*/
+edge_stereotype_t* edge_stereotype_next(edge_stereotype_t* iter)
+{
+    return list_item_next(iter);
+}
+/*-------------------------------------------------------------------------------------------------------------------*/
+bool edge_stereotype_restore(const stereotype_tags_t* tags, const edge_resource_tm_t* edge_tm)
+{
+    edge_stereotype_t* s = edge_stereotype_find(tags);
+    if (s == NULL)
+    {
+        s = memb_alloc(&stereotypes_memb);
+        if (s == NULL)
+        {
+            LOG_ERR("Failed to allocate memory to restore stereotype\n");
+            return false;
+        }
+
+        s->tags = *tags;
+
+        list_push(stereotypes, s);
+    }
+
+    s->edge_tm = *edge_tm;
+
+    trust_cache_invalidate_all();
+
+    return true;
 }
 /*-------------------------------------------------------------------------------------------------------------------*/
 static int serialise_request(nanocbor_encoder_t* enc, const stereotype_tags_t* tags)
 {
-    nanocbor_fmt_array(enc, 2);
+    NANOCBOR_CHECK(nanocbor_fmt_array(enc, 2));
 
     // Need to inform the server which trust model we are requesting information for
     NANOCBOR_CHECK(nanocbor_fmt_uint(enc, TRUST_MODEL_TAG));
@@ -118,6 +170,41 @@ static int deserialise_response(nanocbor_value_t* dec, uint32_t* model, edge_ste
     return NANOCBOR_OK;
 }
 /*-------------------------------------------------------------------------------------------------------------------*/
+static bool
+process_sterotype(uint32_t model, const edge_stereotype_t* stereotype)
+{
+    // Unlikely to reach here, as this will likely cause a parsing error earlier
+    if (model != TRUST_MODEL_TAG)
+    {
+        LOG_WARN("Received stereotype for incorrect model %"PRIu32" != " CC_STRINGIFY(TRUST_MODEL_TAG) "\n", model);
+        return false;
+    }
+
+    edge_stereotype_t* s = edge_stereotype_find_in_list(&stereotype->tags, stereotypes_in_flight);
+    if (s == NULL)
+    {
+        // At this point something odd has happened,
+        // we received a sterotype for tags that we did not request.
+        LOG_WARN("Received sterotype for tags we did not ask for: ");
+        stereotype_tags_print(&stereotype->tags);
+        LOG_WARN_("\n");
+        return false;
+    }
+
+    s->tags = stereotype->tags;
+    s->edge_tm = stereotype->edge_tm;
+
+    // Remove from request list and add to actual list
+    list_remove(stereotypes_in_flight, s);
+    list_push(stereotypes, s);
+
+    LOG_DBG("Added stereotype for trust model %" PRIu32 " and tag: ", model);
+    stereotype_tags_print(&stereotype->tags);
+    LOG_DBG_("\n");
+
+    return true;
+}
+/*-------------------------------------------------------------------------------------------------------------------*/
 static void
 process_sterotype_response(coap_message_t* response)
 {
@@ -136,51 +223,88 @@ process_sterotype_response(coap_message_t* response)
         return;
     }
 
-    uint32_t model = TRUST_MODEL_INVALID_TAG;
-    edge_stereotype_t stereotype;
-
-    nanocbor_value_t dec;
+    // The response contains one stereotype for each set of tags that the root could provide
+    nanocbor_value_t dec, arr;
     nanocbor_decoder_init(&dec, payload, payload_len);
-    if (deserialise_response(&dec, &model, &stereotype) != NANOCBOR_OK)
+    if (nanocbor_enter_array(&dec, &arr) < 0)
     {
         LOG_ERR("Failed to deserialise sterotype payload\n");
         return;
     }
 
-    // Unlikely to reach here, as this will likely cause a parsing error earlier
-    if (model != TRUST_MODEL_TAG)
-    {
-        LOG_WARN("Received stereotype for incorrect model %"PRIu32" != " CC_STRINGIFY(TRUST_MODEL_TAG) "\n", model);
-        return;
-    }
+    bool added = false;
 
-    edge_stereotype_t* s = edge_stereotype_find_in_list(&stereotype.tags, stereotypes_requesting);
-    if (s != NULL)
+    while (!nanocbor_at_end(&arr))
     {
-        s->tags = stereotype.tags;
-        s->edge_tm = stereotype.edge_tm;
+        uint32_t model = TRUST_MODEL_INVALID_TAG;
+        edge_stereotype_t stereotype;
 
-        // Remove from request list and add to actual list
-        list_remove(stereotypes_requesting, s);
-        list_push(stereotypes, s);
+        if (deserialise_response(&arr, &model, &stereotype) != NANOCBOR_OK)
+        {
+            LOG_ERR("Failed to deserialise sterotype payload\n");
+            break;
+        }
 
-        LOG_DBG("Added stereotype for trust model %" PRIu32 " and tag: ", model);
-        stereotype_tags_print(&stereotype.tags);
-        LOG_DBG_("\n");
+        added |= process_sterotype(model, &stereotype);
     }
-    else
+
+    if (added)
     {
-        // At this point something odd has happened,
-        // we received a sterotype for tags that we did not request.
-        LOG_WARN("Received sterotype for tags we did not ask for: ");
-        stereotype_tags_print(&stereotype.tags);
-        LOG_WARN_("\n");
+        // Edges with these tags may now be evaluated with these stereotypes
+        trust_cache_invalidate_all();
     }
 }
 /*-------------------------------------------------------------------------------------------------------------------*/
+static stereotype_request_t*
+find_request(coap_callback_request_state_t* callback_state)
+{
+    for (uint8_t i = 0; i != STEREOTYPES_MAX_IN_FLIGHT; ++i)
+    {
+        if (&requests[i].coap_callback == callback_state)
+        {
+            return &requests[i];
+        }
+    }
+
+    return NULL;
+}
+/*-------------------------------------------------------------------------------------------------------------------*/
+static void
+request_requeue(stereotype_request_t* request)
+{
+    // Stereotypes that were not in the response will be asked for again
+    for (uint8_t i = 0; i != request->num_stereotypes; ++i)
+    {
+        edge_stereotype_t* s = request->stereotypes[i];
+
+        if (list_contains(stereotypes_in_flight, s))
+        {
+            list_remove(stereotypes_in_flight, s);
+            list_push(stereotypes_requesting, s);
+        }
+    }
+
+    request->num_stereotypes = 0;
+}
+/*-------------------------------------------------------------------------------------------------------------------*/
+static void
+request_finished(stereotype_request_t* request)
+{
+    request_requeue(request);
+
+    timed_unlock_unlock(&request->in_use);
+}
+/*-------------------------------------------------------------------------------------------------------------------*/
 static void
 send_callback(coap_callback_request_state_t* callback_state)
 {
+    stereotype_request_t* request = find_request(callback_state);
+    if (request == NULL)
+    {
+        LOG_ERR("Received a callback for an unknown stereotype request\n");
+        return;
+    }
+
     switch (callback_state->state.status)
     {
     case COAP_REQUEST_STATUS_RESPONSE:
@@ -201,7 +325,7 @@ send_callback(coap_callback_request_state_t* callback_state)
 
     case COAP_REQUEST_STATUS_FINISHED:
     {
-        timed_unlock_unlock(&coap_callback_in_use);
+        request_finished(request);
 
         // Poll to signal that a request has finished being processed
         process_poll(&stereotype);
@@ -211,7 +335,7 @@ send_callback(coap_callback_request_state_t* callback_state)
     {
         LOG_ERR("Failed to send message due to %s(%d)\n",
             coap_request_status_to_string(callback_state->state.status), callback_state->state.status);
-        timed_unlock_unlock(&coap_callback_in_use);
+        request_finished(request);
     } break;
     }
 }
@@ -250,7 +374,8 @@ bool stereotypes_request(const stereotype_tags_t* tags)
         return false;
     }
 
-    if (edge_stereotype_find_in_list(tags, stereotypes_requesting) != NULL)
+    if (edge_stereotype_find_in_list(tags, stereotypes_requesting) != NULL ||
+        edge_stereotype_find_in_list(tags, stereotypes_in_flight) != NULL)
     {
         LOG_DBG("No need to request stereotypes for ");
         stereotype_tags_print(tags);
@@ -292,50 +417,97 @@ bool stereotypes_request(const stereotype_tags_t* tags)
     return true;
 }
 /*-------------------------------------------------------------------------------------------------------------------*/
-static bool stereotypes_send_request(const stereotype_tags_t* tags)
+static bool stereotypes_send_request(stereotype_request_t* request)
 {
-    if (timed_unlock_is_locked(&coap_callback_in_use))
+    if (timed_unlock_is_locked(&request->in_use))
     {
         LOG_WARN("Cannot generate a new message, as in process of sending one\n");
         return false;
     }
 
+    const uint8_t num_stereotypes = MIN(list_length(stereotypes_requesting), STEREOTYPES_BATCH_SIZE);
+
     nanocbor_encoder_t enc;
-    nanocbor_encoder_init(&enc, msg_buf, sizeof(msg_buf));
-    if (serialise_request(&enc, tags) != NANOCBOR_OK)
+    nanocbor_encoder_init(&enc, request->msg_buf, sizeof(request->msg_buf));
+    nanocbor_fmt_array(&enc, num_stereotypes);
+
+    // Ask for the most recently requested stereotypes first
+    edge_stereotype_t* s = list_head(stereotypes_requesting);
+    for (uint8_t i = 0; i != num_stereotypes; ++i, s = list_item_next(s))
     {
-        LOG_ERR("Failed to serialise the sterotype request\n");
-        return false;
+        if (serialise_request(&enc, &s->tags) != NANOCBOR_OK)
+        {
+            LOG_ERR("Failed to serialise the sterotype request\n");
+            return false;
+        }
+
+        request->stereotypes[i] = s;
     }
 
-    assert(nanocbor_encoded_len(&enc) <= sizeof(msg_buf));
+    assert(nanocbor_encoded_len(&enc) <= sizeof(request->msg_buf));
 
-    coap_init_message(&msg, COAP_TYPE_CON, COAP_GET, 0);
-    coap_set_header_uri_path(&msg, STEREOTYPE_URI);
-    coap_set_header_content_format(&msg, APPLICATION_CBOR);
-    coap_set_payload(&msg, msg_buf, nanocbor_encoded_len(&enc));
+    coap_init_message(&request->msg, COAP_TYPE_CON, COAP_GET, 0);
+    coap_set_header_uri_path(&request->msg, STEREOTYPE_URI);
+    coap_set_header_content_format(&request->msg, APPLICATION_CBOR);
+    coap_set_payload(&request->msg, request->msg_buf, nanocbor_encoded_len(&enc));
 
 #if defined(WITH_OSCORE) && defined(AIOCOAP_SUPPORTS_OSCORE)
-    coap_set_random_token(&msg);
-    keystore_protect_coap_with_oscore(&msg, &root_ep);
+    coap_set_random_token(&request->msg);
+    keystore_protect_coap_with_oscore(&request->msg, &root_ep);
 #endif
 
-    int ret = coap_send_request(&coap_callback, &root_ep, &msg, send_callback);
+    int ret = coap_send_request(&request->coap_callback, &root_ep, &request->msg, send_callback);
     if (ret)
     {
-        timed_unlock_lock(&coap_callback_in_use);
+        timed_unlock_lock(&request->in_use);
+
         LOG_DBG("Stereotype request message sent to ");
         LOG_DBG_COAP_EP(&root_ep);
-        LOG_DBG_(" for ");
-        stereotype_tags_print(tags);
+        LOG_DBG_(" for");
+
+        // Only move the stereotypes once sent, so they are not asked for by another request
+        for (uint8_t i = 0; i != num_stereotypes; ++i)
+        {
+            list_remove(stereotypes_requesting, request->stereotypes[i]);
+            list_add(stereotypes_in_flight, request->stereotypes[i]);
+
+            LOG_DBG_(" ");
+            stereotype_tags_print(&request->stereotypes[i]->tags);
+        }
         LOG_DBG_("\n");
+
+        request->num_stereotypes = num_stereotypes;
     }
     else
     {
         LOG_ERR("Failed to send stereotype request message with %d\n", ret);
     }
 
-    return timed_unlock_is_locked(&coap_callback_in_use);
+    return timed_unlock_is_locked(&request->in_use);
+}
+/*-------------------------------------------------------------------------------------------------------------------*/
+static void stereotypes_send_requests(void)
+{
+    for (uint8_t i = 0; i != STEREOTYPES_MAX_IN_FLIGHT && list_head(stereotypes_requesting) != NULL; ++i)
+    {
+        if (!timed_unlock_is_locked(&requests[i].in_use))
+        {
+            stereotypes_send_request(&requests[i]);
+        }
+    }
+}
+/*-------------------------------------------------------------------------------------------------------------------*/
+static stereotype_request_t* find_request_by_lock(process_data_t data)
+{
+    for (uint8_t i = 0; i != STEREOTYPES_MAX_IN_FLIGHT; ++i)
+    {
+        if (data == &requests[i].in_use)
+        {
+            return &requests[i];
+        }
+    }
+
+    return NULL;
 }
 /*-------------------------------------------------------------------------------------------------------------------*/
 void stereotypes_init(void)
@@ -343,9 +515,14 @@ void stereotypes_init(void)
     memb_init(&stereotypes_memb);
     list_init(stereotypes);
     list_init(stereotypes_requesting);
+    list_init(stereotypes_in_flight);
 
     PROCESS_CONTEXT_BEGIN(&stereotype);
-    timed_unlock_init(&coap_callback_in_use, "stereotypes", (1 * 60 * CLOCK_SECOND));
+    for (uint8_t i = 0; i != STEREOTYPES_MAX_IN_FLIGHT; ++i)
+    {
+        timed_unlock_init(&requests[i].in_use, "stereotypes", (1 * 60 * CLOCK_SECOND));
+        requests[i].num_stereotypes = 0;
+    }
     PROCESS_CONTEXT_END(&stereotype);
 
     process_start(&stereotype, NULL);
@@ -359,19 +536,20 @@ PROCESS_THREAD(stereotype, ev, data)
     {
         PROCESS_YIELD();
 
-        // Either try to send when the coap lock is released or the process is polled
-        if ((ev == pe_timed_unlock_unlocked && data == &coap_callback_in_use) || ev == PROCESS_EVENT_POLL)
+        if (ev == pe_timed_unlock_unlocked)
         {
-            // Do not expect this to be the case at this point
-            if (!timed_unlock_is_locked(&coap_callback_in_use))
+            // A request timed out without finishing, so ask for its stereotypes again
+            stereotype_request_t* request = find_request_by_lock(data);
+            if (request != NULL)
             {
-                edge_stereotype_t* s = list_head(stereotypes_requesting);
-                if (s)
-                {
-                    stereotypes_send_request(&s->tags);
-                }
+                request_requeue(request);
+                stereotypes_send_requests();
             }
         }
+        else if (ev == PROCESS_EVENT_POLL)
+        {
+            stereotypes_send_requests();
+        }
     }
 
     PROCESS_END();
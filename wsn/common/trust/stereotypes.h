@@ -9,6 +9,16 @@
 #define MAX_NUM_STEREOTYPES 5
 #endif
 
+// Up to this many stereotypes are asked for in one request to the root
+#ifndef STEREOTYPES_BATCH_SIZE
+#define STEREOTYPES_BATCH_SIZE 4
+#endif
+
+// Number of stereotype requests that may be awaiting a response at once
+#ifndef STEREOTYPES_MAX_IN_FLIGHT
+#define STEREOTYPES_MAX_IN_FLIGHT 2
+#endif
+
 /*-------------------------------------------------------------------------------------------------------------------*/
 typedef struct edge_stereotype {
     struct edge_stereotype* next;
@@ -30,3 +40,9 @@ edge_stereotype_t* edge_stereotype_find(const stereotype_tags_t* tags);
 /*-------------------------------------------------------------------------------------------------------------------*/
 bool edge_stereotype_remove(edge_stereotype_t* stereotype);
 /*-------------------------------------------------------------------------------------------------------------------*/
+edge_stereotype_t* edge_stereotype_iter(void);
+edge_stereotype_t* edge_stereotype_next(edge_stereotype_t* iter);
+/*-------------------------------------------------------------------------------------------------------------------*/
+// Adds a stereotype received before a reboot (see trust-snapshot.h), or replaces the one held for the tags
+bool edge_stereotype_restore(const stereotype_tags_t* tags, const edge_resource_tm_t* edge_tm);
+/*-------------------------------------------------------------------------------------------------------------------*/
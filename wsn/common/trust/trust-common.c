@@ -4,6 +4,7 @@
 #include "trust-models.h"
 #include "stereotypes.h"
 #include "edge-ping.h"
+#include "trust-snapshot.h"
 
 #include "contiki.h"
 #include "os/sys/log.h"
@@ -11,12 +12,14 @@
 #include "os/net/ipv6/uiplib.h"
 #include "assert.h"
 #include "coap-log.h"
+#include "coap.h"
 
 #include <stdio.h>
-#include <ctype.h>
+#include <string.h>
 
 #include "applications.h"
 #include "keystore.h"
+#include "crypto-support.h"
 #include "device-classes.h"
 
 #include "nanocbor-helper.h"
@@ -29,13 +32,6 @@
 #define LOG_LEVEL LOG_LEVEL_NONE
 #endif
 /*-------------------------------------------------------------------------------------------------------------------*/
-const char *topics_to_suscribe[TOPICS_TO_SUBSCRIBE_LEN] = {
-    MQTT_EDGE_NAMESPACE "/+/" MQTT_EDGE_ACTION_ANNOUNCE,
-    MQTT_EDGE_NAMESPACE "/+/" MQTT_EDGE_ACTION_UNANNOUNCE,
-    MQTT_EDGE_NAMESPACE "/+/" MQTT_EDGE_ACTION_CAPABILITY "/+/" MQTT_EDGE_ACTION_CAPABILITY_ADD,
-    MQTT_EDGE_NAMESPACE "/+/" MQTT_EDGE_ACTION_CAPABILITY "/+/" MQTT_EDGE_ACTION_CAPABILITY_REMOVE,
-};
-/*-------------------------------------------------------------------------------------------------------------------*/
 process_event_t pe_edge_capability_add;
 process_event_t pe_edge_capability_remove;
 /*-------------------------------------------------------------------------------------------------------------------*/
@@ -133,9 +129,8 @@ process_certificate(const uint8_t* eui64, const certificate_t* cert)
 }
 /*-------------------------------------------------------------------------------------------------------------------*/
 static int
-mqtt_publish_announce_handler(const char *topic, const char* topic_end,
-                              const uint8_t *chunk, uint16_t chunk_len,
-                              const uint8_t* eui64)
+mqtt_publish_announce_handler(const uint8_t* eui64, capability_id_t capability_id,
+                              const uint8_t *chunk, uint16_t chunk_len)
 {
     nanocbor_value_t dec;
     nanocbor_decoder_init(&dec, chunk, chunk_len);
@@ -147,9 +142,8 @@ mqtt_publish_announce_handler(const char *topic, const char* topic_end,
 }
 /*-------------------------------------------------------------------------------------------------------------------*/
 static int
-mqtt_publish_unannounce_handler(const char *topic, const char* topic_end,
-                                const uint8_t *chunk, uint16_t chunk_len,
-                                const uint8_t* eui64)
+mqtt_publish_unannounce_handler(const uint8_t* eui64, capability_id_t capability_id,
+                                const uint8_t *chunk, uint16_t chunk_len)
 {
     nanocbor_value_t dec;
     nanocbor_decoder_init(&dec, chunk, chunk_len);
@@ -226,7 +220,7 @@ mqtt_publish_unannounce_handler(const char *topic, const char* topic_end,
 }
 /*-------------------------------------------------------------------------------------------------------------------*/
 static int
-mqtt_publish_capability_add_handler(const uint8_t* eui64, const char* capability_name,
+mqtt_publish_capability_add_handler(const uint8_t* eui64, capability_id_t capability_id,
                                     const uint8_t *chunk, uint16_t chunk_len)
 {
     nanocbor_value_t dec;
@@ -291,33 +285,39 @@ mqtt_publish_capability_add_handler(const uint8_t* eui64, const char* capability
         request_public_key(&ipaddr);
     }
 
-    edge_capability_t* capability = edge_info_capability_find(edge, capability_name);
+    // Only record capabilities for applications we run
+    if (!capability_id_is_valid(capability_id))
+    {
+        return -1;
+    }
+
+    edge_capability_t* capability = edge_info_capability_find(edge, capability_id);
     if (capability != NULL)
     {
         // Do not process active capabilities we already know about
         if (edge_capability_is_active(capability))
         {
-            LOG_DBG("Notified of active capability (%s) already known of\n", capability_name);
+            LOG_DBG("Notified of active capability (%s) already known of\n", capability_id_name(capability_id));
             return -1;
         }
         else
         {
-            LOG_INFO("Notified of inactive capability (%s) already known of\n", capability_name);
+            LOG_INFO("Notified of inactive capability (%s) already known of\n", capability_id_name(capability_id));
         }
     }
     else
     {
-        capability = edge_info_capability_add(edge, capability_name);
+        capability = edge_info_capability_add(edge, capability_id);
         if (capability == NULL)
         {
-            LOG_ERR("Failed to create capability (%s) for edge with identity ", capability_name);
+            LOG_ERR("Failed to create capability (%s) for edge with identity ", capability_id_name(capability_id));
             LOG_ERR_6ADDR(&edge->ep.ipaddr);
             LOG_ERR_("\n");
             return -1;
         }
         else
         {
-            LOG_INFO("Added capability (%s) for edge with identity ", capability_name);
+            LOG_INFO("Added capability (%s) for edge with identity ", capability_id_name(capability_id));
             LOG_INFO_6ADDR(&edge->ep.ipaddr);
             LOG_INFO_("\n");
         }
@@ -333,7 +333,7 @@ mqtt_publish_capability_add_handler(const uint8_t* eui64, const char* capability
 }
 /*-------------------------------------------------------------------------------------------------------------------*/
 static int
-mqtt_publish_capability_remove_handler(const uint8_t* eui64, const char* capability_name,
+mqtt_publish_capability_remove_handler(const uint8_t* eui64, capability_id_t capability_id,
                                        const uint8_t *chunk, uint16_t chunk_len)
 {
     nanocbor_value_t dec;
@@ -368,10 +368,10 @@ mqtt_publish_capability_remove_handler(const uint8_t* eui64, const char* capabil
     }
 
     // Check that this edge has this capability
-    edge_capability_t* capability = edge_info_capability_find(edge, capability_name);
+    edge_capability_t* capability = edge_info_capability_find(edge, capability_id);
     if (capability == NULL)
     {
-        LOG_DBG("Notified of removal of capability %s from ", capability_name);
+        LOG_DBG("Notified of removal of capability %s from ", capability_id_name(capability_id));
         LOG_DBG_6ADDR(&edge->ep.ipaddr);
         LOG_DBG_(", but had not recorded this previously.\n");
         return -1;
@@ -388,14 +388,14 @@ mqtt_publish_capability_remove_handler(const uint8_t* eui64, const char* capabil
     bool result = edge_info_capability_remove(edge, capability);
     if (result)
     {
-        LOG_INFO("Removed capability %s from ", capability_name);
+        LOG_INFO("Removed capability %s from ", capability_id_name(capability_id));
         LOG_INFO_6ADDR(&edge->ep.ipaddr);
         LOG_INFO_("\n");
     }
     else
     {
         // Should never get here
-        LOG_ERR("Cannot removed capability %s from ", capability_name);
+        LOG_ERR("Cannot removed capability %s from ", capability_id_name(capability_id));
         LOG_ERR_6ADDR(&edge->ep.ipaddr);
         LOG_ERR_(" as it does not have that capability\n");
     }
@@ -418,172 +418,247 @@ mqtt_publish_capability_remove_handler(const uint8_t* eui64, const char* capabil
     return 0;
 }
 /*-------------------------------------------------------------------------------------------------------------------*/
-static int
-mqtt_publish_capability_handler(const char *topic, const char* topic_end,
-                                const uint8_t *chunk, uint16_t chunk_len,
-                                const uint8_t* eui64)
-{
-    // Format of topic is now in "/%s/add"
+typedef int (*mqtt_topic_handler_t)(const uint8_t* eui64, capability_id_t capability_id,
+                                    const uint8_t *chunk, uint16_t chunk_len);
+/*-------------------------------------------------------------------------------------------------------------------*/
+// Generates both the subscriptions and the dispatch table, so they cannot get out of step.
+// The first '+' in a topic is the edge's identity and the second (if any) is a capability name.
+#define TRUST_TOPICS(X) \
+    X(MQTT_EDGE_NAMESPACE "/+/" MQTT_EDGE_ACTION_ANNOUNCE, mqtt_publish_announce_handler) \
+    X(MQTT_EDGE_NAMESPACE "/+/" MQTT_EDGE_ACTION_UNANNOUNCE, mqtt_publish_unannounce_handler) \
+    X(MQTT_EDGE_NAMESPACE "/+/" MQTT_EDGE_ACTION_CAPABILITY "/+/" MQTT_EDGE_ACTION_CAPABILITY_ADD, mqtt_publish_capability_add_handler) \
+    X(MQTT_EDGE_NAMESPACE "/+/" MQTT_EDGE_ACTION_CAPABILITY "/+/" MQTT_EDGE_ACTION_CAPABILITY_REMOVE, mqtt_publish_capability_remove_handler)
+
+#define TRUST_TOPIC_NAME(topic, handler) topic,
+#define TRUST_TOPIC_HANDLER(topic, handler) handler,
+/*-------------------------------------------------------------------------------------------------------------------*/
+const char *topics_to_suscribe[] = { TRUST_TOPICS(TRUST_TOPIC_NAME) };
 
-    if (*topic != '/')
+static const mqtt_topic_handler_t topic_handlers[] = { TRUST_TOPICS(TRUST_TOPIC_HANDLER) };
+/*-------------------------------------------------------------------------------------------------------------------*/
+_Static_assert(sizeof(topics_to_suscribe) / sizeof(*topics_to_suscribe) == TOPICS_TO_SUBSCRIBE_LEN,
+               "TOPICS_TO_SUBSCRIBE_LEN does not match the number of trust topics");
+_Static_assert(TOPICS_TO_SUBSCRIBE_LEN <= 8, "Topic candidates are tracked in a uint8_t");
+/*-------------------------------------------------------------------------------------------------------------------*/
+// Extracts the field for the nth '+' in the topics, returns false if the topic should be ignored
+static bool
+mqtt_topic_wildcard(uint8_t n, const char* segment, size_t len,
+                    uint8_t* eui64, capability_id_t* capability_id)
+{
+    if (n == 0)
     {
-        LOG_ERR("Bad sep\n");
-        return -1;
-    }
-
-    topic += 1;
+        if (!eui64_from_strn(segment, len, eui64))
+        {
+            LOG_ERR("Bad topic identity (%.*s)\n", (int)len, segment);
+            return false;
+        }
 
-    const char* next_slash = strchr(topic, '/');
-    if (next_slash == NULL)
-    {
-        LOG_ERR("Bad sep\n");
-        return -1;
+        // No need to add information on ourselves
+        return !is_our_eui64(eui64);
     }
-
-    // Check that capability name isn't too long
-    ptrdiff_t distance = next_slash - topic;
-    if (distance <= 0 || distance > EDGE_CAPABILITY_NAME_LEN)
+    else
     {
-        LOG_ERR("Bad cap name\n");
-        return -1;
-    }
-
-    // Parse capability name
-    char capability_name[EDGE_CAPABILITY_NAME_LEN+1];
-    strncpy(capability_name, topic, distance);
-    capability_name[distance] = '\0';
+        if (len == 0 || len > EDGE_CAPABILITY_NAME_LEN)
+        {
+            LOG_ERR("Bad cap name\n");
+            return false;
+        }
 
-    topic = next_slash + 1;
+        // Intern capability name, capabilities for applications we do not run are invalid
+        *capability_id = capability_id_findn(segment, len);
+        if (!capability_id_is_valid(*capability_id))
+        {
+            LOG_DBG("Unknown cap (%.*s)\n", (int)len, segment);
+        }
 
-    if (strncmp(MQTT_EDGE_ACTION_CAPABILITY_ADD, topic, strlen(MQTT_EDGE_ACTION_CAPABILITY_ADD)) == 0)
-    {
-        return mqtt_publish_capability_add_handler(eui64, capability_name, chunk, chunk_len);
-    }
-    else if (strncmp(MQTT_EDGE_ACTION_CAPABILITY_REMOVE, topic, strlen(MQTT_EDGE_ACTION_CAPABILITY_REMOVE)) == 0)
-    {
-        return mqtt_publish_capability_remove_handler(eui64, capability_name, chunk, chunk_len);
-    }
-    else
-    {
-        LOG_WARN("Unknown cap action (%.*s)\n", topic_end - topic, topic);
-        return -1;
+        return true;
     }
 }
 /*-------------------------------------------------------------------------------------------------------------------*/
 void
 mqtt_publish_handler(const char *topic, const char* topic_end, const uint8_t *chunk, uint16_t chunk_len)
 {
-    LOG_DBG("Pub Handler: topic='%.*s' (len=%u), chunk_len=%u\n", topic_end - topic, topic, topic_end - topic, chunk_len);
+    LOG_DBG("Pub Handler: topic='%.*s' (len=%u), chunk_len=%u\n", (int)(topic_end - topic), topic, (unsigned int)(topic_end - topic), chunk_len);
 
-    int ret;
+    // Single pass over the topic's segments, matching them against every subscribed topic at once
+    // and extracting the wildcard fields as they are reached
+    uint8_t candidates = (1u << TOPICS_TO_SUBSCRIBE_LEN) - 1;
+    const char* patterns[TOPICS_TO_SUBSCRIBE_LEN];
+    memcpy(patterns, topics_to_suscribe, sizeof(patterns));
 
-    // First check that we are in the right namespace
-    ret = strncmp(MQTT_EDGE_NAMESPACE, topic, MQTT_EDGE_NAMESPACE_LEN);
-    if (ret != 0)
-    {
-        LOG_ERR("Initial prefix does not match " MQTT_EDGE_NAMESPACE "\n");
-        return;
-    }
+    uint8_t eui64[EUI64_LENGTH];
+    capability_id_t capability_id = CAPABILITY_ID_INVALID;
+    uint8_t wildcards = 0;
 
-    // Consume MQTT_EDGE_NAMESPACE_LEN
-    topic += MQTT_EDGE_NAMESPACE_LEN;
+    const char* segment = topic;
 
-    if ((topic_end - topic) < 2 + MQTT_IDENTITY_LEN || *topic != '/')
+    while (candidates != 0)
     {
-        LOG_ERR("Topic does not contain identity\n");
-        return;
-    }
+        const char* segment_end = memchr(segment, '/', topic_end - segment);
+        const bool last = (segment_end == NULL);
+        if (last)
+        {
+            segment_end = topic_end;
+        }
 
-    // Consume '/'
-    topic += 1;
+        const size_t len = segment_end - segment;
+        bool wildcard = false;
 
-    // Check that the identiy is hex
-    for (unsigned int i = 0; i != MQTT_IDENTITY_LEN; ++i)
-    {
-        if (!isxdigit(topic[i]))
+        for (uint8_t i = 0; i != TOPICS_TO_SUBSCRIBE_LEN; ++i)
         {
-            LOG_ERR("Topic identity is in an invalid format (char %u = %c)\n", i, topic[i]);
-            return;
+            if ((candidates & (1u << i)) == 0)
+            {
+                continue;
+            }
+
+            const char* pattern = patterns[i];
+            const bool is_wildcard = (pattern[0] == '+' && (pattern[1] == '/' || pattern[1] == '\0'));
+
+            if (is_wildcard)
+            {
+                pattern += 1;
+            }
+            else if (strncmp(pattern, segment, len) == 0 && (pattern[len] == '/' || pattern[len] == '\0'))
+            {
+                pattern += len;
+            }
+            else
+            {
+                candidates &= ~(1u << i);
+                continue;
+            }
+
+            // The topic and pattern need to end at the same segment
+            if (last != (*pattern == '\0'))
+            {
+                candidates &= ~(1u << i);
+                continue;
+            }
+
+            patterns[i] = last ? pattern : pattern + 1;
+            wildcard |= is_wildcard;
         }
-    }
 
-    // Parse topic identity
-    uint8_t eui64[EUI64_LENGTH];
-    if(!eui64_from_strn(topic, MQTT_IDENTITY_LEN, eui64))
-    {
-        LOG_ERR("Bad topic_identity\n");
-        return;
+        if (wildcard)
+        {
+            if (!mqtt_topic_wildcard(wildcards, segment, len, eui64, &capability_id))
+            {
+                return;
+            }
+
+            wildcards += 1;
+        }
+
+        if (last)
+        {
+            break;
+        }
+
+        segment = segment_end + 1;
     }
 
-    // No need to add information on ourselves
-    if (is_our_eui64(eui64))
+    if (candidates == 0)
     {
+        LOG_ERR("Unknown topic '%.*s'\n", (int)(topic_end - topic), topic);
         return;
     }
 
-    topic += MQTT_IDENTITY_LEN;
-
-    if (*topic != '/')
+    // Topics are distinct, so only one can match
+    for (uint8_t i = 0; i != TOPICS_TO_SUBSCRIBE_LEN; ++i)
     {
-        LOG_ERR("Bad sep\n");
-        return;
+        if (candidates & (1u << i))
+        {
+            topic_handlers[i](eui64, capability_id, chunk, chunk_len);
+            return;
+        }
     }
+}
+/*-------------------------------------------------------------------------------------------------------------------*/
+// Every TRUST_SNAPSHOT_PERIOD periodic broadcasts contains all trust information,
+// the broadcasts in between only contain records that have changed.
+#ifndef TRUST_SNAPSHOT_PERIOD
+#define TRUST_SNAPSHOT_PERIOD 5
+#endif
+_Static_assert(TRUST_SNAPSHOT_PERIOD >= 1, "TRUST_SNAPSHOT_PERIOD must be at least 1");
+/*-------------------------------------------------------------------------------------------------------------------*/
+// Start with a snapshot so peers that are already running learn about all edges
+static uint8_t broadcasts_until_snapshot = 0;
+/*-------------------------------------------------------------------------------------------------------------------*/
+static int serialise_trust_edge_and_capabilities(nanocbor_encoder_t* enc, edge_resource_t* edge, bool snapshot)
+{
+    NANOCBOR_CHECK(nanocbor_fmt_array(enc, 3));
+    NANOCBOR_CHECK(nanocbor_fmt_uint(enc, edge->tm_version));
 
-    topic += 1;
-
-    if (strncmp(MQTT_EDGE_ACTION_ANNOUNCE, topic, strlen(MQTT_EDGE_ACTION_ANNOUNCE)) == 0)
+    if (snapshot || (edge->flags & EDGE_RESOURCE_TRUST_CHANGED))
     {
-        topic += strlen(MQTT_EDGE_ACTION_ANNOUNCE);
-
-        mqtt_publish_announce_handler(topic, topic_end, chunk, chunk_len, eui64);
+        NANOCBOR_CHECK(serialise_trust_edge_resource(enc, &edge->tm));
     }
-    else if (strncmp(MQTT_EDGE_ACTION_UNANNOUNCE, topic, strlen(MQTT_EDGE_ACTION_UNANNOUNCE)) == 0)
+    else
     {
-        topic += strlen(MQTT_EDGE_ACTION_UNANNOUNCE);
-
-        mqtt_publish_unannounce_handler(topic, topic_end, chunk, chunk_len, eui64);
+        NANOCBOR_CHECK(nanocbor_fmt_null(enc));
     }
-    else if (strncmp(MQTT_EDGE_ACTION_CAPABILITY, topic, strlen(MQTT_EDGE_ACTION_CAPABILITY)) == 0)
-    {
-        topic += strlen(MQTT_EDGE_ACTION_CAPABILITY);
 
-        mqtt_publish_capability_handler(topic, topic_end, chunk, chunk_len, eui64);
-    }
-    else
+    size_t num_caps = 0;
+    for (edge_capability_t* cap = list_head(edge->capabilities); cap != NULL; cap = list_item_next(cap))
     {
-        LOG_ERR("Unknown topic '%.*s'\n", topic_end - topic, topic);
+        if (snapshot || (cap->flags & EDGE_CAPABILITY_TRUST_CHANGED))
+        {
+            num_caps += 1;
+        }
     }
-}
-/*-------------------------------------------------------------------------------------------------------------------*/
-static int serialise_trust_edge_and_capabilities(nanocbor_encoder_t* enc, edge_resource_t* edge)
-{
-    NANOCBOR_CHECK(nanocbor_fmt_array(enc, 2));
-    NANOCBOR_CHECK(serialise_trust_edge_resource(enc, &edge->tm));
 
-    NANOCBOR_CHECK(nanocbor_fmt_map(enc, list_length(edge->capabilities)));
+    NANOCBOR_CHECK(nanocbor_fmt_map(enc, num_caps));
     for (edge_capability_t* cap = list_head(edge->capabilities); cap != NULL; cap = list_item_next(cap))
     {
-        NANOCBOR_CHECK(nanocbor_put_tstr(enc, cap->name));
-        NANOCBOR_CHECK(serialise_trust_edge_capability(enc, &cap->tm));
+        if (snapshot || (cap->flags & EDGE_CAPABILITY_TRUST_CHANGED))
+        {
+            NANOCBOR_CHECK(nanocbor_put_tstr(enc, capability_id_name(cap->id)));
+            NANOCBOR_CHECK(nanocbor_fmt_array(enc, 2));
+            NANOCBOR_CHECK(nanocbor_fmt_uint(enc, cap->tm_version));
+            NANOCBOR_CHECK(serialise_trust_edge_capability(enc, &cap->tm));
+        }
     }
 
     return NANOCBOR_OK;
 }
 /*-------------------------------------------------------------------------------------------------------------------*/
-int serialise_trust(const uip_ipaddr_t* addr, uint8_t* buffer, size_t buffer_len)
+static int serialise_trust_edges(const uip_ipaddr_t* addr, bool snapshot, uint8_t* buffer, size_t buffer_len)
 {
-    // Can provide addr to request trust on specific nodes, when NULL is provided
-    // Then details on all edges are sent
+    size_t num_edges;
+    if (addr != NULL)
+    {
+        num_edges = 1;
+    }
+    else if (snapshot)
+    {
+        num_edges = edge_info_count();
+    }
+    else
+    {
+        num_edges = 0;
+        for (edge_resource_t* iter = edge_info_iter(); iter != NULL; iter = edge_info_next(iter))
+        {
+            if (edge_info_tm_has_changes(iter))
+            {
+                num_edges += 1;
+            }
+        }
 
-    const size_t num_edges = (addr == NULL) ? edge_info_count() : 1;
+        // Nothing has changed, so there is nothing to send
+        if (num_edges == 0)
+        {
+            return 0;
+        }
+    }
 
     uint32_t time_secs = clock_seconds();
 
     nanocbor_encoder_t enc;
     nanocbor_encoder_init(&enc, buffer, buffer_len);
 
-    NANOCBOR_CHECK(nanocbor_fmt_array(&enc, 2));
+    NANOCBOR_CHECK(nanocbor_fmt_array(&enc, 3));
     NANOCBOR_CHECK(nanocbor_fmt_uint(&enc, time_secs));
+    NANOCBOR_CHECK(nanocbor_fmt_bool(&enc, snapshot));
     NANOCBOR_CHECK(nanocbor_fmt_map(&enc, num_edges));
 
     if (addr != NULL)
@@ -595,14 +670,17 @@ int serialise_trust(const uip_ipaddr_t* addr, uint8_t* buffer, size_t buffer_len
         }
 
         NANOCBOR_CHECK(nanocbor_fmt_ipaddr(&enc, addr));
-        NANOCBOR_CHECK(serialise_trust_edge_and_capabilities(&enc, edge));
+        NANOCBOR_CHECK(serialise_trust_edge_and_capabilities(&enc, edge, snapshot));
     }
     else
     {
         for (edge_resource_t* iter = edge_info_iter(); iter != NULL; iter = edge_info_next(iter))
         {
-            NANOCBOR_CHECK(nanocbor_fmt_ipaddr(&enc, &iter->ep.ipaddr));
-            NANOCBOR_CHECK(serialise_trust_edge_and_capabilities(&enc, iter));
+            if (snapshot || edge_info_tm_has_changes(iter))
+            {
+                NANOCBOR_CHECK(nanocbor_fmt_ipaddr(&enc, &iter->ep.ipaddr));
+                NANOCBOR_CHECK(serialise_trust_edge_and_capabilities(&enc, iter, snapshot));
+            }
         }
     }
 
@@ -611,52 +689,230 @@ int serialise_trust(const uip_ipaddr_t* addr, uint8_t* buffer, size_t buffer_len
     return nanocbor_encoded_len(&enc);
 }
 /*-------------------------------------------------------------------------------------------------------------------*/
-static int deserialise_trust_edge_and_capabilities(nanocbor_value_t* dec, peer_t* peer, edge_resource_t* edge)
+int serialise_trust(const uip_ipaddr_t* addr, uint8_t* buffer, size_t buffer_len)
 {
+    // Can provide addr to request trust on specific nodes, when NULL is provided
+    // Then details on all edges are sent
+    return serialise_trust_edges(addr, true, buffer, buffer_len);
+}
+/*-------------------------------------------------------------------------------------------------------------------*/
+static void periodic_serialised(bool snapshot)
+{
+    broadcasts_until_snapshot = snapshot ? (TRUST_SNAPSHOT_PERIOD - 1) : (broadcasts_until_snapshot - 1);
+
+    // All changes are now included in this broadcast
+    edge_info_tm_clear_changes();
+}
+/*-------------------------------------------------------------------------------------------------------------------*/
+int serialise_trust_periodic(uint8_t* buffer, size_t buffer_len)
+{
+    const bool snapshot = (broadcasts_until_snapshot == 0);
+
+    const int len = serialise_trust_edges(NULL, snapshot, buffer, buffer_len);
+    if (len < 0)
+    {
+        return len;
+    }
+
+    periodic_serialised(snapshot);
+
+    LOG_DBG("Serialised trust %s of length %d\n", snapshot ? "snapshot" : "delta", len);
+
+    return len;
+}
+/*-------------------------------------------------------------------------------------------------------------------*/
+void serialise_trust_request_snapshot(void)
+{
+    broadcasts_until_snapshot = 0;
+}
+/*-------------------------------------------------------------------------------------------------------------------*/
+bool trust_block_digest(const uint8_t* buffer, size_t buffer_len, uint8_t* digest)
+{
+    uint8_t hash[SHA256_DIGEST_LEN_BYTES];
+    platform_sha256_context_t ctx;
+
+    bool success = platform_crypto_success(platform_sha256_init(&ctx)) &&
+                   platform_crypto_success(platform_sha256_update(&ctx, buffer, buffer_len)) &&
+                   platform_crypto_success(platform_sha256_finalise(&ctx, hash));
+
+    platform_sha256_done(&ctx);
+
+    if (!success)
+    {
+        LOG_ERR("Failed to hash trust block\n");
+        return false;
+    }
+
+    // Truncated to save space in the manifest
+    memcpy(digest, hash, TRUST_BLOCK_DIGEST_LEN);
+
+    return true;
+}
+/*-------------------------------------------------------------------------------------------------------------------*/
+void serialise_trust_stream_init(trust_stream_t* stream)
+{
+    stream->next_edge = edge_info_iter();
+    stream->as_of = (uint32_t)clock_seconds();
+}
+/*-------------------------------------------------------------------------------------------------------------------*/
+static int serialise_trust_stream_block(trust_stream_t* stream, uint8_t* buffer, size_t block_len, size_t buffer_len)
+{
+    assert(buffer_len >= block_len * 2);
+
+    if (stream->next_edge == NULL)
+    {
+        return 0;
+    }
+
+    nanocbor_encoder_t enc;
+    nanocbor_encoder_init(&enc, buffer, buffer_len);
+
+    NANOCBOR_CHECK(nanocbor_fmt_map_indefinite(&enc));
+
+    edge_resource_t* iter;
+    for (iter = stream->next_edge; iter != NULL; iter = edge_info_next(iter))
+    {
+        const nanocbor_encoder_t before = enc;
+
+        NANOCBOR_CHECK(nanocbor_fmt_ipaddr(&enc, &iter->ep.ipaddr));
+        NANOCBOR_CHECK(serialise_trust_edge_and_capabilities(&enc, iter, true));
+
+        // Record crosses the end of the block (leaving space for the end of the map),
+        // so remove it and send it in the next block
+        if (nanocbor_encoded_len(&enc) + 1 > block_len)
+        {
+            enc = before;
+            break;
+        }
+    }
+
+    if (iter == stream->next_edge)
+    {
+        LOG_ERR("Trust for edge %s is too large for a block of %zu\n", edge_info_name(iter), block_len);
+        return -1;
+    }
+
+    stream->next_edge = iter;
+
+    NANOCBOR_CHECK(nanocbor_fmt_end_indefinite(&enc));
+
+    return nanocbor_encoded_len(&enc);
+}
+/*-------------------------------------------------------------------------------------------------------------------*/
+int serialise_trust_stream_next(trust_stream_t* stream, uint8_t* buffer, size_t block_len, size_t buffer_len)
+{
+#ifdef TRUST_MODEL_BETA_DECAY
+    // Every block is decayed to the same time, so the snapshot is consistent however long the blocks take
+    decayed_beta_dist_serialise_as_of(stream->as_of);
+    const int len = serialise_trust_stream_block(stream, buffer, block_len, buffer_len);
+    decayed_beta_dist_serialise_now();
+
+    return len;
+#else
+    return serialise_trust_stream_block(stream, buffer, block_len, buffer_len);
+#endif
+}
+/*-------------------------------------------------------------------------------------------------------------------*/
+int serialise_trust_manifest(uint8_t* buffer, size_t buffer_len, uint8_t num_blocks, const uint8_t* digests)
+{
+    nanocbor_encoder_t enc;
+    nanocbor_encoder_init(&enc, buffer, buffer_len);
+
+    NANOCBOR_CHECK(nanocbor_fmt_array(&enc, 4));
+    NANOCBOR_CHECK(nanocbor_fmt_uint(&enc, clock_seconds()));
+    NANOCBOR_CHECK(nanocbor_fmt_bool(&enc, true));
+    NANOCBOR_CHECK(nanocbor_fmt_uint(&enc, num_blocks));
+    NANOCBOR_CHECK(nanocbor_put_bstr(&enc, digests, num_blocks * TRUST_BLOCK_DIGEST_LEN));
+
+    // Block-wise transfers are always snapshots
+    periodic_serialised(true);
+
+    return nanocbor_encoded_len(&enc);
+}
+/*-------------------------------------------------------------------------------------------------------------------*/
+static int deserialise_trust_edge_and_capabilities(nanocbor_value_t* dec, peer_info_merge_t* merge, edge_resource_t* edge, bool snapshot)
+{
+    peer_info_merge_edge(merge, edge);
+
     nanocbor_value_t arr;
     NANOCBOR_CHECK(nanocbor_enter_array(dec, &arr));
 
-    edge_resource_tm_t edge_tm;
-    NANOCBOR_CHECK(deserialise_trust_edge_resource(&arr, &edge_tm));
+    uint8_t edge_version;
+    NANOCBOR_CHECK(nanocbor_get_uint8(&arr, &edge_version));
+
+    // Edge record is null when only capabilities have changed
+    if (nanocbor_get_null(&arr) != NANOCBOR_OK)
+    {
+        // Fields that are not serialised (such as an interaction history) start from the model's defaults
+        edge_resource_tm_t edge_tm;
+        edge_resource_tm_init(&edge_tm);
+        NANOCBOR_CHECK(deserialise_trust_edge_resource(&arr, &edge_tm));
 
-    peer_info_update_edge(peer, edge, &edge_tm);
+        if (snapshot || peer_info_merge_edge_is_newer(merge, edge_version))
+        {
+            peer_info_merge_update_edge(merge, edge_version, &edge_tm);
+        }
+        else
+        {
+            LOG_DBG("Skipping stale edge %s v%" PRIu8 "\n", edge_info_name(edge), edge_version);
+        }
+    }
 
     nanocbor_value_t map;
     NANOCBOR_CHECK(nanocbor_enter_map(&arr, &map));
 
+    // Capabilities are sent in canonical order, so only move forward through ours
+    edge_capability_t* cap_iter = list_head(edge->capabilities);
+
     while (!nanocbor_at_end(&map))
     {
         const char* cap_name;
         size_t cap_name_len;
         NANOCBOR_CHECK(nanocbor_get_tstr(&map, &cap_name, &cap_name_len));
 
-        if (cap_name_len > EDGE_CAPABILITY_NAME_LEN)
-        {
-            LOG_DBG("Skipping processing edge ");
-            LOG_DBG_6ADDR(&edge->ep.ipaddr);
-            LOG_DBG_(" capability %.*s (name too long)\n", cap_name_len, cap_name);
-
-            NANOCBOR_CHECK(nanocbor_skip(&map));
-            continue;
-        }
-
-        char cap_name_terminated[EDGE_CAPABILITY_NAME_LEN + 1];
-        strncpy(cap_name_terminated, cap_name, cap_name_len);
-        cap_name_terminated[cap_name_len] = '\0';
+        // Unknown names intern to CAPABILITY_ID_INVALID, which no edge capability has
+        const capability_id_t cap_id = capability_id_findn(cap_name, cap_name_len);
 
-        edge_capability_t* cap = edge_info_capability_find(edge, cap_name_terminated);
+        edge_capability_t* cap = capability_id_is_valid(cap_id)
+            ? edge_info_capability_find_next(edge, &cap_iter, cap_id)
+            : NULL;
         if (cap != NULL)
         {
-            edge_capability_tm_t cap_tm;
-            NANOCBOR_CHECK(deserialise_trust_edge_capability(&map, &cap_tm));
+            nanocbor_value_t cap_arr;
+            NANOCBOR_CHECK(nanocbor_enter_array(&map, &cap_arr));
+
+            uint8_t cap_version;
+            NANOCBOR_CHECK(nanocbor_get_uint8(&cap_arr, &cap_version));
 
-            peer_info_update_capability(peer, edge, cap, &cap_tm);
+            edge_capability_tm_t cap_tm;
+            edge_capability_tm_init(&cap_tm);
+            NANOCBOR_CHECK(deserialise_trust_edge_capability(&cap_arr, &cap_tm));
+
+            if (!nanocbor_at_end(&cap_arr))
+            {
+                LOG_ERR("!nanocbor_at_end\n");
+                return -1;
+            }
+
+            nanocbor_leave_container(&map, &cap_arr);
+
+            peer_info_merge_capability(merge, cap);
+
+            if (snapshot || peer_info_merge_capability_is_newer(merge, cap_version))
+            {
+                peer_info_merge_update_capability(merge, cap_version, &cap_tm);
+            }
+            else
+            {
+                LOG_DBG("Skipping stale edge %s capability %s v%" PRIu8 "\n",
+                    edge_info_name(edge), capability_id_name(cap_id), cap_version);
+            }
         }
         else
         {
             LOG_DBG("Skipping processing edge ");
             LOG_DBG_6ADDR(&edge->ep.ipaddr);
-            LOG_DBG_(" unknown capability %.*s\n", cap_name_len, cap_name);
+            LOG_DBG_(" unknown capability %.*s\n", (int)cap_name_len, cap_name);
 
             NANOCBOR_CHECK(nanocbor_skip(&map));
         }
@@ -675,6 +931,47 @@ static int deserialise_trust_edge_and_capabilities(nanocbor_value_t* dec, peer_t
     return NANOCBOR_OK;
 }
 /*-------------------------------------------------------------------------------------------------------------------*/
+static int deserialise_trust_edges(nanocbor_value_t* dec, peer_t* peer, bool snapshot)
+{
+    nanocbor_value_t map;
+    NANOCBOR_CHECK(nanocbor_enter_map(dec, &map));
+
+    peer_info_merge_t merge;
+    peer_info_merge_begin(&merge, peer);
+
+    while (!nanocbor_at_end(&map))
+    {
+        const uip_ipaddr_t* ipaddr;
+        NANOCBOR_CHECK(nanocbor_get_ipaddr(&map, &ipaddr));
+
+        // TODO: in the future might want to consider creating an edge here
+        // Risk of possible DoS via buffer exhaustion though
+        edge_resource_t* edge = edge_info_find_addr(ipaddr);
+        if (edge == NULL)
+        {
+            LOG_DBG("Skipping processing unknown edge ");
+            LOG_DBG_6ADDR(ipaddr);
+            LOG_DBG_("\n");
+
+            NANOCBOR_CHECK(nanocbor_skip(&map));
+        }
+        else
+        {
+            NANOCBOR_CHECK(deserialise_trust_edge_and_capabilities(&map, &merge, edge, snapshot));
+        }
+    }
+
+    if (!nanocbor_at_end(&map))
+    {
+        LOG_ERR("!nanocbor_at_end 4\n");
+        return -1;
+    }
+
+    nanocbor_leave_container(dec, &map);
+
+    return NANOCBOR_OK;
+}
+/*-------------------------------------------------------------------------------------------------------------------*/
 int process_received_trust(const uip_ipaddr_t* src, const uint8_t* buffer, size_t buffer_len)
 {
     // Add or find peer
@@ -687,60 +984,323 @@ int process_received_trust(const uip_ipaddr_t* src, const uint8_t* buffer, size_
         return -1;
     }
 
-    //const uint32_t previous_last_seen = peer->last_seen;
-
     nanocbor_value_t dec;
     nanocbor_decoder_init(&dec, buffer, buffer_len);
 
     nanocbor_value_t arr;
     NANOCBOR_CHECK(nanocbor_enter_array(&dec, &arr));
 
-    NANOCBOR_CHECK(nanocbor_get_uint32(&arr, &peer->last_seen));
+    uint32_t time_secs;
+    NANOCBOR_CHECK(nanocbor_get_uint32(&arr, &time_secs));
 
-    nanocbor_value_t map;
-    NANOCBOR_CHECK(nanocbor_enter_map(&arr, &map));
+    bool snapshot;
+    NANOCBOR_CHECK(nanocbor_get_bool(&arr, &snapshot));
 
-    while (!nanocbor_at_end(&map))
+    // A delta older than the last broadcast seen is a replay, merging it would roll back newer records.
+    // A restarted peer's clock and record versions have been reset, but it starts with a snapshot.
+    if (peer->last_seen != PEER_LAST_SEEN_INVALID && time_secs < peer->last_seen)
     {
-        const uip_ipaddr_t* ipaddr;
-        NANOCBOR_CHECK(nanocbor_get_ipaddr(&map, &ipaddr));
+        if (!snapshot)
+        {
+            LOG_WARN("Rejecting trust delta from ");
+            LOG_WARN_6ADDR(src);
+            LOG_WARN_(" from %" PRIu32 " older than the last seen %" PRIu32 "\n", time_secs, peer->last_seen);
+            return -1;
+        }
 
-        // TODO: in the future might want to consider creating an edge here
-        // Risk of possible DoS via buffer exhaustion though
-        edge_resource_t* edge = edge_info_find_addr(ipaddr);
-        if (edge == NULL)
+        LOG_INFO("Peer ");
+        LOG_INFO_6ADDR(src);
+        LOG_INFO_(" has restarted\n");
+    }
+
+    peer->last_seen = time_secs;
+
+    NANOCBOR_CHECK(deserialise_trust_edges(&arr, peer, snapshot));
+
+    if (!nanocbor_at_end(&arr))
+    {
+        LOG_ERR("!nanocbor_at_end 5\n");
+        return -1;
+    }
+
+    nanocbor_leave_container(&dec, &arr);
+
+    return 0;
+}
+/*-------------------------------------------------------------------------------------------------------------------*/
+typedef struct {
+    // Sender's EUI-64, used to match blocks to the manifest
+    uint8_t eui64[EUI64_LENGTH];
+
+    // Sender's address derived from its certificate, used to find the peer
+    uip_ipaddr_t addr;
+
+    uint8_t token[COAP_TOKEN_LEN];
+    uint8_t token_len;
+
+    uint8_t num_blocks;
+    uint16_t received;
+
+    clock_time_t started;
+
+    // Blocks not received within the time it takes to send all of them since the
+    // manifest was verified, or since they were last requested, are requested again
+    clock_time_t nacked;
+    uint8_t nacks;
+
+    uint8_t digests[TRUST_BLOCKS_MAX * TRUST_BLOCK_DIGEST_LEN];
+
+    bool in_use;
+
+} trust_rx_transfer_t;
+/*-------------------------------------------------------------------------------------------------------------------*/
+_Static_assert(TRUST_BLOCKS_MAX <= 16, "trust_rx_transfer_t.received cannot track more than 16 blocks");
+/*-------------------------------------------------------------------------------------------------------------------*/
+static trust_rx_transfer_t rx_transfers[TRUST_RX_TRANSFERS];
+/*-------------------------------------------------------------------------------------------------------------------*/
+static trust_rx_transfer_t* rx_transfer_allocate(const uint8_t* eui64)
+{
+    const clock_time_t now = clock_time();
+    trust_rx_transfer_t* oldest = &rx_transfers[0];
+
+    for (uint8_t i = 0; i != TRUST_RX_TRANSFERS; ++i)
+    {
+        trust_rx_transfer_t* transfer = &rx_transfers[i];
+
+        // A new transfer from the same sender replaces the previous one
+        if (!transfer->in_use || memcmp(transfer->eui64, eui64, EUI64_LENGTH) == 0)
         {
-            LOG_DBG("Skipping processing unknown edge ");
-            LOG_DBG_6ADDR(ipaddr);
-            LOG_DBG_("\n");
+            return transfer;
+        }
 
-            NANOCBOR_CHECK(nanocbor_skip(&map));
+        if ((clock_time_t)(now - transfer->started) > (clock_time_t)(now - oldest->started))
+        {
+            oldest = transfer;
         }
-        else
+    }
+
+    LOG_WARN("Replacing trust block transfer from ");
+    LOG_WARN_BYTES(oldest->eui64, EUI64_LENGTH);
+    LOG_WARN_("\n");
+
+    return oldest;
+}
+/*-------------------------------------------------------------------------------------------------------------------*/
+static trust_rx_transfer_t* rx_transfer_find(const uint8_t* eui64, const uint8_t* token, uint8_t token_len)
+{
+    for (uint8_t i = 0; i != TRUST_RX_TRANSFERS; ++i)
+    {
+        trust_rx_transfer_t* transfer = &rx_transfers[i];
+
+        if (transfer->in_use &&
+            transfer->token_len == token_len &&
+            memcmp(transfer->token, token, token_len) == 0 &&
+            memcmp(transfer->eui64, eui64, EUI64_LENGTH) == 0)
         {
-            NANOCBOR_CHECK(deserialise_trust_edge_and_capabilities(&map, peer, edge));
+            return transfer;
         }
     }
 
-    if (!nanocbor_at_end(&map))
+    return NULL;
+}
+/*-------------------------------------------------------------------------------------------------------------------*/
+int process_received_trust_manifest(const uip_ipaddr_t* src, const uint8_t* token, uint8_t token_len,
+                                    const uint8_t* buffer, size_t buffer_len)
+{
+    if (token_len > COAP_TOKEN_LEN)
     {
-        LOG_ERR("!nanocbor_at_end 4\n");
         return -1;
     }
 
-    nanocbor_leave_container(&arr, &map);
+    peer_t* peer = peer_info_add(src);
+    if (peer == NULL)
+    {
+        LOG_ERR("Failed to create peer data storage for ");
+        LOG_ERR_6ADDR(src);
+        LOG_ERR_("\n");
+        return -1;
+    }
+
+    nanocbor_value_t dec;
+    nanocbor_decoder_init(&dec, buffer, buffer_len);
+
+    nanocbor_value_t arr;
+    NANOCBOR_CHECK(nanocbor_enter_array(&dec, &arr));
+
+    uint32_t time_secs;
+    NANOCBOR_CHECK(nanocbor_get_uint32(&arr, &time_secs));
+
+    bool snapshot;
+    NANOCBOR_CHECK(nanocbor_get_bool(&arr, &snapshot));
+
+    uint8_t num_blocks;
+    NANOCBOR_CHECK(nanocbor_get_uint8(&arr, &num_blocks));
+
+    const uint8_t* digests;
+    size_t digests_len;
+    NANOCBOR_CHECK(nanocbor_get_bstr(&arr, &digests, &digests_len));
+
+    if (num_blocks == 0 || num_blocks > TRUST_BLOCKS_MAX || digests_len != num_blocks * TRUST_BLOCK_DIGEST_LEN)
+    {
+        LOG_ERR("Invalid trust manifest with %" PRIu8 " blocks and %zu bytes of digests\n", num_blocks, digests_len);
+        return -1;
+    }
 
     if (!nanocbor_at_end(&arr))
     {
-        LOG_ERR("!nanocbor_at_end 5\n");
+        LOG_ERR("!nanocbor_at_end\n");
         return -1;
     }
 
     nanocbor_leave_container(&dec, &arr);
 
+    peer->last_seen = time_secs;
+
+    uint8_t eui64[EUI64_LENGTH];
+    eui64_from_ipaddr(src, eui64);
+
+    trust_rx_transfer_t* transfer = rx_transfer_allocate(eui64);
+
+    memcpy(transfer->eui64, eui64, EUI64_LENGTH);
+    uip_ipaddr_copy(&transfer->addr, src);
+    memcpy(transfer->token, token, token_len);
+    transfer->token_len = token_len;
+    transfer->num_blocks = num_blocks;
+    transfer->received = 0;
+    transfer->started = clock_time();
+    transfer->nacked = transfer->started;
+    transfer->nacks = 0;
+    memcpy(transfer->digests, digests, digests_len);
+    transfer->in_use = true;
+
+    LOG_DBG("Expecting %" PRIu8 " trust blocks from ", num_blocks);
+    LOG_DBG_6ADDR(src);
+    LOG_DBG_("\n");
+
+    return 0;
+}
+/*-------------------------------------------------------------------------------------------------------------------*/
+int process_received_trust_block(const uip_ipaddr_t* src, const uint8_t* token, uint8_t token_len, uint32_t num,
+                                 const uint8_t* buffer, size_t buffer_len)
+{
+    uint8_t eui64[EUI64_LENGTH];
+    eui64_from_ipaddr(src, eui64);
+
+    trust_rx_transfer_t* transfer = rx_transfer_find(eui64, token, token_len);
+    if (transfer == NULL)
+    {
+        // Either the manifest was lost, or it has not finished being verified yet
+        LOG_DBG("No verified manifest for trust block %" PRIu32 " from ", num);
+        LOG_DBG_6ADDR(src);
+        LOG_DBG_("\n");
+        return -1;
+    }
+
+    // Block 0 is the manifest
+    if (num == 0 || num > transfer->num_blocks)
+    {
+        LOG_ERR("Invalid trust block %" PRIu32 " of %" PRIu8 "\n", num, transfer->num_blocks);
+        return -1;
+    }
+
+    const uint16_t block_bit = (uint16_t)1 << (num - 1);
+    if (transfer->received & block_bit)
+    {
+        return 0;
+    }
+
+    uint8_t digest[TRUST_BLOCK_DIGEST_LEN];
+    if (!trust_block_digest(buffer, buffer_len, digest))
+    {
+        return -1;
+    }
+
+    if (memcmp(digest, &transfer->digests[(num - 1) * TRUST_BLOCK_DIGEST_LEN], TRUST_BLOCK_DIGEST_LEN) != 0)
+    {
+        LOG_WARN("Trust block %" PRIu32 " from ", num);
+        LOG_WARN_6ADDR(src);
+        LOG_WARN_(" does not match the manifest, discarding it\n");
+        return -1;
+    }
+
+    peer_t* peer = peer_info_find(&transfer->addr);
+    if (peer == NULL)
+    {
+        transfer->in_use = false;
+        return -1;
+    }
+
+    nanocbor_value_t dec;
+    nanocbor_decoder_init(&dec, buffer, buffer_len);
+
+    // Block-wise transfers are always snapshots
+    NANOCBOR_CHECK(deserialise_trust_edges(&dec, peer, true));
+
+    transfer->received |= block_bit;
+
+    if (transfer->received == (uint16_t)((1u << transfer->num_blocks) - 1))
+    {
+        LOG_DBG("Received all %" PRIu8 " trust blocks from ", transfer->num_blocks);
+        LOG_DBG_6ADDR(src);
+        LOG_DBG_("\n");
+
+        transfer->in_use = false;
+    }
+
     return 0;
 }
 /*-------------------------------------------------------------------------------------------------------------------*/
+bool trust_rx_transfer_nack(uip_ipaddr_t* src, const uint8_t** token, uint8_t* token_len, uint16_t* missing)
+{
+    const clock_time_t now = clock_time();
+
+    for (uint8_t i = 0; i != TRUST_RX_TRANSFERS; ++i)
+    {
+        trust_rx_transfer_t* transfer = &rx_transfers[i];
+
+        if (!transfer->in_use ||
+            (clock_time_t)(now - transfer->nacked) < (clock_time_t)((transfer->num_blocks + 1) * TRUST_BLOCK_INTERVAL))
+        {
+            continue;
+        }
+
+        if (transfer->nacks == TRUST_BLOCK_NACKS_MAX)
+        {
+            LOG_WARN("Giving up on trust blocks from ");
+            LOG_WARN_6ADDR(&transfer->addr);
+            LOG_WARN_(", will wait for the next snapshot\n");
+
+            transfer->in_use = false;
+            continue;
+        }
+
+        transfer->nacks += 1;
+        transfer->nacked = now;
+
+        uip_ipaddr_copy(src, &transfer->addr);
+        *token = transfer->token;
+        *token_len = transfer->token_len;
+        *missing = (uint16_t)((1u << transfer->num_blocks) - 1) & ~transfer->received;
+
+        return true;
+    }
+
+    return false;
+}
+/*-------------------------------------------------------------------------------------------------------------------*/
+bool trust_rx_transfers_pending(void)
+{
+    for (uint8_t i = 0; i != TRUST_RX_TRANSFERS; ++i)
+    {
+        if (rx_transfers[i].in_use)
+        {
+            return true;
+        }
+    }
+
+    return false;
+}
+/*-------------------------------------------------------------------------------------------------------------------*/
 void
 trust_common_init(void)
 {
@@ -749,10 +1309,15 @@ trust_common_init(void)
     pe_edge_capability_add = process_alloc_event();
     pe_edge_capability_remove = process_alloc_event();
 
-    trust_weights_init();
+    memset(rx_transfers, 0, sizeof(rx_transfers));
 
     stereotypes_init();
 
+#ifdef TRUST_SNAPSHOT
+    // Needs the record pools to have been initialised
+    trust_snapshot_init();
+#endif
+
     // Only enable pinging edges for IoT devices
 #if defined(TRUST_MODEL_PERIODIC_EDGE_PING) && defined(TRUST_NODE)
     edge_ping_start();
@@ -2,6 +2,7 @@
 
 #include <stdint.h>
 #include <stddef.h>
+#include <stdbool.h>
 
 #include "os/net/ipv6/uip.h"
 /*-------------------------------------------------------------------------------------------------------------------*/
@@ -20,7 +21,70 @@
 /*-------------------------------------------------------------------------------------------------------------------*/
 void trust_common_init(void);
 /*-------------------------------------------------------------------------------------------------------------------*/
+// Serialises a snapshot of all trust information (or only that on addr, if provided).
+// Edges and capabilities are written in canonical order (edge_info_compare, capability_id_compare),
+// so receivers can merge them with their records in a single pass.
 int serialise_trust(const uip_ipaddr_t* addr, uint8_t* buffer, size_t buffer_len);
+// Serialises a periodic broadcast, this is either a snapshot or only the records
+// that have changed since the last periodic broadcast. Returns 0 when nothing has changed.
+int serialise_trust_periodic(uint8_t* buffer, size_t buffer_len);
+// Makes the next periodic broadcast a snapshot, e.g., when the last one failed to be sent
+void serialise_trust_request_snapshot(void);
+/*-------------------------------------------------------------------------------------------------------------------*/
+// Trust information too large for a single payload is sent as a block-wise transfer.
+// Block 0 is a signed manifest containing the digest of every following block.
+// Each following block is a self-contained CBOR map of whole edge records, so it
+// can be authenticated against the manifest and merged as soon as it is received.
+#define TRUST_BLOCK_DIGEST_LEN 16
+/*-------------------------------------------------------------------------------------------------------------------*/
+#ifndef TRUST_BLOCKS_MAX
+#define TRUST_BLOCKS_MAX 8
+#endif
+/*-------------------------------------------------------------------------------------------------------------------*/
+#ifndef TRUST_RX_TRANSFERS
+#define TRUST_RX_TRANSFERS 1
+#endif
+/*-------------------------------------------------------------------------------------------------------------------*/
+// Time between sending each block, gives receivers time to verify the manifest
+#ifndef TRUST_BLOCK_INTERVAL
+#define TRUST_BLOCK_INTERVAL (2 * CLOCK_SECOND)
+#endif
+/*-------------------------------------------------------------------------------------------------------------------*/
+// Number of times a receiver asks the sender to resend the blocks it missed, before giving
+// up and waiting for the next snapshot
+#ifndef TRUST_BLOCK_NACKS_MAX
+#define TRUST_BLOCK_NACKS_MAX 2
+#endif
+/*-------------------------------------------------------------------------------------------------------------------*/
+typedef struct {
+    struct edge_resource* next_edge;
+
+    // When the snapshot was started (in clock_seconds), which time-decayed trust is serialised as of
+    uint32_t as_of;
+} trust_stream_t;
+/*-------------------------------------------------------------------------------------------------------------------*/
+bool trust_block_digest(const uint8_t* buffer, size_t buffer_len, uint8_t* digest);
+/*-------------------------------------------------------------------------------------------------------------------*/
+// Starts a snapshot of all edges, which is split into blocks by serialise_trust_stream_next.
+// The blocks of an earlier snapshot can be serialised again by setting as_of to that snapshot's,
+// they are the same blocks if the records have not changed since (see edge_info_generation).
+void serialise_trust_stream_init(trust_stream_t* stream);
+// Serialises as many edge records as fit in block_len bytes. buffer_len must be at least
+// twice block_len, so a record that crosses the end of the block can be detected and
+// moved to the next block. Returns 0 when no edges are left.
+int serialise_trust_stream_next(trust_stream_t* stream, uint8_t* buffer, size_t block_len, size_t buffer_len);
+int serialise_trust_manifest(uint8_t* buffer, size_t buffer_len, uint8_t num_blocks, const uint8_t* digests);
+/*-------------------------------------------------------------------------------------------------------------------*/
+// The manifest must have had its signature verified before calling this
+int process_received_trust_manifest(const uip_ipaddr_t* src, const uint8_t* token, uint8_t token_len,
+                                    const uint8_t* buffer, size_t buffer_len);
+int process_received_trust_block(const uip_ipaddr_t* src, const uint8_t* token, uint8_t token_len, uint32_t num,
+                                 const uint8_t* buffer, size_t buffer_len);
+// Finds a transfer whose blocks should all have been received by now, so the sender can be asked to
+// resend the missing ones (bit n - 1 is set when block n is missing). This includes blocks that
+// arrived before the manifest had been verified. Returns false when there is no such transfer.
+bool trust_rx_transfer_nack(uip_ipaddr_t* src, const uint8_t** token, uint8_t* token_len, uint16_t* missing);
+bool trust_rx_transfers_pending(void);
 /*-------------------------------------------------------------------------------------------------------------------*/
 int process_received_trust(const uip_ipaddr_t* src, const uint8_t* buffer, size_t buffer_len);
 /*-------------------------------------------------------------------------------------------------------------------*/
@@ -1,6 +1,10 @@
 #include "trust-models.h"
+#include "applications.h"
+#include "trust-snapshot.h"
 #include "os/sys/log.h"
-#include "list.h"
+#include "os/sys/clock.h"
+#include <string.h>
+#include <inttypes.h>
 #include "assert.h"
 /*-------------------------------------------------------------------------------------------------------------------*/
 #define LOG_MODULE "trust-mods"
@@ -10,80 +14,31 @@
 #define LOG_LEVEL LOG_LEVEL_NONE
 #endif
 /*-------------------------------------------------------------------------------------------------------------------*/
-LIST(trust_weights);
+// Each application's metric weights must sum to 1
+APPLICATION_TRUST_WEIGHTS_CHECK
 /*-------------------------------------------------------------------------------------------------------------------*/
-void trust_weights_init(void)
-{
-    list_init(trust_weights);
-}
-/*-------------------------------------------------------------------------------------------------------------------*/
-void trust_weights_add(trust_weights_t* item)
-{
-    list_add(trust_weights, item);
-}
-/*-------------------------------------------------------------------------------------------------------------------*/
-trust_weights_t* trust_weights_find(const char* application_name)
-{
-    for (trust_weights_t* iter = list_head(trust_weights); iter != NULL; iter = list_item_next(iter))
-    {
-        if (strcmp(iter->application_name, application_name) == 0)
-        {
-            return iter;
-        }
-    }
-
-    return NULL;
-}
-/*-------------------------------------------------------------------------------------------------------------------*/
-float find_trust_weight(const char* application_name, uint16_t id)
-{
-    trust_weights_t* weights = trust_weights_find(application_name);
-    if (weights == NULL)
-    {
-        LOG_ERR("Failed to find trust weight information for %s\n", application_name);
-        return 0.0f;
-    }
-
-    for (uint8_t i = 0; i != weights->num; ++i)
-    {
-        const trust_weight_t* iter = &weights->weights[i];
-
-        if (iter->id == id)
-        {
-            return iter->weight;
-        }
-    }
-
-    // No weight specified for this trust component
-    return 0.0f;
-}
+// Rows are in the same order as APPLICATION_IDS
+const trust_real_t trust_weights[CAPABILITY_ID_NUM][TRUST_WEIGHT_NUM] = { APPLICATION_TRUST_WEIGHTS };
 /*-------------------------------------------------------------------------------------------------------------------*/
 #ifdef APPLICATIONS_MONITOR_THROUGHPUT
-LIST(trust_throughput_thresholds);
+// Indexed by capability ID
+static const trust_throughput_threshold_t* trust_throughput_thresholds[CAPABILITY_ID_NUM];
 /*-------------------------------------------------------------------------------------------------------------------*/
 void trust_throughput_thresholds_init(void)
 {
-    list_init(trust_throughput_thresholds);
+    memset(trust_throughput_thresholds, 0, sizeof(trust_throughput_thresholds));
 }
 /*-------------------------------------------------------------------------------------------------------------------*/
 void trust_throughput_thresholds_add(trust_throughput_threshold_t* item)
 {
-    list_add(trust_throughput_thresholds, item);
+    assert(capability_id_is_valid(item->id));
+
+    trust_throughput_thresholds[item->id] = item;
 }
 /*-------------------------------------------------------------------------------------------------------------------*/
-trust_throughput_threshold_t* trust_throughput_thresholds_find(const char* application_name)
+const trust_throughput_threshold_t* trust_throughput_thresholds_find(capability_id_t cap_id)
 {
-    for (trust_throughput_threshold_t* iter = list_head(trust_throughput_thresholds);
-         iter != NULL;
-         iter = list_item_next(iter))
-    {
-        if (strcmp(iter->application_name, application_name) == 0)
-        {
-            return iter;
-        }
-    }
-
-    return NULL;
+    return capability_id_is_valid(cap_id) ? trust_throughput_thresholds[cap_id] : NULL;
 }
 #endif
 /*-------------------------------------------------------------------------------------------------------------------*/
@@ -141,39 +96,234 @@ bool tm_challenge_response_good(const tm_challenge_response_info_t* info, bool*
     return good;
 }
 /*-------------------------------------------------------------------------------------------------------------------*/
-__attribute__((__weak__)) void tm_update_task_submission(edge_resource_t* edge, edge_capability_t* cap, const tm_task_submission_info_t* info)
+__attribute__((__weak__)) void tm_model_update_task_submission(edge_resource_t* edge, edge_capability_t* cap, const tm_task_submission_info_t* info)
 {
 }
 /*-------------------------------------------------------------------------------------------------------------------*/
-__attribute__((__weak__)) void tm_update_task_result(edge_resource_t* edge, edge_capability_t* cap, const tm_task_result_info_t* info)
+__attribute__((__weak__)) void tm_model_update_task_result(edge_resource_t* edge, edge_capability_t* cap, const tm_task_result_info_t* info)
 {
 }
 /*-------------------------------------------------------------------------------------------------------------------*/
-__attribute__((__weak__)) void tm_update_announce(edge_resource_t* edge, edge_capability_t* cap, const tm_announce_info_t* info)
+__attribute__((__weak__)) void tm_model_update_announce(edge_resource_t* edge, edge_capability_t* cap, const tm_announce_info_t* info)
 {
 }
 /*-------------------------------------------------------------------------------------------------------------------*/
-__attribute__((__weak__)) void tm_update_result_quality(edge_resource_t* edge, edge_capability_t* cap, const tm_result_quality_info_t* info)
+__attribute__((__weak__)) void tm_model_update_result_quality(edge_resource_t* edge, edge_capability_t* cap, const tm_result_quality_info_t* info)
 {
 }
 /*-------------------------------------------------------------------------------------------------------------------*/
-__attribute__((__weak__)) void tm_update_result_latency(edge_resource_t* edge, edge_capability_t* cap, const tm_result_latency_info_t* info)
+__attribute__((__weak__)) void tm_model_update_result_latency(edge_resource_t* edge, edge_capability_t* cap, const tm_result_latency_info_t* info)
 {
 }
 /*-------------------------------------------------------------------------------------------------------------------*/
-__attribute__((__weak__)) void tm_update_task_throughput(edge_resource_t* edge, edge_capability_t* cap, const tm_throughput_info_t* info)
+__attribute__((__weak__)) void tm_model_update_task_throughput(edge_resource_t* edge, edge_capability_t* cap, const tm_throughput_info_t* info)
 {
 }
 /*-------------------------------------------------------------------------------------------------------------------*/
-__attribute__((__weak__)) void tm_update_challenge_response(edge_resource_t* edge, const tm_challenge_response_info_t* info)
+__attribute__((__weak__)) void tm_model_update_challenge_response(edge_resource_t* edge, const tm_challenge_response_info_t* info)
 {
 }
 /*-------------------------------------------------------------------------------------------------------------------*/
-__attribute__((__weak__)) void tm_update_task_observation(peer_t* peer, const tm_task_observation_info_t* info)
+__attribute__((__weak__)) void tm_model_update_task_observation(peer_t* peer, const tm_task_observation_info_t* info)
 {
 }
 /*-------------------------------------------------------------------------------------------------------------------*/
-__attribute__((__weak__)) void tm_update_ping(edge_resource_t* edge, const tm_edge_ping_t* info)
+__attribute__((__weak__)) void tm_model_update_ping(edge_resource_t* edge, const tm_edge_ping_t* info)
 {
 }
 /*-------------------------------------------------------------------------------------------------------------------*/
+// Model updates mark the records they change with edge_info_tm_changed or edge_info_capability_tm_changed,
+// both of which advance the edge generation
+static void tm_updated(edge_resource_t* edge, edge_capability_t* cap, uint16_t generation)
+{
+    edge_info_used(edge, cap);
+
+    if (edge_info_generation() != generation)
+    {
+        // Whole edge, as the challenge response result quality contributes to other capabilities
+        trust_cache_invalidate_edge(edge);
+    }
+}
+/*-------------------------------------------------------------------------------------------------------------------*/
+void tm_update_task_submission(edge_resource_t* edge, edge_capability_t* cap, const tm_task_submission_info_t* info)
+{
+    const uint16_t generation = edge_info_generation();
+
+    tm_model_update_task_submission(edge, cap, info);
+    tm_updated(edge, cap, generation);
+}
+/*-------------------------------------------------------------------------------------------------------------------*/
+void tm_update_task_result(edge_resource_t* edge, edge_capability_t* cap, const tm_task_result_info_t* info)
+{
+    const uint16_t generation = edge_info_generation();
+
+    tm_model_update_task_result(edge, cap, info);
+    tm_updated(edge, cap, generation);
+}
+/*-------------------------------------------------------------------------------------------------------------------*/
+void tm_update_announce(edge_resource_t* edge, edge_capability_t* cap, const tm_announce_info_t* info)
+{
+    const uint16_t generation = edge_info_generation();
+
+    tm_model_update_announce(edge, cap, info);
+    tm_updated(edge, cap, generation);
+}
+/*-------------------------------------------------------------------------------------------------------------------*/
+void tm_update_result_quality(edge_resource_t* edge, edge_capability_t* cap, const tm_result_quality_info_t* info)
+{
+    const uint16_t generation = edge_info_generation();
+
+    tm_model_update_result_quality(edge, cap, info);
+    tm_updated(edge, cap, generation);
+}
+/*-------------------------------------------------------------------------------------------------------------------*/
+void tm_update_result_latency(edge_resource_t* edge, edge_capability_t* cap, const tm_result_latency_info_t* info)
+{
+    const uint16_t generation = edge_info_generation();
+
+    tm_model_update_result_latency(edge, cap, info);
+    tm_updated(edge, cap, generation);
+}
+/*-------------------------------------------------------------------------------------------------------------------*/
+void tm_update_task_throughput(edge_resource_t* edge, edge_capability_t* cap, const tm_throughput_info_t* info)
+{
+    const uint16_t generation = edge_info_generation();
+
+    tm_model_update_task_throughput(edge, cap, info);
+    tm_updated(edge, cap, generation);
+
+#ifdef TRUST_MODEL_HAS_PER_CAPABILITY_INFO
+    // Per-capability information is shared between all edges
+    trust_cache_invalidate_all();
+#endif
+}
+/*-------------------------------------------------------------------------------------------------------------------*/
+void tm_update_challenge_response(edge_resource_t* edge, const tm_challenge_response_info_t* info)
+{
+    const uint16_t generation = edge_info_generation();
+
+    tm_model_update_challenge_response(edge, info);
+    tm_updated(edge, NULL, generation);
+}
+/*-------------------------------------------------------------------------------------------------------------------*/
+void tm_update_task_observation(peer_t* peer, const tm_task_observation_info_t* info)
+{
+    tm_model_update_task_observation(peer, info);
+
+    // Peer information can contribute to the trust of any edge
+    trust_cache_invalidate_all();
+}
+/*-------------------------------------------------------------------------------------------------------------------*/
+void tm_update_ping(edge_resource_t* edge, const tm_edge_ping_t* info)
+{
+    const uint16_t generation = edge_info_generation();
+
+    tm_model_update_ping(edge, info);
+    tm_updated(edge, NULL, generation);
+}
+/*-------------------------------------------------------------------------------------------------------------------*/
+static uint16_t trust_cache_epoch;
+static trust_cache_stats_t trust_cache_stats_data;
+/*-------------------------------------------------------------------------------------------------------------------*/
+static void trust_cache_next_epoch(void)
+{
+    trust_cache_epoch += 1;
+
+    // On wrap around an old entry could match the new epoch, so clear every entry
+    if (trust_cache_epoch == 0)
+    {
+        for (edge_resource_t* edge = edge_info_iter(); edge != NULL; edge = edge_info_next(edge))
+        {
+            for (edge_capability_t* cap = list_head(edge->capabilities); cap != NULL; cap = list_item_next(cap))
+            {
+                cap->flags &= ~EDGE_CAPABILITY_TRUST_CACHED;
+            }
+        }
+    }
+}
+/*-------------------------------------------------------------------------------------------------------------------*/
+#ifdef TRUST_MODEL_BETA_DECAY
+// Checked lazily on lookup rather than with a timer. Not a change to the trust information,
+// so unlike trust_cache_invalidate_all this does not mark the snapshot as changed.
+static void trust_cache_decay(void)
+{
+    static uint32_t quantum;
+
+    const uint32_t now = (uint32_t)clock_seconds() / TRUST_CACHE_DECAY_QUANTUM;
+
+    if (now != quantum)
+    {
+        quantum = now;
+        trust_cache_next_epoch();
+
+        trust_cache_stats_data.invalidate_decay += 1;
+    }
+}
+#endif
+/*-------------------------------------------------------------------------------------------------------------------*/
+#ifndef TRUST_MODEL_NO_TRUST_VALUE
+trust_real_t trust_value_cached(edge_resource_t* edge, edge_capability_t* cap)
+{
+#ifdef TRUST_MODEL_BETA_DECAY
+    trust_cache_decay();
+#endif
+
+    if ((cap->flags & EDGE_CAPABILITY_TRUST_CACHED) && cap->trust_epoch == trust_cache_epoch)
+    {
+        trust_cache_stats_data.hits += 1;
+        return cap->trust;
+    }
+
+    trust_cache_stats_data.misses += 1;
+
+    cap->trust = calculate_trust_value(edge, cap);
+    cap->trust_epoch = trust_cache_epoch;
+    cap->flags |= EDGE_CAPABILITY_TRUST_CACHED;
+
+    return cap->trust;
+}
+#endif
+/*-------------------------------------------------------------------------------------------------------------------*/
+void trust_cache_invalidate_edge(edge_resource_t* edge)
+{
+    for (edge_capability_t* cap = list_head(edge->capabilities); cap != NULL; cap = list_item_next(cap))
+    {
+        cap->flags &= ~EDGE_CAPABILITY_TRUST_CACHED;
+    }
+
+    trust_cache_stats_data.invalidate_edge += 1;
+
+#ifdef TRUST_SNAPSHOT
+    trust_snapshot_changed();
+#endif
+}
+/*-------------------------------------------------------------------------------------------------------------------*/
+void trust_cache_invalidate_all(void)
+{
+    trust_cache_next_epoch();
+
+    trust_cache_stats_data.invalidate_all += 1;
+
+#ifdef TRUST_SNAPSHOT
+    trust_snapshot_changed();
+#endif
+}
+/*-------------------------------------------------------------------------------------------------------------------*/
+const trust_cache_stats_t* trust_cache_stats(void)
+{
+    return &trust_cache_stats_data;
+}
+/*-------------------------------------------------------------------------------------------------------------------*/
+void trust_cache_stats_print(void)
+{
+    // 64-bit so neither the total nor hits * 100 can overflow on a long run
+    const uint64_t total = (uint64_t)trust_cache_stats_data.hits + trust_cache_stats_data.misses;
+
+    LOG_INFO("Trust cache: hits=%" PRIu32 " misses=%" PRIu32 " (hit rate %" PRIu32 "%%) "
+             "invalidate_edge=%" PRIu32 " invalidate_all=%" PRIu32 " invalidate_decay=%" PRIu32 "\n",
+        trust_cache_stats_data.hits, trust_cache_stats_data.misses,
+        total == 0 ? 0 : (uint32_t)(((uint64_t)trust_cache_stats_data.hits * 100) / total),
+        trust_cache_stats_data.invalidate_edge, trust_cache_stats_data.invalidate_all,
+        trust_cache_stats_data.invalidate_decay);
+}
+/*-------------------------------------------------------------------------------------------------------------------*/
@@ -9,33 +9,57 @@
 #include "coap-constants.h"
 #include "coap-request-state.h"
 /*-------------------------------------------------------------------------------------------------------------------*/
-typedef struct {
-    uint16_t id;
-    float weight;
-} trust_weight_t;
-/*-------------------------------------------------------------------------------------------------------------------*/
-typedef struct trust_weights {
-    struct trust_weights* next;
-
-    const char* application_name;
-    const trust_weight_t* weights;
-    uint8_t num;
-
-} trust_weights_t;
-/*-------------------------------------------------------------------------------------------------------------------*/
-void trust_weights_init(void);
-/*-------------------------------------------------------------------------------------------------------------------*/
-void trust_weights_add(trust_weights_t* item);
-/*-------------------------------------------------------------------------------------------------------------------*/
-trust_weights_t* trust_weights_find(const char* application_name);
-/*-------------------------------------------------------------------------------------------------------------------*/
-float find_trust_weight(const char* application_name, uint16_t id);
+// Trust model configurations and metrics, each is a dense index into the weights of a capability
+typedef enum {
+    // Trust model configurations
+    TRUST_CONF_REPUTATION_WEIGHT,
+
+    // Edge resource metrics
+    TRUST_METRIC_TASK_SUBMISSION,
+    TRUST_METRIC_TASK_RESULT,
+    TRUST_METRIC_ANNOUNCE,
+    TRUST_METRIC_CHALLENGE_RESP,
+
+    // Edge capability metrics
+    TRUST_METRIC_RESULT_QUALITY,
+    TRUST_METRIC_RESULT_LATENCY,
+    TRUST_METRIC_THROUGHPUT,
+
+    // Peer metrics
+    TRUST_METRIC_TASK_OBSERVATION,
+
+    TRUST_WEIGHT_NUM
+} trust_weight_id_t;
+
+#define TRUST_METRIC_FIRST TRUST_METRIC_TASK_SUBMISSION
+/*-------------------------------------------------------------------------------------------------------------------*/
+// Each application provides its weights as an X macro of (id, weight) pairs, for example:
+//   #define MONITORING_TRUST_WEIGHTS(X) X(TRUST_METRIC_TASK_SUBMISSION, 1.0f) X(TRUST_CONF_REPUTATION_WEIGHT, 0.25f)
+// applications/Makefile.include generates APPLICATION_TRUST_WEIGHTS from these, which has one row per application
+// in capability ID order. The weights of the metrics must sum to 1, this is checked when the rows are compiled.
+// An application without any metric weights will always have a trust value of 0.
+#define TRUST_WEIGHT_ENTRY(id, weight) [id] = TRUST_REAL(weight),
+#define TRUST_WEIGHT_METRIC_SUM(id, weight) + ((id) >= TRUST_METRIC_FIRST ? (weight) : 0.0f)
+#define TRUST_WEIGHT_METRIC_COUNT(id, weight) + ((id) >= TRUST_METRIC_FIRST ? 1 : 0)
+
+#define TRUST_WEIGHTS_ROW(weights) { weights(TRUST_WEIGHT_ENTRY) }
+#define TRUST_WEIGHTS_CHECK(weights) \
+    _Static_assert((0 weights(TRUST_WEIGHT_METRIC_COUNT)) == 0 || \
+                   ((0.0f weights(TRUST_WEIGHT_METRIC_SUM)) >= 1.0f - 2.5e-4f && \
+                    (0.0f weights(TRUST_WEIGHT_METRIC_SUM)) <= 1.0f + 2.5e-4f), \
+                   #weights " must sum to 1")
+/*-------------------------------------------------------------------------------------------------------------------*/
+// Indexed by capability ID and then trust_weight_id_t, weights that are not specified are 0
+extern const trust_real_t trust_weights[CAPABILITY_ID_NUM][TRUST_WEIGHT_NUM];
+/*-------------------------------------------------------------------------------------------------------------------*/
+static inline trust_real_t find_trust_weight(capability_id_t cap_id, trust_weight_id_t id)
+{
+    return capability_id_is_valid(cap_id) ? trust_weights[cap_id][id] : TRUST_REAL(0);
+}
 /*-------------------------------------------------------------------------------------------------------------------*/
 #ifdef APPLICATIONS_MONITOR_THROUGHPUT
 typedef struct trust_throughput_threshold {
-    struct trust_throughput_threshold* next;
-
-    const char* application_name;
+    capability_id_t id;
     uint32_t in_threshold;
     uint32_t out_threshold;
 
@@ -45,28 +69,11 @@ void trust_throughput_thresholds_init(void);
 /*-------------------------------------------------------------------------------------------------------------------*/
 void trust_throughput_thresholds_add(trust_throughput_threshold_t* item);
 /*-------------------------------------------------------------------------------------------------------------------*/
-trust_throughput_threshold_t* trust_throughput_thresholds_find(const char* application_name);
+const trust_throughput_threshold_t* trust_throughput_thresholds_find(capability_id_t cap_id);
 #endif
 /*-------------------------------------------------------------------------------------------------------------------*/
 #define TRUST_MODEL_INVALID_TAG UINT32_MAX
 /*-------------------------------------------------------------------------------------------------------------------*/
-// Trust model configurations
-#define TRUST_CONF_REPUTATION_WEIGHT  0001
-/*-------------------------------------------------------------------------------------------------------------------*/
-// Edge resource metrics
-#define TRUST_METRIC_TASK_SUBMISSION  1001
-#define TRUST_METRIC_TASK_RESULT      1002
-#define TRUST_METRIC_ANNOUNCE         1003
-#define TRUST_METRIC_CHALLENGE_RESP   1004
-/*-------------------------------------------------------------------------------------------------------------------*/
-// Edge capability metrics
-#define TRUST_METRIC_RESULT_QUALITY   2001
-#define TRUST_METRIC_RESULT_LATENCY   2002
-#define TRUST_METRIC_THROUGHPUT       2003
-/*-------------------------------------------------------------------------------------------------------------------*/
-// Peer metrics
-#define TRUST_METRIC_TASK_OBSERVATION 3001
-/*-------------------------------------------------------------------------------------------------------------------*/
 typedef struct {
     coap_status_t coap_status;
     coap_request_status_t coap_request_status;
@@ -157,6 +164,46 @@ void tm_update_challenge_response(edge_resource_t* edge, const tm_challenge_resp
 void tm_update_task_observation(peer_t* peer, const tm_task_observation_info_t* info);
 void tm_update_ping(edge_resource_t* edge, const tm_edge_ping_t* info);
 /*-------------------------------------------------------------------------------------------------------------------*/
+// Implemented by the trust model, called by the tm_update_* functions above
+void tm_model_update_task_submission(edge_resource_t* edge, edge_capability_t* cap, const tm_task_submission_info_t* info);
+void tm_model_update_task_result(edge_resource_t* edge, edge_capability_t* cap, const tm_task_result_info_t* info);
+void tm_model_update_announce(edge_resource_t* edge, edge_capability_t* cap, const tm_announce_info_t* info);
+void tm_model_update_result_quality(edge_resource_t* edge, edge_capability_t* cap, const tm_result_quality_info_t* info);
+void tm_model_update_result_latency(edge_resource_t* edge, edge_capability_t* cap, const tm_result_latency_info_t* info);
+void tm_model_update_task_throughput(edge_resource_t* edge, edge_capability_t* cap, const tm_throughput_info_t* info);
+void tm_model_update_challenge_response(edge_resource_t* edge, const tm_challenge_response_info_t* info);
+void tm_model_update_task_observation(peer_t* peer, const tm_task_observation_info_t* info);
+void tm_model_update_ping(edge_resource_t* edge, const tm_edge_ping_t* info);
+/*-------------------------------------------------------------------------------------------------------------------*/
 bool tm_task_submission_good(const tm_task_submission_info_t* info, bool* should_update);
 bool tm_challenge_response_good(const tm_challenge_response_info_t* info, bool* should_update);
 /*-------------------------------------------------------------------------------------------------------------------*/
+// Returns the cached result of calculate_trust_value, only recalculating it
+// when the trust information it depends on has changed
+#ifndef TRUST_MODEL_NO_TRUST_VALUE
+trust_real_t trust_value_cached(edge_resource_t* edge, edge_capability_t* cap);
+#endif
+/*-------------------------------------------------------------------------------------------------------------------*/
+void trust_cache_invalidate_edge(edge_resource_t* edge);
+void trust_cache_invalidate_all(void);
+/*-------------------------------------------------------------------------------------------------------------------*/
+#ifdef TRUST_MODEL_BETA_DECAY
+// Decay changes trust values without the trust information being updated,
+// so every cached value goes stale once per this many seconds
+#ifndef TRUST_CACHE_DECAY_QUANTUM
+#define TRUST_CACHE_DECAY_QUANTUM (BETA_DIST_DECAY_HALF_LIFE / 32)
+#endif
+_Static_assert(TRUST_CACHE_DECAY_QUANTUM > 0, "Decay quantum must be at least a second");
+#endif
+/*-------------------------------------------------------------------------------------------------------------------*/
+typedef struct {
+    uint32_t hits;
+    uint32_t misses;
+    uint32_t invalidate_edge;
+    uint32_t invalidate_all;
+    uint32_t invalidate_decay;
+} trust_cache_stats_t;
+/*-------------------------------------------------------------------------------------------------------------------*/
+const trust_cache_stats_t* trust_cache_stats(void);
+void trust_cache_stats_print(void);
+/*-------------------------------------------------------------------------------------------------------------------*/
@@ -0,0 +1,65 @@
+#pragma once
+/*-------------------------------------------------------------------------------------------------------------------*/
+// Real numbers used by the distributions and trust models.
+//
+// By default these are floats, which on MCUs without an FPU (such as the CC2538) are emulated
+// in software. Defining TRUST_FIXED_POINT uses fixed-point arithmetic instead:
+//  - trust_real_t is Q16.16, used for probabilities, weights and trust values
+//  - trust_wide_t is Q48.16, used for sample values (such as throughput) and their statistics
+//
+// Arithmetic on these types must go through the macros below so that it is correct in both modes.
+// Addition, subtraction and comparison can be done directly.
+/*-------------------------------------------------------------------------------------------------------------------*/
+#include <stdint.h>
+/*-------------------------------------------------------------------------------------------------------------------*/
+#ifdef TRUST_FIXED_POINT
+/*-------------------------------------------------------------------------------------------------------------------*/
+#include "fixed-point.h"
+
+typedef q16_16_t trust_real_t;
+typedef q48_16_t trust_wide_t;
+
+// For constants only
+#define TRUST_REAL(x)                   Q16_16_CONST(x)
+
+#define trust_real_from_uint(x)         q16_16_from_uint(x)
+#define trust_real_ratio(n, d)          q16_16_ratio(n, d)
+#define trust_real_mul(a, b)            q16_16_mul(a, b)
+#define trust_real_div(a, b)            q16_16_div(a, b)
+#define trust_real_scale_to_uint(x, n)  q16_16_scale_to_uint(x, n)
+#define trust_real_isclose(a, b)        q16_16_isclose(a, b)
+#define trust_real_to_float(x)          q16_16_to_float(x)
+#define trust_real_from_float(x)        q16_16_from_float(x)
+
+#define trust_wide_from_uint(x)         q48_16_from_uint(x)
+#define trust_wide_from_real(x)         ((trust_wide_t)(x))
+#define trust_wide_mul(a, b)            q48_16_mul(a, b)
+#define trust_wide_to_float(x)          q48_16_to_float(x)
+#define trust_wide_from_float(x)        q48_16_from_float(x)
+/*-------------------------------------------------------------------------------------------------------------------*/
+#else
+/*-------------------------------------------------------------------------------------------------------------------*/
+#include "float-helpers.h"
+
+typedef float trust_real_t;
+typedef float trust_wide_t;
+
+#define TRUST_REAL(x)                   ((float)(x))
+
+#define trust_real_from_uint(x)         ((float)(x))
+#define trust_real_ratio(n, d)          ((float)(n) / (float)(d))
+#define trust_real_mul(a, b)            ((a) * (b))
+#define trust_real_div(a, b)            ((a) / (b))
+#define trust_real_scale_to_uint(x, n)  ((uint32_t)((x) * (n)))
+#define trust_real_isclose(a, b)        isclose(a, b)
+#define trust_real_to_float(x)          (x)
+#define trust_real_from_float(x)        (x)
+
+#define trust_wide_from_uint(x)         ((float)(x))
+#define trust_wide_from_real(x)         (x)
+#define trust_wide_mul(a, b)            ((a) * (b))
+#define trust_wide_to_float(x)          (x)
+#define trust_wide_from_float(x)        (x)
+/*-------------------------------------------------------------------------------------------------------------------*/
+#endif
+/*-------------------------------------------------------------------------------------------------------------------*/
@@ -0,0 +1,982 @@
+#include "trust-snapshot.h"
+
+#ifdef TRUST_SNAPSHOT
+
+#include "edge-info.h"
+#include "capability-info.h"
+#include "peer-info.h"
+#include "stereotypes.h"
+#include "trust-models.h"
+#include "keystore.h"
+#include "certificate.h"
+#include "crypto-support.h"
+
+#include "cfs/cfs.h"
+#ifdef TRUST_SNAPSHOT_COFFEE
+#include "cfs/cfs-coffee.h"
+#endif
+#include "lib/crc16.h"
+#include "os/sys/log.h"
+#include "sys/ctimer.h"
+
+#include "nanocbor-helper.h"
+
+#include <stdio.h>
+#include <string.h>
+#include <inttypes.h>
+/*-------------------------------------------------------------------------------------------------------------------*/
+#define LOG_MODULE "trust-snap"
+#ifdef TRUST_MODEL_LOG_LEVEL
+#define LOG_LEVEL TRUST_MODEL_LOG_LEVEL
+#else
+#define LOG_LEVEL LOG_LEVEL_NONE
+#endif
+/*-------------------------------------------------------------------------------------------------------------------*/
+#define TRUST_SNAPSHOT_MAGIC 0x54534e50
+#define TRUST_SNAPSHOT_VERSION 2
+
+#define TRUST_SNAPSHOT_SLOTS 2
+/*-------------------------------------------------------------------------------------------------------------------*/
+// Each record is a CBOR array starting with its kind:
+//   EDGE:        [kind, addr, flags, tm_version, information, tm, [[capability, flags, tm_version, information, tm], ...]]
+//   CAPABILITY:  [kind, capability, tm]
+//   PEER:        [kind, addr, last_seen, tm]
+//   PEER_EDGE:   [kind, addr, version, tm, [[capability, version, tm], ...]], of the last PEER record
+//   STEREOTYPE:  [kind, tags, tm]
+//   CERTIFICATE: [kind, certificate, mac]
+// Capabilities are held by name, tm are the trust model's structs as byte strings.
+// Edges come before the records that refer to them.
+typedef enum {
+    RECORD_EDGE,
+    RECORD_CAPABILITY,
+    RECORD_PEER,
+    RECORD_PEER_EDGE,
+    RECORD_STEREOTYPE,
+    RECORD_CERTIFICATE,
+} record_kind_t;
+/*-------------------------------------------------------------------------------------------------------------------*/
+typedef struct {
+    uint32_t magic;
+    uint8_t version;
+    uint8_t model;
+
+    // Changes when the layout of the trust model's structs does
+    uint16_t layout;
+
+    // Incremented for each image written, the newest valid image is restored
+    uint16_t sequence;
+
+    // Of the records following the header
+    uint16_t length;
+    uint16_t crc;
+
+    // The clocks when the image was written, so times held by the trust model can be moved on restore
+    uint32_t written_time;
+    uint32_t written_seconds;
+
+} snapshot_header_t;
+/*-------------------------------------------------------------------------------------------------------------------*/
+#define CAPABILITY_RECORD_MAX_LEN ((1) + (1 + EDGE_CAPABILITY_NAME_LEN) + 3 * (1 + sizeof(uint32_t)) + \
+                                   (3 + sizeof(edge_capability_tm_t)))
+
+#define EDGE_RECORD_MAX_LEN ((1) + (1) + IPV6ADDR_CBOR_MAX_LEN + 3 * (1 + sizeof(uint32_t)) + \
+                             (3 + sizeof(edge_resource_tm_t)) + (1) + NUM_EDGE_CAPABILITIES * CAPABILITY_RECORD_MAX_LEN)
+
+// Truncated HMAC-SHA256 of a certificate record
+#define CERTIFICATE_MAC_LEN 16
+
+#define CERTIFICATE_RECORD_MAX_LEN ((1) + (1) + CERTIFICATE_CBOR_LENGTH + (1 + CERTIFICATE_MAC_LEN))
+
+#define CAPABILITY_INFO_RECORD_MAX_LEN ((1) + (1) + (1 + EDGE_CAPABILITY_NAME_LEN) + (3 + sizeof(capability_tm_t)))
+
+#define PEER_RECORD_MAX_LEN ((1) + (1) + IPV6ADDR_CBOR_MAX_LEN + (1 + sizeof(uint32_t)) + (3 + sizeof(peer_tm_t)))
+
+#define PEER_EDGE_RECORD_MAX_LEN ((1) + (1) + IPV6ADDR_CBOR_MAX_LEN + (1 + sizeof(uint32_t)) + \
+                                  (3 + sizeof(peer_edge_resource_tm_t)) + (1) + NUM_EDGE_CAPABILITIES * \
+                                  ((1) + (1 + EDGE_CAPABILITY_NAME_LEN) + (1 + sizeof(uint32_t)) + \
+                                   (3 + sizeof(peer_edge_capability_tm_t))))
+
+#define STEREOTYPE_RECORD_MAX_LEN ((1) + (1) + (3) + (3 + sizeof(edge_resource_tm_t)))
+
+// Largest record that can be written or restored
+#ifndef TRUST_SNAPSHOT_RECORD_LEN
+#define TRUST_SNAPSHOT_RECORD_LEN MAX(EDGE_RECORD_MAX_LEN, CERTIFICATE_RECORD_MAX_LEN)
+#endif
+
+// Longest image when every pool is full, reserved with Coffee so an image is not extended as it is written
+#ifndef TRUST_SNAPSHOT_RESERVE
+#define TRUST_SNAPSHOT_RESERVE (sizeof(snapshot_header_t) + \
+    NUM_EDGE_RESOURCES * (2 + EDGE_RECORD_MAX_LEN) + \
+    NUM_EDGE_CAPABILITIES * (2 + CAPABILITY_INFO_RECORD_MAX_LEN) + \
+    NUM_PEERS * ((2 + PEER_RECORD_MAX_LEN) + NUM_EDGE_RESOURCES * (2 + PEER_EDGE_RECORD_MAX_LEN)) + \
+    MAX_NUM_STEREOTYPES * (2 + STEREOTYPE_RECORD_MAX_LEN) + \
+    PUBLIC_KEYSTORE_SIZE * (2 + CERTIFICATE_RECORD_MAX_LEN))
+#endif
+
+#if defined(TRUST_SNAPSHOT_COFFEE) && defined(COFFEE_CONF_SIZE)
+_Static_assert(2 * TRUST_SNAPSHOT_RESERVE <= COFFEE_CONF_SIZE, "Coffee cannot hold two images, increase TRUST_SNAPSHOT_COFFEE_SIZE");
+#endif
+/*-------------------------------------------------------------------------------------------------------------------*/
+static uint8_t record_buf[TRUST_SNAPSHOT_RECORD_LEN];
+
+static struct ctimer snapshot_timer;
+
+// Sequence number of the newest image, which is in slot (sequence % TRUST_SNAPSHOT_SLOTS)
+static uint16_t sequence;
+
+// Changes made while restoring do not need to be written back
+static bool restoring;
+
+// The newest image written or restored, and the changes it holds, so an unchanged image is not written again
+static bool written;
+static uint32_t written_seconds;
+static uint16_t written_generation;
+
+// Incremented by trust_snapshot_changed
+static uint16_t generation;
+
+// The peer that PEER_EDGE records are restored to
+static peer_t* restoring_peer;
+
+static int32_t time_shift;
+static int32_t seconds_shift;
+/*-------------------------------------------------------------------------------------------------------------------*/
+static void snapshot_name(uint16_t seq, char* name, size_t name_len)
+{
+    snprintf(name, name_len, TRUST_SNAPSHOT_FILE_PREFIX "%u", (unsigned int)(seq % TRUST_SNAPSHOT_SLOTS));
+}
+/*-------------------------------------------------------------------------------------------------------------------*/
+#define SNAPSHOT_NAME_LEN (sizeof(TRUST_SNAPSHOT_FILE_PREFIX) + 1)
+/*-------------------------------------------------------------------------------------------------------------------*/
+static uint16_t snapshot_layout(void)
+{
+    const uint16_t sizes[] = {
+        TRUST_SNAPSHOT_VERSION,
+        sizeof(edge_resource_tm_t),
+        sizeof(edge_capability_tm_t),
+        sizeof(capability_tm_t),
+        sizeof(peer_tm_t),
+        sizeof(peer_edge_resource_tm_t),
+        sizeof(peer_edge_capability_tm_t),
+#ifdef TRUST_FIXED_POINT
+        1,
+#else
+        0,
+#endif
+    };
+
+    return crc16_data((const unsigned char*)sizes, sizeof(sizes), 0);
+}
+/*-------------------------------------------------------------------------------------------------------------------*/
+static bool sequence_is_newer(uint16_t seq, uint16_t current)
+{
+    return (int16_t)(seq - current) > 0;
+}
+/*-------------------------------------------------------------------------------------------------------------------*/
+static int serialise_capability_name(nanocbor_encoder_t* enc, capability_id_t id)
+{
+    return nanocbor_put_tstr(enc, capability_id_name(id));
+}
+/*-------------------------------------------------------------------------------------------------------------------*/
+static int deserialise_capability_name(nanocbor_value_t* dec, capability_id_t* id)
+{
+    const char* name;
+    size_t name_len;
+    NANOCBOR_CHECK(nanocbor_get_tstr(dec, &name, &name_len));
+
+    *id = capability_id_findn(name, name_len);
+
+    return NANOCBOR_OK;
+}
+/*-------------------------------------------------------------------------------------------------------------------*/
+static int serialise_edge(nanocbor_encoder_t* enc, void* item)
+{
+    edge_resource_t* edge = (edge_resource_t*)item;
+
+    NANOCBOR_CHECK(nanocbor_fmt_array(enc, 7));
+    NANOCBOR_CHECK(nanocbor_fmt_uint(enc, RECORD_EDGE));
+    NANOCBOR_CHECK(nanocbor_fmt_ipaddr(enc, &edge->ep.ipaddr));
+    NANOCBOR_CHECK(nanocbor_fmt_uint(enc, edge->flags));
+    NANOCBOR_CHECK(nanocbor_fmt_uint(enc, edge->tm_version));
+#if EDGE_INFO_EVICTION == EDGE_INFO_EVICTION_LEAST_INFORMATION
+    NANOCBOR_CHECK(nanocbor_fmt_uint(enc, edge->information));
+#else
+    NANOCBOR_CHECK(nanocbor_fmt_uint(enc, 0));
+#endif
+    NANOCBOR_CHECK(nanocbor_put_bstr(enc, (const uint8_t*)&edge->tm, sizeof(edge->tm)));
+
+    NANOCBOR_CHECK(nanocbor_fmt_array(enc, list_length(edge->capabilities)));
+    for (edge_capability_t* cap = list_head(edge->capabilities); cap != NULL; cap = list_item_next(cap))
+    {
+        NANOCBOR_CHECK(nanocbor_fmt_array(enc, 5));
+        NANOCBOR_CHECK(serialise_capability_name(enc, cap->id));
+        NANOCBOR_CHECK(nanocbor_fmt_uint(enc, cap->flags & ~EDGE_CAPABILITY_TRUST_CACHED));
+        NANOCBOR_CHECK(nanocbor_fmt_uint(enc, cap->tm_version));
+#if EDGE_INFO_EVICTION == EDGE_INFO_EVICTION_LEAST_INFORMATION
+        NANOCBOR_CHECK(nanocbor_fmt_uint(enc, cap->information));
+#else
+        NANOCBOR_CHECK(nanocbor_fmt_uint(enc, 0));
+#endif
+        NANOCBOR_CHECK(nanocbor_put_bstr(enc, (const uint8_t*)&cap->tm, sizeof(cap->tm)));
+    }
+
+    return NANOCBOR_OK;
+}
+/*-------------------------------------------------------------------------------------------------------------------*/
+static int serialise_capability(nanocbor_encoder_t* enc, void* item)
+{
+    capability_t* cap = (capability_t*)item;
+
+    NANOCBOR_CHECK(nanocbor_fmt_array(enc, 3));
+    NANOCBOR_CHECK(nanocbor_fmt_uint(enc, RECORD_CAPABILITY));
+    NANOCBOR_CHECK(serialise_capability_name(enc, cap->id));
+    NANOCBOR_CHECK(nanocbor_put_bstr(enc, (const uint8_t*)&cap->tm, sizeof(cap->tm)));
+
+    return NANOCBOR_OK;
+}
+/*-------------------------------------------------------------------------------------------------------------------*/
+static int serialise_peer(nanocbor_encoder_t* enc, void* item)
+{
+    peer_t* peer = (peer_t*)item;
+
+    NANOCBOR_CHECK(nanocbor_fmt_array(enc, 4));
+    NANOCBOR_CHECK(nanocbor_fmt_uint(enc, RECORD_PEER));
+    NANOCBOR_CHECK(nanocbor_fmt_ipaddr(enc, &peer->addr));
+    NANOCBOR_CHECK(nanocbor_fmt_uint(enc, peer->last_seen));
+    NANOCBOR_CHECK(nanocbor_put_bstr(enc, (const uint8_t*)&peer->tm, sizeof(peer->tm)));
+
+    return NANOCBOR_OK;
+}
+/*-------------------------------------------------------------------------------------------------------------------*/
+static int serialise_peer_edge(nanocbor_encoder_t* enc, void* item)
+{
+    peer_edge_t* peer_edge = (peer_edge_t*)item;
+
+    NANOCBOR_CHECK(nanocbor_fmt_array(enc, 5));
+    NANOCBOR_CHECK(nanocbor_fmt_uint(enc, RECORD_PEER_EDGE));
+    NANOCBOR_CHECK(nanocbor_fmt_ipaddr(enc, &peer_edge->edge->ep.ipaddr));
+    NANOCBOR_CHECK(nanocbor_fmt_uint(enc, peer_edge->version));
+    NANOCBOR_CHECK(nanocbor_put_bstr(enc, (const uint8_t*)&peer_edge->tm, sizeof(peer_edge->tm)));
+
+    uint32_t num_caps = 0;
+    for (peer_edge_capability_t* peer_cap = peer_info_capabilities_head(peer_edge); peer_cap != NULL;
+         peer_cap = peer_info_capabilities_next(peer_cap))
+    {
+        num_caps += 1;
+    }
+
+    NANOCBOR_CHECK(nanocbor_fmt_array(enc, num_caps));
+    for (peer_edge_capability_t* peer_cap = peer_info_capabilities_head(peer_edge); peer_cap != NULL;
+         peer_cap = peer_info_capabilities_next(peer_cap))
+    {
+        NANOCBOR_CHECK(nanocbor_fmt_array(enc, 3));
+        NANOCBOR_CHECK(serialise_capability_name(enc, peer_cap->cap->id));
+        NANOCBOR_CHECK(nanocbor_fmt_uint(enc, peer_cap->version));
+        NANOCBOR_CHECK(nanocbor_put_bstr(enc, (const uint8_t*)&peer_cap->tm, sizeof(peer_cap->tm)));
+    }
+
+    return NANOCBOR_OK;
+}
+/*-------------------------------------------------------------------------------------------------------------------*/
+static int serialise_stereotype(nanocbor_encoder_t* enc, void* item)
+{
+    edge_stereotype_t* s = (edge_stereotype_t*)item;
+
+    NANOCBOR_CHECK(nanocbor_fmt_array(enc, 3));
+    NANOCBOR_CHECK(nanocbor_fmt_uint(enc, RECORD_STEREOTYPE));
+    NANOCBOR_CHECK(serialise_stereotype_tags(enc, &s->tags));
+    NANOCBOR_CHECK(nanocbor_put_bstr(enc, (const uint8_t*)&s->edge_tm, sizeof(s->edge_tm)));
+
+    return NANOCBOR_OK;
+}
+/*-------------------------------------------------------------------------------------------------------------------*/
+// HMAC-SHA256 keyed by this node's private key. The CRC16 only shows that an image was not corrupted, a matching
+// MAC shows the certificate was written by this node after verifying it, so it need not be verified again.
+static bool certificate_mac(const uint8_t* encoded, size_t encoded_len, uint8_t* mac)
+{
+    static const char label[] = "trust-snapshot";
+
+    uint8_t pad[64];
+    uint8_t hash[SHA256_DIGEST_LEN_BYTES];
+    platform_sha256_context_t ctx;
+
+    // The key is shorter than a block, so is padded with zeros
+    memset(pad, 0x36, sizeof(pad));
+    for (size_t i = 0; i != sizeof(our_privkey.k); ++i)
+    {
+        pad[i] ^= our_privkey.k[i];
+    }
+
+    bool success = platform_crypto_success(platform_sha256_init(&ctx)) &&
+                   platform_crypto_success(platform_sha256_update(&ctx, pad, sizeof(pad))) &&
+                   platform_crypto_success(platform_sha256_update(&ctx, (const uint8_t*)label, sizeof(label) - 1)) &&
+                   platform_crypto_success(platform_sha256_update(&ctx, encoded, encoded_len)) &&
+                   platform_crypto_success(platform_sha256_finalise(&ctx, hash));
+
+    platform_sha256_done(&ctx);
+
+    for (size_t i = 0; i != sizeof(pad); ++i)
+    {
+        pad[i] ^= 0x36 ^ 0x5c;
+    }
+
+    success = success &&
+              platform_crypto_success(platform_sha256_init(&ctx)) &&
+              platform_crypto_success(platform_sha256_update(&ctx, pad, sizeof(pad))) &&
+              platform_crypto_success(platform_sha256_update(&ctx, hash, sizeof(hash))) &&
+              platform_crypto_success(platform_sha256_finalise(&ctx, hash));
+
+    platform_sha256_done(&ctx);
+
+    memset(pad, 0, sizeof(pad));
+    memcpy(mac, hash, CERTIFICATE_MAC_LEN);
+
+    return success;
+}
+/*-------------------------------------------------------------------------------------------------------------------*/
+static int serialise_certificate(nanocbor_encoder_t* enc, void* item)
+{
+    public_key_item_t* key = (public_key_item_t*)item;
+
+    NANOCBOR_CHECK(nanocbor_fmt_array(enc, 3));
+    NANOCBOR_CHECK(nanocbor_fmt_uint(enc, RECORD_CERTIFICATE));
+
+    // The encoder writes to record_buf, so the MAC is of the certificate as it is written
+    const size_t start = nanocbor_encoded_len(enc);
+    NANOCBOR_CHECK(certificate_encode(enc, &key->cert));
+    const size_t end = nanocbor_encoded_len(enc);
+
+    uint8_t mac[CERTIFICATE_MAC_LEN];
+    if (end > sizeof(record_buf) || !certificate_mac(record_buf + start, end - start, mac))
+    {
+        LOG_ERR("Failed to MAC certificate\n");
+        return -1;
+    }
+
+    NANOCBOR_CHECK(nanocbor_put_bstr(enc, mac, sizeof(mac)));
+
+    return NANOCBOR_OK;
+}
+/*-------------------------------------------------------------------------------------------------------------------*/
+typedef struct {
+    int fd;
+    uint16_t length;
+    uint16_t crc;
+} snapshot_writer_t;
+
+typedef int (*record_serialise_fn_t)(nanocbor_encoder_t* enc, void* item);
+/*-------------------------------------------------------------------------------------------------------------------*/
+static bool snapshot_put(snapshot_writer_t* w, record_serialise_fn_t fn, void* item)
+{
+    nanocbor_encoder_t enc;
+    nanocbor_encoder_init(&enc, record_buf, sizeof(record_buf));
+
+    const int ret = fn(&enc, item);
+    const size_t len = nanocbor_encoded_len(&enc);
+
+    if (ret != NANOCBOR_OK || len > sizeof(record_buf))
+    {
+        LOG_ERR("Failed to serialise record (%zu > %zu)\n", len, sizeof(record_buf));
+        return false;
+    }
+
+    const uint16_t prefix = (uint16_t)len;
+
+    if ((uint32_t)w->length + sizeof(prefix) + len > UINT16_MAX)
+    {
+        LOG_ERR("Snapshot is too long\n");
+        return false;
+    }
+
+    if (cfs_write(w->fd, &prefix, sizeof(prefix)) != sizeof(prefix) ||
+        cfs_write(w->fd, record_buf, len) != (int)len)
+    {
+        LOG_ERR("Failed to write record\n");
+        return false;
+    }
+
+    w->crc = crc16_data((const unsigned char*)&prefix, sizeof(prefix), w->crc);
+    w->crc = crc16_data(record_buf, len, w->crc);
+    w->length += sizeof(prefix) + len;
+
+    return true;
+}
+/*-------------------------------------------------------------------------------------------------------------------*/
+static bool snapshot_put_all(snapshot_writer_t* w)
+{
+    for (edge_resource_t* edge = edge_info_iter(); edge != NULL; edge = edge_info_next(edge))
+    {
+        if (!snapshot_put(w, serialise_edge, edge))
+        {
+            return false;
+        }
+    }
+
+#ifdef TRUST_MODEL_HAS_PER_CAPABILITY_INFO
+    for (capability_t* cap = capability_info_iter(); cap != NULL; cap = capability_info_next(cap))
+    {
+        if (!snapshot_put(w, serialise_capability, cap))
+        {
+            return false;
+        }
+    }
+#endif
+
+    for (peer_t* peer = peer_info_iter(); peer != NULL; peer = peer_info_next(peer))
+    {
+        if (!snapshot_put(w, serialise_peer, peer))
+        {
+            return false;
+        }
+
+        for (peer_edge_t* peer_edge = peer_info_edges_head(peer); peer_edge != NULL;
+             peer_edge = peer_info_edges_next(peer_edge))
+        {
+            if (!snapshot_put(w, serialise_peer_edge, peer_edge))
+            {
+                return false;
+            }
+        }
+    }
+
+    for (edge_stereotype_t* s = edge_stereotype_iter(); s != NULL; s = edge_stereotype_next(s))
+    {
+        if (!snapshot_put(w, serialise_stereotype, s))
+        {
+            return false;
+        }
+    }
+
+    for (public_key_item_t* key = keystore_iter(); key != NULL; key = keystore_next(key))
+    {
+        if (!snapshot_put(w, serialise_certificate, key))
+        {
+            return false;
+        }
+    }
+
+    return true;
+}
+/*-------------------------------------------------------------------------------------------------------------------*/
+int trust_snapshot_write(void)
+{
+    const uint16_t seq = sequence + 1;
+
+    char name[SNAPSHOT_NAME_LEN];
+    snapshot_name(seq, name, sizeof(name));
+
+    // Overwrites the older image, the newer one is kept until this one is complete
+    cfs_remove(name);
+
+#ifdef TRUST_SNAPSHOT_COFFEE
+    // Otherwise Coffee starts with a small file, which has to be extended as the records are written
+    if (cfs_coffee_reserve(name, TRUST_SNAPSHOT_RESERVE) < 0)
+    {
+        LOG_ERR("Failed to reserve %u bytes for %s\n", (unsigned int)TRUST_SNAPSHOT_RESERVE, name);
+        return -1;
+    }
+#endif
+
+    snapshot_writer_t w = {
+        .fd = cfs_open(name, CFS_WRITE),
+        .length = 0,
+        .crc = 0,
+    };
+    if (w.fd < 0)
+    {
+        LOG_ERR("Failed to open %s\n", name);
+        return -1;
+    }
+
+    snapshot_header_t header;
+    memset(&header, 0, sizeof(header));
+
+    // The header is written last, so the image is not valid until all of the records have been written
+    bool ok = cfs_write(w.fd, &header, sizeof(header)) == sizeof(header) && snapshot_put_all(&w);
+
+    if (ok)
+    {
+        header.magic = TRUST_SNAPSHOT_MAGIC;
+        header.version = TRUST_SNAPSHOT_VERSION;
+        header.model = TRUST_MODEL_TAG;
+        header.layout = snapshot_layout();
+        header.sequence = seq;
+        header.length = w.length;
+        header.crc = w.crc;
+        header.written_time = (uint32_t)clock_time();
+        header.written_seconds = (uint32_t)clock_seconds();
+
+        ok = cfs_seek(w.fd, 0, CFS_SEEK_SET) == 0 &&
+             cfs_write(w.fd, &header, sizeof(header)) == sizeof(header);
+    }
+
+    cfs_close(w.fd);
+
+    if (!ok)
+    {
+        LOG_ERR("Failed to write snapshot %s\n", name);
+        cfs_remove(name);
+        return -1;
+    }
+
+    sequence = seq;
+
+    written = true;
+    written_seconds = header.written_seconds;
+    written_generation = generation;
+
+    LOG_DBG("Wrote snapshot %" PRIu16 " to %s (%zu bytes)\n", seq, name, sizeof(header) + w.length);
+
+    return (int)(sizeof(header) + w.length);
+}
+/*-------------------------------------------------------------------------------------------------------------------*/
+static void snapshot_timer_callback(void* ptr)
+{
+    // Changes made until the minimum interval has passed are written together
+    const uint32_t since = (uint32_t)clock_seconds() - written_seconds;
+    if (written && since < TRUST_SNAPSHOT_MIN_INTERVAL)
+    {
+        ctimer_set(&snapshot_timer, (clock_time_t)(TRUST_SNAPSHOT_MIN_INTERVAL - since) * CLOCK_SECOND,
+            snapshot_timer_callback, NULL);
+        return;
+    }
+
+    if (written && generation == written_generation)
+    {
+        LOG_DBG("Snapshot unchanged, not writing\n");
+        return;
+    }
+
+    trust_snapshot_write();
+}
+/*-------------------------------------------------------------------------------------------------------------------*/
+void trust_snapshot_changed(void)
+{
+    if (restoring)
+    {
+        return;
+    }
+
+    generation += 1;
+
+    // Changes until the timer expires are written together
+    if (!ctimer_expired(&snapshot_timer))
+    {
+        return;
+    }
+
+    ctimer_set(&snapshot_timer, TRUST_SNAPSHOT_DELAY, snapshot_timer_callback, NULL);
+}
+/*-------------------------------------------------------------------------------------------------------------------*/
+static int restore_edge_capability(nanocbor_value_t* dec, edge_resource_t* edge)
+{
+    nanocbor_value_t arr;
+    NANOCBOR_CHECK(nanocbor_enter_array(dec, &arr));
+
+    capability_id_t id;
+    uint32_t flags, tm_version, information;
+    const edge_capability_tm_t* tm;
+
+    NANOCBOR_CHECK(deserialise_capability_name(&arr, &id));
+    NANOCBOR_CHECK(nanocbor_get_uint32(&arr, &flags));
+    NANOCBOR_CHECK(nanocbor_get_uint32(&arr, &tm_version));
+    NANOCBOR_CHECK(nanocbor_get_uint32(&arr, &information));
+    NANOCBOR_GET_OBJECT(&arr, &tm);
+
+    nanocbor_leave_container(dec, &arr);
+
+    if (!capability_id_is_valid(id))
+    {
+        LOG_WARN("Not restoring capability unknown to this build\n");
+        return NANOCBOR_OK;
+    }
+
+    edge_capability_t* cap = edge_info_capability_add(edge, id);
+    if (cap == NULL)
+    {
+        LOG_ERR("Failed to restore capability %s\n", capability_id_name(id));
+        return -1;
+    }
+
+    // Whether the edge still offers the capability is learnt again from its announcements
+    cap->flags = flags & ~EDGE_CAPABILITY_ACTIVE;
+    cap->tm_version = (uint8_t)tm_version;
+#if EDGE_INFO_EVICTION == EDGE_INFO_EVICTION_LEAST_INFORMATION
+    cap->information = (uint16_t)information;
+#endif
+    memcpy(&cap->tm, tm, sizeof(cap->tm));
+
+#ifdef TRUST_MODEL_HAS_TM_REBASE
+    edge_capability_tm_rebase(&cap->tm, time_shift, seconds_shift);
+#endif
+
+    return NANOCBOR_OK;
+}
+/*-------------------------------------------------------------------------------------------------------------------*/
+static int restore_edge(nanocbor_value_t* arr)
+{
+    const uip_ip6addr_t* addr;
+    uint32_t flags, tm_version, information;
+    const edge_resource_tm_t* tm;
+
+    NANOCBOR_CHECK(nanocbor_get_ipaddr(arr, &addr));
+    NANOCBOR_CHECK(nanocbor_get_uint32(arr, &flags));
+    NANOCBOR_CHECK(nanocbor_get_uint32(arr, &tm_version));
+    NANOCBOR_CHECK(nanocbor_get_uint32(arr, &information));
+    NANOCBOR_GET_OBJECT(arr, &tm);
+
+    edge_resource_t* edge = edge_info_add(addr);
+    if (edge == NULL)
+    {
+        LOG_ERR("Failed to restore edge ");
+        LOG_ERR_6ADDR(addr);
+        LOG_ERR_("\n");
+        return -1;
+    }
+
+    // Whether the edge is still there is learnt again from its announcements
+    edge->flags = flags & ~EDGE_RESOURCE_ACTIVE;
+    edge->tm_version = (uint8_t)tm_version;
+#if EDGE_INFO_EVICTION == EDGE_INFO_EVICTION_LEAST_INFORMATION
+    edge->information = (uint16_t)information;
+#endif
+    memcpy(&edge->tm, tm, sizeof(edge->tm));
+
+#ifdef TRUST_MODEL_HAS_TM_REBASE
+    edge_resource_tm_rebase(&edge->tm, time_shift, seconds_shift);
+#endif
+
+    nanocbor_value_t caps;
+    NANOCBOR_CHECK(nanocbor_enter_array(arr, &caps));
+    while (!nanocbor_at_end(&caps))
+    {
+        NANOCBOR_CHECK(restore_edge_capability(&caps, edge));
+    }
+    nanocbor_leave_container(arr, &caps);
+
+    return NANOCBOR_OK;
+}
+/*-------------------------------------------------------------------------------------------------------------------*/
+static int restore_capability(nanocbor_value_t* arr)
+{
+    capability_id_t id;
+    const capability_tm_t* tm;
+
+    NANOCBOR_CHECK(deserialise_capability_name(arr, &id));
+    NANOCBOR_GET_OBJECT(arr, &tm);
+
+    // Only held for capabilities of the restored edges
+    capability_t* cap = capability_id_is_valid(id) ? capability_info_find(id) : NULL;
+    if (cap != NULL)
+    {
+        memcpy(&cap->tm, tm, sizeof(cap->tm));
+    }
+
+    return NANOCBOR_OK;
+}
+/*-------------------------------------------------------------------------------------------------------------------*/
+static int restore_peer(nanocbor_value_t* arr)
+{
+    const uip_ip6addr_t* addr;
+    uint32_t last_seen;
+    const peer_tm_t* tm;
+
+    NANOCBOR_CHECK(nanocbor_get_ipaddr(arr, &addr));
+    NANOCBOR_CHECK(nanocbor_get_uint32(arr, &last_seen));
+    NANOCBOR_GET_OBJECT(arr, &tm);
+
+    restoring_peer = peer_info_add(addr);
+    if (restoring_peer == NULL)
+    {
+        LOG_ERR("Failed to restore peer ");
+        LOG_ERR_6ADDR(addr);
+        LOG_ERR_("\n");
+        return -1;
+    }
+
+    restoring_peer->last_seen = last_seen;
+    memcpy(&restoring_peer->tm, tm, sizeof(restoring_peer->tm));
+
+    return NANOCBOR_OK;
+}
+/*-------------------------------------------------------------------------------------------------------------------*/
+static int restore_peer_edge(nanocbor_value_t* arr)
+{
+    const uip_ip6addr_t* addr;
+    uint32_t version;
+    const peer_edge_resource_tm_t* tm;
+
+    NANOCBOR_CHECK(nanocbor_get_ipaddr(arr, &addr));
+    NANOCBOR_CHECK(nanocbor_get_uint32(arr, &version));
+    NANOCBOR_GET_OBJECT(arr, &tm);
+
+    edge_resource_t* edge = edge_info_find_addr(addr);
+    if (restoring_peer == NULL || edge == NULL)
+    {
+        return -1;
+    }
+
+    peer_edge_t* peer_edge = peer_info_find_edge_or_allocate(restoring_peer, edge);
+    if (peer_edge == NULL)
+    {
+        return -1;
+    }
+
+    peer_edge->version = (uint8_t)version;
+    memcpy(&peer_edge->tm, tm, sizeof(peer_edge->tm));
+
+    nanocbor_value_t caps;
+    NANOCBOR_CHECK(nanocbor_enter_array(arr, &caps));
+    while (!nanocbor_at_end(&caps))
+    {
+        nanocbor_value_t cap_arr;
+        NANOCBOR_CHECK(nanocbor_enter_array(&caps, &cap_arr));
+
+        capability_id_t id;
+        const peer_edge_capability_tm_t* cap_tm;
+
+        NANOCBOR_CHECK(deserialise_capability_name(&cap_arr, &id));
+        NANOCBOR_CHECK(nanocbor_get_uint32(&cap_arr, &version));
+        NANOCBOR_GET_OBJECT(&cap_arr, &cap_tm);
+
+        nanocbor_leave_container(&caps, &cap_arr);
+
+        edge_capability_t* cap = capability_id_is_valid(id) ? edge_info_capability_find(edge, id) : NULL;
+        peer_edge_capability_t* peer_cap = cap != NULL ? peer_info_find_capability_or_allocate(peer_edge, cap) : NULL;
+        if (peer_cap != NULL)
+        {
+            peer_cap->version = (uint8_t)version;
+            memcpy(&peer_cap->tm, cap_tm, sizeof(peer_cap->tm));
+        }
+    }
+    nanocbor_leave_container(arr, &caps);
+
+    return NANOCBOR_OK;
+}
+/*-------------------------------------------------------------------------------------------------------------------*/
+static int restore_stereotype(nanocbor_value_t* arr)
+{
+    stereotype_tags_t tags;
+    const edge_resource_tm_t* tm;
+
+    NANOCBOR_CHECK(deserialise_stereotype_tags(arr, &tags));
+    NANOCBOR_GET_OBJECT(arr, &tm);
+
+    edge_resource_tm_t edge_tm;
+    memcpy(&edge_tm, tm, sizeof(edge_tm));
+
+#ifdef TRUST_MODEL_HAS_TM_REBASE
+    edge_resource_tm_rebase(&edge_tm, time_shift, seconds_shift);
+#endif
+
+    return edge_stereotype_restore(&tags, &edge_tm) ? NANOCBOR_OK : -1;
+}
+/*-------------------------------------------------------------------------------------------------------------------*/
+static int restore_certificate(nanocbor_value_t* arr)
+{
+    const uint8_t* encoded;
+    size_t encoded_len;
+    NANOCBOR_CHECK(nanocbor_get_subcbor(arr, &encoded, &encoded_len));
+
+    const uint8_t* mac;
+    size_t mac_len;
+    NANOCBOR_CHECK(nanocbor_get_bstr(arr, &mac, &mac_len));
+
+    certificate_t cert;
+    nanocbor_value_t dec;
+    nanocbor_decoder_init(&dec, encoded, encoded_len);
+    NANOCBOR_CHECK(certificate_decode(&dec, &cert));
+
+    uint8_t expected[CERTIFICATE_MAC_LEN];
+    if (mac_len != sizeof(expected) ||
+        !certificate_mac(encoded, encoded_len, expected) ||
+        memcmp(mac, expected, sizeof(expected)) != 0)
+    {
+        LOG_WARN("Restored certificate for ");
+        LOG_WARN_BYTES(cert.subject, EUI64_LENGTH);
+        LOG_WARN_(" has an invalid MAC, verifying it again\n");
+
+        return keystore_add(&cert) ? NANOCBOR_OK : -1;
+    }
+
+    return keystore_restore(&cert) ? NANOCBOR_OK : -1;
+}
+/*-------------------------------------------------------------------------------------------------------------------*/
+static int restore_record(const uint8_t* buf, size_t len)
+{
+    nanocbor_value_t dec, arr;
+    nanocbor_decoder_init(&dec, buf, len);
+    NANOCBOR_CHECK(nanocbor_enter_array(&dec, &arr));
+
+    uint32_t kind;
+    NANOCBOR_CHECK(nanocbor_get_uint32(&arr, &kind));
+
+    switch (kind)
+    {
+    case RECORD_EDGE:           return restore_edge(&arr);
+    case RECORD_CAPABILITY:     return restore_capability(&arr);
+    case RECORD_PEER:           return restore_peer(&arr);
+    case RECORD_PEER_EDGE:      return restore_peer_edge(&arr);
+    case RECORD_STEREOTYPE:     return restore_stereotype(&arr);
+    case RECORD_CERTIFICATE:    return restore_certificate(&arr);
+    default:
+        LOG_ERR("Unknown snapshot record %" PRIu32 "\n", kind);
+        return -1;
+    }
+}
+/*-------------------------------------------------------------------------------------------------------------------*/
+// Opens the image with seq's slot, positioned after its header, if the header and CRC of the records are valid
+static int snapshot_open_valid(uint16_t seq, snapshot_header_t* header)
+{
+    char name[SNAPSHOT_NAME_LEN];
+    snapshot_name(seq, name, sizeof(name));
+
+    int fd = cfs_open(name, CFS_READ);
+    if (fd < 0)
+    {
+        return -1;
+    }
+
+    if (cfs_read(fd, header, sizeof(*header)) != sizeof(*header) ||
+        header->magic != TRUST_SNAPSHOT_MAGIC ||
+        header->version != TRUST_SNAPSHOT_VERSION ||
+        header->model != TRUST_MODEL_TAG ||
+        header->layout != snapshot_layout())
+    {
+        LOG_WARN("Ignoring snapshot %s from a different build or not fully written\n", name);
+        cfs_close(fd);
+        return -1;
+    }
+
+    uint16_t crc = 0;
+    uint16_t remaining = header->length;
+    while (remaining > 0)
+    {
+        const uint16_t chunk = MIN(remaining, sizeof(record_buf));
+        if (cfs_read(fd, record_buf, chunk) != chunk)
+        {
+            break;
+        }
+
+        crc = crc16_data(record_buf, chunk, crc);
+        remaining -= chunk;
+    }
+
+    if (remaining != 0 || crc != header->crc)
+    {
+        LOG_WARN("Ignoring snapshot %s with an invalid CRC\n", name);
+        cfs_close(fd);
+        return -1;
+    }
+
+    if (cfs_seek(fd, sizeof(*header), CFS_SEEK_SET) != sizeof(*header))
+    {
+        cfs_close(fd);
+        return -1;
+    }
+
+    return fd;
+}
+/*-------------------------------------------------------------------------------------------------------------------*/
+int trust_snapshot_restore(void)
+{
+    snapshot_header_t header, newest = {0};
+    int fd = -1;
+
+    for (uint16_t slot = 0; slot != TRUST_SNAPSHOT_SLOTS; ++slot)
+    {
+        const int slot_fd = snapshot_open_valid(slot, &header);
+        if (slot_fd < 0)
+        {
+            continue;
+        }
+
+        if (fd < 0 || sequence_is_newer(header.sequence, newest.sequence))
+        {
+            if (fd >= 0)
+            {
+                cfs_close(fd);
+            }
+
+            fd = slot_fd;
+            newest = header;
+        }
+        else
+        {
+            cfs_close(slot_fd);
+        }
+    }
+
+    if (fd < 0)
+    {
+        LOG_INFO("No snapshot to restore\n");
+        return -1;
+    }
+
+    restoring = true;
+    sequence = newest.sequence;
+    written = true;
+    written_seconds = (uint32_t)clock_seconds();
+    written_generation = generation;
+    time_shift = (int32_t)((uint32_t)clock_time() - newest.written_time);
+    seconds_shift = (int32_t)((uint32_t)clock_seconds() - newest.written_seconds);
+    restoring_peer = NULL;
+
+    int records = 0;
+    uint16_t remaining = newest.length;
+    while (remaining >= sizeof(uint16_t))
+    {
+        uint16_t len;
+        if (cfs_read(fd, &len, sizeof(len)) != sizeof(len) || len > sizeof(record_buf) ||
+            len > remaining - sizeof(len) || cfs_read(fd, record_buf, len) != len)
+        {
+            LOG_ERR("Failed to read snapshot record %d\n", records);
+            break;
+        }
+
+        remaining -= sizeof(len) + len;
+
+        // A record that cannot be restored (e.g., the pools are smaller in this build) does not prevent the others
+        if (restore_record(record_buf, len) < 0)
+        {
+            LOG_WARN("Failed to restore snapshot record %d\n", records);
+        }
+        else
+        {
+            records += 1;
+        }
+    }
+
+    cfs_close(fd);
+
+    // Trust values need to be calculated with the restored records
+    trust_cache_invalidate_all();
+
+    restoring = false;
+
+    LOG_INFO("Restored %d records from snapshot %" PRIu16 "\n", records, sequence);
+
+    return records;
+}
+/*-------------------------------------------------------------------------------------------------------------------*/
+void trust_snapshot_erase(void)
+{
+    for (uint16_t slot = 0; slot != TRUST_SNAPSHOT_SLOTS; ++slot)
+    {
+        char name[SNAPSHOT_NAME_LEN];
+        snapshot_name(slot, name, sizeof(name));
+        cfs_remove(name);
+    }
+
+    ctimer_stop(&snapshot_timer);
+    sequence = 0;
+    written = false;
+}
+/*-------------------------------------------------------------------------------------------------------------------*/
+void trust_snapshot_init(void)
+{
+    trust_snapshot_restore();
+}
+/*-------------------------------------------------------------------------------------------------------------------*/
+#endif /* TRUST_SNAPSHOT */
+/*-------------------------------------------------------------------------------------------------------------------*/
@@ -0,0 +1,46 @@
+#pragma once
+/*-------------------------------------------------------------------------------------------------------------------*/
+#include <stdint.h>
+#include <stdbool.h>
+
+#include "contiki.h"
+/*-------------------------------------------------------------------------------------------------------------------*/
+// Keeps the edge, capability, peer and stereotype records and the verified certificates in flash (via CFS),
+// so that after a reboot a node does not need to re-learn trust or re-verify certificates before offloading.
+//
+// An image is a header followed by length-prefixed CBOR records, protected by a CRC16 of the records. Images are
+// written alternately to two files, so a reboot part way through writing one leaves the previous image intact.
+// The records hold the trust model's structs as they are in RAM, so an image is only restored by a build with
+// the same trust model and record layout. Certificates also carry a MAC keyed by the node's private key, and are
+// verified again if it does not match.
+//
+// Enabled with TRUST_SNAPSHOT=1, which uses Coffee on motes and a file-backed CFS on native and Cooja.
+/*-------------------------------------------------------------------------------------------------------------------*/
+// A change to trust is written out after this long, along with any other changes made in the meantime
+#ifndef TRUST_SNAPSHOT_DELAY
+#define TRUST_SNAPSHOT_DELAY (60 * CLOCK_SECOND)
+#endif
+
+// Trust changes with most tasks, so to limit flash wear images are written at most once per this many seconds.
+// A scheduled image is not written if nothing has changed since the last one.
+#ifndef TRUST_SNAPSHOT_MIN_INTERVAL
+#define TRUST_SNAPSHOT_MIN_INTERVAL (30 * 60)
+#endif
+
+#ifndef TRUST_SNAPSHOT_FILE_PREFIX
+#define TRUST_SNAPSHOT_FILE_PREFIX "trust-snapshot-"
+#endif
+/*-------------------------------------------------------------------------------------------------------------------*/
+// Restores the newest valid image, called from trust_common_init once the record pools have been initialised
+void trust_snapshot_init(void);
+/*-------------------------------------------------------------------------------------------------------------------*/
+// Schedules an image to be written, changes made before it is written are coalesced into it
+void trust_snapshot_changed(void);
+/*-------------------------------------------------------------------------------------------------------------------*/
+// Returns the length of the image written or a negative value on failure
+int trust_snapshot_write(void);
+// Returns the number of records restored or a negative value if there was no valid image
+int trust_snapshot_restore(void);
+// Removes both images, e.g., when the node is moved to a different network
+void trust_snapshot_erase(void);
+/*-------------------------------------------------------------------------------------------------------------------*/
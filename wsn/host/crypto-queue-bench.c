@@ -0,0 +1,377 @@
+#include "contiki.h"
+#include "crypto-support.h"
+
+#include <inttypes.h>
+#include <math.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+/*-------------------------------------------------------------------------------------------------------------------*/
+// Load test of the verify queue in crypto-support.c, driven in virtual time so that it does not depend on the host.
+// Verifies of each class arrive as independent Poisson streams and every verify takes the same time, as the ECC
+// engine would. The same arrivals are run through the queue twice: first all queued as critical without a deadline,
+// which verifies them in the order queued from the whole pool as before there were classes, then with their classes
+// and deadlines. The latency is from being queued to the verify being reported.
+/*-------------------------------------------------------------------------------------------------------------------*/
+#ifndef CRYPTO_QUEUE_BENCH_VERIFIES
+#define CRYPTO_QUEUE_BENCH_VERIFIES 20000
+#endif
+
+// How long an ECDSA secp256r1 verify takes on the ECC engine
+#ifndef CRYPTO_QUEUE_BENCH_VERIFY_MS
+#define CRYPTO_QUEUE_BENCH_VERIFY_MS 350
+#endif
+
+// The deadline trust broadcasts are verified with (TRUST_RX_VERIFY_MAX_WAIT)
+#ifndef CRYPTO_QUEUE_BENCH_BULK_MAX_WAIT
+#define CRYPTO_QUEUE_BENCH_BULK_MAX_WAIT (30 * CLOCK_SECOND)
+#endif
+/*-------------------------------------------------------------------------------------------------------------------*/
+static const char* const priority_names[CRYPTO_PRIORITY_NUM] = { "critical", "normal", "bulk" };
+
+typedef enum {
+    SCHEDULER_FIFO,
+    SCHEDULER_PRIORITY,
+
+    SCHEDULER_NUM
+} scheduler_t;
+
+static const char* const scheduler_names[SCHEDULER_NUM] = { "fifo", "priority" };
+/*-------------------------------------------------------------------------------------------------------------------*/
+// Virtual time in microseconds, the clock and rtimer shims are replaced by it
+static uint64_t now_us;
+static uint64_t verify_us;
+
+// When the verify being run completes, valid while verifying
+static bool verifying;
+static uint64_t verify_done_us;
+
+typedef struct {
+    bool in_use;
+    crypto_priority_t priority;
+    uint64_t queued_us;
+} request_t;
+
+// More than the verify queue can hold
+static request_t requests[16];
+
+typedef struct {
+    uint32_t offered;
+    uint32_t rejected;
+    uint32_t expired;
+    uint32_t verified;
+    uint32_t* latencies;
+} class_stats_t;
+
+static class_stats_t stats[CRYPTO_PRIORITY_NUM];
+
+static const uint8_t message[64];
+static const ecdsa_secp256r1_pubkey_t pubkey;
+/*-------------------------------------------------------------------------------------------------------------------*/
+PROCESS_NAME(verifier);
+PROCESS(crypto_queue_bench, "crypto-queue-bench");
+/*-------------------------------------------------------------------------------------------------------------------*/
+void clock_init(void)
+{
+    now_us = 0;
+}
+/*-------------------------------------------------------------------------------------------------------------------*/
+clock_time_t clock_time(void)
+{
+    return (clock_time_t)(now_us / (1000000 / CLOCK_SECOND));
+}
+/*-------------------------------------------------------------------------------------------------------------------*/
+unsigned long clock_seconds(void)
+{
+    return (unsigned long)(now_us / 1000000);
+}
+/*-------------------------------------------------------------------------------------------------------------------*/
+rtimer_clock_t rtimer_arch_now(void)
+{
+    return (rtimer_clock_t)now_us;
+}
+/*-------------------------------------------------------------------------------------------------------------------*/
+PT_THREAD(ecc_verify(verify_state_t* state, const ecdsa_secp256r1_pubkey_t* pk, const uint8_t* buffer, size_t buffer_len))
+{
+    (void)pk;
+    (void)buffer;
+    (void)buffer_len;
+
+    PT_BEGIN(&state->pt);
+
+    verifying = true;
+    verify_done_us = now_us + verify_us;
+
+    PT_WAIT_UNTIL(&state->pt, now_us >= verify_done_us);
+
+    verifying = false;
+    state->result = 0;
+
+    PT_END(&state->pt);
+}
+/*-------------------------------------------------------------------------------------------------------------------*/
+// Only verifies are queued
+PT_THREAD(ecc_sign(sign_state_t* state, uint8_t* buffer, size_t buffer_len, size_t msg_len))
+{
+    (void)buffer;
+    (void)buffer_len;
+    (void)msg_len;
+
+    PT_BEGIN(&state->pt);
+
+    state->result = 0;
+
+    PT_END(&state->pt);
+}
+/*-------------------------------------------------------------------------------------------------------------------*/
+PROCESS_THREAD(crypto_queue_bench, ev, data)
+{
+    PROCESS_BEGIN();
+
+    while (1)
+    {
+        PROCESS_WAIT_EVENT_UNTIL(ev == pe_message_verified);
+
+        messages_to_verify_entry_t* const item = (messages_to_verify_entry_t*)data;
+        request_t* const request = (request_t*)item->data;
+        class_stats_t* const s = &stats[request->priority];
+
+        if (item->result == PLATFORM_CRYPTO_EXPIRED)
+        {
+            s->expired += 1;
+        }
+        else
+        {
+            s->latencies[s->verified++] = (uint32_t)(now_us - request->queued_us);
+        }
+
+        request->in_use = false;
+        queue_message_to_verify_done(item);
+    }
+
+    PROCESS_END();
+}
+/*-------------------------------------------------------------------------------------------------------------------*/
+static uint64_t xorshift_state;
+
+// Exponentially distributed with the given mean
+static uint64_t exponential_us(double mean_us)
+{
+    xorshift_state ^= xorshift_state << 13;
+    xorshift_state ^= xorshift_state >> 7;
+    xorshift_state ^= xorshift_state << 17;
+
+    const double u = ((xorshift_state >> 11) + 1.0) / 9007199254740993.0;
+
+    return (uint64_t)(-log(u) * mean_us);
+}
+/*-------------------------------------------------------------------------------------------------------------------*/
+static bool queue(scheduler_t scheduler, crypto_priority_t priority)
+{
+    request_t* request = NULL;
+    for (size_t i = 0; i != sizeof(requests)/sizeof(*requests); ++i)
+    {
+        if (!requests[i].in_use)
+        {
+            request = &requests[i];
+            break;
+        }
+    }
+    if (request == NULL)
+    {
+        return false;
+    }
+
+    request->priority = priority;
+    request->queued_us = now_us;
+
+    bool queued;
+    if (scheduler == SCHEDULER_FIFO)
+    {
+        queued = queue_message_to_verify(&crypto_queue_bench, request, message, sizeof(message), &pubkey,
+                                         CRYPTO_PRIORITY_CRITICAL, CRYPTO_NO_DEADLINE);
+    }
+    else
+    {
+        queued = queue_message_to_verify(&crypto_queue_bench, request, message, sizeof(message), &pubkey,
+                                         priority,
+                                         priority == CRYPTO_PRIORITY_BULK ? CRYPTO_QUEUE_BENCH_BULK_MAX_WAIT : CRYPTO_NO_DEADLINE);
+    }
+
+    request->in_use = queued;
+
+    return queued;
+}
+/*-------------------------------------------------------------------------------------------------------------------*/
+static void run(scheduler_t scheduler, const double load[CRYPTO_PRIORITY_NUM], uint32_t verifies)
+{
+    xorshift_state = 0x9e3779b97f4a7c15ull;
+
+    uint64_t next_arrival[CRYPTO_PRIORITY_NUM];
+    for (uint8_t priority = 0; priority != CRYPTO_PRIORITY_NUM; ++priority)
+    {
+        stats[priority].offered = stats[priority].rejected = stats[priority].expired = stats[priority].verified = 0;
+        next_arrival[priority] = load[priority] > 0 ? now_us + exponential_us(verify_us / load[priority]) : UINT64_MAX;
+    }
+
+    uint32_t arrived = 0;
+
+    while (1)
+    {
+        while (process_run())
+        {
+        }
+
+        crypto_priority_t next = 0;
+        for (uint8_t priority = 1; priority != CRYPTO_PRIORITY_NUM; ++priority)
+        {
+            if (next_arrival[priority] < next_arrival[next])
+            {
+                next = priority;
+            }
+        }
+
+        const bool arrivals = arrived != verifies && next_arrival[next] != UINT64_MAX;
+
+        if (verifying && (!arrivals || verify_done_us <= next_arrival[next]))
+        {
+            now_us = verify_done_us;
+            process_poll(&verifier);
+            continue;
+        }
+
+        if (!arrivals)
+        {
+            break;
+        }
+
+        now_us = next_arrival[next];
+        next_arrival[next] = now_us + exponential_us(verify_us / load[next]);
+        arrived += 1;
+
+        stats[next].offered += 1;
+        if (!queue(scheduler, next))
+        {
+            stats[next].rejected += 1;
+        }
+    }
+}
+/*-------------------------------------------------------------------------------------------------------------------*/
+static int uint32_cmp(const void* a, const void* b)
+{
+    const uint32_t x = *(const uint32_t*)a;
+    const uint32_t y = *(const uint32_t*)b;
+
+    return (x > y) - (x < y);
+}
+/*-------------------------------------------------------------------------------------------------------------------*/
+// Nearest-rank percentile of sorted values, in milliseconds
+static double percentile_ms(const uint32_t* sorted, uint32_t count, uint8_t p)
+{
+    const uint32_t rank = (uint32_t)(((uint64_t)count * p + 99) / 100);
+
+    return count == 0 ? 0 : sorted[rank == 0 ? 0 : rank - 1] / 1000.0;
+}
+/*-------------------------------------------------------------------------------------------------------------------*/
+static void print(scheduler_t scheduler)
+{
+    for (uint8_t priority = 0; priority != CRYPTO_PRIORITY_NUM; ++priority)
+    {
+        class_stats_t* const s = &stats[priority];
+
+        if (s->offered == 0)
+        {
+            continue;
+        }
+
+        qsort(s->latencies, s->verified, sizeof(*s->latencies), uint32_cmp);
+
+        printf("%s,%s,%" PRIu32 ",%" PRIu32 ",%" PRIu32 ",%" PRIu32 ",%.1f,%.1f,%.1f,%.1f\n",
+            scheduler_names[scheduler], priority_names[priority],
+            s->offered, s->rejected, s->expired, s->verified,
+            percentile_ms(s->latencies, s->verified, 50),
+            percentile_ms(s->latencies, s->verified, 95),
+            percentile_ms(s->latencies, s->verified, 99),
+            s->verified == 0 ? 0 : s->latencies[s->verified - 1] / 1000.0);
+    }
+}
+/*-------------------------------------------------------------------------------------------------------------------*/
+static void usage(const char* name)
+{
+    fprintf(stderr, "Usage: %s [-q] [-n verifies] [-v verify_ms] [-l critical,normal,bulk]\n", name);
+    fprintf(stderr, "  -q  Do not print the CSV header\n");
+    fprintf(stderr, "  -n  Number of verifies queued by each scheduler (default %d)\n", CRYPTO_QUEUE_BENCH_VERIFIES);
+    fprintf(stderr, "  -v  Time a verify takes in milliseconds (default %d)\n", CRYPTO_QUEUE_BENCH_VERIFY_MS);
+    fprintf(stderr, "  -l  Load offered by each class, as a fraction of the verifies the ECC engine can do (default 0.1,0.1,0.7)\n");
+}
+/*-------------------------------------------------------------------------------------------------------------------*/
+int main(int argc, char* argv[])
+{
+    bool header = true;
+    uint32_t verifies = CRYPTO_QUEUE_BENCH_VERIFIES;
+    double verify_ms = CRYPTO_QUEUE_BENCH_VERIFY_MS;
+    double load[CRYPTO_PRIORITY_NUM] = { 0.1, 0.1, 0.7 };
+
+    int opt;
+    while ((opt = getopt(argc, argv, "qn:v:l:h")) != -1)
+    {
+        switch (opt)
+        {
+        case 'q': header = false; break;
+        case 'n': verifies = strtoul(optarg, NULL, 10); break;
+        case 'v': verify_ms = strtod(optarg, NULL); break;
+        case 'l':
+            if (sscanf(optarg, "%lf,%lf,%lf", &load[CRYPTO_PRIORITY_CRITICAL], &load[CRYPTO_PRIORITY_NORMAL], &load[CRYPTO_PRIORITY_BULK]) != 3)
+            {
+                usage(argv[0]);
+                return EXIT_FAILURE;
+            }
+            break;
+        default: usage(argv[0]); return opt == 'h' ? EXIT_SUCCESS : EXIT_FAILURE;
+        }
+    }
+
+    if (verifies == 0 || verify_ms <= 0 || load[0] < 0 || load[1] < 0 || load[2] < 0 || load[0] + load[1] + load[2] <= 0)
+    {
+        usage(argv[0]);
+        return EXIT_FAILURE;
+    }
+
+    verify_us = (uint64_t)(verify_ms * 1000);
+
+    for (uint8_t priority = 0; priority != CRYPTO_PRIORITY_NUM; ++priority)
+    {
+        stats[priority].latencies = calloc(verifies, sizeof(*stats[priority].latencies));
+        if (stats[priority].latencies == NULL)
+        {
+            perror("calloc");
+            return EXIT_FAILURE;
+        }
+    }
+
+    clock_init();
+
+    crypto_support_init();
+    process_start(&crypto_queue_bench, NULL);
+
+    if (header)
+    {
+        printf("scheduler,class,offered,rejected,expired,verified,p50_ms,p95_ms,p99_ms,max_ms\n");
+    }
+
+    for (scheduler_t scheduler = 0; scheduler != SCHEDULER_NUM; ++scheduler)
+    {
+        run(scheduler, load, verifies);
+        print(scheduler);
+    }
+
+    for (uint8_t priority = 0; priority != CRYPTO_PRIORITY_NUM; ++priority)
+    {
+        free(stats[priority].latencies);
+    }
+
+    return EXIT_SUCCESS;
+}
+/*-------------------------------------------------------------------------------------------------------------------*/
@@ -0,0 +1,26 @@
+#pragma once
+/*-------------------------------------------------------------------------------------------------------------------*/
+#include <stdint.h>
+#include <time.h>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#endif
+/*-------------------------------------------------------------------------------------------------------------------*/
+// Cost of short operations in cycles where a cycle counter is available, otherwise in nanoseconds
+#if defined(__x86_64__) || defined(__i386__)
+#define COST_UNIT "cycles"
+static inline uint64_t cost_now(void)
+{
+    return __rdtsc();
+}
+#else
+#define COST_UNIT "ns"
+static inline uint64_t cost_now(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000u + (uint64_t)ts.tv_nsec;
+}
+#endif
+/*-------------------------------------------------------------------------------------------------------------------*/
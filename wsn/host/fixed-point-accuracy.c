@@ -0,0 +1,402 @@
+#include "distributions.h"
+#include "fixed-point.h"
+
+#include "cycles.h"
+
+#include <inttypes.h>
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+/*-------------------------------------------------------------------------------------------------------------------*/
+// Compares the fixed-point distributions (this is built with TRUST_FIXED_POINT) and the floating-point
+// arithmetic they replace against a double precision reference, and measures the cost of each per operation.
+// The float versions below mirror the floating-point branches of distributions.c.
+// The table driven gaussian_dist_cdf is measured in both modes by normal-cdf-bench.c.
+//
+// Host timings only show the relative cost of the fixed-point code, a host FPU makes floats far cheaper
+// than the software emulation on a CC2538. Use the profile application (PROFILE_TRUST=1) for device timings.
+/*-------------------------------------------------------------------------------------------------------------------*/
+#ifndef ACCURACY_SAMPLES
+#define ACCURACY_SAMPLES 100000
+#endif
+
+// Number of samples in each stream of distribution updates
+#define ACCURACY_STREAM_LEN 100
+/*-------------------------------------------------------------------------------------------------------------------*/
+typedef struct {
+    const char* operation;
+    uint32_t samples;
+
+    double fixed_max_error;
+    double float_max_error;
+
+    uint64_t fixed_cost;
+    uint64_t float_cost;
+    uint32_t ops;
+
+} accuracy_t;
+/*-------------------------------------------------------------------------------------------------------------------*/
+static uint32_t rng_state = 0x12345678;
+
+static uint32_t rng(void)
+{
+    // xorshift32, so results are the same on every host
+    rng_state ^= rng_state << 13;
+    rng_state ^= rng_state >> 17;
+    rng_state ^= rng_state << 5;
+    return rng_state;
+}
+
+static double rng_uniform(double low, double high)
+{
+    return low + (high - low) * (rng() / (double)UINT32_MAX);
+}
+/*-------------------------------------------------------------------------------------------------------------------*/
+static volatile double sink;
+/*-------------------------------------------------------------------------------------------------------------------*/
+static void error(accuracy_t* acc, double reference, double fixed_value, float float_value, bool relative)
+{
+    const double scale = relative && reference != 0 ? fabs(reference) : 1.0;
+
+    acc->fixed_max_error = fmax(acc->fixed_max_error, fabs(fixed_value - reference) / scale);
+    acc->float_max_error = fmax(acc->float_max_error, fabs(float_value - reference) / scale);
+    acc->samples += 1;
+}
+/*-------------------------------------------------------------------------------------------------------------------*/
+static void print(const accuracy_t* acc)
+{
+    printf("%s,%" PRIu32 ",%.3g,%.3g,%.1f,%.1f\n",
+        acc->operation, acc->samples, acc->fixed_max_error, acc->float_max_error,
+        (double)acc->fixed_cost / acc->ops, (double)acc->float_cost / acc->ops);
+}
+/*-------------------------------------------------------------------------------------------------------------------*/
+static void beta_expected(void)
+{
+    accuracy_t acc = { .operation = "beta_dist_expected" };
+
+    for (uint32_t i = 0; i != ACCURACY_SAMPLES; ++i)
+    {
+        beta_dist_t dist;
+        beta_dist_init(&dist, 1 + rng() % 1000, 1 + rng() % 1000);
+
+        const double reference = dist.alpha / (double)(dist.alpha + dist.beta);
+
+        uint64_t start = cost_now();
+        const trust_real_t fixed_value = beta_dist_expected(&dist);
+        acc.fixed_cost += cost_now() - start;
+
+        start = cost_now();
+        const float a = dist.alpha, b = dist.beta;
+        const float float_value = a / (a + b);
+        acc.float_cost += cost_now() - start;
+
+        error(&acc, reference, q16_16_to_float(fixed_value), float_value, false);
+        acc.ops += 1;
+        sink += fixed_value + float_value;
+    }
+
+    print(&acc);
+}
+/*-------------------------------------------------------------------------------------------------------------------*/
+static void weighted_trust(void)
+{
+    accuracy_t acc = { .operation = "weighted_trust" };
+
+    // The weights used by the routing application
+    const trust_real_t fixed_w = TRUST_REAL(1.0f/3.0f);
+    const float float_w = 1.0f/3.0f;
+
+    for (uint32_t i = 0; i != ACCURACY_SAMPLES; ++i)
+    {
+        double e[3];
+        trust_real_t fixed_e[3];
+        float float_e[3];
+        double reference = 0;
+
+        for (int j = 0; j != 3; ++j)
+        {
+            e[j] = rng_uniform(0, 1);
+            fixed_e[j] = q16_16_from_float(e[j]);
+            float_e[j] = (float)e[j];
+            reference += e[j] / 3.0;
+        }
+
+        uint64_t start = cost_now();
+        trust_real_t fixed_value = TRUST_REAL(0);
+        for (int j = 0; j != 3; ++j)
+        {
+            fixed_value += trust_real_mul(fixed_w, fixed_e[j]);
+        }
+        acc.fixed_cost += cost_now() - start;
+
+        start = cost_now();
+        float float_value = 0;
+        for (int j = 0; j != 3; ++j)
+        {
+            float_value += float_w * float_e[j];
+        }
+        acc.float_cost += cost_now() - start;
+
+        error(&acc, reference, q16_16_to_float(fixed_value), float_value, false);
+        acc.ops += 1;
+        sink += fixed_value + float_value;
+    }
+
+    print(&acc);
+}
+/*-------------------------------------------------------------------------------------------------------------------*/
+static void gaussian_update(void)
+{
+    accuracy_t mean_acc = { .operation = "gaussian_dist_update(mean)" };
+    accuracy_t var_acc = { .operation = "gaussian_dist_update(variance)" };
+
+    for (uint32_t i = 0; i != ACCURACY_SAMPLES / ACCURACY_STREAM_LEN; ++i)
+    {
+        // Throughput in bytes per second
+        const double centre = rng_uniform(100, 20000);
+
+        gaussian_dist_t fixed_dist;
+        gaussian_dist_init_empty(&fixed_dist);
+
+        float float_mean = 0, float_variance = 0;
+        double sum = 0, sum_sq = 0;
+
+        for (uint32_t n = 1; n <= ACCURACY_STREAM_LEN; ++n)
+        {
+            const uint32_t value = (uint32_t)rng_uniform(centre * 0.5, centre * 1.5);
+
+            uint64_t start = cost_now();
+            gaussian_dist_update(&fixed_dist, trust_wide_from_uint(value));
+            mean_acc.fixed_cost += cost_now() - start;
+
+            start = cost_now();
+            if (n == 1)
+            {
+                float_mean = value;
+                float_variance = 0;
+            }
+            else
+            {
+                const float new_mean = float_mean + (value - float_mean) / n;
+                const float new_variance = (float_variance * ((n - 2.0f) / (n - 1.0f))) +
+                                           ((value - float_mean) * (value - float_mean)) / n;
+                float_mean = new_mean;
+                float_variance = new_variance;
+            }
+            mean_acc.float_cost += cost_now() - start;
+            mean_acc.ops += 1;
+
+            sum += value;
+            sum_sq += (double)value * value;
+        }
+
+        const double mean = sum / ACCURACY_STREAM_LEN;
+        const double variance = (sum_sq - sum * mean) / (ACCURACY_STREAM_LEN - 1);
+
+        error(&mean_acc, mean, q48_16_to_float(fixed_dist.mean), float_mean, true);
+        error(&var_acc, variance, q48_16_to_float(fixed_dist.variance), float_variance, true);
+    }
+
+    var_acc.fixed_cost = mean_acc.fixed_cost;
+    var_acc.float_cost = mean_acc.float_cost;
+    var_acc.ops = mean_acc.ops;
+
+    print(&mean_acc);
+    print(&var_acc);
+}
+/*-------------------------------------------------------------------------------------------------------------------*/
+static void gaussian_update_ewma(void)
+{
+    accuracy_t mean_acc = { .operation = "gaussian_dist_update_ewma(mean)" };
+    accuracy_t var_acc = { .operation = "gaussian_dist_update_ewma(variance)" };
+
+    const double alpha = 0.6;
+
+    for (uint32_t i = 0; i != ACCURACY_SAMPLES / ACCURACY_STREAM_LEN; ++i)
+    {
+        const double centre = rng_uniform(100, 20000);
+
+        gaussian_dist_t fixed_dist;
+        gaussian_dist_init_empty(&fixed_dist);
+
+        float float_mean = 0, float_variance = 0;
+        double mean = 0, variance = 0;
+
+        for (uint32_t n = 1; n <= ACCURACY_STREAM_LEN; ++n)
+        {
+            const uint32_t value = (uint32_t)rng_uniform(centre * 0.5, centre * 1.5);
+
+            uint64_t start = cost_now();
+            gaussian_dist_update_ewma(&fixed_dist, trust_wide_from_uint(value), TRUST_REAL(0.6));
+            mean_acc.fixed_cost += cost_now() - start;
+
+            start = cost_now();
+            if (n == 1)
+            {
+                float_mean = value;
+                float_variance = 0;
+            }
+            else
+            {
+                const float diff = value - float_mean;
+                const float incr = 0.6f * diff;
+                float_variance = (1.0f - 0.6f) * (float_variance + diff * incr);
+                float_mean += incr;
+            }
+            mean_acc.float_cost += cost_now() - start;
+            mean_acc.ops += 1;
+
+            if (n == 1)
+            {
+                mean = value;
+            }
+            else
+            {
+                const double diff = value - mean;
+                const double incr = alpha * diff;
+                variance = (1.0 - alpha) * (variance + diff * incr);
+                mean += incr;
+            }
+        }
+
+        error(&mean_acc, mean, q48_16_to_float(fixed_dist.mean), float_mean, true);
+        error(&var_acc, variance, q48_16_to_float(fixed_dist.variance), float_variance, true);
+    }
+
+    var_acc.fixed_cost = mean_acc.fixed_cost;
+    var_acc.float_cost = mean_acc.float_cost;
+    var_acc.ops = mean_acc.ops;
+
+    print(&mean_acc);
+    print(&var_acc);
+}
+/*-------------------------------------------------------------------------------------------------------------------*/
+static void gaussian_cdf(void)
+{
+    accuracy_t acc = { .operation = "gaussian_dist_cdf_exact" };
+
+    for (uint32_t i = 0; i != ACCURACY_SAMPLES; ++i)
+    {
+        const double mean = rng_uniform(100, 20000);
+        const double sd = rng_uniform(1, mean);
+        const double value = mean + rng_uniform(-4, 4) * sd;
+
+        gaussian_dist_t fixed_dist = {
+            .mean = q48_16_from_float(mean),
+            .variance = q48_16_from_float(sd * sd),
+            .count = 2
+        };
+        const trust_wide_t fixed_x = q48_16_from_float(value);
+
+        const float float_mean = mean, float_variance = sd * sd, float_x = value;
+
+        const double reference = erfc(-(value - mean) / (sd * sqrt(2.0))) / 2.0;
+
+        uint64_t start = cost_now();
+        const trust_real_t fixed_value = gaussian_dist_cdf_exact(&fixed_dist, fixed_x);
+        acc.fixed_cost += cost_now() - start;
+
+        start = cost_now();
+        const float float_value = (float)(erfc(-(float_x - float_mean) / sqrt(float_variance * 2.0)) / 2.0);
+        acc.float_cost += cost_now() - start;
+
+        error(&acc, reference, q16_16_to_float(fixed_value), float_value, false);
+        acc.ops += 1;
+        sink += fixed_value + float_value;
+    }
+
+    print(&acc);
+}
+/*-------------------------------------------------------------------------------------------------------------------*/
+static void exponential_cdf(void)
+{
+    accuracy_t acc = { .operation = "exponential_dist_cdf" };
+
+    for (uint32_t i = 0; i != ACCURACY_SAMPLES; ++i)
+    {
+        // Mean time in clock ticks between changes, as used by the throughput_pr model
+        const uint32_t mean = 1000 + rng() % 3600000;
+        const uint32_t value = rng() % (5 * mean);
+
+        exponential_dist_t fixed_dist;
+        exponential_dist_init(&fixed_dist, trust_wide_from_uint(mean));
+
+        const float float_lambda = 1.0f / mean;
+
+        const double reference = 1.0 - exp(-(double)value / mean);
+
+        uint64_t start = cost_now();
+        const trust_real_t fixed_value = exponential_dist_cdf(&fixed_dist, trust_wide_from_uint(value));
+        acc.fixed_cost += cost_now() - start;
+
+        start = cost_now();
+        const float float_value = 1.0f - exp(-float_lambda * value);
+        acc.float_cost += cost_now() - start;
+
+        error(&acc, reference, q16_16_to_float(fixed_value), float_value, false);
+        acc.ops += 1;
+        sink += fixed_value + float_value;
+    }
+
+    print(&acc);
+}
+/*-------------------------------------------------------------------------------------------------------------------*/
+static void exponential_mle_update(void)
+{
+    accuracy_t acc = { .operation = "exponential_dist_mle_update" };
+
+    for (uint32_t i = 0; i != ACCURACY_SAMPLES / ACCURACY_STREAM_LEN; ++i)
+    {
+        const uint32_t initial = 1000 + rng() % 3600000;
+
+        exponential_dist_t fixed_dist;
+        exponential_dist_init(&fixed_dist, trust_wide_from_uint(initial));
+
+        float float_lambda = 1.0f / initial;
+        uint32_t float_n = 1;
+
+        double sum = initial;
+
+        for (uint32_t n = 1; n != ACCURACY_STREAM_LEN; ++n)
+        {
+            const uint32_t value = rng() % (2 * initial);
+
+            uint64_t start = cost_now();
+            exponential_dist_mle_update(&fixed_dist, trust_wide_from_uint(value));
+            acc.fixed_cost += cost_now() - start;
+
+            start = cost_now();
+            const float xbar = 1.0f / float_lambda;
+            const float new_xbar = xbar + (value - xbar) / (float_n + 1);
+            float_lambda = 1.0f / new_xbar;
+            float_n += 1;
+            acc.float_cost += cost_now() - start;
+            acc.ops += 1;
+
+            sum += value;
+        }
+
+        const double mean = sum / ACCURACY_STREAM_LEN;
+
+        error(&acc, mean, q48_16_to_float(fixed_dist.mean), 1.0f / float_lambda, true);
+    }
+
+    print(&acc);
+}
+/*-------------------------------------------------------------------------------------------------------------------*/
+int main(void)
+{
+    // Errors are absolute for probabilities and relative for the statistics of samples
+    printf("operation,samples,fixed_max_error,float_max_error,fixed_" COST_UNIT ",float_" COST_UNIT "\n");
+
+    beta_expected();
+    weighted_trust();
+    gaussian_update();
+    gaussian_update_ewma();
+    gaussian_cdf();
+    exponential_cdf();
+    exponential_mle_update();
+
+    return EXIT_SUCCESS;
+}
+/*-------------------------------------------------------------------------------------------------------------------*/
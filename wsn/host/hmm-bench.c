@@ -0,0 +1,108 @@
+#include "hmm.h"
+
+#include "cycles.h"
+
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+/*-------------------------------------------------------------------------------------------------------------------*/
+// Measures the cost of the HMM kernels for the HMM_KERNEL, HMM_NUM_STATES and HMM_NUM_OBSERVATIONS this is built with.
+// `make hmm-bench` builds and runs every combination, so the unrolled kernels can be compared with the generic loops.
+/*-------------------------------------------------------------------------------------------------------------------*/
+#ifndef HMM_BENCH_OPS
+#define HMM_BENCH_OPS 1000000
+#endif
+
+#if HMM_KERNEL == HMM_KERNEL_GENERIC
+#define KERNEL "generic"
+#elif HMM_KERNEL == HMM_KERNEL_UNROLLED
+#define KERNEL "unrolled"
+#endif
+/*-------------------------------------------------------------------------------------------------------------------*/
+// A fixed sequence of observations, so every build measures the same work
+static uint8_t observations[256];
+
+static volatile float sink;
+/*-------------------------------------------------------------------------------------------------------------------*/
+static void print(const char* operation, uint64_t cost)
+{
+    printf("%s,%d,%d,%s,%d,%.1f\n", KERNEL, HMM_NUM_STATES, HMM_NUM_OBSERVATIONS,
+        operation, HMM_BENCH_OPS, (double)cost / HMM_BENCH_OPS);
+}
+/*-------------------------------------------------------------------------------------------------------------------*/
+static void usage(const char* name)
+{
+    fprintf(stderr, "Usage: %s [-q]\n", name);
+    fprintf(stderr, "  -q  Do not print the CSV header\n");
+}
+/*-------------------------------------------------------------------------------------------------------------------*/
+int main(int argc, char* argv[])
+{
+    bool header = true;
+
+    int opt;
+    while ((opt = getopt(argc, argv, "qh")) != -1)
+    {
+        switch (opt)
+        {
+        case 'q': header = false; break;
+        default: usage(argv[0]); return opt == 'h' ? EXIT_SUCCESS : EXIT_FAILURE;
+        }
+    }
+
+    uint32_t state = 0x12345678;
+    for (size_t i = 0; i != sizeof(observations); ++i)
+    {
+        // Mostly good observations, as from a trustworthy edge
+        state = state * 1103515245u + 12345u;
+        observations[i] = ((state >> 16) % 4 == 0)
+            ? (state >> 24) % HMM_NUM_OBSERVATIONS
+            : HMM_OBS_TASK_RESULT_QUALITY_CORRECT;
+    }
+
+    if (header)
+    {
+        printf("kernel,states,observations,operation,ops," COST_UNIT "_per_op\n");
+    }
+
+    hmm_t hmm;
+    hmm_init_default(&hmm);
+
+    interaction_history_t hist;
+    interaction_history_init(&hist);
+
+    hmm_forward_t fwd;
+    hmm_forward_init(&hmm, &fwd);
+
+    uint64_t start = cost_now();
+    for (uint32_t i = 0; i != HMM_BENCH_OPS; ++i)
+    {
+        hmm_forward_push(&hmm, &fwd, &hist, observations[i % sizeof(observations)]);
+    }
+    print("hmm_forward_push", cost_now() - start);
+
+    start = cost_now();
+    for (uint32_t i = 0; i != HMM_BENCH_OPS; ++i)
+    {
+        sink = hmm_observation_probability(&hmm, observations[i % sizeof(observations)], &fwd);
+    }
+    print("hmm_observation_probability", cost_now() - start);
+
+    start = cost_now();
+    for (uint32_t i = 0; i != HMM_BENCH_OPS; ++i)
+    {
+        sink = hmm_one_observation_probability(&hmm, observations[i % sizeof(observations)]);
+    }
+    print("hmm_one_observation_probability", cost_now() - start);
+
+    start = cost_now();
+    for (uint32_t i = 0; i != HMM_BENCH_OPS; ++i)
+    {
+        hmm_update(&hmm, observations[i % sizeof(observations)], i == 0);
+    }
+    print("hmm_update", cost_now() - start);
+
+    return EXIT_SUCCESS;
+}
+/*-------------------------------------------------------------------------------------------------------------------*/
@@ -0,0 +1,116 @@
+#include "distributions.h"
+
+#include "cycles.h"
+
+#include <inttypes.h>
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+/*-------------------------------------------------------------------------------------------------------------------*/
+// Checks the accuracy of the table driven gaussian_dist_cdf against a double precision reference
+// and compares its cost per call with gaussian_dist_cdf_exact, in the arithmetic this is built with.
+// Exits with a failure if the error exceeds the bound documented in distributions.h.
+/*-------------------------------------------------------------------------------------------------------------------*/
+#ifndef CDF_BENCH_SAMPLES
+#define CDF_BENCH_SAMPLES 200000
+#endif
+
+#define CDF_MAX_ERROR 3e-5
+
+#ifdef TRUST_FIXED_POINT
+#define ARITHMETIC "fixed"
+#else
+#define ARITHMETIC "float"
+#endif
+/*-------------------------------------------------------------------------------------------------------------------*/
+typedef trust_real_t (*cdf_fn_t)(const gaussian_dist_t* dist, trust_wide_t value);
+
+typedef struct {
+    gaussian_dist_t dist;
+    trust_wide_t value;
+    double reference;
+} sample_t;
+
+static sample_t samples[CDF_BENCH_SAMPLES];
+
+static volatile trust_real_t sink;
+/*-------------------------------------------------------------------------------------------------------------------*/
+static uint32_t rng_state = 0x12345678;
+
+static double rng_uniform(double low, double high)
+{
+    // xorshift32, so results are the same on every host
+    rng_state ^= rng_state << 13;
+    rng_state ^= rng_state >> 17;
+    rng_state ^= rng_state << 5;
+
+    return low + (high - low) * (rng_state / (double)UINT32_MAX);
+}
+/*-------------------------------------------------------------------------------------------------------------------*/
+static void generate(void)
+{
+    for (uint32_t i = 0; i != CDF_BENCH_SAMPLES; ++i)
+    {
+        // Throughput in bytes per second, with values up to 8 standard deviations from the mean
+        const double mean = rng_uniform(100, 20000);
+        const double sd = rng_uniform(1, mean);
+        const double value = mean + rng_uniform(-8, 8) * sd;
+
+        const trust_wide_t w_mean = trust_wide_from_float(mean);
+        const trust_wide_t w_variance = trust_wide_from_float(sd * sd);
+        const trust_wide_t w_value = trust_wide_from_float(value < 0 ? 0 : value);
+
+        gaussian_dist_init(&samples[i].dist, w_mean, w_variance);
+        samples[i].value = w_value;
+
+        // Use the rounded inputs, so only the error of the CDF itself is measured
+        const double r_mean = trust_wide_to_float(w_mean);
+        const double r_sd = sqrt(trust_wide_to_float(w_variance));
+        const double r_value = trust_wide_to_float(w_value);
+        samples[i].reference = erfc(-(r_value - r_mean) / (r_sd * sqrt(2.0))) / 2.0;
+    }
+}
+/*-------------------------------------------------------------------------------------------------------------------*/
+static double measure(const char* name, cdf_fn_t fn, double* cost)
+{
+    double max_error = 0;
+
+    for (uint32_t i = 0; i != CDF_BENCH_SAMPLES; ++i)
+    {
+        const double result = trust_real_to_float(fn(&samples[i].dist, samples[i].value));
+        max_error = fmax(max_error, fabs(result - samples[i].reference));
+    }
+
+    const uint64_t start = cost_now();
+    for (uint32_t i = 0; i != CDF_BENCH_SAMPLES; ++i)
+    {
+        sink = fn(&samples[i].dist, samples[i].value);
+    }
+    *cost = (double)(cost_now() - start) / CDF_BENCH_SAMPLES;
+
+    printf("%s,%s,%u,%.3g,%.1f\n", name, ARITHMETIC, CDF_BENCH_SAMPLES, max_error, *cost);
+
+    return max_error;
+}
+/*-------------------------------------------------------------------------------------------------------------------*/
+int main(void)
+{
+    generate();
+
+    printf("function,arithmetic,samples,max_abs_error," COST_UNIT "_per_call\n");
+
+    double exact_cost, table_cost;
+    measure("gaussian_dist_cdf_exact", gaussian_dist_cdf_exact, &exact_cost);
+    const double table_error = measure("gaussian_dist_cdf", gaussian_dist_cdf, &table_cost);
+
+    fprintf(stderr, "gaussian_dist_cdf is %.1fx faster than gaussian_dist_cdf_exact\n", exact_cost / table_cost);
+
+    if (table_error > CDF_MAX_ERROR)
+    {
+        fprintf(stderr, "gaussian_dist_cdf error %.3g exceeds the bound of %.3g\n", table_error, CDF_MAX_ERROR);
+        return EXIT_FAILURE;
+    }
+
+    return EXIT_SUCCESS;
+}
+/*-------------------------------------------------------------------------------------------------------------------*/
@@ -0,0 +1,24 @@
+#include "applications.h"
+/*-------------------------------------------------------------------------------------------------------------------*/
+// Host stand-in for applications/applications.c. No application processes run on the host,
+// so there is nothing to notify when capabilities are added or removed.
+/*-------------------------------------------------------------------------------------------------------------------*/
+struct process* find_process_with_name(const char* name)
+{
+    (void)name;
+    return NULL;
+}
+/*-------------------------------------------------------------------------------------------------------------------*/
+struct process* find_process_for_capability(const edge_capability_t* cap)
+{
+    (void)cap;
+    return NULL;
+}
+/*-------------------------------------------------------------------------------------------------------------------*/
+void post_to_capability_process(const edge_capability_t* cap, process_event_t pe, void* data)
+{
+    (void)cap;
+    (void)pe;
+    (void)data;
+}
+/*-------------------------------------------------------------------------------------------------------------------*/
@@ -0,0 +1,156 @@
+#include "keystore.h"
+#include "eui64.h"
+#include "trust-models.h"
+
+#include "lib/memb.h"
+#include "lib/list.h"
+#include "os/sys/log.h"
+/*-------------------------------------------------------------------------------------------------------------------*/
+// Host stand-in for common/crypto/keystore.c. There is no root to verify certificates
+// against or request keys from, so added certificates are trusted immediately.
+/*-------------------------------------------------------------------------------------------------------------------*/
+#define LOG_MODULE "keystore"
+#ifdef KEYSTORE_LOG_LEVEL
+#define LOG_LEVEL KEYSTORE_LOG_LEVEL
+#else
+#define LOG_LEVEL LOG_LEVEL_NONE
+#endif
+/*-------------------------------------------------------------------------------------------------------------------*/
+// There is no device key on the host, this keys the MACs of certificates in trust snapshots
+const ecdsa_secp256r1_privkey_t our_privkey = { .k = { 0 } };
+/*-------------------------------------------------------------------------------------------------------------------*/
+MEMB(public_keys_memb, public_key_item_t, PUBLIC_KEYSTORE_SIZE);
+LIST(public_keys);
+/*-------------------------------------------------------------------------------------------------------------------*/
+public_key_item_t* keystore_find(const uint8_t* eui64)
+{
+    for (public_key_item_t* iter = list_head(public_keys); iter != NULL; iter = list_item_next(iter))
+    {
+        if (memcmp(&iter->cert.subject, eui64, EUI64_LENGTH) == 0)
+        {
+            return iter;
+        }
+    }
+
+    return NULL;
+}
+/*-------------------------------------------------------------------------------------------------------------------*/
+public_key_item_t* keystore_find_addr(const uip_ip6addr_t* addr)
+{
+    uip_ip6addr_t norm_addr;
+    uip_ipaddr_copy(&norm_addr, addr);
+
+    if (uip_is_addr_linklocal(&norm_addr))
+    {
+        norm_addr.u8[0] = 0xFD;
+        norm_addr.u8[1] = 0x00;
+    }
+
+    uint8_t eui64[EUI64_LENGTH];
+    eui64_from_ipaddr(&norm_addr, eui64);
+
+    return keystore_find(eui64);
+}
+/*-------------------------------------------------------------------------------------------------------------------*/
+const ecdsa_secp256r1_pubkey_t* keystore_find_pubkey(const uip_ip6addr_t* addr)
+{
+    public_key_item_t* item = keystore_find_addr(addr);
+
+    return item == NULL ? NULL : &item->cert.public_key;
+}
+/*-------------------------------------------------------------------------------------------------------------------*/
+public_key_item_t* keystore_iter(void)
+{
+    return list_head(public_keys);
+}
+/*-------------------------------------------------------------------------------------------------------------------*/
+public_key_item_t* keystore_next(public_key_item_t* iter)
+{
+    return list_item_next(iter);
+}
+/*-------------------------------------------------------------------------------------------------------------------*/
+bool keystore_certificate_contains_tags(const stereotype_tags_t* tags)
+{
+    for (public_key_item_t* iter = list_head(public_keys); iter != NULL; iter = list_item_next(iter))
+    {
+        if (stereotype_tags_equal(tags, &iter->cert.tags))
+        {
+            return true;
+        }
+    }
+
+    return false;
+}
+/*-------------------------------------------------------------------------------------------------------------------*/
+void keystore_pin(public_key_item_t* item)
+{
+    item->pin_count += 1;
+}
+/*-------------------------------------------------------------------------------------------------------------------*/
+void keystore_unpin(public_key_item_t* item)
+{
+    item->pin_count -= 1;
+}
+/*-------------------------------------------------------------------------------------------------------------------*/
+bool keystore_is_pinned(const public_key_item_t* item)
+{
+    return item->pin_count > 0;
+}
+/*-------------------------------------------------------------------------------------------------------------------*/
+bool keystore_add(const certificate_t* cert)
+{
+    if (keystore_find(cert->subject) != NULL)
+    {
+        return true;
+    }
+
+    public_key_item_t* item = memb_alloc(&public_keys_memb);
+    if (item == NULL)
+    {
+        LOG_ERR("keystore_add: out of memory for ");
+        LOG_ERR_BYTES(cert->subject, EUI64_LENGTH);
+        LOG_ERR_("\n");
+        return false;
+    }
+
+    item->cert = *cert;
+    item->pin_count = 0;
+
+    list_push(public_keys, item);
+
+    // Stereotypes are found via the certificate tags
+    trust_cache_invalidate_all();
+
+    return true;
+}
+/*-------------------------------------------------------------------------------------------------------------------*/
+#ifdef TRUST_SNAPSHOT
+bool keystore_restore(const certificate_t* cert)
+{
+    return keystore_add(cert);
+}
+#endif
+/*-------------------------------------------------------------------------------------------------------------------*/
+bool keystore_remove(public_key_item_t* item)
+{
+    if (keystore_is_pinned(item) || !list_remove(public_keys, item))
+    {
+        return false;
+    }
+
+    memb_free(&public_keys_memb, item);
+
+    trust_cache_invalidate_all();
+
+    return true;
+}
+/*-------------------------------------------------------------------------------------------------------------------*/
+bool request_public_key(const uip_ip6addr_t* addr)
+{
+    LOG_WARN("No key server to request the public key of ");
+    LOG_WARN_6ADDR(addr);
+    LOG_WARN_(" from\n");
+
+    return false;
+}
+/*-------------------------------------------------------------------------------------------------------------------*/
@@ -0,0 +1,19 @@
+#pragma once
+/*-------------------------------------------------------------------------------------------------------------------*/
+// Host stand-in for Contiki-NG's contiki.h, providing only what the trust core uses
+/*-------------------------------------------------------------------------------------------------------------------*/
+#include <stdint.h>
+#include <inttypes.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <string.h>
+
+#include "sys/cc.h"
+#include "sys/clock.h"
+#include "sys/rtimer.h"
+#include "sys/pt.h"
+#include "sys/process.h"
+#include "sys/etimer.h"
+#include "sys/ctimer.h"
+#include "net/linkaddr.h"
+/*-------------------------------------------------------------------------------------------------------------------*/
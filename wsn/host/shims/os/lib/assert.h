@@ -0,0 +1,13 @@
+#pragma once
+/*-------------------------------------------------------------------------------------------------------------------*/
+// Same as Contiki-NG's lib/assert.h, reports the failed assertion and stops
+/*-------------------------------------------------------------------------------------------------------------------*/
+#include <stdio.h>
+#include <stdlib.h>
+/*-------------------------------------------------------------------------------------------------------------------*/
+#ifdef NDEBUG
+#define assert(e) ((void)0)
+#else
+#define assert(e) ((e) ? (void)0 : (fprintf(stderr, "%s:%d: assertion failed: %s\n", __FILE__, __LINE__, #e), abort()))
+#endif
+/*-------------------------------------------------------------------------------------------------------------------*/
@@ -0,0 +1,23 @@
+#include "lib/crc16.h"
+/*-------------------------------------------------------------------------------------------------------------------*/
+// CRC-16/KERMIT as computed by Contiki-NG's lib/crc16
+unsigned short crc16_add(unsigned char b, unsigned short acc)
+{
+    acc ^= b;
+    acc = (acc >> 8) | (acc << 8);
+    acc ^= (acc & 0xff00) << 4;
+    acc ^= (acc >> 8) >> 4;
+    acc ^= (acc & 0xff00) >> 5;
+    return acc;
+}
+/*-------------------------------------------------------------------------------------------------------------------*/
+unsigned short crc16_data(const unsigned char* data, int len, unsigned short acc)
+{
+    for (int i = 0; i < len; ++i)
+    {
+        acc = crc16_add(*data, acc);
+        ++data;
+    }
+    return acc;
+}
+/*-------------------------------------------------------------------------------------------------------------------*/
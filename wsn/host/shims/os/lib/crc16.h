@@ -0,0 +1,5 @@
+#pragma once
+/*-------------------------------------------------------------------------------------------------------------------*/
+unsigned short crc16_add(unsigned char b, unsigned short acc);
+unsigned short crc16_data(const unsigned char* data, int datalen, unsigned short acc);
+/*-------------------------------------------------------------------------------------------------------------------*/
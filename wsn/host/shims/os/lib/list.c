@@ -0,0 +1,160 @@
+#include "lib/list.h"
+
+#include <stddef.h>
+/*-------------------------------------------------------------------------------------------------------------------*/
+struct list {
+    struct list* next;
+};
+/*-------------------------------------------------------------------------------------------------------------------*/
+void list_init(list_t list)
+{
+    *list = NULL;
+}
+/*-------------------------------------------------------------------------------------------------------------------*/
+void* list_head(const list_t list)
+{
+    return *list;
+}
+/*-------------------------------------------------------------------------------------------------------------------*/
+void* list_tail(const list_t list)
+{
+    struct list* l = *list;
+    if (l == NULL)
+    {
+        return NULL;
+    }
+
+    while (l->next != NULL)
+    {
+        l = l->next;
+    }
+
+    return l;
+}
+/*-------------------------------------------------------------------------------------------------------------------*/
+void list_copy(list_t dest, const list_t src)
+{
+    *dest = *src;
+}
+/*-------------------------------------------------------------------------------------------------------------------*/
+bool list_remove(list_t list, const void* item)
+{
+    for (struct list** l = (struct list**)list; *l != NULL; l = &(*l)->next)
+    {
+        if (*l == item)
+        {
+            *l = (*l)->next;
+            return true;
+        }
+    }
+
+    return false;
+}
+/*-------------------------------------------------------------------------------------------------------------------*/
+void list_add(list_t list, void* item)
+{
+    // Make sure not to add the same item twice
+    list_remove(list, item);
+
+    ((struct list*)item)->next = NULL;
+
+    struct list* l = list_tail(list);
+    if (l == NULL)
+    {
+        *list = item;
+    }
+    else
+    {
+        l->next = item;
+    }
+}
+/*-------------------------------------------------------------------------------------------------------------------*/
+void list_push(list_t list, void* item)
+{
+    // Make sure not to add the same item twice
+    list_remove(list, item);
+
+    ((struct list*)item)->next = *list;
+    *list = item;
+}
+/*-------------------------------------------------------------------------------------------------------------------*/
+void* list_chop(list_t list)
+{
+    struct list* l = *list;
+    if (l == NULL)
+    {
+        return NULL;
+    }
+
+    if (l->next == NULL)
+    {
+        *list = NULL;
+        return l;
+    }
+
+    struct list* r;
+    for (; l->next->next != NULL; l = l->next)
+    {
+    }
+
+    r = l->next;
+    l->next = NULL;
+
+    return r;
+}
+/*-------------------------------------------------------------------------------------------------------------------*/
+void* list_pop(list_t list)
+{
+    struct list* l = *list;
+    if (l != NULL)
+    {
+        *list = l->next;
+    }
+
+    return l;
+}
+/*-------------------------------------------------------------------------------------------------------------------*/
+int list_length(const list_t list)
+{
+    int n = 0;
+
+    for (struct list* l = *list; l != NULL; l = l->next)
+    {
+        ++n;
+    }
+
+    return n;
+}
+/*-------------------------------------------------------------------------------------------------------------------*/
+void list_insert(list_t list, void* previtem, void* newitem)
+{
+    if (previtem == NULL)
+    {
+        list_push(list, newitem);
+    }
+    else
+    {
+        list_remove(list, newitem);
+        ((struct list*)newitem)->next = ((struct list*)previtem)->next;
+        ((struct list*)previtem)->next = newitem;
+    }
+}
+/*-------------------------------------------------------------------------------------------------------------------*/
+void* list_item_next(const void* item)
+{
+    return item == NULL ? NULL : ((const struct list*)item)->next;
+}
+/*-------------------------------------------------------------------------------------------------------------------*/
+bool list_contains(const list_t list, const void* item)
+{
+    for (struct list* l = *list; l != NULL; l = l->next)
+    {
+        if (item == l)
+        {
+            return true;
+        }
+    }
+
+    return false;
+}
+/*-------------------------------------------------------------------------------------------------------------------*/
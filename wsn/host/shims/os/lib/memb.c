@@ -0,0 +1,62 @@
+#include "lib/memb.h"
+
+#include <string.h>
+/*-------------------------------------------------------------------------------------------------------------------*/
+void memb_init(struct memb* m)
+{
+    memset(m->used, 0, sizeof(*m->used) * m->num);
+    memset(m->mem, 0, (size_t)m->size * m->num);
+}
+/*-------------------------------------------------------------------------------------------------------------------*/
+void* memb_alloc(struct memb* m)
+{
+    for (unsigned short i = 0; i < m->num; ++i)
+    {
+        if (!m->used[i])
+        {
+            m->used[i] = true;
+            return (char*)m->mem + (size_t)i * m->size;
+        }
+    }
+
+    return NULL;
+}
+/*-------------------------------------------------------------------------------------------------------------------*/
+int memb_free(struct memb* m, void* ptr)
+{
+    if (!memb_inmemb(m, ptr))
+    {
+        return -1;
+    }
+
+    m->used[memb_index(m, ptr)] = false;
+
+    return 0;
+}
+/*-------------------------------------------------------------------------------------------------------------------*/
+int memb_inmemb(struct memb* m, void* ptr)
+{
+    return (char*)ptr >= (char*)m->mem &&
+           (char*)ptr < (char*)m->mem + (size_t)m->size * m->num;
+}
+/*-------------------------------------------------------------------------------------------------------------------*/
+int memb_numfree(struct memb* m)
+{
+    int num_free = 0;
+
+    for (unsigned short i = 0; i < m->num; ++i)
+    {
+        if (!m->used[i])
+        {
+            ++num_free;
+        }
+    }
+
+    return num_free;
+}
+/*-------------------------------------------------------------------------------------------------------------------*/
+size_t memb_index(struct memb* m, const void* ptr)
+{
+    return (size_t)((const char*)ptr - (const char*)m->mem) / m->size;
+}
+/*-------------------------------------------------------------------------------------------------------------------*/
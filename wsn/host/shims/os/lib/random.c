@@ -0,0 +1,18 @@
+#include "lib/random.h"
+
+#include <stdint.h>
+/*-------------------------------------------------------------------------------------------------------------------*/
+// Same linear congruential generator as Contiki-NG's lib/random, so runs are repeatable
+static uint32_t rand_state = 1;
+/*-------------------------------------------------------------------------------------------------------------------*/
+void random_init(unsigned short seed)
+{
+    rand_state = seed;
+}
+/*-------------------------------------------------------------------------------------------------------------------*/
+unsigned short random_rand(void)
+{
+    rand_state = rand_state * 1103515245 + 12345;
+    return (unsigned short)((rand_state / 65536) % (RANDOM_RAND_MAX + 1));
+}
+/*-------------------------------------------------------------------------------------------------------------------*/
@@ -0,0 +1,7 @@
+#pragma once
+/*-------------------------------------------------------------------------------------------------------------------*/
+#define RANDOM_RAND_MAX 65535U
+/*-------------------------------------------------------------------------------------------------------------------*/
+void random_init(unsigned short seed);
+unsigned short random_rand(void);
+/*-------------------------------------------------------------------------------------------------------------------*/
@@ -0,0 +1,28 @@
+#include "coap-callback-api.h"
+/*-------------------------------------------------------------------------------------------------------------------*/
+int coap_send_request(coap_callback_request_state_t* callback_state, coap_endpoint_t* endpoint,
+                      coap_message_t* request,
+                      void (*callback)(coap_callback_request_state_t* callback_state))
+{
+    (void)endpoint;
+
+    callback_state->state.request = request;
+    callback_state->state.response = NULL;
+    callback_state->callback = callback;
+
+    return 0;
+}
+/*-------------------------------------------------------------------------------------------------------------------*/
+const char* coap_request_status_to_string(coap_request_status_t status)
+{
+    switch (status)
+    {
+    case COAP_REQUEST_STATUS_RESPONSE:      return "RESPONSE";
+    case COAP_REQUEST_STATUS_MORE:          return "MORE";
+    case COAP_REQUEST_STATUS_FINISHED:      return "FINISHED";
+    case COAP_REQUEST_STATUS_TIMEOUT:       return "TIMEOUT";
+    case COAP_REQUEST_STATUS_BLOCK_ERROR:   return "BLOCK_ERROR";
+    default:                                return "UNKNOWN";
+    }
+}
+/*-------------------------------------------------------------------------------------------------------------------*/
@@ -0,0 +1,17 @@
+#pragma once
+/*-------------------------------------------------------------------------------------------------------------------*/
+#include "coap.h"
+#include "coap-request-state.h"
+/*-------------------------------------------------------------------------------------------------------------------*/
+typedef struct coap_callback_request_state coap_callback_request_state_t;
+
+struct coap_callback_request_state {
+    coap_request_state_t state;
+    void (*callback)(coap_callback_request_state_t* state);
+};
+/*-------------------------------------------------------------------------------------------------------------------*/
+// Nothing is sent on the host, so requests always fail and the callback is never invoked
+int coap_send_request(coap_callback_request_state_t* callback_state, coap_endpoint_t* endpoint,
+                      coap_message_t* request,
+                      void (*callback)(coap_callback_request_state_t* callback_state));
+/*-------------------------------------------------------------------------------------------------------------------*/
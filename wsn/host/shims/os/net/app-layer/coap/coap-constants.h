@@ -0,0 +1,54 @@
+#pragma once
+/*-------------------------------------------------------------------------------------------------------------------*/
+typedef enum {
+    COAP_TYPE_CON,
+    COAP_TYPE_NON,
+    COAP_TYPE_ACK,
+    COAP_TYPE_RST
+} coap_message_type_t;
+/*-------------------------------------------------------------------------------------------------------------------*/
+typedef enum {
+    COAP_GET = 1,
+    COAP_POST,
+    COAP_PUT,
+    COAP_DELETE
+} coap_method_t;
+/*-------------------------------------------------------------------------------------------------------------------*/
+typedef enum {
+    NO_ERROR = 0,
+
+    CREATED_2_01 = 65,
+    DELETED_2_02 = 66,
+    VALID_2_03 = 67,
+    CHANGED_2_04 = 68,
+    CONTENT_2_05 = 69,
+    CONTINUE_2_31 = 95,
+
+    BAD_REQUEST_4_00 = 128,
+    UNAUTHORIZED_4_01 = 129,
+    BAD_OPTION_4_02 = 130,
+    FORBIDDEN_4_03 = 131,
+    NOT_FOUND_4_04 = 132,
+    METHOD_NOT_ALLOWED_4_05 = 133,
+    NOT_ACCEPTABLE_4_06 = 134,
+    PRECONDITION_FAILED_4_12 = 140,
+    REQUEST_ENTITY_TOO_LARGE_4_13 = 141,
+    UNSUPPORTED_MEDIA_TYPE_4_15 = 143,
+
+    INTERNAL_SERVER_ERROR_5_00 = 160,
+    NOT_IMPLEMENTED_5_01 = 161,
+    BAD_GATEWAY_5_02 = 162,
+    SERVICE_UNAVAILABLE_5_03 = 163,
+    GATEWAY_TIMEOUT_5_04 = 164,
+    PROXYING_NOT_SUPPORTED_5_05 = 165,
+} coap_status_t;
+/*-------------------------------------------------------------------------------------------------------------------*/
+typedef enum {
+    TEXT_PLAIN = 0,
+    APPLICATION_LINK_FORMAT = 40,
+    APPLICATION_XML = 41,
+    APPLICATION_OCTET_STREAM = 42,
+    APPLICATION_JSON = 50,
+    APPLICATION_CBOR = 60,
+} coap_content_format_t;
+/*-------------------------------------------------------------------------------------------------------------------*/
@@ -0,0 +1,104 @@
+#include "coap-endpoint.h"
+#include "net/ipv6/uiplib.h"
+#include "os/sys/log.h"
+
+#include <stdlib.h>
+#include <string.h>
+/*-------------------------------------------------------------------------------------------------------------------*/
+void coap_endpoint_copy(coap_endpoint_t* dest, const coap_endpoint_t* src)
+{
+    memcpy(dest, src, sizeof(*dest));
+}
+/*-------------------------------------------------------------------------------------------------------------------*/
+int coap_endpoint_cmp(const coap_endpoint_t* e1, const coap_endpoint_t* e2)
+{
+    return uip_ipaddr_cmp(&e1->ipaddr, &e2->ipaddr) &&
+           e1->port == e2->port &&
+           e1->secure == e2->secure;
+}
+/*-------------------------------------------------------------------------------------------------------------------*/
+int coap_endpoint_parse(const char* text, size_t size, coap_endpoint_t* ep)
+{
+    static const char scheme[] = "coap://";
+    static const char secure_scheme[] = "coaps://";
+
+    memset(ep, 0, sizeof(*ep));
+
+    size_t start = 0;
+    if (size >= sizeof(secure_scheme) - 1 && strncmp(text, secure_scheme, sizeof(secure_scheme) - 1) == 0)
+    {
+        ep->secure = 1;
+        start = sizeof(secure_scheme) - 1;
+    }
+    else if (size >= sizeof(scheme) - 1 && strncmp(text, scheme, sizeof(scheme) - 1) == 0)
+    {
+        start = sizeof(scheme) - 1;
+    }
+
+    if (start >= size || text[start] != '[')
+    {
+        return 0;
+    }
+
+    const char* end = memchr(text + start, ']', size - start);
+    if (end == NULL)
+    {
+        return 0;
+    }
+
+    char addrstr[64];
+    const size_t addr_len = (size_t)(end - (text + start + 1));
+    if (addr_len >= sizeof(addrstr))
+    {
+        return 0;
+    }
+
+    memcpy(addrstr, text + start + 1, addr_len);
+    addrstr[addr_len] = '\0';
+
+    if (!uiplib_ip6addrconv(addrstr, &ep->ipaddr))
+    {
+        return 0;
+    }
+
+    ep->port = ep->secure ? COAP_DEFAULT_SECURE_PORT : COAP_DEFAULT_PORT;
+
+    const size_t port_start = (size_t)(end - text) + 1;
+    if (port_start < size && text[port_start] == ':')
+    {
+        ep->port = (uint16_t)strtoul(text + port_start + 1, NULL, 10);
+    }
+
+    return 1;
+}
+/*-------------------------------------------------------------------------------------------------------------------*/
+int coap_endpoint_is_connected(const coap_endpoint_t* ep)
+{
+    (void)ep;
+    return 1;
+}
+/*-------------------------------------------------------------------------------------------------------------------*/
+int coap_endpoint_connect(coap_endpoint_t* ep)
+{
+    (void)ep;
+    return 1;
+}
+/*-------------------------------------------------------------------------------------------------------------------*/
+void coap_endpoint_disconnect(coap_endpoint_t* ep)
+{
+    (void)ep;
+}
+/*-------------------------------------------------------------------------------------------------------------------*/
+void coap_endpoint_log(const coap_endpoint_t* ep)
+{
+    if (ep == NULL)
+    {
+        LOG_OUTPUT("(NULL EP)");
+        return;
+    }
+
+    LOG_OUTPUT("coap%s://[", ep->secure ? "s" : "");
+    log_6addr(&ep->ipaddr);
+    LOG_OUTPUT("]:%u", ep->port);
+}
+/*-------------------------------------------------------------------------------------------------------------------*/
@@ -0,0 +1,30 @@
+#pragma once
+/*-------------------------------------------------------------------------------------------------------------------*/
+#include <stdint.h>
+#include <stddef.h>
+#include <stdbool.h>
+
+#include "net/ipv6/uip.h"
+/*-------------------------------------------------------------------------------------------------------------------*/
+#define COAP_DEFAULT_PORT 5683
+#define COAP_DEFAULT_SECURE_PORT 5684
+/*-------------------------------------------------------------------------------------------------------------------*/
+typedef struct {
+    uip_ipaddr_t ipaddr;
+    uint16_t port;
+    uint8_t secure;
+} coap_endpoint_t;
+/*-------------------------------------------------------------------------------------------------------------------*/
+void coap_endpoint_copy(coap_endpoint_t* dest, const coap_endpoint_t* src);
+int coap_endpoint_cmp(const coap_endpoint_t* e1, const coap_endpoint_t* e2);
+/*-------------------------------------------------------------------------------------------------------------------*/
+// Parses endpoints of the form coap[s]://[address][:port]
+int coap_endpoint_parse(const char* text, size_t size, coap_endpoint_t* ep);
+/*-------------------------------------------------------------------------------------------------------------------*/
+// There is no network on the host, so endpoints are always connected
+int coap_endpoint_is_connected(const coap_endpoint_t* ep);
+int coap_endpoint_connect(coap_endpoint_t* ep);
+void coap_endpoint_disconnect(coap_endpoint_t* ep);
+/*-------------------------------------------------------------------------------------------------------------------*/
+void coap_endpoint_log(const coap_endpoint_t* ep);
+/*-------------------------------------------------------------------------------------------------------------------*/
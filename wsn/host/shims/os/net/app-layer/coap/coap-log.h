@@ -0,0 +1,29 @@
+#pragma once
+/*-------------------------------------------------------------------------------------------------------------------*/
+#include "os/sys/log.h"
+#include "coap-endpoint.h"
+/*-------------------------------------------------------------------------------------------------------------------*/
+#define LOG_COAP_EP(level, endpoint) \
+    do { \
+        if ((level) <= (LOG_LEVEL)) { \
+            coap_endpoint_log(endpoint); \
+        } \
+    } while (0)
+
+#define LOG_COAP_STRING(level, text, len) \
+    do { \
+        if ((level) <= (LOG_LEVEL)) { \
+            LOG_OUTPUT("%.*s", (int)(len), (const char*)(text)); \
+        } \
+    } while (0)
+/*-------------------------------------------------------------------------------------------------------------------*/
+#define LOG_ERR_COAP_EP(endpoint)  LOG_COAP_EP(LOG_LEVEL_ERR, endpoint)
+#define LOG_WARN_COAP_EP(endpoint) LOG_COAP_EP(LOG_LEVEL_WARN, endpoint)
+#define LOG_INFO_COAP_EP(endpoint) LOG_COAP_EP(LOG_LEVEL_INFO, endpoint)
+#define LOG_DBG_COAP_EP(endpoint)  LOG_COAP_EP(LOG_LEVEL_DBG, endpoint)
+
+#define LOG_ERR_COAP_STRING(text, len)  LOG_COAP_STRING(LOG_LEVEL_ERR, text, len)
+#define LOG_WARN_COAP_STRING(text, len) LOG_COAP_STRING(LOG_LEVEL_WARN, text, len)
+#define LOG_INFO_COAP_STRING(text, len) LOG_COAP_STRING(LOG_LEVEL_INFO, text, len)
+#define LOG_DBG_COAP_STRING(text, len)  LOG_COAP_STRING(LOG_LEVEL_DBG, text, len)
+/*-------------------------------------------------------------------------------------------------------------------*/
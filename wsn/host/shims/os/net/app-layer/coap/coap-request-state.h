@@ -0,0 +1,26 @@
+#pragma once
+/*-------------------------------------------------------------------------------------------------------------------*/
+#include "coap.h"
+/*-------------------------------------------------------------------------------------------------------------------*/
+typedef enum {
+    COAP_REQUEST_STATUS_RESPONSE,
+    COAP_REQUEST_STATUS_MORE,
+    COAP_REQUEST_STATUS_FINISHED,
+    COAP_REQUEST_STATUS_TIMEOUT,
+    COAP_REQUEST_STATUS_BLOCK_ERROR
+} coap_request_status_t;
+/*-------------------------------------------------------------------------------------------------------------------*/
+typedef struct coap_request_state {
+    coap_message_t* request;
+    coap_message_t* response;
+    coap_endpoint_t* remote_endpoint;
+    uint32_t block_num;
+    uint32_t res_block;
+    uint8_t more;
+    uint8_t block_error;
+    void* user_data;
+    coap_request_status_t status;
+} coap_request_state_t;
+/*-------------------------------------------------------------------------------------------------------------------*/
+const char* coap_request_status_to_string(coap_request_status_t status);
+/*-------------------------------------------------------------------------------------------------------------------*/
@@ -0,0 +1,99 @@
+#include "coap.h"
+#include "lib/random.h"
+
+#include <string.h>
+/*-------------------------------------------------------------------------------------------------------------------*/
+void coap_init_message(coap_message_t* message, coap_message_type_t type, uint8_t code, uint16_t mid)
+{
+    memset(message, 0, sizeof(*message));
+
+    message->type = type;
+    message->code = code;
+    message->mid = mid;
+}
+/*-------------------------------------------------------------------------------------------------------------------*/
+int coap_set_token(coap_message_t* message, const uint8_t* token, size_t token_len)
+{
+    message->token_len = (uint8_t)(token_len < COAP_TOKEN_LEN ? token_len : COAP_TOKEN_LEN);
+    memcpy(message->token, token, message->token_len);
+
+    return message->token_len;
+}
+/*-------------------------------------------------------------------------------------------------------------------*/
+void coap_set_random_token(coap_message_t* message)
+{
+    for (uint8_t i = 0; i < COAP_TOKEN_LEN; ++i)
+    {
+        message->token[i] = (uint8_t)random_rand();
+    }
+    message->token_len = COAP_TOKEN_LEN;
+}
+/*-------------------------------------------------------------------------------------------------------------------*/
+int coap_set_header_uri_path(coap_message_t* message, const char* path)
+{
+    while (path[0] == '/')
+    {
+        ++path;
+    }
+
+    message->uri_path = path;
+    message->uri_path_len = strlen(path);
+
+    return (int)message->uri_path_len;
+}
+/*-------------------------------------------------------------------------------------------------------------------*/
+int coap_get_header_uri_path(coap_message_t* message, const char** path)
+{
+    if (message->uri_path == NULL)
+    {
+        return 0;
+    }
+
+    *path = message->uri_path;
+    return (int)message->uri_path_len;
+}
+/*-------------------------------------------------------------------------------------------------------------------*/
+int coap_set_header_content_format(coap_message_t* message, unsigned int format)
+{
+    message->content_format = format;
+    return 1;
+}
+/*-------------------------------------------------------------------------------------------------------------------*/
+int coap_get_header_content_format(coap_message_t* message, unsigned int* format)
+{
+    *format = message->content_format;
+    return 1;
+}
+/*-------------------------------------------------------------------------------------------------------------------*/
+int coap_set_header_max_age(coap_message_t* message, uint32_t age)
+{
+    message->max_age = age;
+    return 1;
+}
+/*-------------------------------------------------------------------------------------------------------------------*/
+int coap_get_header_max_age(coap_message_t* message, uint32_t* age)
+{
+    *age = message->max_age;
+    return 1;
+}
+/*-------------------------------------------------------------------------------------------------------------------*/
+int coap_set_payload(coap_message_t* message, const void* payload, size_t length)
+{
+    message->payload = (const uint8_t*)payload;
+    message->payload_len = (uint16_t)length;
+
+    return message->payload_len;
+}
+/*-------------------------------------------------------------------------------------------------------------------*/
+int coap_get_payload(coap_message_t* message, const uint8_t** payload)
+{
+    *payload = message->payload;
+    return message->payload_len;
+}
+/*-------------------------------------------------------------------------------------------------------------------*/
+int coap_set_status_code(coap_message_t* message, unsigned int code)
+{
+    message->code = (uint8_t)code;
+    return 1;
+}
+/*-------------------------------------------------------------------------------------------------------------------*/
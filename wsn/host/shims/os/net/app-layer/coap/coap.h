@@ -0,0 +1,57 @@
+#pragma once
+/*-------------------------------------------------------------------------------------------------------------------*/
+// Host stand-in for the CoAP message API. Messages are built in memory but never sent.
+/*-------------------------------------------------------------------------------------------------------------------*/
+#include <stdint.h>
+#include <stddef.h>
+
+#include "contiki.h"
+#include "coap-constants.h"
+#include "coap-endpoint.h"
+/*-------------------------------------------------------------------------------------------------------------------*/
+#ifndef COAP_TOKEN_LEN
+#define COAP_TOKEN_LEN 8
+#endif
+
+#define COAP_MAX_AGE 60
+/*-------------------------------------------------------------------------------------------------------------------*/
+typedef struct {
+    const coap_endpoint_t* src_ep;
+
+    uint8_t type;
+    uint8_t code;
+    uint16_t mid;
+
+    uint8_t token_len;
+    uint8_t token[COAP_TOKEN_LEN];
+
+    unsigned int content_format;
+    uint32_t max_age;
+
+    const char* uri_path;
+    size_t uri_path_len;
+
+    const uint8_t* payload;
+    uint16_t payload_len;
+
+} coap_message_t;
+/*-------------------------------------------------------------------------------------------------------------------*/
+void coap_init_message(coap_message_t* message, coap_message_type_t type, uint8_t code, uint16_t mid);
+/*-------------------------------------------------------------------------------------------------------------------*/
+int coap_set_token(coap_message_t* message, const uint8_t* token, size_t token_len);
+void coap_set_random_token(coap_message_t* message);
+/*-------------------------------------------------------------------------------------------------------------------*/
+int coap_set_header_uri_path(coap_message_t* message, const char* path);
+int coap_get_header_uri_path(coap_message_t* message, const char** path);
+/*-------------------------------------------------------------------------------------------------------------------*/
+int coap_set_header_content_format(coap_message_t* message, unsigned int format);
+int coap_get_header_content_format(coap_message_t* message, unsigned int* format);
+/*-------------------------------------------------------------------------------------------------------------------*/
+int coap_set_header_max_age(coap_message_t* message, uint32_t age);
+int coap_get_header_max_age(coap_message_t* message, uint32_t* age);
+/*-------------------------------------------------------------------------------------------------------------------*/
+int coap_set_payload(coap_message_t* message, const void* payload, size_t length);
+int coap_get_payload(coap_message_t* message, const uint8_t** payload);
+/*-------------------------------------------------------------------------------------------------------------------*/
+int coap_set_status_code(coap_message_t* message, unsigned int code);
+/*-------------------------------------------------------------------------------------------------------------------*/
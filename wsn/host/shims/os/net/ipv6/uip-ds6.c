@@ -0,0 +1,37 @@
+#include "net/ipv6/uip-ds6.h"
+/*-------------------------------------------------------------------------------------------------------------------*/
+uip_ds6_netif_t uip_ds6_if;
+/*-------------------------------------------------------------------------------------------------------------------*/
+uip_ds6_addr_t* uip_ds6_addr_add(uip_ipaddr_t* ipaddr, unsigned long vlifetime, uint8_t type)
+{
+    (void)vlifetime;
+    (void)type;
+
+    for (int i = 0; i < UIP_DS6_ADDR_NB; ++i)
+    {
+        uip_ds6_addr_t* addr = &uip_ds6_if.addr_list[i];
+        if (!addr->isused)
+        {
+            addr->isused = 1;
+            uip_ipaddr_copy(&addr->ipaddr, ipaddr);
+            addr->state = ADDR_PREFERRED;
+            return addr;
+        }
+    }
+
+    return NULL;
+}
+/*-------------------------------------------------------------------------------------------------------------------*/
+// The interface identifier is the link-layer address with the universal/local bit inverted (RFC 4291)
+void uip_ds6_set_addr_iid(uip_ipaddr_t* ipaddr, const uip_lladdr_t* lladdr)
+{
+    memcpy(ipaddr->u8 + 8, lladdr, sizeof(*lladdr));
+    ipaddr->u8[8] ^= 0x02;
+}
+/*-------------------------------------------------------------------------------------------------------------------*/
+void uip_ds6_set_lladdr_from_iid(uip_lladdr_t* lladdr, const uip_ipaddr_t* ipaddr)
+{
+    memcpy(lladdr, ipaddr->u8 + 8, sizeof(*lladdr));
+    lladdr->addr[0] ^= 0x02;
+}
+/*-------------------------------------------------------------------------------------------------------------------*/
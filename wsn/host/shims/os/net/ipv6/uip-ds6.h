@@ -0,0 +1,25 @@
+#pragma once
+/*-------------------------------------------------------------------------------------------------------------------*/
+#include "net/ipv6/uip.h"
+/*-------------------------------------------------------------------------------------------------------------------*/
+#define ADDR_TENTATIVE 0
+#define ADDR_PREFERRED 1
+#define ADDR_DEPRECATED 2
+/*-------------------------------------------------------------------------------------------------------------------*/
+typedef struct uip_ds6_addr {
+    uint8_t isused;
+    uip_ipaddr_t ipaddr;
+    uint8_t state;
+} uip_ds6_addr_t;
+
+typedef struct uip_ds6_netif {
+    uip_ds6_addr_t addr_list[UIP_DS6_ADDR_NB];
+} uip_ds6_netif_t;
+/*-------------------------------------------------------------------------------------------------------------------*/
+extern uip_ds6_netif_t uip_ds6_if;
+/*-------------------------------------------------------------------------------------------------------------------*/
+uip_ds6_addr_t* uip_ds6_addr_add(uip_ipaddr_t* ipaddr, unsigned long vlifetime, uint8_t type);
+/*-------------------------------------------------------------------------------------------------------------------*/
+void uip_ds6_set_addr_iid(uip_ipaddr_t* ipaddr, const uip_lladdr_t* lladdr);
+void uip_ds6_set_lladdr_from_iid(uip_lladdr_t* lladdr, const uip_ipaddr_t* ipaddr);
+/*-------------------------------------------------------------------------------------------------------------------*/
@@ -0,0 +1,54 @@
+#pragma once
+/*-------------------------------------------------------------------------------------------------------------------*/
+// Host stand-in for the parts of uIP's address handling used by the trust core
+/*-------------------------------------------------------------------------------------------------------------------*/
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+
+#include "contiki.h"
+#include "net/ipv6/uipopt.h"
+/*-------------------------------------------------------------------------------------------------------------------*/
+typedef union uip_ip6addr_t {
+    uint8_t u8[16];
+    uint16_t u16[8];
+} uip_ip6addr_t;
+
+typedef uip_ip6addr_t uip_ipaddr_t;
+/*-------------------------------------------------------------------------------------------------------------------*/
+typedef struct uip_802154_longaddr {
+    uint8_t addr[8];
+} uip_lladdr_t;
+/*-------------------------------------------------------------------------------------------------------------------*/
+#if UIP_BYTE_ORDER == UIP_BIG_ENDIAN
+#define UIP_HTONS(n) (n)
+#define UIP_HTONL(n) (n)
+#else
+#define UIP_HTONS(n) (uint16_t)((((uint16_t)(n)) << 8) | (((uint16_t)(n)) >> 8))
+#define UIP_HTONL(n) (((uint32_t)UIP_HTONS(n) << 16) | UIP_HTONS((uint32_t)(n) >> 16))
+#endif
+
+#define uip_htons(n) UIP_HTONS(n)
+#define uip_ntohs(n) UIP_HTONS(n)
+/*-------------------------------------------------------------------------------------------------------------------*/
+#define uip_ip6addr(addr, addr0, addr1, addr2, addr3, addr4, addr5, addr6, addr7) \
+    do { \
+        (addr)->u16[0] = UIP_HTONS(addr0); \
+        (addr)->u16[1] = UIP_HTONS(addr1); \
+        (addr)->u16[2] = UIP_HTONS(addr2); \
+        (addr)->u16[3] = UIP_HTONS(addr3); \
+        (addr)->u16[4] = UIP_HTONS(addr4); \
+        (addr)->u16[5] = UIP_HTONS(addr5); \
+        (addr)->u16[6] = UIP_HTONS(addr6); \
+        (addr)->u16[7] = UIP_HTONS(addr7); \
+    } while (0)
+
+#define uip_ipaddr_copy(dest, src) (*((uip_ipaddr_t*)(dest)) = *((const uip_ipaddr_t*)(src)))
+#define uip_ip6addr_copy(dest, src) uip_ipaddr_copy(dest, src)
+
+#define uip_ipaddr_cmp(addr1, addr2) (memcmp(addr1, addr2, sizeof(uip_ip6addr_t)) == 0)
+#define uip_ip6addr_cmp(addr1, addr2) uip_ipaddr_cmp(addr1, addr2)
+
+#define uip_is_addr_mcast(a) (((a)->u8[0]) == 0xFF)
+#define uip_is_addr_linklocal(a) ((a)->u8[0] == 0xFE && (a)->u8[1] == 0x80)
+/*-------------------------------------------------------------------------------------------------------------------*/
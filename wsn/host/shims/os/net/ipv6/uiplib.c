@@ -0,0 +1,15 @@
+#include "net/ipv6/uiplib.h"
+#include "os/sys/log.h"
+
+#include <arpa/inet.h>
+/*-------------------------------------------------------------------------------------------------------------------*/
+int uiplib_ip6addrconv(const char* addrstr, uip_ip6addr_t* addr)
+{
+    return inet_pton(AF_INET6, addrstr, addr) == 1;
+}
+/*-------------------------------------------------------------------------------------------------------------------*/
+void uiplib_ipaddr_print(const uip_ipaddr_t* addr)
+{
+    log_6addr(addr);
+}
+/*-------------------------------------------------------------------------------------------------------------------*/
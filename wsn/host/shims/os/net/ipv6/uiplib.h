@@ -0,0 +1,9 @@
+#pragma once
+/*-------------------------------------------------------------------------------------------------------------------*/
+#include "net/ipv6/uip.h"
+/*-------------------------------------------------------------------------------------------------------------------*/
+int uiplib_ip6addrconv(const char* addrstr, uip_ip6addr_t* addr);
+#define uiplib_ipaddrconv uiplib_ip6addrconv
+
+void uiplib_ipaddr_print(const uip_ipaddr_t* addr);
+/*-------------------------------------------------------------------------------------------------------------------*/
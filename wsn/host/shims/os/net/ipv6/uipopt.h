@@ -0,0 +1,13 @@
+#pragma once
+/*-------------------------------------------------------------------------------------------------------------------*/
+#define UIP_LITTLE_ENDIAN 3412
+#define UIP_BIG_ENDIAN    1234
+
+#if __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__
+#define UIP_BYTE_ORDER UIP_LITTLE_ENDIAN
+#else
+#define UIP_BYTE_ORDER UIP_BIG_ENDIAN
+#endif
+/*-------------------------------------------------------------------------------------------------------------------*/
+#define UIP_DS6_ADDR_NB 3
+/*-------------------------------------------------------------------------------------------------------------------*/
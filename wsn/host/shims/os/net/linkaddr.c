@@ -0,0 +1,22 @@
+#include "net/linkaddr.h"
+
+#include <string.h>
+/*-------------------------------------------------------------------------------------------------------------------*/
+linkaddr_t linkaddr_node_addr;
+const linkaddr_t linkaddr_null = { { 0 } };
+/*-------------------------------------------------------------------------------------------------------------------*/
+void linkaddr_copy(linkaddr_t* dest, const linkaddr_t* src)
+{
+    memcpy(dest, src, LINKADDR_SIZE);
+}
+/*-------------------------------------------------------------------------------------------------------------------*/
+bool linkaddr_cmp(const linkaddr_t* addr1, const linkaddr_t* addr2)
+{
+    return memcmp(addr1, addr2, LINKADDR_SIZE) == 0;
+}
+/*-------------------------------------------------------------------------------------------------------------------*/
+void linkaddr_set_node_addr(const linkaddr_t* addr)
+{
+    linkaddr_copy(&linkaddr_node_addr, addr);
+}
+/*-------------------------------------------------------------------------------------------------------------------*/
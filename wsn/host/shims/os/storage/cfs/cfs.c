@@ -0,0 +1,55 @@
+#include "cfs/cfs.h"
+
+#include <fcntl.h>
+#include <stdio.h>
+#include <unistd.h>
+/*-------------------------------------------------------------------------------------------------------------------*/
+// Files are kept in the working directory, as with Contiki-NG's POSIX CFS on the native target
+/*-------------------------------------------------------------------------------------------------------------------*/
+int cfs_open(const char* name, int flags)
+{
+    int oflags = 0;
+
+    if ((flags & (CFS_READ | CFS_WRITE)) == (CFS_READ | CFS_WRITE))
+    {
+        oflags = O_RDWR | O_CREAT;
+    }
+    else if (flags & CFS_WRITE)
+    {
+        oflags = O_WRONLY | O_CREAT | ((flags & CFS_APPEND) ? O_APPEND : O_TRUNC);
+    }
+    else
+    {
+        oflags = O_RDONLY;
+    }
+
+    return open(name, oflags, 0600);
+}
+/*-------------------------------------------------------------------------------------------------------------------*/
+void cfs_close(int fd)
+{
+    close(fd);
+}
+/*-------------------------------------------------------------------------------------------------------------------*/
+int cfs_read(int fd, void* buf, unsigned int len)
+{
+    return (int)read(fd, buf, len);
+}
+/*-------------------------------------------------------------------------------------------------------------------*/
+int cfs_write(int fd, const void* buf, unsigned int len)
+{
+    return (int)write(fd, buf, len);
+}
+/*-------------------------------------------------------------------------------------------------------------------*/
+cfs_offset_t cfs_seek(int fd, cfs_offset_t offset, int whence)
+{
+    const int posix_whence = whence == CFS_SEEK_CUR ? SEEK_CUR : whence == CFS_SEEK_END ? SEEK_END : SEEK_SET;
+
+    return (cfs_offset_t)lseek(fd, offset, posix_whence);
+}
+/*-------------------------------------------------------------------------------------------------------------------*/
+int cfs_remove(const char* name)
+{
+    return unlink(name);
+}
+/*-------------------------------------------------------------------------------------------------------------------*/
@@ -0,0 +1,21 @@
+#pragma once
+/*-------------------------------------------------------------------------------------------------------------------*/
+#define CC_INLINE inline
+#define CC_ALIGN(n) __attribute__((__aligned__(n)))
+
+#define CC_CONCAT2(s1, s2) s1##s2
+#define CC_CONCAT(s1, s2) CC_CONCAT2(s1, s2)
+
+#define CC_STRINGIFY2(x) #x
+#define CC_STRINGIFY(x) CC_STRINGIFY2(x)
+
+#define CC_ARRAY_SIZE(a) (sizeof(a) / sizeof((a)[0]))
+/*-------------------------------------------------------------------------------------------------------------------*/
+#ifndef MAX
+#define MAX(n, m) (((n) < (m)) ? (m) : (n))
+#endif
+
+#ifndef MIN
+#define MIN(n, m) (((n) < (m)) ? (n) : (m))
+#endif
+/*-------------------------------------------------------------------------------------------------------------------*/
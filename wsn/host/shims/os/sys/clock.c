@@ -0,0 +1,35 @@
+#include "sys/clock.h"
+#include "sys/rtimer.h"
+
+#include <time.h>
+/*-------------------------------------------------------------------------------------------------------------------*/
+static struct timespec start;
+/*-------------------------------------------------------------------------------------------------------------------*/
+void clock_init(void)
+{
+    clock_gettime(CLOCK_MONOTONIC, &start);
+}
+/*-------------------------------------------------------------------------------------------------------------------*/
+clock_time_t clock_time(void)
+{
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+
+    return (clock_time_t)(now.tv_sec - start.tv_sec) * CLOCK_SECOND +
+           (clock_time_t)(now.tv_nsec / (1000000000L / CLOCK_SECOND)) -
+           (clock_time_t)(start.tv_nsec / (1000000000L / CLOCK_SECOND));
+}
+/*-------------------------------------------------------------------------------------------------------------------*/
+unsigned long clock_seconds(void)
+{
+    return clock_time() / CLOCK_SECOND;
+}
+/*-------------------------------------------------------------------------------------------------------------------*/
+rtimer_clock_t rtimer_arch_now(void)
+{
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+
+    return (rtimer_clock_t)((now.tv_sec - start.tv_sec) * 1000000L + (now.tv_nsec - start.tv_nsec) / 1000L);
+}
+/*-------------------------------------------------------------------------------------------------------------------*/
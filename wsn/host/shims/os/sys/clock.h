@@ -0,0 +1,15 @@
+#pragma once
+/*-------------------------------------------------------------------------------------------------------------------*/
+#include <stdint.h>
+/*-------------------------------------------------------------------------------------------------------------------*/
+// Matches the native Contiki-NG platform
+typedef unsigned long clock_time_t;
+
+#define CLOCK_SECOND ((clock_time_t)1000)
+/*-------------------------------------------------------------------------------------------------------------------*/
+void clock_init(void);
+/*-------------------------------------------------------------------------------------------------------------------*/
+// Monotonic time since clock_init, read from the host
+clock_time_t clock_time(void);
+unsigned long clock_seconds(void);
+/*-------------------------------------------------------------------------------------------------------------------*/
@@ -0,0 +1,31 @@
+#include "sys/ctimer.h"
+/*-------------------------------------------------------------------------------------------------------------------*/
+void ctimer_set(struct ctimer* c, clock_time_t t, void (*f)(void*), void* ptr)
+{
+    c->start = clock_time();
+    c->interval = t;
+    c->f = f;
+    c->ptr = ptr;
+    c->p = PROCESS_CURRENT();
+}
+/*-------------------------------------------------------------------------------------------------------------------*/
+void ctimer_reset(struct ctimer* c)
+{
+    c->start += c->interval;
+}
+/*-------------------------------------------------------------------------------------------------------------------*/
+void ctimer_restart(struct ctimer* c)
+{
+    c->start = clock_time();
+}
+/*-------------------------------------------------------------------------------------------------------------------*/
+void ctimer_stop(struct ctimer* c)
+{
+    c->f = NULL;
+}
+/*-------------------------------------------------------------------------------------------------------------------*/
+int ctimer_expired(struct ctimer* c)
+{
+    return c->f == NULL || clock_time() - c->start >= c->interval;
+}
+/*-------------------------------------------------------------------------------------------------------------------*/
@@ -0,0 +1,20 @@
+#pragma once
+/*-------------------------------------------------------------------------------------------------------------------*/
+#include "sys/clock.h"
+#include "sys/process.h"
+/*-------------------------------------------------------------------------------------------------------------------*/
+// Callback timers are recorded but their callbacks are never invoked on the host
+struct ctimer {
+    clock_time_t start;
+    clock_time_t interval;
+    void (*f)(void*);
+    void* ptr;
+    struct process* p;
+};
+/*-------------------------------------------------------------------------------------------------------------------*/
+void ctimer_set(struct ctimer* c, clock_time_t t, void (*f)(void*), void* ptr);
+void ctimer_reset(struct ctimer* c);
+void ctimer_restart(struct ctimer* c);
+void ctimer_stop(struct ctimer* c);
+int ctimer_expired(struct ctimer* c);
+/*-------------------------------------------------------------------------------------------------------------------*/
@@ -0,0 +1,29 @@
+#include "sys/etimer.h"
+/*-------------------------------------------------------------------------------------------------------------------*/
+void etimer_set(struct etimer* et, clock_time_t interval)
+{
+    et->start = clock_time();
+    et->interval = interval;
+    et->p = PROCESS_CURRENT();
+}
+/*-------------------------------------------------------------------------------------------------------------------*/
+void etimer_reset(struct etimer* et)
+{
+    et->start += et->interval;
+}
+/*-------------------------------------------------------------------------------------------------------------------*/
+void etimer_restart(struct etimer* et)
+{
+    et->start = clock_time();
+}
+/*-------------------------------------------------------------------------------------------------------------------*/
+void etimer_stop(struct etimer* et)
+{
+    et->p = NULL;
+}
+/*-------------------------------------------------------------------------------------------------------------------*/
+int etimer_expired(struct etimer* et)
+{
+    return et->p == NULL || clock_time() - et->start >= et->interval;
+}
+/*-------------------------------------------------------------------------------------------------------------------*/
@@ -0,0 +1,19 @@
+#pragma once
+/*-------------------------------------------------------------------------------------------------------------------*/
+#include "sys/clock.h"
+#include "sys/process.h"
+/*-------------------------------------------------------------------------------------------------------------------*/
+// Timers are tracked but never expire on their own on the host, as there is no main loop to post
+// PROCESS_EVENT_TIMER. Callers that need expiry check etimer_expired themselves.
+struct etimer {
+    clock_time_t start;
+    clock_time_t interval;
+    struct process* p;
+};
+/*-------------------------------------------------------------------------------------------------------------------*/
+void etimer_set(struct etimer* et, clock_time_t interval);
+void etimer_reset(struct etimer* et);
+void etimer_restart(struct etimer* et);
+void etimer_stop(struct etimer* et);
+int etimer_expired(struct etimer* et);
+/*-------------------------------------------------------------------------------------------------------------------*/
@@ -0,0 +1,34 @@
+#include "sys/log.h"
+/*-------------------------------------------------------------------------------------------------------------------*/
+void log_6addr(const void* ipaddr)
+{
+    const uint8_t* addr = (const uint8_t*)ipaddr;
+
+    if (addr == NULL)
+    {
+        LOG_OUTPUT("(NULL IP addr)");
+        return;
+    }
+
+    for (int i = 0; i < 16; i += 2)
+    {
+        LOG_OUTPUT("%s%x", i == 0 ? "" : ":", (addr[i] << 8) | addr[i + 1]);
+    }
+}
+/*-------------------------------------------------------------------------------------------------------------------*/
+void log_bytes(const void* data, size_t length)
+{
+    const uint8_t* u8data = (const uint8_t*)data;
+
+    if (u8data == NULL)
+    {
+        LOG_OUTPUT("(null)");
+        return;
+    }
+
+    for (size_t i = 0; i < length; ++i)
+    {
+        LOG_OUTPUT("%02x", u8data[i]);
+    }
+}
+/*-------------------------------------------------------------------------------------------------------------------*/
@@ -0,0 +1,70 @@
+#pragma once
+/*-------------------------------------------------------------------------------------------------------------------*/
+// Host stand-in for Contiki-NG's logging, written to stdout with the same prefixes
+/*-------------------------------------------------------------------------------------------------------------------*/
+#include <stdio.h>
+#include <stddef.h>
+#include <stdint.h>
+/*-------------------------------------------------------------------------------------------------------------------*/
+#define LOG_LEVEL_NONE 0
+#define LOG_LEVEL_ERR  1
+#define LOG_LEVEL_WARN 2
+#define LOG_LEVEL_INFO 3
+#define LOG_LEVEL_DBG  4
+/*-------------------------------------------------------------------------------------------------------------------*/
+#define LOG_OUTPUT(...) printf(__VA_ARGS__)
+
+#define LOG(newline, level, levelstr, ...) \
+    do { \
+        if ((level) <= (LOG_LEVEL)) { \
+            if (newline) { \
+                LOG_OUTPUT("[%-4s: %-10s] ", levelstr, LOG_MODULE); \
+            } \
+            LOG_OUTPUT(__VA_ARGS__); \
+        } \
+    } while (0)
+
+#define LOG_6ADDR(level, ipaddr) \
+    do { \
+        if ((level) <= (LOG_LEVEL)) { \
+            log_6addr(ipaddr); \
+        } \
+    } while (0)
+
+#define LOG_BYTES(level, data, length) \
+    do { \
+        if ((level) <= (LOG_LEVEL)) { \
+            log_bytes(data, length); \
+        } \
+    } while (0)
+/*-------------------------------------------------------------------------------------------------------------------*/
+#define LOG_PRINT(...)   LOG(1, 0, "PRI", __VA_ARGS__)
+#define LOG_ERR(...)     LOG(1, LOG_LEVEL_ERR, "ERR", __VA_ARGS__)
+#define LOG_WARN(...)    LOG(1, LOG_LEVEL_WARN, "WARN", __VA_ARGS__)
+#define LOG_INFO(...)    LOG(1, LOG_LEVEL_INFO, "INFO", __VA_ARGS__)
+#define LOG_DBG(...)     LOG(1, LOG_LEVEL_DBG, "DBG", __VA_ARGS__)
+
+#define LOG_PRINT_(...)  LOG(0, 0, "PRI", __VA_ARGS__)
+#define LOG_ERR_(...)    LOG(0, LOG_LEVEL_ERR, "ERR", __VA_ARGS__)
+#define LOG_WARN_(...)   LOG(0, LOG_LEVEL_WARN, "WARN", __VA_ARGS__)
+#define LOG_INFO_(...)   LOG(0, LOG_LEVEL_INFO, "INFO", __VA_ARGS__)
+#define LOG_DBG_(...)    LOG(0, LOG_LEVEL_DBG, "DBG", __VA_ARGS__)
+
+#define LOG_ERR_6ADDR(ipaddr)  LOG_6ADDR(LOG_LEVEL_ERR, ipaddr)
+#define LOG_WARN_6ADDR(ipaddr) LOG_6ADDR(LOG_LEVEL_WARN, ipaddr)
+#define LOG_INFO_6ADDR(ipaddr) LOG_6ADDR(LOG_LEVEL_INFO, ipaddr)
+#define LOG_DBG_6ADDR(ipaddr)  LOG_6ADDR(LOG_LEVEL_DBG, ipaddr)
+
+#define LOG_ERR_BYTES(data, length)  LOG_BYTES(LOG_LEVEL_ERR, data, length)
+#define LOG_WARN_BYTES(data, length) LOG_BYTES(LOG_LEVEL_WARN, data, length)
+#define LOG_INFO_BYTES(data, length) LOG_BYTES(LOG_LEVEL_INFO, data, length)
+#define LOG_DBG_BYTES(data, length)  LOG_BYTES(LOG_LEVEL_DBG, data, length)
+
+#define LOG_ERR_ENABLED  ((LOG_LEVEL) >= LOG_LEVEL_ERR)
+#define LOG_WARN_ENABLED ((LOG_LEVEL) >= LOG_LEVEL_WARN)
+#define LOG_INFO_ENABLED ((LOG_LEVEL) >= LOG_LEVEL_INFO)
+#define LOG_DBG_ENABLED  ((LOG_LEVEL) >= LOG_LEVEL_DBG)
+/*-------------------------------------------------------------------------------------------------------------------*/
+void log_6addr(const void* ipaddr);
+void log_bytes(const void* data, size_t length);
+/*-------------------------------------------------------------------------------------------------------------------*/
@@ -0,0 +1,169 @@
+#include "sys/process.h"
+
+#include <stdbool.h>
+#include <stddef.h>
+/*-------------------------------------------------------------------------------------------------------------------*/
+#ifndef PROCESS_CONF_NUMEVENTS
+#define PROCESS_CONF_NUMEVENTS 32
+#endif
+/*-------------------------------------------------------------------------------------------------------------------*/
+enum {
+    PROCESS_STATE_NONE = 0,
+    PROCESS_STATE_RUNNING,
+    PROCESS_STATE_CALLED,
+};
+/*-------------------------------------------------------------------------------------------------------------------*/
+struct process* process_list = NULL;
+struct process* process_current = NULL;
+
+static process_event_t lastevent = PROCESS_EVENT_MAX;
+/*-------------------------------------------------------------------------------------------------------------------*/
+// Events posted asynchronously, delivered by process_run
+static struct {
+    struct process* p;
+    process_event_t ev;
+    process_data_t data;
+} events[PROCESS_CONF_NUMEVENTS];
+
+static unsigned int nevents, fevent;
+static bool poll_requested;
+/*-------------------------------------------------------------------------------------------------------------------*/
+process_event_t process_alloc_event(void)
+{
+    return lastevent++;
+}
+/*-------------------------------------------------------------------------------------------------------------------*/
+static void call_process(struct process* p, process_event_t ev, process_data_t data)
+{
+    if (p->state != PROCESS_STATE_RUNNING || p->thread == NULL)
+    {
+        return;
+    }
+
+    struct process* caller = process_current;
+
+    process_current = p;
+    p->state = PROCESS_STATE_CALLED;
+
+    const int ret = p->thread(&p->pt, ev, data);
+    if (ret == PT_EXITED || ret == PT_ENDED || ev == PROCESS_EVENT_EXIT)
+    {
+        process_exit(p);
+    }
+    else
+    {
+        p->state = PROCESS_STATE_RUNNING;
+    }
+
+    process_current = caller;
+}
+/*-------------------------------------------------------------------------------------------------------------------*/
+void process_start(struct process* p, process_data_t data)
+{
+    for (struct process* q = process_list; q != NULL; q = q->next)
+    {
+        if (q == p)
+        {
+            return;
+        }
+    }
+
+    p->next = process_list;
+    process_list = p;
+    p->state = PROCESS_STATE_RUNNING;
+    PT_INIT(&p->pt);
+
+    call_process(p, PROCESS_EVENT_INIT, data);
+}
+/*-------------------------------------------------------------------------------------------------------------------*/
+void process_exit(struct process* p)
+{
+    for (struct process** q = &process_list; *q != NULL; q = &(*q)->next)
+    {
+        if (*q == p)
+        {
+            *q = p->next;
+            break;
+        }
+    }
+
+    p->state = PROCESS_STATE_NONE;
+}
+/*-------------------------------------------------------------------------------------------------------------------*/
+int process_post(struct process* p, process_event_t ev, process_data_t data)
+{
+    if (nevents == PROCESS_CONF_NUMEVENTS)
+    {
+        return PROCESS_ERR_FULL;
+    }
+
+    const unsigned int snum = (fevent + nevents) % PROCESS_CONF_NUMEVENTS;
+    events[snum].p = p;
+    events[snum].ev = ev;
+    events[snum].data = data;
+    ++nevents;
+
+    return PROCESS_ERR_OK;
+}
+/*-------------------------------------------------------------------------------------------------------------------*/
+void process_post_synch(struct process* p, process_event_t ev, process_data_t data)
+{
+    call_process(p, ev, data);
+}
+/*-------------------------------------------------------------------------------------------------------------------*/
+void process_poll(struct process* p)
+{
+    if (p != NULL && p->state != PROCESS_STATE_NONE)
+    {
+        p->needspoll = 1;
+        poll_requested = true;
+    }
+}
+/*-------------------------------------------------------------------------------------------------------------------*/
+int process_is_running(struct process* p)
+{
+    return p != NULL && p->state != PROCESS_STATE_NONE;
+}
+/*-------------------------------------------------------------------------------------------------------------------*/
+int process_run(void)
+{
+    if (poll_requested)
+    {
+        poll_requested = false;
+
+        for (struct process* p = process_list; p != NULL; p = p->next)
+        {
+            if (p->needspoll)
+            {
+                p->needspoll = 0;
+                call_process(p, PROCESS_EVENT_POLL, NULL);
+            }
+        }
+    }
+
+    if (nevents > 0)
+    {
+        struct process* p = events[fevent].p;
+        const process_event_t ev = events[fevent].ev;
+        process_data_t data = events[fevent].data;
+
+        fevent = (fevent + 1) % PROCESS_CONF_NUMEVENTS;
+        --nevents;
+
+        if (p == NULL)
+        {
+            // Broadcast
+            for (struct process* q = process_list; q != NULL; q = q->next)
+            {
+                call_process(q, ev, data);
+            }
+        }
+        else
+        {
+            call_process(p, ev, data);
+        }
+    }
+
+    return (int)nevents + poll_requested;
+}
+/*-------------------------------------------------------------------------------------------------------------------*/
@@ -0,0 +1,59 @@
+#pragma once
+/*-------------------------------------------------------------------------------------------------------------------*/
+// Protothreads using switch-based local continuations, as in Contiki-NG
+/*-------------------------------------------------------------------------------------------------------------------*/
+struct pt {
+    unsigned short lc;
+};
+/*-------------------------------------------------------------------------------------------------------------------*/
+#define PT_WAITING 0
+#define PT_YIELDED 1
+#define PT_EXITED  2
+#define PT_ENDED   3
+/*-------------------------------------------------------------------------------------------------------------------*/
+#define PT_THREAD(name_args) char name_args
+
+#define PT_INIT(pt) (pt)->lc = 0
+
+#define PT_BEGIN(pt) { char PT_YIELD_FLAG = 1; if (PT_YIELD_FLAG) {;} switch ((pt)->lc) { case 0:
+
+#define PT_END(pt) } PT_YIELD_FLAG = 0; PT_INIT(pt); return PT_ENDED; }
+
+#define PT_WAIT_UNTIL(pt, condition) \
+    do { \
+        (pt)->lc = __LINE__; case __LINE__: \
+        if (!(condition)) { return PT_WAITING; } \
+    } while (0)
+
+#define PT_WAIT_WHILE(pt, cond) PT_WAIT_UNTIL((pt), !(cond))
+
+#define PT_WAIT_THREAD(pt, thread) PT_WAIT_WHILE((pt), PT_SCHEDULE(thread))
+
+#define PT_SPAWN(pt, child, thread) \
+    do { \
+        PT_INIT((child)); \
+        PT_WAIT_THREAD((pt), (thread)); \
+    } while (0)
+
+#define PT_EXIT(pt) \
+    do { \
+        PT_INIT(pt); \
+        return PT_EXITED; \
+    } while (0)
+
+#define PT_SCHEDULE(f) ((f) < PT_EXITED)
+
+#define PT_YIELD(pt) \
+    do { \
+        PT_YIELD_FLAG = 0; \
+        (pt)->lc = __LINE__; case __LINE__: \
+        if (PT_YIELD_FLAG == 0) { return PT_YIELDED; } \
+    } while (0)
+
+#define PT_YIELD_UNTIL(pt, cond) \
+    do { \
+        PT_YIELD_FLAG = 0; \
+        (pt)->lc = __LINE__; case __LINE__: \
+        if ((PT_YIELD_FLAG == 0) || !(cond)) { return PT_YIELDED; } \
+    } while (0)
+/*-------------------------------------------------------------------------------------------------------------------*/
@@ -0,0 +1,15 @@
+#pragma once
+/*-------------------------------------------------------------------------------------------------------------------*/
+#include <stdint.h>
+/*-------------------------------------------------------------------------------------------------------------------*/
+// The host build does not schedule real-time tasks, rtimer is only used to measure time
+typedef uint32_t rtimer_clock_t;
+
+#define RTIMER_SECOND 1000000UL
+
+// Microseconds since clock_init
+rtimer_clock_t rtimer_arch_now(void);
+
+#define RTIMER_NOW() rtimer_arch_now()
+#define RTIMERTICKS_TO_US_64(t) ((uint64_t)(t))
+/*-------------------------------------------------------------------------------------------------------------------*/
@@ -0,0 +1,65 @@
+#pragma once
+/*-------------------------------------------------------------------------------------------------------------------*/
+// Host crypto target: SHA-256 in software, no ECC. Only what the trust core needs.
+/*-------------------------------------------------------------------------------------------------------------------*/
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+
+#include "sys/pt.h"
+#include "sys/process.h"
+
+#include "keys.h"
+/*-------------------------------------------------------------------------------------------------------------------*/
+typedef uint8_t platform_crypto_result_t;
+/*-------------------------------------------------------------------------------------------------------------------*/
+void platform_crypto_support_init(void);
+/*-------------------------------------------------------------------------------------------------------------------*/
+#define PLATFORM_CRYPTO_EXPIRED ((platform_crypto_result_t)0xff)
+/*-------------------------------------------------------------------------------------------------------------------*/
+bool platform_crypto_success(platform_crypto_result_t ret);
+bool platform_crypto_signature_invalid(platform_crypto_result_t ret);
+/*-------------------------------------------------------------------------------------------------------------------*/
+bool crypto_fill_random(uint8_t* buffer, size_t size_in_bytes);
+/*-------------------------------------------------------------------------------------------------------------------*/
+platform_crypto_result_t sha256_hash(const uint8_t* buffer, size_t len, uint8_t* hash);
+/*-------------------------------------------------------------------------------------------------------------------*/
+typedef struct {
+    uint32_t state[8];
+    uint64_t length;
+    uint8_t block[64];
+    uint8_t block_len;
+} platform_sha256_context_t;
+platform_crypto_result_t platform_sha256_init(platform_sha256_context_t* ctx);
+platform_crypto_result_t platform_sha256_update(platform_sha256_context_t* ctx, const uint8_t* buffer, size_t len);
+platform_crypto_result_t platform_sha256_finalise(platform_sha256_context_t* ctx, uint8_t* hash);
+void platform_sha256_done(platform_sha256_context_t* ctx);
+/*-------------------------------------------------------------------------------------------------------------------*/
+// There is no ECC on the host. A program that queues signs or verifies (crypto-queue-bench) provides
+// ecc_sign and ecc_verify itself, and decides how long they take.
+typedef struct {
+    struct pt pt;
+
+    struct process* process;
+    platform_crypto_result_t result;
+} sign_state_t;
+
+PT_THREAD(ecc_sign(sign_state_t* state, uint8_t* buffer, size_t buffer_len, size_t msg_len));
+
+#define ECC_SIGN_GET_RESULT(state) state.result
+#define ECC_SIGN_GET_PROCESS(state) state.process
+/*-------------------------------------------------------------------------------------------------------------------*/
+typedef struct {
+    struct pt pt;
+
+    struct process* process;
+    platform_crypto_result_t result;
+} verify_state_t;
+
+PT_THREAD(ecc_verify(verify_state_t* state, const ecdsa_secp256r1_pubkey_t* pubkey, const uint8_t* buffer, size_t buffer_len));
+
+#define ECC_VERIFY_GET_RESULT(state) state.result
+#define ECC_VERIFY_GET_PROCESS(state) state.process
+/*-------------------------------------------------------------------------------------------------------------------*/
+#define CRYPTO_RESULT_SPEC "u"
+/*-------------------------------------------------------------------------------------------------------------------*/
@@ -0,0 +1,744 @@
+#include "contiki.h"
+#include "lib/random.h"
+#include "os/sys/log.h"
+
+#include "edge-info.h"
+#include "capability-info.h"
+#include "peer-info.h"
+#include "trust-common.h"
+#include "trust-models.h"
+#include "trust-choose.h"
+#include "trust-snapshot.h"
+#include "eui64.h"
+
+#include <assert.h>
+#include <inttypes.h>
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+/*-------------------------------------------------------------------------------------------------------------------*/
+// Measures the throughput of the trust core on the host, printed as CSV with one row per operation:
+// model,choose,arithmetic,edges,peers,operation,ops,ns_per_op
+// Built with TRUST_SNAPSHOT, writing and restoring the snapshot are measured too (in the working directory).
+// With -s it instead reports the payload and RAM used by the trust of each number of edges, after -i rounds of
+// interactions, and the largest change in trust value from passing that trust through serialise and deserialise:
+// model,choose,arithmetic,encoding,edges,history,payload_bytes,edge_tm_bytes,capability_tm_bytes,
+// peer_edge_bytes,peer_capability_bytes,max_trust_error
+/*-------------------------------------------------------------------------------------------------------------------*/
+#ifndef BENCH_ITERATIONS
+#define BENCH_ITERATIONS 100
+#endif
+
+// Interactions recorded with each edge and capability before measuring, so models have history to work on
+#ifndef BENCH_HISTORY
+#define BENCH_HISTORY 8
+#endif
+
+#ifndef BENCH_BUFFER_LEN
+#define BENCH_BUFFER_LEN 16384
+#endif
+
+#define BENCH_MAX_COUNTS 8
+
+#define BENCH_NUM_CAPABILITIES MIN(CAPABILITY_ID_NUM, NUM_EDGE_CAPABILITIES)
+
+#ifdef TRUST_DIST_COMPACT
+#define BENCH_ENCODING "compact"
+#else
+#define BENCH_ENCODING "full"
+#endif
+/*-------------------------------------------------------------------------------------------------------------------*/
+typedef struct {
+    uint16_t edges[BENCH_MAX_COUNTS];
+    uint8_t num_edges;
+
+    uint16_t peers[BENCH_MAX_COUNTS];
+    uint8_t num_peers;
+
+    uint32_t iterations;
+
+    bool quiet;
+    bool verbose;
+    bool sizes;
+
+} bench_config_t;
+/*-------------------------------------------------------------------------------------------------------------------*/
+static edge_resource_t* edges[NUM_EDGE_RESOURCES];
+static uint16_t num_edges;
+
+static uint8_t buffer[BENCH_BUFFER_LEN];
+
+// Some models print distributions to stdout regardless of log level,
+// so results are written to their own stream and stdout is discarded unless verbose
+static FILE* results;
+
+// Results are accumulated here so the compiler cannot remove the calls being measured
+static volatile float sink;
+/*-------------------------------------------------------------------------------------------------------------------*/
+static uint64_t now_ns(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000u + (uint64_t)ts.tv_nsec;
+}
+/*-------------------------------------------------------------------------------------------------------------------*/
+static void result(const char* operation, uint16_t peers, uint64_t ops, uint64_t start)
+{
+    const uint64_t elapsed = now_ns() - start;
+
+    fprintf(results, "%s,%s,%s,%" PRIu16 ",%" PRIu16 ",%s,%" PRIu64 ",%.1f\n",
+        BENCH_TRUST_MODEL, BENCH_TRUST_CHOOSE, BENCH_ARITHMETIC, num_edges, peers, operation, ops,
+        ops == 0 ? 0.0 : (double)elapsed / ops);
+}
+/*-------------------------------------------------------------------------------------------------------------------*/
+static void edge_eui64(uint16_t i, uint8_t* eui64)
+{
+    const uint8_t prefix[EUI64_LENGTH] = {0x00, 0x12, 0x4b, 0x00, 0x00, 0x00, i >> 8, i & 0xff};
+    memcpy(eui64, prefix, EUI64_LENGTH);
+}
+/*-------------------------------------------------------------------------------------------------------------------*/
+static void peer_addr(uint16_t i, uip_ipaddr_t* addr)
+{
+    const uint8_t eui64[EUI64_LENGTH] = {0x00, 0x12, 0x4b, 0x00, 0x00, 0x01, i >> 8, i & 0xff};
+    eui64_to_ipaddr(eui64, addr);
+}
+/*-------------------------------------------------------------------------------------------------------------------*/
+// Outcomes follow a fixed pattern, so every model sees the same mix of good and bad interactions
+static bool outcome_good(uint32_t i)
+{
+    return (i % 4) != 3;
+}
+/*-------------------------------------------------------------------------------------------------------------------*/
+static void update_task_submission(edge_resource_t* edge, edge_capability_t* cap, uint32_t i)
+{
+    const tm_task_submission_info_t info = {
+        .coap_status = outcome_good(i) ? CREATED_2_01 : SERVICE_UNAVAILABLE_5_03,
+        .coap_request_status = COAP_REQUEST_STATUS_RESPONSE
+    };
+    tm_update_task_submission(edge, cap, &info);
+}
+/*-------------------------------------------------------------------------------------------------------------------*/
+static void update_task_result(edge_resource_t* edge, edge_capability_t* cap, uint32_t i)
+{
+    const tm_task_result_info_t info = {
+        .result = outcome_good(i) ? TM_TASK_RESULT_INFO_SUCCESS : TM_TASK_RESULT_INFO_FAIL
+    };
+    tm_update_task_result(edge, cap, &info);
+}
+/*-------------------------------------------------------------------------------------------------------------------*/
+static void update_announce(edge_resource_t* edge, edge_capability_t* cap, uint32_t i)
+{
+    (void)i;
+    const tm_announce_info_t info = {};
+    tm_update_announce(edge, cap, &info);
+}
+/*-------------------------------------------------------------------------------------------------------------------*/
+static void update_result_quality(edge_resource_t* edge, edge_capability_t* cap, uint32_t i)
+{
+    const tm_result_quality_info_t info = {
+        .good = outcome_good(i)
+    };
+    tm_update_result_quality(edge, cap, &info);
+}
+/*-------------------------------------------------------------------------------------------------------------------*/
+static void update_result_latency(edge_resource_t* edge, edge_capability_t* cap, uint32_t i)
+{
+    (void)i;
+    const tm_result_latency_info_t info = {};
+    tm_update_result_latency(edge, cap, &info);
+}
+/*-------------------------------------------------------------------------------------------------------------------*/
+static void update_task_throughput(edge_resource_t* edge, edge_capability_t* cap, uint32_t i)
+{
+    const tm_throughput_info_t info = {
+        .direction = (i % 2) ? TM_THROUGHPUT_IN : TM_THROUGHPUT_OUT,
+        .throughput = outcome_good(i) ? 4096 : 64
+    };
+    tm_update_task_throughput(edge, cap, &info);
+}
+/*-------------------------------------------------------------------------------------------------------------------*/
+static void update_challenge_response(edge_resource_t* edge, edge_capability_t* cap, uint32_t i)
+{
+    (void)cap;
+    const tm_challenge_response_info_t info = {
+        .type = TM_CHALLENGE_RESPONSE_RESP,
+        .challenge_successful = outcome_good(i),
+        .challenge_late = false
+    };
+    tm_update_challenge_response(edge, &info);
+}
+/*-------------------------------------------------------------------------------------------------------------------*/
+static void update_ping(edge_resource_t* edge, edge_capability_t* cap, uint32_t i)
+{
+    (void)cap;
+    const tm_edge_ping_t info = {
+        .action = (i % 2) ? TM_PING_SENT : TM_PING_RECEIVED
+    };
+    tm_update_ping(edge, &info);
+}
+/*-------------------------------------------------------------------------------------------------------------------*/
+typedef void (*update_fn_t)(edge_resource_t* edge, edge_capability_t* cap, uint32_t i);
+
+static const struct {
+    const char* name;
+    update_fn_t fn;
+    bool per_capability;
+} updates[] = {
+    { "tm_update_task_submission", update_task_submission, true },
+    { "tm_update_task_result", update_task_result, true },
+    { "tm_update_announce", update_announce, true },
+    { "tm_update_result_quality", update_result_quality, true },
+    { "tm_update_result_latency", update_result_latency, true },
+    { "tm_update_task_throughput", update_task_throughput, true },
+    { "tm_update_challenge_response", update_challenge_response, false },
+    { "tm_update_ping", update_ping, false },
+};
+/*-------------------------------------------------------------------------------------------------------------------*/
+static uint64_t for_each_capability(update_fn_t fn, bool per_capability, uint32_t iterations)
+{
+    uint64_t ops = 0;
+
+    for (uint32_t repeat = 0; repeat != iterations; ++repeat)
+    {
+        for (uint16_t i = 0; i != num_edges; ++i)
+        {
+            edge_resource_t* edge = edges[i];
+
+            if (!per_capability)
+            {
+                fn(edge, NULL, repeat);
+                ++ops;
+                continue;
+            }
+
+            for (edge_capability_t* cap = list_head(edge->capabilities); cap != NULL; cap = list_item_next(cap))
+            {
+                fn(edge, cap, repeat);
+                ++ops;
+            }
+        }
+    }
+
+    return ops;
+}
+/*-------------------------------------------------------------------------------------------------------------------*/
+static bool setup_edges(uint16_t count)
+{
+    edge_info_init();
+    capability_info_init();
+    peer_info_init();
+
+    num_edges = 0;
+
+    for (uint16_t i = 0; i != count; ++i)
+    {
+        uint8_t eui64[EUI64_LENGTH];
+        uip_ipaddr_t addr;
+        edge_eui64(i, eui64);
+        eui64_to_ipaddr(eui64, &addr);
+
+        edge_resource_t* edge = edge_info_add(&addr);
+        if (edge == NULL)
+        {
+            fprintf(stderr, "Failed to add edge %" PRIu16 " of %" PRIu16 "\n", i, count);
+            return false;
+        }
+
+        edge->flags |= EDGE_RESOURCE_ACTIVE;
+
+        for (capability_id_t id = 0; id != BENCH_NUM_CAPABILITIES; ++id)
+        {
+            edge_capability_t* cap = edge_info_capability_add(edge, id);
+            if (cap == NULL)
+            {
+                fprintf(stderr, "Failed to add capability %s to edge %" PRIu16 "\n", capability_id_name(id), i);
+                return false;
+            }
+
+            cap->flags |= EDGE_CAPABILITY_ACTIVE;
+        }
+
+        edges[num_edges++] = edge;
+    }
+
+    // Give the models some history to work on
+    for_each_capability(update_task_submission, true, BENCH_HISTORY);
+    for_each_capability(update_task_result, true, BENCH_HISTORY);
+    for_each_capability(update_result_quality, true, BENCH_HISTORY);
+
+    return true;
+}
+/*-------------------------------------------------------------------------------------------------------------------*/
+static void bench_merge(uint16_t peers, uint32_t iterations)
+{
+#ifdef TRUST_MODEL_NO_PEER_PROVIDED
+    (void)peers;
+    (void)iterations;
+#else
+    if (peers == 0)
+    {
+        return;
+    }
+
+    const int len = serialise_trust(NULL, buffer, sizeof(buffer));
+    if (len <= 0)
+    {
+        fprintf(stderr, "Skipping process_received_trust as the trust of %" PRIu16 " edges does not fit in %u bytes\n",
+            num_edges, BENCH_BUFFER_LEN);
+        return;
+    }
+
+    uip_ipaddr_t addr;
+
+    // Our own trust information stands in for what each peer would send,
+    // the first merge from each peer allocates its records
+    for (uint16_t p = 0; p != peers; ++p)
+    {
+        peer_addr(p, &addr);
+        if (process_received_trust(&addr, buffer, len) != 0)
+        {
+            fprintf(stderr, "Failed to merge trust from peer %" PRIu16 "\n", p);
+            return;
+        }
+    }
+
+    uint64_t ops = 0;
+    const uint64_t start = now_ns();
+
+    for (uint32_t repeat = 0; repeat != iterations; ++repeat)
+    {
+        for (uint16_t p = 0; p != peers; ++p)
+        {
+            peer_addr(p, &addr);
+            sink += process_received_trust(&addr, buffer, len);
+            ++ops;
+        }
+    }
+
+    result("process_received_trust", peers, ops, start);
+
+    const tm_task_observation_info_t info = {};
+    ops = 0;
+    const uint64_t observation_start = now_ns();
+
+    for (uint32_t repeat = 0; repeat != iterations; ++repeat)
+    {
+        for (peer_t* peer = peer_info_iter(); peer != NULL; peer = peer_info_next(peer))
+        {
+            tm_update_task_observation(peer, &info);
+            ++ops;
+        }
+    }
+
+    result("tm_update_task_observation", peers, ops, observation_start);
+#endif
+}
+/*-------------------------------------------------------------------------------------------------------------------*/
+#ifdef TRUST_SNAPSHOT
+static float trust_sum(void)
+{
+    float sum = 0;
+
+#ifndef TRUST_MODEL_NO_TRUST_VALUE
+    for (edge_resource_t* edge = edge_info_iter(); edge != NULL; edge = edge_info_next(edge))
+    {
+        for (edge_capability_t* cap = list_head(edge->capabilities); cap != NULL; cap = list_item_next(cap))
+        {
+            sum += trust_real_to_float(calculate_trust_value(edge, cap));
+        }
+    }
+#endif
+
+    return sum;
+}
+/*-------------------------------------------------------------------------------------------------------------------*/
+// serialise_trust starts with an array header and the time it was serialised, a uint whose additional info
+// gives its length. These are skipped, as the restores can take longer than a second.
+static size_t serialised_time_len(const uint8_t* serialised)
+{
+    const uint8_t info = serialised[1] & 0x1f;
+
+    return 2 + (info < 24 ? 0 : (1u << (info - 24)));
+}
+/*-------------------------------------------------------------------------------------------------------------------*/
+static void bench_snapshot(uint16_t peers, uint32_t iterations)
+{
+    uint64_t ops = 0;
+    uint64_t start = now_ns();
+
+    for (uint32_t repeat = 0; repeat != iterations; ++repeat)
+    {
+        if (trust_snapshot_write() < 0)
+        {
+            fprintf(stderr, "trust_snapshot_write of %" PRIu16 " edges failed\n", num_edges);
+            break;
+        }
+
+        ++ops;
+    }
+
+    result("trust_snapshot_write", peers, ops, start);
+
+    // A restore must give back the trust that was written
+    static uint8_t written[BENCH_BUFFER_LEN];
+    const int written_len = serialise_trust(NULL, written, sizeof(written));
+    const float written_sum = trust_sum();
+
+    ops = 0;
+    start = now_ns();
+
+    for (uint32_t repeat = 0; repeat != iterations; ++repeat)
+    {
+        edge_info_init();
+        capability_info_init();
+        peer_info_init();
+
+        if (trust_snapshot_restore() < 0)
+        {
+            fprintf(stderr, "trust_snapshot_restore of %" PRIu16 " edges failed\n", num_edges);
+            break;
+        }
+
+        ++ops;
+    }
+
+    result("trust_snapshot_restore", peers, ops, start);
+
+    // The sums are compared bitwise, as reputation is NaN for a capability with no weights for the peer's metrics
+    const int restored_len = serialise_trust(NULL, buffer, sizeof(buffer));
+    const float restored_sum = trust_sum();
+    bool same = (memcmp(&restored_sum, &written_sum, sizeof(written_sum)) == 0);
+    if (written_len > 0 && restored_len > 0)
+    {
+        const size_t written_skip = serialised_time_len(written);
+        const size_t restored_skip = serialised_time_len(buffer);
+
+        same = same && (written_len - written_skip == restored_len - restored_skip) &&
+            memcmp(buffer + restored_skip, written + written_skip, written_len - written_skip) == 0;
+    }
+
+    if (!same)
+    {
+        fprintf(stderr, "Trust restored for %" PRIu16 " edges and %" PRIu16 " peers differs from that written\n",
+            num_edges, peers);
+    }
+
+    // The records have been reallocated
+    num_edges = 0;
+    for (edge_resource_t* edge = edge_info_iter(); edge != NULL; edge = edge_info_next(edge))
+    {
+        edges[num_edges++] = edge;
+    }
+}
+#endif
+/*-------------------------------------------------------------------------------------------------------------------*/
+static void bench(uint16_t peers, uint32_t iterations)
+{
+    uint64_t ops, start;
+
+    // Merging first means the trust values below include the peers' information
+    bench_merge(peers, iterations);
+
+#ifndef TRUST_MODEL_NO_TRUST_VALUE
+    ops = 0;
+    start = now_ns();
+
+    for (uint32_t repeat = 0; repeat != iterations; ++repeat)
+    {
+        for (uint16_t i = 0; i != num_edges; ++i)
+        {
+            for (edge_capability_t* cap = list_head(edges[i]->capabilities); cap != NULL; cap = list_item_next(cap))
+            {
+                sink += calculate_trust_value(edges[i], cap);
+                ++ops;
+            }
+        }
+    }
+
+    result("calculate_trust_value", peers, ops, start);
+#endif
+
+    ops = 0;
+    start = now_ns();
+
+    for (uint32_t repeat = 0; repeat != iterations; ++repeat)
+    {
+        for (capability_id_t id = 0; id != BENCH_NUM_CAPABILITIES; ++id)
+        {
+            sink += choose_edge(id) != NULL;
+            ++ops;
+        }
+    }
+
+    result("choose_edge", peers, ops, start);
+
+    ops = 0;
+    start = now_ns();
+
+    for (uint32_t repeat = 0; repeat != iterations; ++repeat)
+    {
+        const int len = serialise_trust(NULL, buffer, sizeof(buffer));
+        if (len <= 0)
+        {
+            fprintf(stderr, "serialise_trust of %" PRIu16 " edges does not fit in %u bytes\n",
+                num_edges, BENCH_BUFFER_LEN);
+            break;
+        }
+
+        sink += len;
+        ++ops;
+    }
+
+    result("serialise_trust", peers, ops, start);
+
+    // Updates last, as they change the state the measurements above depend on
+    for (size_t u = 0; u != sizeof(updates)/sizeof(*updates); ++u)
+    {
+        start = now_ns();
+        ops = for_each_capability(updates[u].fn, updates[u].per_capability, iterations);
+        result(updates[u].name, peers, ops, start);
+    }
+
+#ifdef TRUST_SNAPSHOT
+    bench_snapshot(peers, iterations);
+#endif
+}
+/*-------------------------------------------------------------------------------------------------------------------*/
+static double round_trip_error(void)
+{
+    double max_error = 0;
+
+#ifndef TRUST_MODEL_NO_TRUST_VALUE
+    static float before[NUM_EDGE_RESOURCES][NUM_EDGE_CAPABILITIES];
+
+    for (uint16_t i = 0; i != num_edges; ++i)
+    {
+        uint8_t c = 0;
+        for (edge_capability_t* cap = list_head(edges[i]->capabilities); cap != NULL; cap = list_item_next(cap), ++c)
+        {
+            before[i][c] = trust_real_to_float(calculate_trust_value(edges[i], cap));
+        }
+    }
+
+    // Replace each edge's own trust with what a peer would decode, fields that are not sent are kept
+    for (uint16_t i = 0; i != num_edges; ++i)
+    {
+        nanocbor_encoder_t enc;
+        nanocbor_value_t dec;
+
+        edge_resource_tm_t edge_tm = edges[i]->tm;
+        nanocbor_encoder_init(&enc, buffer, sizeof(buffer));
+        serialise_trust_edge_resource(&enc, &edge_tm);
+        nanocbor_decoder_init(&dec, buffer, nanocbor_encoded_len(&enc));
+        if (deserialise_trust_edge_resource(&dec, &edge_tm) != NANOCBOR_OK)
+        {
+            fprintf(stderr, "Failed to deserialise the trust of edge %" PRIu16 "\n", i);
+            return NAN;
+        }
+        edges[i]->tm = edge_tm;
+
+        for (edge_capability_t* cap = list_head(edges[i]->capabilities); cap != NULL; cap = list_item_next(cap))
+        {
+            edge_capability_tm_t cap_tm = cap->tm;
+            nanocbor_encoder_init(&enc, buffer, sizeof(buffer));
+            serialise_trust_edge_capability(&enc, &cap_tm);
+            nanocbor_decoder_init(&dec, buffer, nanocbor_encoded_len(&enc));
+            if (deserialise_trust_edge_capability(&dec, &cap_tm) != NANOCBOR_OK)
+            {
+                fprintf(stderr, "Failed to deserialise the trust of edge %" PRIu16 " capability %s\n",
+                    i, capability_id_name(cap->id));
+                return NAN;
+            }
+            cap->tm = cap_tm;
+        }
+
+        trust_cache_invalidate_edge(edges[i]);
+    }
+
+    for (uint16_t i = 0; i != num_edges; ++i)
+    {
+        uint8_t c = 0;
+        for (edge_capability_t* cap = list_head(edges[i]->capabilities); cap != NULL; cap = list_item_next(cap), ++c)
+        {
+            const float after = trust_real_to_float(calculate_trust_value(edges[i], cap));
+            max_error = fmax(max_error, fabs(after - before[i][c]));
+        }
+    }
+#endif
+
+    return max_error;
+}
+/*-------------------------------------------------------------------------------------------------------------------*/
+static void sizes(uint32_t history)
+{
+    // More history than setup_edges gives, as counts are only quantised once they no longer fit in 16 bits
+    for_each_capability(update_task_submission, true, history);
+    for_each_capability(update_task_result, true, history);
+    for_each_capability(update_result_quality, true, history);
+    for_each_capability(update_task_throughput, true, history);
+
+    const int len = serialise_trust(NULL, buffer, sizeof(buffer));
+    if (len <= 0)
+    {
+        fprintf(stderr, "serialise_trust of %" PRIu16 " edges does not fit in %u bytes\n",
+            num_edges, BENCH_BUFFER_LEN);
+        return;
+    }
+
+    const double error = round_trip_error();
+
+    fprintf(results, "%s,%s,%s,%s,%" PRIu16 ",%" PRIu32 ",%d,%zu,%zu,%zu,%zu,%.3g\n",
+        BENCH_TRUST_MODEL, BENCH_TRUST_CHOOSE, BENCH_ARITHMETIC, BENCH_ENCODING, num_edges, history, len,
+        sizeof(edge_resource_tm_t), sizeof(edge_capability_tm_t), sizeof(peer_edge_t), sizeof(peer_edge_capability_t),
+        error);
+}
+/*-------------------------------------------------------------------------------------------------------------------*/
+static uint8_t parse_counts(const char* arg, uint16_t* counts)
+{
+    uint8_t num = 0;
+    char* end;
+
+    while (*arg != '\0' && num != BENCH_MAX_COUNTS)
+    {
+        counts[num++] = (uint16_t)strtoul(arg, &end, 10);
+
+        if (end == arg)
+        {
+            return 0;
+        }
+
+        arg = (*end == ',') ? end + 1 : end;
+    }
+
+    return num;
+}
+/*-------------------------------------------------------------------------------------------------------------------*/
+static void usage(const char* name)
+{
+    fprintf(stderr,
+        "Usage: %s [-e edges,...] [-p peers,...] [-i iterations] [-s] [-q] [-v]\n"
+        "  -e  Numbers of edges to measure (default 4,16,64 up to NUM_EDGE_RESOURCES=%d)\n"
+        "  -p  Numbers of peers to merge trust from (default 0,NUM_PEERS=%d)\n"
+        "  -i  Iterations of each measurement, or rounds of interactions with -s (default %d)\n"
+        "  -s  Report the payload and RAM used by trust and the error of serialising it, instead of timings\n"
+        "  -q  Do not print the CSV header\n"
+        "  -v  Keep the output of the trust core, which is otherwise discarded\n",
+        name, NUM_EDGE_RESOURCES, NUM_PEERS, BENCH_ITERATIONS);
+}
+/*-------------------------------------------------------------------------------------------------------------------*/
+int main(int argc, char** argv)
+{
+    bench_config_t config = {
+        .edges = {4, 16, 64},
+        .num_edges = 3,
+        .peers = {0, NUM_PEERS},
+        .num_peers = NUM_PEERS > 0 ? 2 : 1,
+        .iterations = BENCH_ITERATIONS,
+        .quiet = false,
+        .verbose = false,
+        .sizes = false,
+    };
+
+    int opt;
+    while ((opt = getopt(argc, argv, "e:p:i:sqvh")) != -1)
+    {
+        switch (opt)
+        {
+        case 'e': config.num_edges = parse_counts(optarg, config.edges); break;
+        case 'p': config.num_peers = parse_counts(optarg, config.peers); break;
+        case 'i': config.iterations = (uint32_t)strtoul(optarg, NULL, 10); break;
+        case 'q': config.quiet = true; break;
+        case 'v': config.verbose = true; break;
+        case 's': config.sizes = true; break;
+        default: usage(argv[0]); return opt == 'h' ? EXIT_SUCCESS : EXIT_FAILURE;
+        }
+    }
+
+    if (config.num_edges == 0 || config.num_peers == 0 || config.iterations == 0)
+    {
+        usage(argv[0]);
+        return EXIT_FAILURE;
+    }
+
+    fflush(stdout);
+    results = fdopen(dup(STDOUT_FILENO), "w");
+    if (results == NULL)
+    {
+        perror("fdopen");
+        return EXIT_FAILURE;
+    }
+
+    if (!config.verbose && freopen("/dev/null", "w", stdout) == NULL)
+    {
+        perror("freopen");
+        return EXIT_FAILURE;
+    }
+
+    clock_init();
+    random_init(0);
+
+#ifdef TRUST_SNAPSHOT
+    // Start from empty records, rather than those left by a previous run
+    trust_snapshot_erase();
+#endif
+
+    trust_common_init();
+
+    if (!config.quiet)
+    {
+        fprintf(results, config.sizes
+            ? "model,choose,arithmetic,encoding,edges,history,payload_bytes,edge_tm_bytes,capability_tm_bytes,"
+              "peer_edge_bytes,peer_capability_bytes,max_trust_error\n"
+            : "model,choose,arithmetic,edges,peers,operation,ops,ns_per_op\n");
+    }
+
+    for (uint8_t e = 0; e != config.num_edges; ++e)
+    {
+        if (config.edges[e] > NUM_EDGE_RESOURCES)
+        {
+            fprintf(stderr, "Skipping %" PRIu16 " edges as NUM_EDGE_RESOURCES=%d\n", config.edges[e], NUM_EDGE_RESOURCES);
+            continue;
+        }
+
+        if (config.sizes)
+        {
+            if (!setup_edges(config.edges[e]))
+            {
+                return EXIT_FAILURE;
+            }
+
+            sizes(config.iterations);
+            fflush(results);
+            continue;
+        }
+
+        for (uint8_t p = 0; p != config.num_peers; ++p)
+        {
+            if (config.peers[p] > NUM_PEERS)
+            {
+                fprintf(stderr, "Skipping %" PRIu16 " peers as NUM_PEERS=%d\n", config.peers[p], NUM_PEERS);
+                continue;
+            }
+
+            if (!setup_edges(config.edges[e]))
+            {
+                return EXIT_FAILURE;
+            }
+
+            bench(config.peers[p], config.iterations);
+            fflush(results);
+        }
+    }
+
+    fclose(results);
+
+#ifdef TRUST_SNAPSHOT
+    trust_snapshot_erase();
+#endif
+
+    return EXIT_SUCCESS;
+}
+/*-------------------------------------------------------------------------------------------------------------------*/
@@ -0,0 +1,406 @@
+#include "contiki.h"
+#include "lib/random.h"
+#include "os/sys/log.h"
+
+#include "edge-info.h"
+#include "capability-info.h"
+#include "peer-info.h"
+#include "trust-common.h"
+#include "trust-models.h"
+#include "trust-snapshot.h"
+#include "eui64.h"
+
+#include <inttypes.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+/*-------------------------------------------------------------------------------------------------------------------*/
+// Checks how the trust core keeps its records consistent, against the same shims as trust-bench.
+// Prints each failed check and exits with a failure status if there were any.
+/*-------------------------------------------------------------------------------------------------------------------*/
+#ifndef TEST_BUFFER_LEN
+#define TEST_BUFFER_LEN 16384
+#endif
+
+#define TEST_NUM_CAPABILITIES MIN(CAPABILITY_ID_NUM, NUM_EDGE_CAPABILITIES)
+/*-------------------------------------------------------------------------------------------------------------------*/
+static uint8_t buffer[TEST_BUFFER_LEN];
+
+static uint32_t checks;
+static uint32_t failures;
+/*-------------------------------------------------------------------------------------------------------------------*/
+#define CHECK(cond) check((cond), #cond, __func__, __LINE__)
+
+static bool check(bool passed, const char* cond, const char* func, int line)
+{
+    checks += 1;
+
+    if (!passed)
+    {
+        fprintf(stderr, "%s:%d: check failed: %s\n", func, line, cond);
+        failures += 1;
+    }
+
+    return passed;
+}
+/*-------------------------------------------------------------------------------------------------------------------*/
+static void edge_addr(uint16_t i, uip_ipaddr_t* addr)
+{
+    const uint8_t eui64[EUI64_LENGTH] = {0x00, 0x12, 0x4b, 0x00, 0x00, 0x00, i >> 8, i & 0xff};
+    eui64_to_ipaddr(eui64, addr);
+}
+/*-------------------------------------------------------------------------------------------------------------------*/
+static void peer_addr(uint16_t i, uip_ipaddr_t* addr)
+{
+    const uint8_t eui64[EUI64_LENGTH] = {0x00, 0x12, 0x4b, 0x00, 0x00, 0x01, i >> 8, i & 0xff};
+    eui64_to_ipaddr(eui64, addr);
+}
+/*-------------------------------------------------------------------------------------------------------------------*/
+static edge_resource_t* add_edge(uint16_t i)
+{
+    uip_ipaddr_t addr;
+    edge_addr(i, &addr);
+
+    edge_resource_t* edge = edge_info_add(&addr);
+    if (edge == NULL)
+    {
+        return NULL;
+    }
+
+    for (capability_id_t id = 0; id != TEST_NUM_CAPABILITIES; ++id)
+    {
+        if (edge_info_capability_add(edge, id) == NULL)
+        {
+            return NULL;
+        }
+    }
+
+    return edge;
+}
+/*-------------------------------------------------------------------------------------------------------------------*/
+// Fills the edge pool with inactive edges 0 to NUM_EDGE_RESOURCES - 1, so the next edge added evicts one
+static bool setup_full(void)
+{
+    edge_info_init();
+    capability_info_init();
+    peer_info_init();
+    serialise_trust_request_snapshot();
+
+    for (uint16_t i = 0; i != NUM_EDGE_RESOURCES; ++i)
+    {
+        if (add_edge(i) == NULL)
+        {
+            fprintf(stderr, "Failed to add edge %" PRIu16 "\n", i);
+            return false;
+        }
+    }
+
+    return true;
+}
+/*-------------------------------------------------------------------------------------------------------------------*/
+static bool merge_from_peer(uint16_t p, int len)
+{
+    uip_ipaddr_t addr;
+    peer_addr(p, &addr);
+
+    return len > 0 && process_received_trust(&addr, buffer, len) == 0;
+}
+/*-------------------------------------------------------------------------------------------------------------------*/
+static bool edge_is_held(const edge_resource_t* edge)
+{
+    for (edge_resource_t* iter = edge_info_iter(); iter != NULL; iter = edge_info_next(iter))
+    {
+        if (iter == edge)
+        {
+            return true;
+        }
+    }
+
+    return false;
+}
+/*-------------------------------------------------------------------------------------------------------------------*/
+// Every record a peer holds must be of an edge and capability that are still held, in canonical order
+static void check_peer_records(peer_t* peer)
+{
+    const peer_edge_t* prev_edge = NULL;
+
+    for (peer_edge_t* peer_edge = peer_info_edges_head(peer); peer_edge != NULL; peer_edge = peer_info_edges_next(peer_edge))
+    {
+        if (!CHECK(edge_is_held(peer_edge->edge)))
+        {
+            return;
+        }
+
+        CHECK(prev_edge == NULL || edge_info_compare(prev_edge->edge, peer_edge->edge) < 0);
+        prev_edge = peer_edge;
+
+        const peer_edge_capability_t* prev_cap = NULL;
+
+        for (peer_edge_capability_t* peer_cap = peer_info_capabilities_head(peer_edge); peer_cap != NULL; peer_cap = peer_info_capabilities_next(peer_cap))
+        {
+            if (!CHECK(edge_info_capability_find(peer_edge->edge, peer_cap->cap->id) == peer_cap->cap))
+            {
+                return;
+            }
+
+            CHECK(prev_cap == NULL || capability_id_compare(prev_cap->cap->id, peer_cap->cap->id) < 0);
+            prev_cap = peer_cap;
+        }
+    }
+}
+/*-------------------------------------------------------------------------------------------------------------------*/
+// Evicting an edge or capability must remove the peers' records of it, as the record freed is reused
+static void test_evict_held_by_peers(void)
+{
+    if (!setup_full())
+    {
+        CHECK(false);
+        return;
+    }
+
+    CHECK(merge_from_peer(0, serialise_trust(NULL, buffer, sizeof(buffer))));
+
+    peer_t* peer = peer_info_iter();
+    if (!CHECK(peer != NULL))
+    {
+        return;
+    }
+
+    // The first inactive edge is evicted and the new edge, which the peer knows nothing about,
+    // takes its record. It sorts last, so a stale record would also be out of order.
+    edge_resource_t* edge = add_edge(NUM_EDGE_RESOURCES);
+    if (!CHECK(edge != NULL))
+    {
+        return;
+    }
+
+    CHECK(edge_info_eviction_stats()->edge_evictions == 1);
+    CHECK(peer_info_find_edge(peer, edge) == NULL);
+    check_peer_records(peer);
+
+    // The same for a capability, which is re-added to take the record it was removed from
+    edge_resource_t* const other = edge_info_next(edge_info_iter());
+    edge_capability_t* cap = list_head(other->capabilities);
+    const capability_id_t id = cap->id;
+
+    CHECK(peer_info_find_capability(peer_info_find_edge(peer, other), cap) != NULL);
+    CHECK(edge_info_capability_remove(other, cap));
+
+    cap = edge_info_capability_add(other, id);
+    if (!CHECK(cap != NULL))
+    {
+        return;
+    }
+
+    CHECK(peer_info_find_capability(peer_info_find_edge(peer, other), cap) == NULL);
+    check_peer_records(peer);
+}
+/*-------------------------------------------------------------------------------------------------------------------*/
+// A merge after an eviction must not take the evicted edge's record, or its version, for the edge that replaced it
+static void test_evict_between_merges(void)
+{
+    if (!setup_full())
+    {
+        CHECK(false);
+        return;
+    }
+
+    // The first edge has a newer version than the edge that will replace it
+    edge_resource_t* const evicted = edge_info_iter();
+    for (uint8_t i = 0; i != 5; ++i)
+    {
+        edge_info_tm_changed(evicted);
+    }
+
+    CHECK(merge_from_peer(0, serialise_trust_periodic(buffer, sizeof(buffer))));
+
+    peer_t* peer = peer_info_iter();
+    if (!CHECK(peer != NULL))
+    {
+        return;
+    }
+
+    edge_resource_t* edge = add_edge(NUM_EDGE_RESOURCES);
+    if (!CHECK(edge != NULL))
+    {
+        return;
+    }
+
+    edge_info_tm_changed(edge);
+
+    // Only the new edge has changed, so the broadcast is a delta of it alone
+    CHECK(merge_from_peer(0, serialise_trust_periodic(buffer, sizeof(buffer))));
+
+    CHECK(peer_info_is_ordered(peer));
+    check_peer_records(peer);
+
+    peer_edge_t* peer_edge = peer_info_find_edge(peer, edge);
+    if (CHECK(peer_edge != NULL))
+    {
+        CHECK(peer_edge->version == edge->tm_version);
+
+        // The new edge sorts last
+        CHECK(peer_info_edges_next(peer_edge) == NULL);
+    }
+
+    // And the merge after that still walks the records in order
+    CHECK(merge_from_peer(0, serialise_trust(NULL, buffer, sizeof(buffer))));
+    CHECK(peer_info_is_ordered(peer));
+    check_peer_records(peer);
+}
+/*-------------------------------------------------------------------------------------------------------------------*/
+// A delta older than the peer's last broadcast is a replay and must not roll back its records,
+// but an older snapshot is from a peer that has restarted
+static void test_replayed_delta_rejected(void)
+{
+    if (!setup_full())
+    {
+        CHECK(false);
+        return;
+    }
+
+    CHECK(merge_from_peer(0, serialise_trust_periodic(buffer, sizeof(buffer))));
+
+    peer_t* peer = peer_info_iter();
+    if (!CHECK(peer != NULL))
+    {
+        return;
+    }
+
+    edge_resource_t* const edge = edge_info_iter();
+    peer_edge_t* const peer_edge = peer_info_find_edge(peer, edge);
+    if (!CHECK(peer_edge != NULL))
+    {
+        return;
+    }
+
+    const uint32_t version = peer_edge->version;
+    edge_info_tm_changed(edge);
+
+    const int delta_len = serialise_trust_periodic(buffer, sizeof(buffer));
+
+    // As if a later broadcast had been seen since the delta was sent
+    const uint32_t last_seen = peer->last_seen;
+    peer->last_seen = last_seen + 100;
+
+    CHECK(!merge_from_peer(0, delta_len));
+    CHECK(peer->last_seen == last_seen + 100);
+    CHECK(peer_edge->version == version);
+
+    peer->last_seen = last_seen;
+
+    CHECK(merge_from_peer(0, delta_len));
+    CHECK(peer_edge->version == edge->tm_version);
+
+    peer->last_seen = last_seen + 100;
+
+    CHECK(merge_from_peer(0, serialise_trust(NULL, buffer, sizeof(buffer))));
+    CHECK(peer->last_seen <= last_seen + 1);
+    check_peer_records(peer);
+}
+/*-------------------------------------------------------------------------------------------------------------------*/
+#ifdef TRUST_SNAPSHOT
+// After a reboot an edge and its capabilities are only active once they have been announced again
+static void test_snapshot_restores_inactive(void)
+{
+    if (!setup_full())
+    {
+        CHECK(false);
+        return;
+    }
+
+    edge_resource_t* edge = edge_info_iter();
+    edge_capability_t* cap = list_head(edge->capabilities);
+
+    edge->flags |= EDGE_RESOURCE_ACTIVE;
+    cap->flags |= EDGE_CAPABILITY_ACTIVE;
+    edge_info_tm_changed(edge);
+
+    uip_ipaddr_t addr;
+    uip_ipaddr_copy(&addr, &edge->ep.ipaddr);
+    const capability_id_t id = cap->id;
+    const uint8_t tm_version = edge->tm_version;
+
+    CHECK(trust_snapshot_write() > 0);
+
+    edge_info_init();
+    capability_info_init();
+    peer_info_init();
+
+    CHECK(trust_snapshot_restore() > 0);
+
+    edge = edge_info_find_addr(&addr);
+    if (CHECK(edge != NULL))
+    {
+        CHECK(!edge_info_is_active(edge));
+        CHECK(edge->tm_version == tm_version);
+
+        cap = edge_info_capability_find(edge, id);
+        CHECK(cap != NULL && !edge_capability_is_active(cap));
+    }
+
+    trust_snapshot_erase();
+}
+#endif
+/*-------------------------------------------------------------------------------------------------------------------*/
+static const struct {
+    const char* name;
+    void (*fn)(void);
+} tests[] = {
+    { "evict_held_by_peers", test_evict_held_by_peers },
+    { "evict_between_merges", test_evict_between_merges },
+    { "replayed_delta_rejected", test_replayed_delta_rejected },
+#ifdef TRUST_SNAPSHOT
+    { "snapshot_restores_inactive", test_snapshot_restores_inactive },
+#endif
+};
+/*-------------------------------------------------------------------------------------------------------------------*/
+int main(int argc, char** argv)
+{
+    const bool verbose = argc > 1 && strcmp(argv[1], "-v") == 0;
+
+    // Some models print distributions to stdout regardless of log level
+    fflush(stdout);
+    FILE* results = fdopen(dup(STDOUT_FILENO), "w");
+    if (results == NULL)
+    {
+        perror("fdopen");
+        return EXIT_FAILURE;
+    }
+
+    if (!verbose && freopen("/dev/null", "w", stdout) == NULL)
+    {
+        perror("freopen");
+        return EXIT_FAILURE;
+    }
+
+    clock_init();
+    random_init(0);
+
+    trust_common_init();
+
+    // The tests merge trust from peers
+    if (NUM_PEERS == 0)
+    {
+        fprintf(results, "%s: nothing to test as NUM_PEERS=0\n", BENCH_TRUST_MODEL);
+        fclose(results);
+        return EXIT_SUCCESS;
+    }
+
+    for (size_t t = 0; t != sizeof(tests)/sizeof(*tests); ++t)
+    {
+        const uint32_t failures_before = failures;
+
+        tests[t].fn();
+
+        fprintf(results, "%s: %s %s\n", BENCH_TRUST_MODEL, tests[t].name, failures == failures_before ? "passed" : "FAILED");
+    }
+
+    fprintf(results, "%s: %" PRIu32 " checks, %" PRIu32 " failed\n", BENCH_TRUST_MODEL, checks, failures);
+
+    fclose(results);
+
+    return failures == 0 ? EXIT_SUCCESS : EXIT_FAILURE;
+}
+/*-------------------------------------------------------------------------------------------------------------------*/
@@ -0,0 +1,180 @@
+#include "trust-admission.h"
+
+#include "contiki.h"
+#include "os/sys/log.h"
+
+#include <inttypes.h>
+#include <string.h>
+/*-------------------------------------------------------------------------------------------------------------------*/
+#define LOG_MODULE "trust-adm"
+#ifdef TRUST_MODEL_LOG_LEVEL
+#define LOG_LEVEL TRUST_MODEL_LOG_LEVEL
+#else
+#define LOG_LEVEL LOG_LEVEL_NONE
+#endif
+/*-------------------------------------------------------------------------------------------------------------------*/
+_Static_assert(TRUST_ADMISSION_PER_SOURCE_BURST > 0 && TRUST_ADMISSION_PER_SOURCE_PER_MINUTE > 0, "Invalid per source rate");
+_Static_assert(TRUST_ADMISSION_GLOBAL_BURST > 0 && TRUST_ADMISSION_GLOBAL_PER_MINUTE > 0, "Invalid global rate");
+_Static_assert(TRUST_ADMISSION_SOURCES > 0 && TRUST_ADMISSION_SOURCES <= UINT8_MAX, "Invalid number of sources");
+/*-------------------------------------------------------------------------------------------------------------------*/
+// Tokens are held in units that one clock tick at a rate of one token per minute adds
+#define TOKEN ((uint32_t)60 * CLOCK_SECOND)
+/*-------------------------------------------------------------------------------------------------------------------*/
+typedef struct {
+    clock_time_t updated;
+    uint32_t tokens;
+} token_bucket_t;
+
+typedef struct {
+    uint8_t eui64[EUI64_LENGTH];
+    bool in_use;
+    token_bucket_t bucket;
+} source_bucket_t;
+/*-------------------------------------------------------------------------------------------------------------------*/
+static source_bucket_t sources[TRUST_ADMISSION_SOURCES];
+static token_bucket_t global;
+
+static trust_admission_stats_t stats;
+/*-------------------------------------------------------------------------------------------------------------------*/
+static void
+token_bucket_init(token_bucket_t* bucket, uint32_t burst, clock_time_t now)
+{
+    bucket->updated = now;
+    bucket->tokens = burst * TOKEN;
+}
+/*-------------------------------------------------------------------------------------------------------------------*/
+static void
+token_bucket_fill(token_bucket_t* bucket, uint32_t burst, uint32_t per_minute, clock_time_t now)
+{
+    const uint32_t full = burst * TOKEN;
+    const clock_time_t elapsed = now - bucket->updated;
+
+    bucket->updated = now;
+
+    // Compare against the time needed to become full, so that a long gap cannot overflow
+    if (bucket->tokens >= full || elapsed >= (full - bucket->tokens + per_minute - 1) / per_minute)
+    {
+        bucket->tokens = full;
+    }
+    else
+    {
+        bucket->tokens += (uint32_t)elapsed * per_minute;
+    }
+}
+/*-------------------------------------------------------------------------------------------------------------------*/
+static inline bool
+token_bucket_has_token(const token_bucket_t* bucket)
+{
+    return bucket->tokens >= TOKEN;
+}
+/*-------------------------------------------------------------------------------------------------------------------*/
+// Seconds until the bucket will have a token, rounded up
+static uint32_t
+token_bucket_retry_after(const token_bucket_t* bucket, uint32_t per_minute)
+{
+    if (token_bucket_has_token(bucket))
+    {
+        return 0;
+    }
+
+    const uint32_t ticks = (TOKEN - bucket->tokens + per_minute - 1) / per_minute;
+
+    return (ticks + CLOCK_SECOND - 1) / CLOCK_SECOND;
+}
+/*-------------------------------------------------------------------------------------------------------------------*/
+static source_bucket_t*
+source_bucket_find(const uint8_t* eui64, clock_time_t now)
+{
+    source_bucket_t* replace = NULL;
+
+    for (uint8_t i = 0; i != TRUST_ADMISSION_SOURCES; ++i)
+    {
+        source_bucket_t* source = &sources[i];
+
+        if (!source->in_use)
+        {
+            if (replace == NULL || replace->in_use)
+            {
+                replace = source;
+            }
+            continue;
+        }
+
+        if (memcmp(source->eui64, eui64, EUI64_LENGTH) == 0)
+        {
+            return source;
+        }
+
+        // Replace the fullest bucket, as a new bucket starts full little is lost by forgetting it.
+        // A source that has run out of tokens is kept, so it cannot be refilled by other sources pushing it out.
+        token_bucket_fill(&source->bucket, TRUST_ADMISSION_PER_SOURCE_BURST, TRUST_ADMISSION_PER_SOURCE_PER_MINUTE, now);
+        if (replace == NULL || (replace->in_use && source->bucket.tokens > replace->bucket.tokens))
+        {
+            replace = source;
+        }
+    }
+
+    memcpy(replace->eui64, eui64, EUI64_LENGTH);
+    replace->in_use = true;
+    token_bucket_init(&replace->bucket, TRUST_ADMISSION_PER_SOURCE_BURST, now);
+
+    return replace;
+}
+/*-------------------------------------------------------------------------------------------------------------------*/
+void trust_admission_init(void)
+{
+    memset(sources, 0, sizeof(sources));
+    memset(&stats, 0, sizeof(stats));
+
+    token_bucket_init(&global, TRUST_ADMISSION_GLOBAL_BURST, clock_time());
+}
+/*-------------------------------------------------------------------------------------------------------------------*/
+uint32_t trust_admission_check(const uint8_t* eui64)
+{
+    const clock_time_t now = clock_time();
+
+    source_bucket_t* source = source_bucket_find(eui64, now);
+
+    token_bucket_fill(&source->bucket, TRUST_ADMISSION_PER_SOURCE_BURST, TRUST_ADMISSION_PER_SOURCE_PER_MINUTE, now);
+    token_bucket_fill(&global, TRUST_ADMISSION_GLOBAL_BURST, TRUST_ADMISSION_GLOBAL_PER_MINUTE, now);
+
+    // Only take tokens when both buckets have one, so a source is not charged for a verify that was not queued
+    if (!token_bucket_has_token(&source->bucket))
+    {
+        stats.dropped_source += 1;
+
+        LOG_DBG("Rate limiting ");
+        LOG_DBG_BYTES(eui64, EUI64_LENGTH);
+        LOG_DBG_("\n");
+
+        return token_bucket_retry_after(&source->bucket, TRUST_ADMISSION_PER_SOURCE_PER_MINUTE);
+    }
+
+    if (!token_bucket_has_token(&global))
+    {
+        stats.dropped_global += 1;
+
+        LOG_DBG("Rate limiting all sources\n");
+
+        return token_bucket_retry_after(&global, TRUST_ADMISSION_GLOBAL_PER_MINUTE);
+    }
+
+    source->bucket.tokens -= TOKEN;
+    global.tokens -= TOKEN;
+
+    stats.admitted += 1;
+
+    return 0;
+}
+/*-------------------------------------------------------------------------------------------------------------------*/
+const trust_admission_stats_t* trust_admission_stats(void)
+{
+    return &stats;
+}
+/*-------------------------------------------------------------------------------------------------------------------*/
+void trust_admission_stats_print(void)
+{
+    LOG_INFO("Admission: admitted=%" PRIu32 " dropped(source=%" PRIu32 " global=%" PRIu32 ")\n",
+        stats.admitted, stats.dropped_source, stats.dropped_global);
+}
+/*-------------------------------------------------------------------------------------------------------------------*/
@@ -0,0 +1,47 @@
+#pragma once
+/*-------------------------------------------------------------------------------------------------------------------*/
+#include <stdint.h>
+#include <stdbool.h>
+
+#include "eui64.h"
+/*-------------------------------------------------------------------------------------------------------------------*/
+// Token buckets limiting how often received trust information is queued to have its signature verified,
+// both per source and across all sources, so one peer cannot keep the verifier busy.
+// A bucket holds up to its burst of tokens and gains its rate of tokens per minute.
+/*-------------------------------------------------------------------------------------------------------------------*/
+#ifndef TRUST_ADMISSION_PER_SOURCE_BURST
+#define TRUST_ADMISSION_PER_SOURCE_BURST 3
+#endif
+
+#ifndef TRUST_ADMISSION_PER_SOURCE_PER_MINUTE
+#define TRUST_ADMISSION_PER_SOURCE_PER_MINUTE 2
+#endif
+
+#ifndef TRUST_ADMISSION_GLOBAL_BURST
+#define TRUST_ADMISSION_GLOBAL_BURST 8
+#endif
+
+#ifndef TRUST_ADMISSION_GLOBAL_PER_MINUTE
+#define TRUST_ADMISSION_GLOBAL_PER_MINUTE 30
+#endif
+
+// Number of sources with their own bucket
+#ifndef TRUST_ADMISSION_SOURCES
+#define TRUST_ADMISSION_SOURCES 8
+#endif
+/*-------------------------------------------------------------------------------------------------------------------*/
+void trust_admission_init(void);
+/*-------------------------------------------------------------------------------------------------------------------*/
+// Returns 0 if a verify for the source may be queued,
+// otherwise the number of seconds after which the source should try again
+uint32_t trust_admission_check(const uint8_t* eui64);
+/*-------------------------------------------------------------------------------------------------------------------*/
+typedef struct {
+    uint32_t admitted;
+    uint32_t dropped_source;
+    uint32_t dropped_global;
+} trust_admission_stats_t;
+/*-------------------------------------------------------------------------------------------------------------------*/
+const trust_admission_stats_t* trust_admission_stats(void);
+void trust_admission_stats_print(void);
+/*-------------------------------------------------------------------------------------------------------------------*/
@@ -3,6 +3,7 @@
 #include "capability-info.h"
 #include "peer-info.h"
 #include "trust-model.h"
+#include "trust-models.h"
 
 #include "contiki.h"
 #include "os/sys/log.h"
@@ -26,6 +27,7 @@
 #include "trust-common.h"
 #include "crypto-support.h"
 #include "keystore.h"
+#include "trust-admission.h"
 #include "keystore-oscore.h"
 
 // Configuration of periodic broadcast:
@@ -49,6 +51,11 @@
 #ifndef TRUST_RX_SIZE
 #define TRUST_RX_SIZE 2
 #endif
+
+// Received trust information not started being verified within this long is dropped, newer information will follow
+#ifndef TRUST_RX_VERIFY_MAX_WAIT
+#define TRUST_RX_VERIFY_MAX_WAIT (30 * CLOCK_SECOND)
+#endif
 /*-------------------------------------------------------------------------------------------------------------------*/
 #ifndef TRUST_MODEL_NO_PERIODIC_BROADCAST
 #define TRUST_POLL_PERIOD (2 * 60 * CLOCK_SECOND)
@@ -76,11 +83,56 @@ MEMB(trust_tx_memb, trust_tx_item_t, TRUST_TX_SIZE);
 typedef struct trust_rx_item
 {
     public_key_item_t* key;
+
+    // Set when this is the manifest (block 0) of a block-wise transfer
+    bool manifest;
+    uint8_t token[COAP_TOKEN_LEN];
+    uint8_t token_len;
+
     uint8_t payload_buf[MAX_TRUST_PAYLOAD + DTLS_EC_SIG_SIZE];
 } trust_rx_item_t;
 
 MEMB(trust_rx_memb, trust_rx_item_t, TRUST_RX_SIZE);
 /*-------------------------------------------------------------------------------------------------------------------*/
+#ifndef TRUST_MODEL_NO_PERIODIC_BROADCAST
+// Trust information that does not fit in MAX_TRUST_PAYLOAD is broadcast block-wise,
+// see trust-common.h. Must be a power of two between 16 and 1024 (CoAP SZX).
+#ifndef TRUST_BLOCK_SIZE
+#define TRUST_BLOCK_SIZE (COAP_MAX_CHUNK_SIZE / 2)
+#endif
+
+_Static_assert((TRUST_BLOCK_SIZE & (TRUST_BLOCK_SIZE - 1)) == 0, "TRUST_BLOCK_SIZE must be a power of two");
+_Static_assert(TRUST_BLOCK_SIZE >= 16 && TRUST_BLOCK_SIZE <= 1024, "TRUST_BLOCK_SIZE must be a valid CoAP block size");
+_Static_assert(TRUST_BLOCK_SIZE * 2 <= MAX_TRUST_PAYLOAD + DTLS_EC_SIG_SIZE, "payload_buf must be able to hold two blocks");
+_Static_assert(TRUST_BLOCKS_MAX * TRUST_BLOCK_DIGEST_LEN + 16 <= MAX_TRUST_PAYLOAD, "Trust manifest too large");
+
+static struct {
+    trust_tx_item_t* manifest;
+
+    uint8_t token[COAP_TOKEN_LEN];
+    uint8_t token_len;
+
+    // Zero when there is no transfer whose blocks can be sent
+    uint8_t num_blocks;
+
+    // Bit n - 1 is set when block n needs to be sent, either for the first time or because a receiver missed it
+    uint16_t pending;
+
+    // Blocks are serialised again each time they are sent, as of the time and the records the manifest was
+    // created from. Blocks whose records have changed since then no longer match the manifest's digests.
+    uint32_t as_of;
+    uint16_t generation;
+    uint8_t digests[TRUST_BLOCKS_MAX * TRUST_BLOCK_DIGEST_LEN];
+
+    struct etimer timer;
+
+    bool in_progress;
+} block_tx;
+#endif
+
+// Requests blocks of a block-wise transfer that were missed from their sender
+static struct etimer block_rx_timer;
+/*-------------------------------------------------------------------------------------------------------------------*/
 static void
 res_trust_get_handler(coap_message_t *request, coap_message_t *response, uint8_t *buffer, uint16_t preferred_size, int32_t *offset);
 
@@ -94,6 +146,18 @@ RESOURCE(res_trust,
          NULL,                   /*PUT*/
          NULL                    /*DELETE*/);
 
+#ifndef TRUST_MODEL_NO_PERIODIC_BROADCAST
+static void
+res_trust_blocks_get_handler(coap_message_t *request, coap_message_t *response, uint8_t *buffer, uint16_t preferred_size, int32_t *offset);
+
+RESOURCE(res_trust_blocks,
+         "title=\"Trust blocks\";rt=\"trust\"",
+         res_trust_blocks_get_handler, /*GET*/  // Handle requests to resend blocks that were missed
+         NULL,                         /*POST*/
+         NULL,                         /*PUT*/
+         NULL                          /*DELETE*/);
+#endif
+
 static void
 res_trust_get_handler(coap_message_t *request, coap_message_t *response, uint8_t *buffer, uint16_t preferred_size, int32_t *offset)
 {
@@ -146,7 +210,8 @@ res_trust_get_handler(coap_message_t *request, coap_message_t *response, uint8_t
     // Will send the response in a subsequent message
     coap_set_status_code(response, CREATED_2_01);
 
-    if (!queue_message_to_sign(&trust_model, item, item->payload_buf, sizeof(item->payload_buf), payload_len))
+    if (!queue_message_to_sign(&trust_model, item, item->payload_buf, sizeof(item->payload_buf), payload_len,
+                               CRYPTO_PRIORITY_NORMAL, CRYPTO_NO_DEADLINE))
     {
         LOG_ERR("trust res_trust_get_handler: Unable to sign message\n");
 
@@ -178,6 +243,23 @@ res_trust_post_handler(coap_message_t *request, coap_message_t *response, uint8_
         return;
     }
 
+    uint32_t block_num;
+    uint8_t block_more;
+    uint16_t block_size;
+    uint32_t block_offset;
+    const bool is_block = coap_get_header_block1(request, &block_num, &block_more, &block_size, &block_offset);
+    if (is_block && block_num > 0)
+    {
+        // Blocks are authenticated using the digests in the already verified manifest (block 0),
+        // so can be merged immediately without needing to verify a signature or buffer them
+        if (process_received_trust_block(&request->src_ep->ipaddr, request->token, request->token_len,
+                                         block_num, payload, payload_len) < 0)
+        {
+            LOG_DBG("Failed to process trust block %" PRIu32 " (mid=%"PRIu16")\n", block_num, request->mid);
+        }
+        return;
+    }
+
     public_key_item_t* key = keystore_find_addr(&request->src_ep->ipaddr);
     if (key == NULL)
     {
@@ -190,6 +272,19 @@ res_trust_post_handler(coap_message_t *request, coap_message_t *response, uint8_
     }
     else
     {
+        const uint32_t retry_after = trust_admission_check(key->cert.subject);
+        if (retry_after != 0)
+        {
+            LOG_WARN("res_trust_post_handler: rate limited, retry after %" PRIu32 "s (mid=%"PRIu16")\n",
+                retry_after, request->mid);
+
+            // Too many verifies from this source or in total, tell it when there will be capacity for it
+            coap_set_status_code(response, SERVICE_UNAVAILABLE_5_03);
+            coap_set_header_max_age(response, retry_after);
+
+            return;
+        }
+
         LOG_DBG("Have public key, adding to queue to be verified (mid=%"PRIu16")\n", request->mid);
         trust_rx_item_t* item = memb_alloc(&trust_rx_memb);
         if (!item)
@@ -205,11 +300,15 @@ res_trust_post_handler(coap_message_t *request, coap_message_t *response, uint8_
         }
 
         item->key = key;
+        item->manifest = is_block;
+        item->token_len = MIN(request->token_len, COAP_TOKEN_LEN);
+        memcpy(item->token, request->token, item->token_len);
         memcpy(item->payload_buf, payload, payload_len);
 
         keystore_pin(key);
 
-        if (!queue_message_to_verify(&trust_model, item, item->payload_buf, payload_len, &key->cert.public_key))
+        if (!queue_message_to_verify(&trust_model, item, item->payload_buf, payload_len, &key->cert.public_key,
+                                     CRYPTO_PRIORITY_BULK, TRUST_RX_VERIFY_MAX_WAIT))
         {
             memb_free(&trust_rx_memb, item);
             keystore_unpin(key);
@@ -242,12 +341,23 @@ static void trust_rx_continue(void* data)
 
         int payload_len = entry->message_len - DTLS_EC_SIG_SIZE;
 
-        LOG_DBG("Trust payload verified (len=%d), need to merge with our db\n", payload_len);
-        process_received_trust(&ipaddr, item->payload_buf, payload_len);
+        if (item->manifest)
+        {
+            LOG_DBG("Trust manifest verified (len=%d), waiting for blocks\n", payload_len);
+            if (process_received_trust_manifest(&ipaddr, item->token, item->token_len, item->payload_buf, payload_len) == 0)
+            {
+                etimer_set(&block_rx_timer, TRUST_BLOCK_INTERVAL);
+            }
+        }
+        else
+        {
+            LOG_DBG("Trust payload verified (len=%d), need to merge with our db\n", payload_len);
+            process_received_trust(&ipaddr, item->payload_buf, payload_len);
+        }
     }
     else
     {
-        LOG_ERR("Verification of trust information failed %d, discarding it\n", entry->result);
+        LOG_ERR("Verification of trust information failed %" CRYPTO_RESULT_SPEC ", discarding it\n", entry->result);
     }
 
     keystore_unpin(item->key);
@@ -258,10 +368,283 @@ static void trust_rx_continue(void* data)
 }
 /*-------------------------------------------------------------------------------------------------------------------*/
 #ifndef TRUST_MODEL_NO_PERIODIC_BROADCAST
+static void broadcast_init(trust_tx_item_t* item)
+{
+    uip_create_linklocal_allnodes_mcast(&item->ep.ipaddr);
+    item->ep.secure = 0;
+    item->ep.port = UIP_HTONS(COAP_DEFAULT_PORT);
+
+    // This is a non-confirmable message
+    coap_init_message(&item->msg, COAP_TYPE_NON, COAP_POST, 0);
+    coap_set_header_content_format(&item->msg, APPLICATION_CBOR);
+    coap_set_header_uri_path(&item->msg, TRUST_COAP_URI);
+}
+/*-------------------------------------------------------------------------------------------------------------------*/
+static bool block_tx_start(trust_tx_item_t* item)
+{
+    if (block_tx.in_progress)
+    {
+        LOG_WARN("block_tx_start: Previous transfer still in progress\n");
+        return false;
+    }
+
+    // Blocks of the previous transfer can no longer be resent
+    block_tx.num_blocks = 0;
+    block_tx.pending = 0;
+
+    trust_stream_t stream;
+    serialise_trust_stream_init(&stream);
+
+    uint8_t* const digests = block_tx.digests;
+    uint8_t num_blocks;
+    for (num_blocks = 0; ; ++num_blocks)
+    {
+        int block_len = serialise_trust_stream_next(&stream, item->payload_buf, TRUST_BLOCK_SIZE, sizeof(item->payload_buf));
+        if (block_len < 0)
+        {
+            return false;
+        }
+
+        if (block_len == 0)
+        {
+            break;
+        }
+
+        if (num_blocks == TRUST_BLOCKS_MAX)
+        {
+            LOG_ERR("block_tx_start: Trust needs more than " CC_STRINGIFY(TRUST_BLOCKS_MAX) " blocks\n");
+            return false;
+        }
+
+        if (!trust_block_digest(item->payload_buf, block_len, &digests[num_blocks * TRUST_BLOCK_DIGEST_LEN]))
+        {
+            return false;
+        }
+    }
+
+    if (num_blocks == 0)
+    {
+        return false;
+    }
+
+    int payload_len = serialise_trust_manifest(item->payload_buf, MAX_TRUST_PAYLOAD, num_blocks, digests);
+    if (payload_len <= 0 || payload_len > MAX_TRUST_PAYLOAD)
+    {
+        LOG_ERR("block_tx_start: serialise_trust_manifest failed %d\n", payload_len);
+        return false;
+    }
+
+    // The manifest is block 0, all blocks share the same token
+    coap_set_header_block1(&item->msg, 0, 1, TRUST_BLOCK_SIZE);
+
+    memcpy(block_tx.token, item->msg.token, item->msg.token_len);
+    block_tx.token_len = item->msg.token_len;
+    block_tx.num_blocks = num_blocks;
+    block_tx.pending = (uint16_t)((1u << num_blocks) - 1);
+    block_tx.as_of = stream.as_of;
+    block_tx.generation = edge_info_generation();
+    block_tx.manifest = item;
+
+    if (!queue_message_to_sign(&trust_model, item, item->payload_buf, sizeof(item->payload_buf), payload_len,
+                               CRYPTO_PRIORITY_BULK, CRYPTO_NO_DEADLINE))
+    {
+        LOG_ERR("block_tx_start: Unable to sign manifest\n");
+        block_tx.manifest = NULL;
+        block_tx.num_blocks = 0;
+        block_tx.pending = 0;
+        return false;
+    }
+
+    block_tx.in_progress = true;
+
+    LOG_DBG("block_tx_start: Manifest for %" PRIu8 " blocks queued to be signed\n", num_blocks);
+
+    return true;
+}
+/*-------------------------------------------------------------------------------------------------------------------*/
+static void block_tx_manifest_sent(bool success)
+{
+    block_tx.manifest = NULL;
+
+    if (success)
+    {
+        etimer_set(&block_tx.timer, TRUST_BLOCK_INTERVAL);
+    }
+    else
+    {
+        block_tx.in_progress = false;
+        block_tx.num_blocks = 0;
+        block_tx.pending = 0;
+    }
+}
+/*-------------------------------------------------------------------------------------------------------------------*/
+static void block_tx_abort(void)
+{
+    block_tx.in_progress = false;
+    block_tx.num_blocks = 0;
+    block_tx.pending = 0;
+
+    // Receivers will have missed some records, so make sure they get them next time
+    serialise_trust_request_snapshot();
+}
+/*-------------------------------------------------------------------------------------------------------------------*/
+// Serialises block num of the transfer again, returns its length or -1 if it no longer matches the manifest
+static int block_tx_serialise(uint8_t num, uint8_t* buffer, size_t buffer_len)
+{
+    trust_stream_t stream;
+    serialise_trust_stream_init(&stream);
+    stream.as_of = block_tx.as_of;
+
+    // Blocks end where the next record does not fit, so the earlier blocks are needed to find where this one starts
+    int block_len = 0;
+    for (uint8_t i = 0; i != num; ++i)
+    {
+        block_len = serialise_trust_stream_next(&stream, buffer, TRUST_BLOCK_SIZE, buffer_len);
+        if (block_len <= 0)
+        {
+            return -1;
+        }
+    }
+
+    // Unchanged records serialise to the same blocks
+    if (edge_info_generation() == block_tx.generation)
+    {
+        return block_len;
+    }
+
+    // Otherwise the change may have been to records in other blocks
+    uint8_t digest[TRUST_BLOCK_DIGEST_LEN];
+    if (!trust_block_digest(buffer, block_len, digest) ||
+        memcmp(digest, &block_tx.digests[(num - 1) * TRUST_BLOCK_DIGEST_LEN], TRUST_BLOCK_DIGEST_LEN) != 0)
+    {
+        return -1;
+    }
+
+    return block_len;
+}
+/*-------------------------------------------------------------------------------------------------------------------*/
+static void block_tx_next(void)
+{
+    if (block_tx.pending == 0)
+    {
+        block_tx.in_progress = false;
+        return;
+    }
+
+    trust_tx_item_t* item = memb_alloc(&trust_tx_memb);
+    if (!item)
+    {
+        LOG_WARN("block_tx_next: Cannot allocate memory, will retry\n");
+        etimer_restart(&block_tx.timer);
+        return;
+    }
+
+    // Lowest numbered block that still needs to be sent
+    uint8_t num = 1;
+    while ((block_tx.pending & ((uint16_t)1 << (num - 1))) == 0)
+    {
+        ++num;
+    }
+
+    const bool more = num < block_tx.num_blocks;
+
+    const int block_len = block_tx_serialise(num, item->payload_buf, sizeof(item->payload_buf));
+    if (block_len < 0)
+    {
+        LOG_WARN("block_tx_next: Trust in block %" PRIu8 " has changed since the manifest, will send a new snapshot\n", num);
+        block_tx_abort();
+        memb_free(&trust_tx_memb, item);
+        return;
+    }
+
+    broadcast_init(item);
+    coap_set_token(&item->msg, block_tx.token, block_tx.token_len);
+    coap_set_header_block1(&item->msg, num, more, TRUST_BLOCK_SIZE);
+
+#if defined(WITH_OSCORE) && defined(WITH_GROUPCOM)
+    keystore_protect_coap_with_oscore(&item->msg, &item->ep);
+#endif
+
+    coap_set_payload(&item->msg, item->payload_buf, block_len);
+
+    int ret = coap_send_request(&item->coap_callback, &item->ep, &item->msg, NULL);
+    if (ret)
+    {
+        LOG_DBG("block_tx_next: Sent block %" PRIu8 "/%" PRIu8 " (len=%d)\n", num, block_tx.num_blocks, block_len);
+    }
+    else
+    {
+        LOG_ERR("block_tx_next: coap_send_request block %" PRIu8 " failed %d\n", num, ret);
+        block_tx_abort();
+        memb_free(&trust_tx_memb, item);
+        return;
+    }
+
+    memb_free(&trust_tx_memb, item);
+
+    block_tx.pending &= ~((uint16_t)1 << (num - 1));
+
+    if (block_tx.pending != 0)
+    {
+        etimer_restart(&block_tx.timer);
+    }
+    else
+    {
+        block_tx.in_progress = false;
+    }
+}
+/*-------------------------------------------------------------------------------------------------------------------*/
+static void
+res_trust_blocks_get_handler(coap_message_t *request, coap_message_t *response, uint8_t *buffer, uint16_t preferred_size, int32_t *offset)
+{
+    // A receiver missed some blocks of our last block-wise transfer, the payload is the bitmap of missing blocks
+    const uint8_t* payload;
+    int payload_len = coap_get_payload(request, &payload);
+    if (payload_len != sizeof(uint16_t))
+    {
+        coap_set_status_code(response, BAD_REQUEST_4_00);
+        return;
+    }
+
+    if (block_tx.num_blocks == 0 ||
+        request->token_len != block_tx.token_len ||
+        memcmp(request->token, block_tx.token, block_tx.token_len) != 0)
+    {
+        // The blocks of older transfers are not kept, the receiver will get them in the next snapshot
+        LOG_DBG("res_trust_blocks_get_handler: Transfer no longer available (mid=%"PRIu16")\n", request->mid);
+        coap_set_status_code(response, NOT_FOUND_4_04);
+        return;
+    }
+
+    const uint16_t missing = ((uint16_t)payload[0] << 8) | payload[1];
+
+    // Resent to everyone, as other receivers are likely to have missed the same blocks
+    block_tx.pending |= missing & (uint16_t)((1u << block_tx.num_blocks) - 1);
+
+    LOG_DBG("res_trust_blocks_get_handler: Resending blocks %" PRIx16 " (mid=%"PRIu16")\n", block_tx.pending, request->mid);
+
+    if (!block_tx.in_progress && block_tx.pending != 0)
+    {
+        block_tx.in_progress = true;
+
+        PROCESS_CONTEXT_BEGIN(&trust_model);
+        etimer_set(&block_tx.timer, TRUST_BLOCK_INTERVAL);
+        PROCESS_CONTEXT_END(&trust_model);
+    }
+
+    coap_set_status_code(response, CHANGED_2_04);
+}
+/*-------------------------------------------------------------------------------------------------------------------*/
 static bool periodic_action(void)
 {
     LOG_DBG("Generating a periodic trust info packet\n");
 
+    trust_cache_stats_print();
+    edge_info_eviction_stats_print();
+    keystore_stats_print();
+    crypto_support_stats_print();
+    trust_admission_stats_print();
+
     trust_tx_item_t* item = memb_alloc(&trust_tx_memb);
     if (!item)
     {
@@ -269,31 +652,50 @@ static bool periodic_action(void)
         return false;
     }
 
-    uip_create_linklocal_allnodes_mcast(&item->ep.ipaddr);
-    item->ep.secure = 0;
-    item->ep.port = UIP_HTONS(COAP_DEFAULT_PORT);
-
-    // This is a non-confirmable message
-    coap_init_message(&item->msg, COAP_TYPE_NON, COAP_POST, 0);
-    coap_set_header_content_format(&item->msg, APPLICATION_CBOR);
-    coap_set_header_uri_path(&item->msg, TRUST_COAP_URI);
+    broadcast_init(item);
     coap_set_random_token(&item->msg);
 
 #if defined(WITH_OSCORE) && defined(WITH_GROUPCOM)
     keystore_protect_coap_with_oscore(&msg, &item->ep);
 #endif
 
-    int payload_len = serialise_trust(NULL, item->payload_buf, MAX_TRUST_PAYLOAD);
-    if (payload_len <= 0 || payload_len > MAX_TRUST_PAYLOAD)
+    int payload_len = serialise_trust_periodic(item->payload_buf, MAX_TRUST_PAYLOAD);
+    if (payload_len == 0)
     {
-        LOG_ERR("trust periodic_action: serialise_trust failed %d\n", payload_len);
+        LOG_DBG("trust periodic_action: No trust changes to broadcast\n");
+        memb_free(&trust_tx_memb, item);
+        return true;
+    }
+
+    if (payload_len == NANOCBOR_ERR_END)
+    {
+        LOG_INFO("trust periodic_action: Trust too large for a single payload, sending block-wise\n");
+
+        if (!block_tx_start(item))
+        {
+            LOG_ERR("trust periodic_action: Unable to start block-wise transfer\n");
+            serialise_trust_request_snapshot();
+            memb_free(&trust_tx_memb, item);
+            return false;
+        }
+
+        return true;
+    }
+
+    if (payload_len < 0 || payload_len > MAX_TRUST_PAYLOAD)
+    {
+        LOG_ERR("trust periodic_action: serialise_trust_periodic failed %d\n", payload_len);
+        serialise_trust_request_snapshot();
         memb_free(&trust_tx_memb, item);
         return false;
     }
 
-    if (!queue_message_to_sign(&trust_model, item, item->payload_buf, sizeof(item->payload_buf), payload_len))
+    if (!queue_message_to_sign(&trust_model, item, item->payload_buf, sizeof(item->payload_buf), payload_len,
+                               CRYPTO_PRIORITY_BULK, CRYPTO_NO_DEADLINE))
     {
         LOG_ERR("trust periodic_action: Unable to sign message\n");
+        // The changes in this broadcast have been lost, so resend everything next time
+        serialise_trust_request_snapshot();
         memb_free(&trust_tx_memb, item);
         return false;
     }
@@ -304,6 +706,55 @@ static bool periodic_action(void)
 }
 #endif
 /*-------------------------------------------------------------------------------------------------------------------*/
+static void block_rx_nack(void)
+{
+    uip_ipaddr_t src;
+    const uint8_t* token;
+    uint8_t token_len;
+    uint16_t missing;
+
+    while (trust_rx_transfer_nack(&src, &token, &token_len, &missing))
+    {
+        trust_tx_item_t* item = memb_alloc(&trust_tx_memb);
+        if (!item)
+        {
+            LOG_WARN("block_rx_nack: Cannot allocate memory, will retry\n");
+            break;
+        }
+
+        uip_ipaddr_copy(&item->ep.ipaddr, &src);
+        item->ep.secure = 0;
+        item->ep.port = UIP_HTONS(COAP_DEFAULT_PORT);
+
+        coap_init_message(&item->msg, COAP_TYPE_NON, COAP_GET, 0);
+        coap_set_header_uri_path(&item->msg, TRUST_BLOCKS_COAP_URI);
+        coap_set_token(&item->msg, token, token_len);
+
+        item->payload_buf[0] = (uint8_t)(missing >> 8);
+        item->payload_buf[1] = (uint8_t)missing;
+        coap_set_payload(&item->msg, item->payload_buf, sizeof(missing));
+
+        int ret = coap_send_request(&item->coap_callback, &item->ep, &item->msg, NULL);
+        if (ret)
+        {
+            LOG_DBG("block_rx_nack: Requested missing blocks %" PRIx16 " from ", missing);
+            LOG_DBG_6ADDR(&src);
+            LOG_DBG_("\n");
+        }
+        else
+        {
+            LOG_ERR("block_rx_nack: coap_send_request failed %d\n", ret);
+        }
+
+        memb_free(&trust_tx_memb, item);
+    }
+
+    if (trust_rx_transfers_pending())
+    {
+        etimer_restart(&block_rx_timer);
+    }
+}
+/*-------------------------------------------------------------------------------------------------------------------*/
 static void trust_tx_continue(void* data)
 {
     messages_to_sign_entry_t* entry = (messages_to_sign_entry_t*)data;
@@ -327,11 +778,27 @@ static void trust_tx_continue(void* data)
         else
         {
             LOG_ERR("trust_tx_continue: coap_send_request trust failed %d\n", ret);
+            serialise_trust_request_snapshot();
+        }
+
+#ifndef TRUST_MODEL_NO_PERIODIC_BROADCAST
+        if (item == block_tx.manifest)
+        {
+            block_tx_manifest_sent(ret);
         }
+#endif
     }
     else
     {
-        LOG_ERR("trust_tx_continue: Sign of trust information failed %d\n", entry->result);
+        LOG_ERR("trust_tx_continue: Sign of trust information failed %" CRYPTO_RESULT_SPEC "\n", entry->result);
+        serialise_trust_request_snapshot();
+
+#ifndef TRUST_MODEL_NO_PERIODIC_BROADCAST
+        if (item == block_tx.manifest)
+        {
+            block_tx_manifest_sent(false);
+        }
+#endif
     }
 
     queue_message_to_sign_done(entry);
@@ -341,12 +808,16 @@ static void trust_tx_continue(void* data)
 /*-------------------------------------------------------------------------------------------------------------------*/
 static void init(void)
 {
-    trust_common_init();
     edge_info_init();
     capability_info_init();
     peer_info_init();
+    trust_common_init();
+    trust_admission_init();
 
     coap_activate_resource(&res_trust, TRUST_COAP_URI);
+#ifndef TRUST_MODEL_NO_PERIODIC_BROADCAST
+    coap_activate_resource(&res_trust_blocks, TRUST_BLOCKS_COAP_URI);
+#endif
 
 #if defined(WITH_OSCORE) && defined(WITH_GROUPCOM)
     oscore_protect_resource(&res_trust);
@@ -383,8 +854,18 @@ PROCESS_THREAD(trust_model, ev, data)
             etimer_reset(&periodic_timer);
             periodic_action();
         }
+
+        if (ev == PROCESS_EVENT_TIMER && data == &block_tx.timer)
+        {
+            block_tx_next();
+        }
 #endif
 
+        if (ev == PROCESS_EVENT_TIMER && data == &block_rx_timer)
+        {
+            block_rx_nack();
+        }
+
         if (ev == pe_message_signed)
         {
             trust_tx_continue(data);
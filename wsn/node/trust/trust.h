@@ -5,4 +5,5 @@
 #include "keys.h"
 
 #define TRUST_COAP_URI "trust"
+#define TRUST_BLOCKS_COAP_URI "trust/blocks"
 #define MAX_TRUST_PAYLOAD (COAP_MAX_CHUNK_SIZE - DTLS_EC_SIG_SIZE)
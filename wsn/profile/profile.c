@@ -7,6 +7,12 @@
 #include "oscore-crypto.h"
 #include "cose.h"
 #include "certificate.h"
+#include "edge-info.h"
+#include "peer-info.h"
+#include "trust-common.h"
+#include "eui64.h"
+
+#include <stdlib.h>
 /*-------------------------------------------------------------------------------------------------------------------*/
 #define LOG_MODULE "profile"
 #define LOG_LEVEL LOG_LEVEL_DBG
@@ -14,6 +20,9 @@
 PROCESS(profile, "profile");
 PROCESS(profile_ecc_sign_verify, "profile_ecc_sign_verify");
 PROCESS(profile_aes_ccm, "profile_aes_ccm");
+PROCESS(profile_edge_lookup, "profile_edge_lookup");
+PROCESS(profile_trust_merge, "profile_trust_merge");
+PROCESS(profile_crypto_queue, "profile_crypto_queue");
 /*-------------------------------------------------------------------------------------------------------------------*/
 AUTOSTART_PROCESSES(&profile);
 /*-------------------------------------------------------------------------------------------------------------------*/
@@ -35,6 +44,21 @@ PROCESS_THREAD(profile, ev, data)
     process_start(&profile_aes_ccm, NULL);
     PROCESS_YIELD_UNTIL(!process_is_running(&profile_aes_ccm));
 
+#elif defined(PROFILE_TRUST)
+    LOG_INFO("Profiling trust\n");
+
+    process_start(&profile_edge_lookup, NULL);
+    PROCESS_YIELD_UNTIL(!process_is_running(&profile_edge_lookup));
+
+    process_start(&profile_trust_merge, NULL);
+    PROCESS_YIELD_UNTIL(!process_is_running(&profile_trust_merge));
+
+#elif defined(PROFILE_CRYPTO_QUEUE)
+    LOG_INFO("Profiling crypto queue\n");
+
+    process_start(&profile_crypto_queue, NULL);
+    PROCESS_YIELD_UNTIL(!process_is_running(&profile_crypto_queue));
+
 #else
 #   error "Not profiling anything"
 #endif
@@ -62,7 +86,8 @@ PROCESS_THREAD(profile_ecc_sign_verify, ev, data)
         assert(r);
         
 
-        r = queue_message_to_sign(&profile_ecc_sign_verify, NULL, message, sizeof(message), message_len);
+        r = queue_message_to_sign(&profile_ecc_sign_verify, NULL, message, sizeof(message), message_len,
+                                  CRYPTO_PRIORITY_NORMAL, CRYPTO_NO_DEADLINE);
         assert(r);
 
         PROCESS_WAIT_EVENT_UNTIL(ev == pe_message_signed);
@@ -70,7 +95,8 @@ PROCESS_THREAD(profile_ecc_sign_verify, ev, data)
         queue_message_to_sign_done((messages_to_sign_entry_t*)data);
 
 
-        r = queue_message_to_verify(&profile_ecc_sign_verify, NULL, message, message_len + DTLS_EC_SIG_SIZE, &our_cert.public_key);
+        r = queue_message_to_verify(&profile_ecc_sign_verify, NULL, message, message_len + DTLS_EC_SIG_SIZE, &our_cert.public_key,
+                                    CRYPTO_PRIORITY_NORMAL, CRYPTO_NO_DEADLINE);
         assert(r);
 
         PROCESS_WAIT_EVENT_UNTIL(ev == pe_message_verified);
@@ -175,3 +201,355 @@ PROCESS_THREAD(profile_aes_ccm, ev, data)
     PROCESS_END();
 }
 /*-------------------------------------------------------------------------------------------------------------------*/
+#ifndef PROFILE_TRUST_LOOKUPS
+#define PROFILE_TRUST_LOOKUPS 100
+#endif
+/*-------------------------------------------------------------------------------------------------------------------*/
+static edge_resource_t*
+edge_find_linear(const uip_ipaddr_t* addr)
+{
+    // The lookup edge_info_find_addr performed before it was indexed
+    for (edge_resource_t* iter = edge_info_iter(); iter != NULL; iter = edge_info_next(iter))
+    {
+        if (uip_ip6addr_cmp(&iter->ep.ipaddr, addr))
+        {
+            return iter;
+        }
+    }
+
+    return NULL;
+}
+/*-------------------------------------------------------------------------------------------------------------------*/
+PROCESS_THREAD(profile_edge_lookup, ev, data)
+{
+    PROCESS_BEGIN();
+
+    static const uint16_t num_edges[] = {4, 16, 64};
+    static uip_ipaddr_t addrs[64];
+
+    static uint8_t size;
+    static uint16_t i;
+    static uint16_t repeat;
+    static uint16_t found;
+
+    static rtimer_clock_t time;
+
+    for (i = 0; i != sizeof(addrs)/sizeof(*addrs); ++i)
+    {
+        const uint8_t eui64[EUI64_LENGTH] = {0x00, 0x12, 0x4b, 0x00, 0x00, 0x00, i >> 8, i & 0xff};
+        eui64_to_ipaddr(eui64, &addrs[i]);
+    }
+
+    for (size = 0; size != sizeof(num_edges)/sizeof(*num_edges); ++size)
+    {
+        if (num_edges[size] > NUM_EDGE_RESOURCES)
+        {
+            LOG_WARN("Skipping %" PRIu16 " edges as NUM_EDGE_RESOURCES=%d\n", num_edges[size], NUM_EDGE_RESOURCES);
+            continue;
+        }
+
+        edge_info_init();
+
+        for (i = 0; i != num_edges[size]; ++i)
+        {
+            edge_resource_t* edge = edge_info_add(&addrs[i]);
+            assert(edge != NULL);
+        }
+
+        LOG_DBG("Starting linear lookup(%" PRIu16 ")...\n", num_edges[size]);
+        found = 0;
+        time = RTIMER_NOW();
+
+        for (repeat = 0; repeat != PROFILE_TRUST_LOOKUPS; ++repeat)
+        {
+            for (i = 0; i != num_edges[size]; ++i)
+            {
+                found += edge_find_linear(&addrs[i]) != NULL;
+            }
+        }
+
+        time = RTIMER_NOW() - time;
+        LOG_DBG("linear lookup(%" PRIu16 "), %" PRIu32 " us for %" PRIu16 " lookups\n",
+            num_edges[size], RTIMERTICKS_TO_US_64(time), found);
+
+        PROCESS_PAUSE();
+
+        LOG_DBG("Starting indexed lookup(%" PRIu16 ")...\n", num_edges[size]);
+        found = 0;
+        time = RTIMER_NOW();
+
+        for (repeat = 0; repeat != PROFILE_TRUST_LOOKUPS; ++repeat)
+        {
+            for (i = 0; i != num_edges[size]; ++i)
+            {
+                found += edge_info_find_addr(&addrs[i]) != NULL;
+            }
+        }
+
+        time = RTIMER_NOW() - time;
+        LOG_DBG("indexed lookup(%" PRIu16 "), %" PRIu32 " us for %" PRIu16 " lookups\n",
+            num_edges[size], RTIMERTICKS_TO_US_64(time), found);
+
+        // Need to yield often enough to prevent the watchdog killing us
+        PROCESS_PAUSE();
+    }
+
+    process_poll(&profile);
+
+    PROCESS_END();
+}
+/*-------------------------------------------------------------------------------------------------------------------*/
+#ifndef PROFILE_TRUST_MERGES
+#define PROFILE_TRUST_MERGES 20
+#endif
+
+#ifndef PROFILE_TRUST_BUFFER_LEN
+#define PROFILE_TRUST_BUFFER_LEN 2048
+#endif
+/*-------------------------------------------------------------------------------------------------------------------*/
+PROCESS_THREAD(profile_trust_merge, ev, data)
+{
+    PROCESS_BEGIN();
+
+#ifdef TRUST_MODEL_NO_PEER_PROVIDED
+    LOG_WARN("Skipping trust merge as the trust model has no peer provided information\n");
+#else
+    static const uint16_t num_edges[] = {4, 16, 64};
+    static uint8_t buffer[PROFILE_TRUST_BUFFER_LEN];
+    static uip_ipaddr_t peer_addr;
+
+    static uint8_t size;
+    static capability_id_t num_caps;
+    static uint16_t i;
+    static uint16_t repeat;
+    static int len;
+    static int failed;
+
+    static rtimer_clock_t time;
+
+    const uint8_t peer_eui64[EUI64_LENGTH] = {0x00, 0x12, 0x4b, 0x00, 0x00, 0x00, 0xff, 0xff};
+    eui64_to_ipaddr(peer_eui64, &peer_addr);
+
+    for (size = 0; size != sizeof(num_edges)/sizeof(*num_edges); ++size)
+    {
+        if (num_edges[size] > NUM_EDGE_RESOURCES)
+        {
+            LOG_WARN("Skipping %" PRIu16 " edges as NUM_EDGE_RESOURCES=%d\n", num_edges[size], NUM_EDGE_RESOURCES);
+            continue;
+        }
+
+        for (num_caps = 1; num_caps <= CAPABILITY_ID_NUM && num_caps <= NUM_EDGE_CAPABILITIES; ++num_caps)
+        {
+            edge_info_init();
+            peer_info_init();
+
+            // Add in reverse order so the canonical ordering is exercised
+            for (i = num_edges[size]; i-- != 0; )
+            {
+                const uint8_t eui64[EUI64_LENGTH] = {0x00, 0x12, 0x4b, 0x00, 0x00, 0x00, i >> 8, i & 0xff};
+                uip_ipaddr_t addr;
+                eui64_to_ipaddr(eui64, &addr);
+
+                edge_resource_t* edge = edge_info_add(&addr);
+                assert(edge != NULL);
+
+                for (capability_id_t id = num_caps; id-- != 0; )
+                {
+                    edge_capability_t* cap = edge_info_capability_add(edge, id);
+                    assert(cap != NULL);
+                }
+            }
+
+            // Our own trust information stands in for what a peer would send
+            len = serialise_trust(NULL, buffer, sizeof(buffer));
+            if (len <= 0)
+            {
+                LOG_WARN("Skipping merge(%" PRIu16 ", %u) as it does not fit in %u bytes\n",
+                    num_edges[size], num_caps, PROFILE_TRUST_BUFFER_LEN);
+                continue;
+            }
+
+            LOG_DBG("Starting merge(%" PRIu16 ", %u) of %d bytes...\n", num_edges[size], num_caps, len);
+            failed = 0;
+            time = RTIMER_NOW();
+
+            // The first merge allocates the peer's records, the rest update them in place
+            for (repeat = 0; repeat != PROFILE_TRUST_MERGES; ++repeat)
+            {
+                failed += process_received_trust(&peer_addr, buffer, len) != 0;
+            }
+
+            time = RTIMER_NOW() - time;
+            LOG_DBG("merge(%" PRIu16 ", %u), %" PRIu32 " us for %u merges (%d failed)\n",
+                num_edges[size], num_caps, RTIMERTICKS_TO_US_64(time), PROFILE_TRUST_MERGES, failed);
+
+            // Need to yield often enough to prevent the watchdog killing us
+            PROCESS_PAUSE();
+        }
+    }
+#endif
+
+    process_poll(&profile);
+
+    PROCESS_END();
+}
+/*-------------------------------------------------------------------------------------------------------------------*/
+// Enough probes for p99 to be the second slowest rather than the slowest
+#ifndef PROFILE_CRYPTO_QUEUE_PROBES
+#define PROFILE_CRYPTO_QUEUE_PROBES 200
+#endif
+
+_Static_assert(PROFILE_CRYPTO_QUEUE_PROBES > 0 && PROFILE_CRYPTO_QUEUE_PROBES <= UINT8_MAX, "Invalid number of probes");
+
+// Number of bulk verifies kept queued while probing
+#ifndef PROFILE_CRYPTO_QUEUE_BULK
+#define PROFILE_CRYPTO_QUEUE_BULK 5
+#endif
+
+#ifndef PROFILE_CRYPTO_QUEUE_BULK_MAX_WAIT
+#define PROFILE_CRYPTO_QUEUE_BULK_MAX_WAIT (5 * CLOCK_SECOND)
+#endif
+
+#ifndef PROFILE_CRYPTO_QUEUE_MESSAGE_LEN
+#define PROFILE_CRYPTO_QUEUE_MESSAGE_LEN 128
+#endif
+/*-------------------------------------------------------------------------------------------------------------------*/
+static int
+uint32_cmp(const void* a, const void* b)
+{
+    const uint32_t x = *(const uint32_t*)a;
+    const uint32_t y = *(const uint32_t*)b;
+
+    return (x > y) - (x < y);
+}
+/*-------------------------------------------------------------------------------------------------------------------*/
+// Nearest-rank percentile of sorted values
+static uint32_t
+percentile(const uint32_t* sorted, uint16_t count, uint8_t p)
+{
+    const uint16_t rank = (uint16_t)(((uint32_t)count * p + 99) / 100);
+
+    return sorted[rank == 0 ? 0 : rank - 1];
+}
+/*-------------------------------------------------------------------------------------------------------------------*/
+// Measures the latency of a verify (the probe) queued behind a backlog of bulk verifies.
+// First the probe is queued like the backlog, so it is verified in the order queued, then it is queued as critical.
+PROCESS_THREAD(profile_crypto_queue, ev, data)
+{
+    PROCESS_BEGIN();
+
+    crypto_support_init();
+
+    static uint8_t message[PROFILE_CRYPTO_QUEUE_MESSAGE_LEN + DTLS_EC_SIG_SIZE];
+    static uint8_t probe_marker;
+
+    static uint32_t latencies[PROFILE_CRYPTO_QUEUE_PROBES];
+    static uint8_t phase;
+    static uint8_t probes;
+    static uint8_t bulk_in_flight;
+    static uint8_t bulk_since_probe;
+    static uint16_t bulk_expired;
+    static uint8_t probe_expired;
+    static bool probe_in_flight;
+    static crypto_priority_t probe_priority;
+    static clock_time_t probe_max_wait;
+    static rtimer_clock_t probe_queued_at;
+
+    static bool r;
+
+    r = crypto_fill_random(message, PROFILE_CRYPTO_QUEUE_MESSAGE_LEN);
+    assert(r);
+
+    // Every verify is of the same signed message
+    r = queue_message_to_sign(&profile_crypto_queue, NULL, message, sizeof(message), PROFILE_CRYPTO_QUEUE_MESSAGE_LEN,
+                              CRYPTO_PRIORITY_NORMAL, CRYPTO_NO_DEADLINE);
+    assert(r);
+
+    PROCESS_WAIT_EVENT_UNTIL(ev == pe_message_signed);
+    assert(platform_crypto_success(((messages_to_sign_entry_t*)data)->result));
+    queue_message_to_sign_done((messages_to_sign_entry_t*)data);
+
+    for (phase = 0; phase != 2; ++phase)
+    {
+        probe_priority = phase == 0 ? CRYPTO_PRIORITY_BULK : CRYPTO_PRIORITY_CRITICAL;
+        probe_max_wait = phase == 0 ? PROFILE_CRYPTO_QUEUE_BULK_MAX_WAIT : CRYPTO_NO_DEADLINE;
+
+        crypto_support_stats_reset();
+        probes = 0;
+        bulk_in_flight = 0;
+        bulk_since_probe = 0;
+        bulk_expired = 0;
+        probe_expired = 0;
+        probe_in_flight = false;
+
+        LOG_DBG("Starting crypto queue(priority=%u, bulk=%u)...\n", probe_priority, PROFILE_CRYPTO_QUEUE_BULK);
+
+        while (probes != PROFILE_CRYPTO_QUEUE_PROBES || bulk_in_flight != 0 || probe_in_flight)
+        {
+            // Keep the verifier saturated with bulk work until all the probes are done
+            while (probes != PROFILE_CRYPTO_QUEUE_PROBES && bulk_in_flight != PROFILE_CRYPTO_QUEUE_BULK)
+            {
+                if (!queue_message_to_verify(&profile_crypto_queue, NULL,
+                                             message, PROFILE_CRYPTO_QUEUE_MESSAGE_LEN + DTLS_EC_SIG_SIZE,
+                                             &our_cert.public_key,
+                                             CRYPTO_PRIORITY_BULK, PROFILE_CRYPTO_QUEUE_BULK_MAX_WAIT))
+                {
+                    break;
+                }
+                bulk_in_flight += 1;
+            }
+
+            // Only probe once the backlog has been replaced, so every probe is queued behind it
+            if (probes != PROFILE_CRYPTO_QUEUE_PROBES && !probe_in_flight && bulk_since_probe >= PROFILE_CRYPTO_QUEUE_BULK)
+            {
+                probe_queued_at = RTIMER_NOW();
+                r = queue_message_to_verify(&profile_crypto_queue, &probe_marker,
+                                            message, PROFILE_CRYPTO_QUEUE_MESSAGE_LEN + DTLS_EC_SIG_SIZE,
+                                            &our_cert.public_key,
+                                            probe_priority, probe_max_wait);
+                assert(r);
+                probe_in_flight = true;
+            }
+
+            PROCESS_WAIT_EVENT_UNTIL(ev == pe_message_verified);
+
+            messages_to_verify_entry_t* entry = (messages_to_verify_entry_t*)data;
+            if (entry->data == &probe_marker)
+            {
+                probe_expired += entry->result == PLATFORM_CRYPTO_EXPIRED;
+                latencies[probes++] = RTIMERTICKS_TO_US_64(RTIMER_NOW() - probe_queued_at);
+                probe_in_flight = false;
+                bulk_since_probe = 0;
+            }
+            else
+            {
+                bulk_expired += entry->result == PLATFORM_CRYPTO_EXPIRED;
+                bulk_in_flight -= 1;
+                bulk_since_probe += 1;
+            }
+
+            queue_message_to_verify_done(entry);
+        }
+
+        qsort(latencies, PROFILE_CRYPTO_QUEUE_PROBES, sizeof(*latencies), uint32_cmp);
+
+        LOG_DBG("crypto queue(priority=%u, bulk=%u), probe latency p50=%" PRIu32 " p95=%" PRIu32 " p99=%" PRIu32
+                " max=%" PRIu32 " us for %u probes (%u probes and %" PRIu16 " bulk expired)\n",
+            probe_priority, PROFILE_CRYPTO_QUEUE_BULK,
+            percentile(latencies, PROFILE_CRYPTO_QUEUE_PROBES, 50),
+            percentile(latencies, PROFILE_CRYPTO_QUEUE_PROBES, 95),
+            percentile(latencies, PROFILE_CRYPTO_QUEUE_PROBES, 99),
+            latencies[PROFILE_CRYPTO_QUEUE_PROBES - 1],
+            PROFILE_CRYPTO_QUEUE_PROBES, probe_expired, bulk_expired);
+
+        crypto_support_stats_print();
+
+        // Need to yield often enough to prevent the watchdog killing us
+        PROCESS_PAUSE();
+    }
+
+    process_poll(&profile);
+
+    PROCESS_END();
+}
+/*-------------------------------------------------------------------------------------------------------------------*/